@@ -268,7 +268,7 @@ namespace carla {
     void resize(uint64_t size) {
       if(_capacity < size) {
         std::unique_ptr<value_type[]> data = std::move(_data);
-        uint64_t old_size = size;
+        const size_type old_size = _size;
         reset(size);
         copy_from(data.get(), static_cast<size_type>(old_size));
       }
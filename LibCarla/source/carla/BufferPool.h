@@ -17,6 +17,10 @@
 #  pragma clang diagnostic pop
 #endif
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
 #include <memory>
 
 namespace carla {
@@ -24,37 +28,182 @@ namespace carla {
   /// A pool of Buffer. Buffers popped from this pool automatically return to
   /// the pool on destruction so the allocated memory can be reused.
   ///
-  /// @warning Buffers adjust their size only by growing, they never shrink
-  /// unless explicitly cleared. The allocated memory is only deleted when this
-  /// pool is destroyed.
+  /// Buffers are kept in size classes by capacity, powers of two, so that
+  /// Pop(size) hands out a buffer that fits without wasting much memory: a
+  /// small message never takes a large buffer, and does not make a large
+  /// message allocate again.
+  ///
+  /// The pool holds at most GetMaxBytes() bytes, buffers returning to a pool
+  /// that is full are deleted. A single buffer is kept even if it is bigger
+  /// than the limit, so a stream of big messages still reuses its memory.
   class BufferPool : public std::enable_shared_from_this<BufferPool> {
   public:
 
-    BufferPool() = default;
+    static constexpr size_t DefaultMaxBytes = 256u << 20u;
+
+    struct Statistics {
+      /// Number of pops served with a buffer from the pool.
+      uint64_t hits;
+
+      /// Number of pops that found no suitable buffer.
+      uint64_t misses;
+
+      /// Bytes deleted because the pool was full or trimmed.
+      uint64_t bytes_trimmed;
+
+      size_t buffers_held;
+
+      /// Sum of the capacities of the buffers in the pool.
+      size_t bytes_held;
+    };
 
-    explicit BufferPool(size_t estimated_size) : _queue(estimated_size) {}
+    BufferPool() : BufferPool(0u) {}
 
-    /// Pop a Buffer from the queue, creates a new one if the queue is empty.
+    /// @a estimated_size is the number of buffers each size class is expected
+    /// to hold.
+    explicit BufferPool(size_t estimated_size) {
+      for (auto &queue : _classes) {
+        queue = std::make_unique<Queue>(estimated_size);
+      }
+    }
+
+    /// Pop a Buffer of any capacity, the largest one available. Creates a new
+    /// one if the pool is empty. Meant for callers that do not know the size
+    /// in advance and always need about the same.
     Buffer Pop() {
       Buffer item;
-      _queue.try_dequeue(item); // we don't care if it fails.
+      bool found = false;
+      for (auto i = _classes.size(); (i > 0u) && !found; --i) {
+        found = TryPop(i - 1u, item);
+      }
+      CountPop(found);
+      return Adopt(std::move(item));
+    }
+
+    /// Pop a Buffer with capacity for @a size bytes, already reset to that
+    /// size. Reuses the smallest buffer that fits at most twice the size
+    /// class of @a size, otherwise allocates a new one.
+    Buffer Pop(size_t size) {
+      Buffer item;
+      const auto size_class = GetSizeClass(size);
+      // Buffers of the same class may be too small, look at the first one.
+      bool found = TryPop(size_class, item);
+      if (found && (item.capacity() < size)) {
+        Push(std::move(item));
+        item = Buffer();
+        found = false;
+      }
+      // Any buffer of the next class fits.
+      if (!found && (size_class + 1u < _classes.size())) {
+        found = TryPop(size_class + 1u, item);
+      }
+      CountPop(found);
+      item.reset(static_cast<uint64_t>(size));
+      return Adopt(std::move(item));
+    }
+
+    /// Set the maximum number of bytes kept by the pool, and delete buffers
+    /// until it holds no more than that. By default DefaultMaxBytes.
+    void SetMaxBytes(size_t max_bytes) {
+      _max_bytes = max_bytes;
+      Trim(max_bytes);
+    }
+
+    size_t GetMaxBytes() const {
+      return _max_bytes;
+    }
+
+    /// Delete buffers, largest first, until the pool holds at most
+    /// @a max_bytes.
+    void Trim(size_t max_bytes) {
+      for (auto i = _classes.size(); (i > 0u) && (_bytes_held > max_bytes); --i) {
+        Buffer item;
+        while ((_bytes_held > max_bytes) && TryPop(i - 1u, item)) {
+          Discard(std::move(item));
+        }
+      }
+    }
+
+    Statistics GetStatistics() const {
+      return {_hits, _misses, _bytes_trimmed, _buffers_held, _bytes_held};
+    }
+
+  private:
+
+    friend class Buffer;
+
+    using Queue = moodycamel::ConcurrentQueue<Buffer>;
+
+    /// One class per bit of Buffer::size_type, class i holds the buffers of
+    /// capacity in [2^i, 2^(i+1)).
+    static constexpr size_t NumberOfClasses = std::numeric_limits<Buffer::size_type>::digits;
+
+    static size_t GetSizeClass(size_t size) {
+      size_t size_class = 0u;
+      while ((size >> 1u) != 0u) {
+        size >>= 1u;
+        ++size_class;
+      }
+      return size_class;
+    }
+
+    void Push(Buffer &&buffer) {
+      const size_t capacity = buffer.capacity();
+      if ((_buffers_held > 0u) && (_bytes_held + capacity > _max_bytes)) {
+        Discard(std::move(buffer));
+        return;
+      }
+      _bytes_held += capacity;
+      ++_buffers_held;
+      _classes[GetSizeClass(capacity)]->enqueue(std::move(buffer));
+    }
+
+    bool TryPop(size_t size_class, Buffer &item) {
+      if (!_classes[size_class]->try_dequeue(item)) {
+        return false;
+      }
+      _bytes_held -= item.capacity();
+      --_buffers_held;
+      return true;
+    }
+
+    void CountPop(bool found) {
+      if (found) {
+        ++_hits;
+      } else {
+        ++_misses;
+      }
+    }
+
+    Buffer Adopt(Buffer &&item) {
 #if __cplusplus >= 201703L // C++17
       item._parent_pool = weak_from_this();
 #else
       item._parent_pool = shared_from_this();
 #endif
-      return item;
+      return std::move(item);
     }
 
-  private:
+    /// Delete @a buffer's memory instead of returning it to the pool.
+    void Discard(Buffer &&buffer) {
+      _bytes_trimmed += buffer.capacity();
+      buffer._parent_pool.reset();
+      buffer.clear();
+    }
 
-    friend class Buffer;
+    std::array<std::unique_ptr<Queue>, NumberOfClasses> _classes;
 
-    void Push(Buffer &&buffer) {
-      _queue.enqueue(std::move(buffer));
-    }
+    std::atomic_size_t _max_bytes{DefaultMaxBytes};
+
+    std::atomic_size_t _bytes_held{0u};
+
+    std::atomic_size_t _buffers_held{0u};
+
+    std::atomic<uint64_t> _hits{0u};
+
+    std::atomic<uint64_t> _misses{0u};
 
-    moodycamel::ConcurrentQueue<Buffer> _queue;
+    std::atomic<uint64_t> _bytes_trimmed{0u};
   };
 
 } // namespace carla
@@ -14,9 +14,16 @@
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/post.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
 #include <future>
+#include <memory>
+#include <mutex>
 #include <thread>
 #include <type_traits>
+#include <utility>
 
 namespace carla {
 
@@ -45,6 +52,84 @@ namespace carla {
       return future;
     }
 
+    /// Call @a functor(index) for every index in [0, size). The range is split
+    /// in chunks of @a chunk_size indices that are processed by the threads of
+    /// the pool and by the calling thread, which blocks until every index has
+    /// been processed. If @a functor throws, the first exception is re-thrown
+    /// here once all the chunks are done.
+    ///
+    /// Chunks are claimed dynamically so the call never waits on tasks that
+    /// have not started yet, it is safe to call it from within a task of the
+    /// same pool.
+    template <typename FunctorT>
+    void ParallelFor(size_t size, size_t chunk_size, FunctorT &&functor) {
+      chunk_size = std::max<size_t>(chunk_size, 1u);
+      const size_t number_of_chunks = (size + chunk_size - 1u) / chunk_size;
+      if (number_of_chunks == 0u) {
+        return;
+      }
+      if ((number_of_chunks == 1u) || (_workers.Size() == 0u)) {
+        for (size_t i = 0u; i < size; ++i) {
+          functor(i);
+        }
+        return;
+      }
+
+      struct SharedState {
+        std::atomic_size_t next_chunk{0u};
+        size_t finished_chunks = 0u;
+        std::exception_ptr exception;
+        std::mutex mutex;
+        std::condition_variable condition;
+      };
+      auto state = std::make_shared<SharedState>();
+
+      auto run_chunks = [=, &functor]() {
+        for (auto chunk = state->next_chunk++;
+             chunk < number_of_chunks;
+             chunk = state->next_chunk++) {
+          std::exception_ptr exception;
+#ifndef LIBCARLA_NO_EXCEPTIONS
+          try {
+#endif // LIBCARLA_NO_EXCEPTIONS
+            const size_t end = std::min(size, (chunk + 1u) * chunk_size);
+            for (size_t i = chunk * chunk_size; i < end; ++i) {
+              functor(i);
+            }
+#ifndef LIBCARLA_NO_EXCEPTIONS
+          } catch (...) {
+            exception = std::current_exception();
+          }
+#endif // LIBCARLA_NO_EXCEPTIONS
+          std::lock_guard<std::mutex> lock(state->mutex);
+          if (exception && !state->exception) {
+            state->exception = exception;
+          }
+          if (++state->finished_chunks == number_of_chunks) {
+            state->condition.notify_all();
+          }
+        }
+      };
+
+      // Helper tasks that start after every chunk has been claimed return
+      // immediately without touching @a functor.
+      const size_t number_of_helpers = std::min(number_of_chunks - 1u, _workers.Size());
+      for (size_t i = 0u; i < number_of_helpers; ++i) {
+        boost::asio::post(_io_context, run_chunks);
+      }
+      run_chunks();
+
+      std::unique_lock<std::mutex> lock(state->mutex);
+      state->condition.wait(lock, [&]() {
+        return state->finished_chunks == number_of_chunks;
+      });
+#ifndef LIBCARLA_NO_EXCEPTIONS
+      if (state->exception) {
+        std::rethrow_exception(state->exception);
+      }
+#endif // LIBCARLA_NO_EXCEPTIONS
+    }
+
     /// Launch threads to run tasks asynchronously. Launch specific number of
     /// threads if @a worker_threads is provided, otherwise use all available
     /// hardware concurrency.
@@ -87,4 +172,20 @@ namespace carla {
     ThreadGroup _workers;
   };
 
+  /// Calls @a functor(index) for every index in [0, size) in chunks of
+  /// @a chunk_size indices, using a temporary pool with a thread per core
+  /// (the calling thread included). For one-off work, like building a map,
+  /// that has no pool of its own; code called often, like queries, should
+  /// keep a pool instead of paying for starting the threads every time.
+  template <typename FunctorT>
+  inline void ParallelFor(size_t size, size_t chunk_size, FunctorT &&functor) {
+    ThreadPool thread_pool;
+    const size_t number_of_chunks = (size + chunk_size - 1u) / chunk_size;
+    const size_t hardware_threads = std::thread::hardware_concurrency();
+    if (number_of_chunks > 1u && hardware_threads > 1u) {
+      thread_pool.AsyncRun(std::min(number_of_chunks, hardware_threads) - 1u);
+    }
+    thread_pool.ParallelFor(size, chunk_size, std::forward<FunctorT>(functor));
+  }
+
 } // namespace carla
@@ -40,6 +40,18 @@ namespace client {
       return _simulator->GetNetworkingTimeout();
     }
 
+    /// Set how the sensors subscribed from now on receive their data. With
+    /// streaming::Transport::SharedMemory, a client on the same host as the
+    /// simulator reads the sensor data from shared memory instead of the
+    /// TCP connection; otherwise it keeps using TCP.
+    void SetStreamingTransport(streaming::Transport transport) {
+      _simulator->SetStreamingTransport(transport);
+    }
+
+    streaming::Transport GetStreamingTransport() const {
+      return _simulator->GetStreamingTransport();
+    }
+
     /// Return the version string of this client API.
     std::string GetClientVersion() const {
       return _simulator->GetClientVersion();
@@ -6,41 +6,94 @@
 
 #include "carla/client/Map.h"
 
+#include "carla/FileSystem.h"
+#include "carla/Logging.h"
+#include "carla/client/FileTransfer.h"
 #include "carla/client/Junction.h"
 #include "carla/client/Waypoint.h"
 #include "carla/opendrive/OpenDriveParser.h"
 #include "carla/road/Map.h"
+#include "carla/road/MapSnapshot.h"
 #include "carla/road/RoadTypes.h"
 #include "carla/trafficmanager/InMemoryMap.h"
 
-#include <sstream>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/stream.hpp>
+
+#include <cstdio>
 
 namespace carla {
 namespace client {
 
-  static auto MakeMap(const std::string &opendrive_contents) {
-    auto stream = std::istringstream(opendrive_contents);
-    auto map = opendrive::OpenDriveParser::Load(stream.str());
+  /// Snapshots of the maps built by the clients of this machine are cached
+  /// next to the downloaded files, named after the hash of their OpenDRIVE.
+  static std::string GetMapSnapshotPath(uint64_t content_hash) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(content_hash));
+    return FileTransfer::GetFilesBaseFolder() + "maps/" + name;
+  }
+
+  static auto MakeMap(const std::string &opendrive_contents, uint64_t content_hash) {
+    auto path = GetMapSnapshotPath(content_hash);
+    auto map = road::MapSnapshot::Load(path, content_hash);
+    if (map.has_value()) {
+      return std::move(*map);
+    }
+    {
+      // Stream the contents, the parser does not need a copy of them.
+      boost::iostreams::stream<boost::iostreams::array_source> opendrive(
+          opendrive_contents.data(),
+          opendrive_contents.size());
+      map = opendrive::OpenDriveParser::Load(opendrive, true);
+    }
     if (!map.has_value()) {
       throw_exception(std::runtime_error("failed to generate map"));
     }
+    try {
+      FileSystem::ValidateFilePath(path);
+      road::MapSnapshot::Save(path, *map, content_hash);
+    } catch (const std::exception &e) {
+      log_warning("failed to save map snapshot", path, ':', e.what());
+    }
     return std::move(*map);
   }
 
   Map::Map(rpc::MapInfo description, std::string xodr_content)
-    : _description(std::move(description)),
-      _map(MakeMap(xodr_content)){
-    open_drive_file = xodr_content;
-  }
+    : Map(std::move(description), std::move(xodr_content), nullptr) {}
+
   Map::Map(std::string name, std::string xodr_content)
     : Map(rpc::MapInfo{
     std::move(name),
-    std::vector<geom::Transform>{}}, xodr_content) {
-    open_drive_file = xodr_content;
+    std::vector<geom::Transform>{}}, std::move(xodr_content)) {}
+
+  Map::Map(
+      rpc::MapInfo description,
+      std::string xodr_content,
+      std::function<std::string()> open_drive_loader)
+    : _open_drive_loader(std::move(open_drive_loader)),
+      _description(std::move(description)),
+      _content_hash(road::MapSnapshot::ComputeContentHash(xodr_content)),
+      _map(MakeMap(xodr_content, _content_hash)) {
+    if (_open_drive_loader == nullptr) {
+      open_drive_file = std::move(xodr_content);
+    }
   }
 
   Map::~Map() = default;
 
+  const std::string &Map::GetOpenDrive() const {
+    std::lock_guard<std::mutex> lock(_open_drive_mutex);
+    if (open_drive_file.empty() && (_open_drive_loader != nullptr)) {
+      std::string contents = _open_drive_loader();
+      if (road::MapSnapshot::ComputeContentHash(contents) != _content_hash) {
+        throw_exception(std::runtime_error(
+            "the OpenDRIVE contents of map " + GetName() + " changed since it was loaded"));
+      }
+      open_drive_file = std::move(contents);
+    }
+    return open_drive_file;
+  }
+
   SharedPtr<Waypoint> Map::GetWaypoint(
   const geom::Location &location,
   bool project_to_road,
@@ -56,6 +109,21 @@ namespace client {
     nullptr;
   }
 
+  std::vector<SharedPtr<Waypoint>> Map::GetWaypoints(
+      const std::vector<geom::Location> &locations,
+      bool project_to_road,
+      int32_t lane_type) const {
+    const auto waypoints = _map.GetWaypoints(locations, project_to_road, lane_type);
+    std::vector<SharedPtr<Waypoint>> result;
+    result.reserve(waypoints.size());
+    for (auto &waypoint : waypoints) {
+      result.emplace_back(waypoint.has_value() ?
+          SharedPtr<Waypoint>(new Waypoint{shared_from_this(), *waypoint}) :
+          nullptr);
+    }
+    return result;
+  }
+
   SharedPtr<Waypoint> Map::GetWaypointXODR(
       carla::road::RoadId road_id,
       carla::road::LaneId lane_id,
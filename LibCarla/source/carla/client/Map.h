@@ -15,6 +15,9 @@
 #include "carla/rpc/MapInfo.h"
 #include "Landmark.h"
 
+#include <cstdint>
+#include <functional>
+#include <mutex>
 #include <string>
 
 namespace carla {
@@ -33,6 +36,14 @@ namespace client {
 
     explicit Map(std::string name, std::string xodr_content);
 
+    /// Build the map of @a xodr_content without keeping the contents, they
+    /// are requested from @a open_drive_loader the first time GetOpenDrive
+    /// is called.
+    explicit Map(
+        rpc::MapInfo description,
+        std::string xodr_content,
+        std::function<std::string()> open_drive_loader);
+
     ~Map();
 
     const std::string &GetName() const {
@@ -43,9 +54,9 @@ namespace client {
       return _map;
     }
 
-    const std::string &GetOpenDrive() const {
-      return open_drive_file;
-    }
+    /// Throws if the map was built without keeping its OpenDRIVE contents
+    /// and those fetched again are not the same.
+    const std::string &GetOpenDrive() const;
 
     const std::vector<geom::Transform> &GetRecommendedSpawnPoints() const {
       return _description.recommended_spawn_points;
@@ -56,6 +67,13 @@ namespace client {
         bool project_to_road = true,
         int32_t lane_type = static_cast<uint32_t>(road::Lane::LaneType::Driving)) const;
 
+    /// Batch version of GetWaypoint(), the queries are answered in parallel.
+    /// Locations without waypoint get a null entry in the result.
+    std::vector<SharedPtr<Waypoint>> GetWaypoints(
+        const std::vector<geom::Location> &locations,
+        bool project_to_road = true,
+        int32_t lane_type = static_cast<uint32_t>(road::Lane::LaneType::Driving)) const;
+
     SharedPtr<Waypoint> GetWaypointXODR(
       carla::road::RoadId road_id,
       carla::road::LaneId lane_id,
@@ -99,10 +117,16 @@ namespace client {
 
   private:
 
-    std::string open_drive_file;
+    mutable std::mutex _open_drive_mutex;
+
+    mutable std::string open_drive_file;
+
+    const std::function<std::string()> _open_drive_loader;
 
     const rpc::MapInfo _description;
 
+    const uint64_t _content_hash;
+
     const road::Map _map;
   };
 
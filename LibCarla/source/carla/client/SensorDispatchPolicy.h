@@ -0,0 +1,26 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+namespace carla {
+namespace client {
+
+  /// What a listening sensor does with the measurements that arrive while its
+  /// dispatch queue is full.
+  enum class SensorDispatchPolicy {
+    /// Keep only the most recent measurement, older ones are dropped.
+    LatestOnly,
+    /// Keep the most recent measurements up to the queue size, the oldest
+    /// one is dropped to make room for a new one.
+    KeepN,
+    /// Keep every measurement, reading from the network waits until the
+    /// queue has room.
+    Block
+  };
+
+} // namespace client
+} // namespace carla
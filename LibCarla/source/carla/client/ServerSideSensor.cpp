@@ -6,10 +6,13 @@
 
 #include "carla/client/ServerSideSensor.h"
 
+#include "carla/Exception.h"
 #include "carla/Logging.h"
+#include "carla/client/detail/SensorDispatchQueue.h"
 #include "carla/client/detail/Simulator.h"
 
 #include <exception>
+#include <stdexcept>
 
 namespace carla {
 namespace client {
@@ -28,11 +31,24 @@ namespace client {
         log_error("exception trying to stop sensor:", GetDisplayId(), ':', e.what());
       }
     }
+    if (_dispatch_queue != nullptr) {
+      _dispatch_queue->Close();
+    }
   }
 
   void ServerSideSensor::Listen(CallbackFunctionType callback) {
     log_debug(GetDisplayId(), ": subscribing to stream");
-    GetEpisode().Lock()->SubscribeToSensor(*this, std::move(callback));
+    if (_dispatch_queue != nullptr) {
+      _dispatch_queue->Close();
+    }
+    _dispatch_queue = std::make_shared<detail::SensorDispatchQueue>(
+        _dispatch_policy,
+        _dispatch_queue_size);
+    GetEpisode().Lock()->SubscribeToSensor(
+        *this,
+        std::move(callback),
+        _dispatch_queue,
+        _stream_compression);
     _is_listening = true;
   }
 
@@ -44,9 +60,28 @@ namespace client {
       return;
     }
     GetEpisode().Lock()->UnSubscribeFromSensor(*this);
+    _dispatch_queue->Close();
     _is_listening = false;
   }
 
+  void ServerSideSensor::SetDispatchPolicy(SensorDispatchPolicy policy, size_t queue_size) {
+    if (_dispatch_queue != nullptr) {
+      _dispatch_queue->SetPolicy(policy, queue_size);
+    } else if (queue_size == 0u) {
+      throw_exception(std::invalid_argument("sensor dispatch queue size must be greater than zero"));
+    }
+    _dispatch_policy = policy;
+    _dispatch_queue_size = queue_size;
+  }
+
+  size_t ServerSideSensor::GetDispatchQueueDepth() const {
+    return _dispatch_queue != nullptr ? _dispatch_queue->GetDepth() : 0u;
+  }
+
+  uint64_t ServerSideSensor::GetDroppedMeasurementCount() const {
+    return _dispatch_queue != nullptr ? _dispatch_queue->GetDroppedCount() : 0u;
+  }
+
   bool ServerSideSensor::Destroy() {
     if (IsListening()) {
       Stop();
@@ -7,10 +7,17 @@
 #pragma once
 
 #include "carla/client/Sensor.h"
+#include "carla/client/SensorDispatchPolicy.h"
+#include "carla/streaming/Compression.h"
+
+#include <cstdint>
+#include <memory>
 
 namespace carla {
 namespace client {
 
+  namespace detail { class SensorDispatchQueue; }
+
   class ServerSideSensor final : public Sensor {
   public:
 
@@ -36,6 +43,41 @@ namespace client {
       return _is_listening;
     }
 
+    /// Set how the measurements are queued while the callback is busy.
+    /// Measurements are read from the network independently of the callback,
+    /// which runs on a thread of its own, into a queue of up to
+    /// @a queue_size measurements (ignored by LatestOnly). Takes effect
+    /// immediately if the sensor is listening.
+    ///
+    /// @throw std::invalid_argument if @a queue_size is zero.
+    void SetDispatchPolicy(SensorDispatchPolicy policy, size_t queue_size = 3u);
+
+    SensorDispatchPolicy GetDispatchPolicy() const {
+      return _dispatch_policy;
+    }
+
+    size_t GetDispatchQueueSize() const {
+      return _dispatch_queue_size;
+    }
+
+    /// Number of measurements received and waiting for the callback.
+    size_t GetDispatchQueueDepth() const;
+
+    /// Number of measurements dropped by the dispatch policy since the last
+    /// call to Listen.
+    uint64_t GetDroppedMeasurementCount() const;
+
+    /// Ask the simulator to send the measurements compressed with
+    /// @a compression, worth it when the simulator runs on another host.
+    /// Takes effect the next time Listen is called.
+    void SetStreamCompression(streaming::Compression compression) {
+      _stream_compression = compression;
+    }
+
+    streaming::Compression GetStreamCompression() const {
+      return _stream_compression;
+    }
+
     /// @copydoc Actor::Destroy()
     ///
     /// Additionally stop listening.
@@ -44,6 +86,14 @@ namespace client {
   private:
 
     bool _is_listening = false;
+
+    SensorDispatchPolicy _dispatch_policy = SensorDispatchPolicy::Block;
+
+    size_t _dispatch_queue_size = 3u;
+
+    std::shared_ptr<detail::SensorDispatchQueue> _dispatch_queue;
+
+    streaming::Compression _stream_compression = streaming::Compression::None;
   };
 
 } // namespace client
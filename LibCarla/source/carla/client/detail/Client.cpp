@@ -515,14 +515,23 @@ namespace detail {
 
   void Client::SubscribeToStream(
       const streaming::Token &token,
-      std::function<void(Buffer)> callback) {
-    _pimpl->streaming_client.Subscribe(token, std::move(callback));
+      std::function<void(Buffer)> callback,
+      streaming::Compression compression) {
+    _pimpl->streaming_client.Subscribe(token, compression, std::move(callback));
   }
 
   void Client::UnSubscribeFromStream(const streaming::Token &token) {
     _pimpl->streaming_client.UnSubscribe(token);
   }
 
+  void Client::SetStreamingTransport(streaming::Transport transport) {
+    _pimpl->streaming_client.SetTransport(transport);
+  }
+
+  streaming::Transport Client::GetStreamingTransport() const {
+    return _pimpl->streaming_client.GetTransport();
+  }
+
   void Client::DrawDebugShape(const rpc::DebugShape &shape) {
     _pimpl->AsyncCall("draw_debug_shape", shape);
   }
@@ -9,6 +9,8 @@
 #include "carla/Memory.h"
 #include "carla/NonCopyable.h"
 #include "carla/Time.h"
+#include "carla/streaming/Compression.h"
+#include "carla/streaming/Transport.h"
 #include "carla/geom/Transform.h"
 #include "carla/geom/Location.h"
 #include "carla/rpc/Actor.h"
@@ -320,10 +322,15 @@ namespace detail {
 
     void SubscribeToStream(
         const streaming::Token &token,
-        std::function<void(Buffer)> callback);
+        std::function<void(Buffer)> callback,
+        streaming::Compression compression = streaming::Compression::None);
 
     void UnSubscribeFromStream(const streaming::Token &token);
 
+    void SetStreamingTransport(streaming::Transport transport);
+
+    streaming::Transport GetStreamingTransport() const;
+
     void DrawDebugShape(const rpc::DebugShape &shape);
 
     void ApplyBatch(
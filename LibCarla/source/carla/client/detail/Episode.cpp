@@ -20,9 +20,9 @@ namespace detail {
 
 using namespace std::chrono_literals;
 
-  static auto &CastData(const sensor::SensorData &data) {
+  static auto CastData(SharedPtr<sensor::SensorData> data) {
     using target_t = const sensor::data::RawEpisodeState;
-    return static_cast<target_t &>(data);
+    return boost::static_pointer_cast<target_t>(std::move(data));
   }
 
   template <typename RangeT>
@@ -56,10 +56,22 @@ using namespace std::chrono_literals;
       auto self = weak.lock();
       if (self != nullptr) {
 
-        auto data = sensor::Deserializer::Deserialize(std::move(buffer));
-        auto next = std::make_shared<const EpisodeState>(CastData(*data));
+        auto raw_state = CastData(sensor::Deserializer::Deserialize(std::move(buffer)));
         auto prev = self->GetState();
 
+        std::shared_ptr<const EpisodeState> next;
+        if (raw_state->IsDelta()) {
+          // A delta can only be applied on top of the frame it was computed
+          // from, otherwise wait for the next keyframe.
+          if ((prev->GetEpisodeId() != raw_state->GetEpisodeId()) ||
+              (prev->GetFrame() != raw_state->GetBaseFrame())) {
+            return;
+          }
+          next = std::make_shared<const EpisodeState>(*raw_state, *prev);
+        } else {
+          next = std::make_shared<const EpisodeState>(std::move(raw_state));
+        }
+
         // TODO: Update how the map change is detected
         bool HasMapChanged = next->HasMapChanged();
         bool UpdateLights = next->IsLightUpdatePending();
@@ -6,11 +6,33 @@
 
 #include "carla/client/detail/EpisodeState.h"
 
+#include <algorithm>
+
 namespace carla {
 namespace client {
 namespace detail {
 
-  EpisodeState::EpisodeState(const sensor::data::RawEpisodeState &state)
+  static size_t HashActorId(ActorId id) {
+    return static_cast<size_t>(id * 2654435761u);
+  }
+
+  EpisodeState::EpisodeState(SharedPtr<const sensor::data::RawEpisodeState> state)
+    : _episode_id(state->GetEpisodeId()),
+      _timestamp(
+          state->GetFrame(),
+          state->GetGameTimeStamp(),
+          state->GetDeltaSeconds(),
+          state->GetPlatformTimeStamp()),
+      _map_origin(state->GetMapOrigin()),
+      _simulation_state(state->GetSimulationState()),
+      _raw_state(std::move(state)) {
+    DEBUG_ASSERT(!_raw_state->IsDelta());
+    SetActors(_raw_state->data(), _raw_state->size());
+  }
+
+  EpisodeState::EpisodeState(
+      const sensor::data::RawEpisodeState &state,
+      const EpisodeState &previous)
     : _episode_id(state.GetEpisodeId()),
       _timestamp(
           state.GetFrame(),
@@ -19,21 +41,78 @@ namespace detail {
           state.GetPlatformTimeStamp()),
       _map_origin(state.GetMapOrigin()),
       _simulation_state(state.GetSimulationState()) {
-    _actors.reserve(state.size());
+    DEBUG_ASSERT(state.IsDelta());
+    DEBUG_ASSERT(previous.GetFrame() == state.GetBaseFrame());
+    _merged_actors.reserve(previous.size() + state.size());
+    _merged_actors.assign(previous._actors, previous._actors + previous._size);
     for (auto &&actor : state) {
-      DEBUG_ONLY(auto result = )
-      _actors.emplace(
-          actor.id,
-          ActorSnapshot{
-              actor.id,
-              actor.actor_state,
-              actor.transform,
-              actor.velocity,
-              actor.angular_velocity,
-              actor.acceleration,
-              actor.state});
-      DEBUG_ASSERT(result.second);
+      auto *previous_actor = previous.Find(actor.id);
+      if (previous_actor != nullptr) {
+        _merged_actors[static_cast<size_t>(previous_actor - previous._actors)] = actor;
+      } else {
+        _merged_actors.emplace_back(actor);
+      }
+    }
+    auto removed = state.GetRemovedActorIds();
+    if (!removed.empty()) {
+      std::vector<ActorId> removed_ids(removed.begin(), removed.end());
+      std::sort(removed_ids.begin(), removed_ids.end());
+      _merged_actors.erase(
+          std::remove_if(
+              _merged_actors.begin(),
+              _merged_actors.end(),
+              [&](const ActorDynamicState &actor) {
+                const ActorId id = actor.id;
+                return std::binary_search(removed_ids.begin(), removed_ids.end(), id);
+              }),
+          _merged_actors.end());
+    }
+    SetActors(_merged_actors.data(), _merged_actors.size());
+  }
+
+  ActorSnapshot EpisodeState::MakeActorSnapshot(const ActorDynamicState &actor) {
+    return ActorSnapshot{
+        actor.id,
+        actor.actor_state,
+        actor.transform,
+        actor.velocity,
+        actor.angular_velocity,
+        actor.acceleration,
+        actor.state};
+  }
+
+  void EpisodeState::SetActors(const ActorDynamicState *actors, size_t size) {
+    _actors = actors;
+    _size = size;
+    // Keep the load factor of the table at or below 0.5.
+    size_t capacity = 16u;
+    while (capacity < 2u * size) {
+      capacity *= 2u;
+    }
+    _index.assign(capacity, 0u);
+    const size_t mask = capacity - 1u;
+    for (size_t i = 0u; i < size; ++i) {
+      size_t slot = HashActorId(actors[i].id) & mask;
+      while (_index[slot] != 0u) {
+        DEBUG_ASSERT(actors[_index[slot] - 1u].id != actors[i].id);
+        slot = (slot + 1u) & mask;
+      }
+      _index[slot] = static_cast<uint32_t>(i + 1u);
+    }
+  }
+
+  const sensor::data::ActorDynamicState *EpisodeState::Find(ActorId id) const {
+    if (_index.empty()) {
+      return nullptr;
+    }
+    const size_t mask = _index.size() - 1u;
+    for (size_t slot = HashActorId(id) & mask; _index[slot] != 0u; slot = (slot + 1u) & mask) {
+      const ActorDynamicState *actor = _actors + (_index[slot] - 1u);
+      if (actor->id == id) {
+        return actor;
+      }
     }
+    return nullptr;
   }
 
 } // namespace detail
@@ -6,35 +6,49 @@
 
 #pragma once
 
-#include "carla/Iterator.h"
 #include "carla/ListView.h"
+#include "carla/Memory.h"
 #include "carla/NonCopyable.h"
 #include "carla/client/ActorSnapshot.h"
 #include "carla/client/Timestamp.h"
 #include "carla/geom/Vector3DInt.h"
 #include "carla/sensor/data/RawEpisodeState.h"
 
+#include <boost/iterator/transform_iterator.hpp>
 #include <boost/optional.hpp>
 
 #include <memory>
-#include <unordered_map>
+#include <vector>
 
 namespace carla {
 namespace client {
 namespace detail {
 
   /// Represents the state of all the actors of an episode at a given frame.
+  ///
+  /// The actors are kept in a contiguous array. When the state comes from a
+  /// full message the array is a view over the received buffer, which is kept
+  /// alive by this object. An open-addressing table maps actor ids to their
+  /// index in the array.
   class EpisodeState
     : public std::enable_shared_from_this<EpisodeState>,
       private NonCopyable {
 
       using SimulationState = sensor::s11n::EpisodeStateSerializer::SimulationState;
 
+      using ActorDynamicState = sensor::data::ActorDynamicState;
+
   public:
 
     explicit EpisodeState(uint64_t episode_id) : _episode_id(episode_id) {}
 
-    explicit EpisodeState(const sensor::data::RawEpisodeState &state);
+    explicit EpisodeState(SharedPtr<const sensor::data::RawEpisodeState> state);
+
+    /// Rebuild the full state from a delta message on top of @a previous, the
+    /// state of the frame the delta was computed from.
+    EpisodeState(
+        const sensor::data::RawEpisodeState &state,
+        const EpisodeState &previous);
 
     auto GetEpisodeId() const {
       return _episode_id;
@@ -61,7 +75,7 @@ namespace detail {
     }
 
     bool ContainsActorSnapshot(ActorId actor_id) const {
-      return _actors.find(actor_id) != _actors.end();
+      return Find(actor_id) != nullptr;
     }
 
     ActorSnapshot GetActorSnapshot(ActorId id) const {
@@ -78,29 +92,41 @@ namespace detail {
 
     auto GetActorIds() const {
       return MakeListView(
-          iterator::make_map_keys_const_iterator(_actors.begin()),
-          iterator::make_map_keys_const_iterator(_actors.end()));
+          boost::make_transform_iterator(_actors, &GetActorId),
+          boost::make_transform_iterator(_actors + _size, &GetActorId));
     }
 
     size_t size() const {
-      return _actors.size();
+      return _size;
     }
 
     auto begin() const {
-      return iterator::make_map_values_const_iterator(_actors.begin());
+      return boost::make_transform_iterator(_actors, &MakeActorSnapshot);
     }
 
     auto end() const {
-      return iterator::make_map_values_const_iterator(_actors.end());
+      return boost::make_transform_iterator(_actors + _size, &MakeActorSnapshot);
     }
 
   private:
 
+    static ActorId GetActorId(const ActorDynamicState &actor) {
+      return actor.id;
+    }
+
+    static ActorSnapshot MakeActorSnapshot(const ActorDynamicState &actor);
+
+    /// Point the actor array to @a actors and build the id lookup table.
+    void SetActors(const ActorDynamicState *actors, size_t size);
+
+    /// Return the actor with @a id, or nullptr if it is not present.
+    const ActorDynamicState *Find(ActorId id) const;
+
     template <typename T>
     void CopyActorSnapshotIfPresent(ActorId id, T &value) const {
-      auto it = _actors.find(id);
-      if (it != _actors.end()) {
-        value = it->second;
+      auto *actor = Find(id);
+      if (actor != nullptr) {
+        value = MakeActorSnapshot(*actor);
       }
     }
 
@@ -112,7 +138,18 @@ namespace detail {
 
     SimulationState _simulation_state;
 
-    std::unordered_map<ActorId, ActorSnapshot> _actors;
+    /// Keeps alive the buffer _actors points to, if any.
+    SharedPtr<const sensor::data::RawEpisodeState> _raw_state;
+
+    /// Storage of the actors of states rebuilt from a delta.
+    std::vector<ActorDynamicState> _merged_actors;
+
+    const ActorDynamicState *_actors = nullptr;
+
+    size_t _size = 0u;
+
+    /// Open-addressing table of actor index + 1, zero marks an empty slot.
+    std::vector<uint32_t> _index;
   };
 
 } // namespace detail
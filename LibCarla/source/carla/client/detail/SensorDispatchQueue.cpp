@@ -0,0 +1,119 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/client/detail/SensorDispatchQueue.h"
+
+#include "carla/Exception.h"
+#include "carla/Logging.h"
+
+#include <exception>
+#include <stdexcept>
+#include <thread>
+
+namespace carla {
+namespace client {
+namespace detail {
+
+  static void ValidateQueueSize(size_t queue_size) {
+    if (queue_size == 0u) {
+      throw_exception(std::invalid_argument("sensor dispatch queue size must be greater than zero"));
+    }
+  }
+
+  SensorDispatchQueue::SensorDispatchQueue(SensorDispatchPolicy policy, size_t queue_size)
+    : _policy(policy),
+      _queue_size(queue_size) {
+    ValidateQueueSize(queue_size);
+  }
+
+  void SensorDispatchQueue::SetPolicy(SensorDispatchPolicy policy, size_t queue_size) {
+    ValidateQueueSize(queue_size);
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _policy = policy;
+      _queue_size = queue_size;
+      if (_policy != SensorDispatchPolicy::Block) {
+        DropOldest(GetCapacity());
+      }
+    }
+    _not_full.notify_all();
+  }
+
+  void SensorDispatchQueue::Start(CallbackType callback) {
+    // The thread keeps the queue alive and is never joined, closing the queue
+    // is enough to make it finish. Joining could deadlock with a callback
+    // that is waiting for a lock held by whoever stops the sensor, e.g. the
+    // Python GIL.
+    std::thread([self=shared_from_this(), cb=std::move(callback)]() mutable {
+      self->Run(std::move(cb));
+    }).detach();
+  }
+
+  void SensorDispatchQueue::Push(Buffer message) {
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      if (_policy == SensorDispatchPolicy::Block) {
+        _not_full.wait(lock, [this]() {
+          return _closed || (_queue.size() < GetCapacity()) || (_policy != SensorDispatchPolicy::Block);
+        });
+      }
+      if (_closed) {
+        return;
+      }
+      DropOldest(GetCapacity() - 1u);
+      _queue.emplace_back(std::move(message));
+    }
+    _not_empty.notify_one();
+  }
+
+  void SensorDispatchQueue::Close() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _closed = true;
+      _queue.clear();
+    }
+    _not_empty.notify_all();
+    _not_full.notify_all();
+  }
+
+  size_t SensorDispatchQueue::GetDepth() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _queue.size();
+  }
+
+  void SensorDispatchQueue::DropOldest(size_t capacity) {
+    while (_queue.size() > capacity) {
+      _queue.pop_front();
+      ++_dropped;
+    }
+  }
+
+  void SensorDispatchQueue::Run(CallbackType callback) {
+    for (;;) {
+      Buffer message;
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _not_empty.wait(lock, [this]() { return _closed || !_queue.empty(); });
+        if (_closed) {
+          break;
+        }
+        message = std::move(_queue.front());
+        _queue.pop_front();
+      }
+      _not_full.notify_one();
+      try {
+        callback(std::move(message));
+      } catch (const std::exception &e) {
+        log_error("exception in sensor callback:", e.what());
+      } catch (...) {
+        log_error("unknown exception in sensor callback");
+      }
+    }
+  }
+
+} // namespace detail
+} // namespace client
+} // namespace carla
@@ -0,0 +1,94 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/NonCopyable.h"
+#include "carla/client/SensorDispatchPolicy.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace carla {
+namespace client {
+namespace detail {
+
+  /// Bounded queue between the streaming client, that pushes the raw
+  /// messages of a sensor as they are read from the network, and a dedicated
+  /// thread that deserializes them and calls the user's callback. A slow
+  /// callback no longer stalls the reads of the stream, what happens when it
+  /// cannot keep up is decided by the SensorDispatchPolicy.
+  class SensorDispatchQueue
+    : public std::enable_shared_from_this<SensorDispatchQueue>,
+      private NonCopyable {
+  public:
+
+    using CallbackType = std::function<void(Buffer)>;
+
+    /// @throw std::invalid_argument if @a queue_size is zero.
+    SensorDispatchQueue(SensorDispatchPolicy policy, size_t queue_size);
+
+    /// @throw std::invalid_argument if @a queue_size is zero.
+    void SetPolicy(SensorDispatchPolicy policy, size_t queue_size);
+
+    /// Start the dispatch thread, @a callback is called from it with each
+    /// message pushed.
+    void Start(CallbackType callback);
+
+    /// Queue @a message, dropping older messages or waiting for room as the
+    /// policy says. Does nothing once closed.
+    void Push(Buffer message);
+
+    /// Drop the queued messages and let the dispatch thread finish. Does not
+    /// wait for a callback already running, so it is safe to call from the
+    /// callback itself.
+    void Close();
+
+    /// Number of messages waiting to be dispatched.
+    size_t GetDepth() const;
+
+    /// Number of messages dropped because the queue was full.
+    uint64_t GetDroppedCount() const {
+      return _dropped;
+    }
+
+  private:
+
+    size_t GetCapacity() const {
+      return _policy == SensorDispatchPolicy::LatestOnly ? 1u : _queue_size;
+    }
+
+    /// Pop the oldest messages until there are no more than @a capacity.
+    void DropOldest(size_t capacity);
+
+    void Run(CallbackType callback);
+
+    mutable std::mutex _mutex;
+
+    std::condition_variable _not_empty;
+
+    std::condition_variable _not_full;
+
+    std::deque<Buffer> _queue;
+
+    SensorDispatchPolicy _policy;
+
+    size_t _queue_size;
+
+    bool _closed = false;
+
+    std::atomic<uint64_t> _dropped{0u};
+  };
+
+} // namespace detail
+} // namespace client
+} // namespace carla
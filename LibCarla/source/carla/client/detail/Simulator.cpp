@@ -143,11 +143,7 @@ namespace detail {
     if (!_cached_map) {
       return true;
     }
-    if (map_info.name != _cached_map->GetName() ||
-        _open_drive_file.size() != _cached_map->GetOpenDrive().size()) {
-      return true;
-    }
-    return false;
+    return map_info.name != _cached_map->GetName();
   }
 
   SharedPtr<Map> Simulator::GetCurrentMap() {
@@ -169,8 +165,16 @@ namespace detail {
       std::reverse(map_base_path.begin(), map_base_path.end());
       std::string XODRFolder = map_base_path + "/OpenDrive/" + map_name + ".xodr";
       if (FileTransfer::FileExists(XODRFolder) == false) _client.GetRequiredFiles();
-      _open_drive_file = _client.GetMapData();
-      _cached_map = MakeShared<Map>(map_info, _open_drive_file);
+      // Only the built map is kept, the OpenDRIVE contents are downloaded
+      // again if requested.
+      std::weak_ptr<Simulator> weak = shared_from_this();
+      _cached_map = MakeShared<Map>(map_info, _client.GetMapData(), [weak]() {
+        auto self = weak.lock();
+        if (self == nullptr) {
+          throw_exception(std::runtime_error("the client of this map was destroyed"));
+        }
+        return self->_client.GetMapData();
+      });
     }
 
     return _cached_map;
@@ -361,15 +365,24 @@ namespace detail {
 
   void Simulator::SubscribeToSensor(
       const Sensor &sensor,
-      std::function<void(SharedPtr<sensor::SensorData>)> callback) {
+      std::function<void(SharedPtr<sensor::SensorData>)> callback,
+      std::shared_ptr<SensorDispatchQueue> dispatch_queue,
+      streaming::Compression compression) {
     DEBUG_ASSERT(_episode != nullptr);
-    _client.SubscribeToStream(
-        sensor.GetActorDescription().GetStreamToken(),
-        [cb=std::move(callback), ep=WeakEpisodeProxy{shared_from_this()}](auto buffer) {
-          auto data = sensor::Deserializer::Deserialize(std::move(buffer));
-          data->_episode = ep.TryLock();
-          cb(std::move(data));
-        });
+    auto deliver = [cb=std::move(callback), ep=WeakEpisodeProxy{shared_from_this()}](auto buffer) {
+      auto data = sensor::Deserializer::Deserialize(std::move(buffer));
+      data->_episode = ep.TryLock();
+      cb(std::move(data));
+    };
+    const auto &token = sensor.GetActorDescription().GetStreamToken();
+    if (dispatch_queue == nullptr) {
+      _client.SubscribeToStream(token, std::move(deliver), compression);
+    } else {
+      dispatch_queue->Start(std::move(deliver));
+      _client.SubscribeToStream(token, [queue=std::move(dispatch_queue)](auto buffer) {
+        queue->Push(std::move(buffer));
+      }, compression);
+    }
   }
 
   void Simulator::UnSubscribeFromSensor(const Sensor &sensor) {
@@ -19,6 +19,7 @@
 #include "carla/client/detail/Client.h"
 #include "carla/client/detail/Episode.h"
 #include "carla/client/detail/EpisodeProxy.h"
+#include "carla/client/detail/SensorDispatchQueue.h"
 #include "carla/client/detail/WalkerNavigation.h"
 #include "carla/profiler/LifetimeProfiled.h"
 #include "carla/rpc/TrafficLightState.h"
@@ -159,6 +160,14 @@ namespace detail {
       return _client.GetTimeout();
     }
 
+    void SetStreamingTransport(streaming::Transport transport) {
+      _client.SetStreamingTransport(transport);
+    }
+
+    streaming::Transport GetStreamingTransport() const {
+      return _client.GetStreamingTransport();
+    }
+
     std::string GetClientVersion() {
       return _client.GetClientVersion();
     }
@@ -550,9 +559,15 @@ namespace detail {
     // =========================================================================
     /// @{
 
+    /// If @a dispatch_queue is not null, the measurements are pushed to it
+    /// and the callback is called from its thread, otherwise the callback is
+    /// called from the streaming client's threads. The server sends the
+    /// measurements compressed with @a compression.
     void SubscribeToSensor(
         const Sensor &sensor,
-        std::function<void(SharedPtr<sensor::SensorData>)> callback);
+        std::function<void(SharedPtr<sensor::SensorData>)> callback,
+        std::shared_ptr<SensorDispatchQueue> dispatch_queue = nullptr,
+        streaming::Compression compression = streaming::Compression::None);
 
     void UnSubscribeFromSensor(const Sensor &sensor);
 
@@ -669,8 +684,6 @@ namespace detail {
     const GarbageCollectionPolicy _gc_policy;
 
     SharedPtr<Map> _cached_map;
-
-    std::string _open_drive_file;
   };
 
 } // namespace detail
@@ -320,6 +320,31 @@ namespace geom {
     return *this;
   }
 
+  Mesh &Mesh::Merge(const std::vector<const Mesh *> &meshes) {
+    size_t vertices = _vertices.size();
+    size_t normals = _normals.size();
+    size_t indexes = _indexes.size();
+    size_t uvs = _uvs.size();
+    size_t materials = _materials.size();
+    for (const auto *mesh : meshes) {
+      vertices += mesh->GetVerticesNum();
+      normals += mesh->GetNormals().size();
+      indexes += mesh->GetIndexesNum();
+      uvs += mesh->GetUVs().size();
+      materials += mesh->GetMaterials().size();
+    }
+    _vertices.reserve(vertices);
+    _normals.reserve(normals);
+    _indexes.reserve(indexes);
+    _uvs.reserve(uvs);
+    _materials.reserve(materials);
+
+    for (const auto *mesh : meshes) {
+      *this += *mesh;
+    }
+    return *this;
+  }
+
   Mesh operator+(const Mesh &lhs, const Mesh &rhs) {
     Mesh m = lhs;
     return m += rhs;
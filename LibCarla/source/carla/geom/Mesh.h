@@ -143,6 +143,10 @@ namespace geom {
     /// Merges two meshes into a single mesh
     Mesh &operator+=(const Mesh &rhs);
 
+    /// Appends @a meshes in order, same as calling operator+= with each of
+    /// them, but the memory needed is reserved only once.
+    Mesh &Merge(const std::vector<const Mesh *> &meshes);
+
     friend Mesh operator+(const Mesh &lhs, const Mesh &rhs);
 
     // =========================================================================
@@ -37,6 +37,11 @@ namespace geom {
       _rtree.insert(elements.begin(), elements.end());
     }
 
+    /// Replace the content of the tree with @a elements, bulk loaded.
+    void BuildTree(const std::vector<TreeElement> &elements) {
+      _rtree = RtreeType(elements.begin(), elements.end());
+    }
+
     /// Return nearest neighbors with a user defined filter.
     /// The filter reveices as an argument a TreeElement value and needs to
     /// return a bool to accept or reject the value
@@ -67,7 +72,9 @@ namespace geom {
 
   private:
 
-    boost::geometry::index::rtree<TreeElement, boost::geometry::index::linear<16>> _rtree;
+    using RtreeType = boost::geometry::index::rtree<TreeElement, boost::geometry::index::linear<16>>;
+
+    RtreeType _rtree;
 
   };
 
@@ -94,6 +101,16 @@ namespace geom {
       _rtree.insert(elements.begin(), elements.end());
     }
 
+    /// Replace the content of the tree with @a elements, bulk loaded.
+    void BuildTree(const std::vector<TreeElement> &elements) {
+      _rtree = RtreeType(elements.begin(), elements.end());
+    }
+
+    /// Return a copy of every element in the tree, in no particular order.
+    std::vector<TreeElement> GetElements() const {
+      return {_rtree.begin(), _rtree.end()};
+    }
+
     /// Return nearest neighbors with a user defined filter.
     /// The filter reveices as an argument a TreeElement value and needs to
     /// return a bool to accept or reject the value
@@ -105,11 +122,23 @@ namespace geom {
         Filter filter,
         size_t number_neighbours = 1) const {
       std::vector<TreeElement> query_result;
+      GetNearestNeighboursWithFilter(geometry, filter, query_result, number_neighbours);
+      return query_result;
+    }
+
+    /// Same as above, but the result is written to @a query_result so its
+    /// memory can be reused by consecutive queries.
+    template <typename Geometry, typename Filter>
+    void GetNearestNeighboursWithFilter(
+        const Geometry &geometry,
+        Filter filter,
+        std::vector<TreeElement> &query_result,
+        size_t number_neighbours = 1) const {
+      query_result.clear();
       _rtree.query(
           boost::geometry::index::nearest(geometry, static_cast<unsigned int>(number_neighbours)) &&
               boost::geometry::index::satisfies(filter),
           std::back_inserter(query_result));
-      return query_result;
     }
 
     template<typename Geometry>
@@ -138,7 +167,9 @@ namespace geom {
 
   private:
 
-    boost::geometry::index::rtree<TreeElement, boost::geometry::index::linear<16>> _rtree;
+    using RtreeType = boost::geometry::index::rtree<TreeElement, boost::geometry::index::linear<16>>;
+
+    RtreeType _rtree;
 
   };
 
@@ -0,0 +1,273 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/image/CityScapesPalette.h"
+#include "carla/sensor/data/Color.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#  include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#  include <emmintrin.h>
+#endif
+
+namespace carla {
+namespace image {
+
+  /// Color converters that process whole buffers of BGRA8 pixels, as sent by
+  /// the cameras, instead of converting pixel by pixel through boost::gil
+  /// views. The output is bit-exact with ColorConverter applied in place with
+  /// ImageConverter::ConvertInPlace.
+  ///
+  /// Depth is vectorized with AVX2 or SSE2 when the compiler targets them;
+  /// CityScapesPalette gathers from a precomputed palette with AVX2.
+  /// LogarithmicDepth reads the gray level from a table of the first depth
+  /// value of each level, which avoids evaluating a logarithm per pixel.
+  ///
+  /// Pixels are handled as little-endian 32-bit words, blue in the lowest
+  /// byte and alpha in the highest.
+  class BulkColorConverter {
+  public:
+
+    static void Depth(uint8_t *data, size_t number_of_pixels) {
+      size_t i = 0u;
+#if defined(__AVX2__)
+      for (; i + 8u <= number_of_pixels; i += 8u) {
+        auto *ptr = reinterpret_cast<__m256i *>(data + 4u * i);
+        _mm256_storeu_si256(ptr, DepthToGray(_mm256_loadu_si256(ptr)));
+      }
+#elif defined(__SSE2__) || defined(_M_X64)
+      for (; i + 4u <= number_of_pixels; i += 4u) {
+        auto *ptr = reinterpret_cast<__m128i *>(data + 4u * i);
+        _mm_storeu_si128(ptr, DepthToGray(_mm_loadu_si128(ptr)));
+      }
+#endif
+      for (; i < number_of_pixels; ++i) {
+        WritePixel(data, i, MakeGray(DepthToGray(DecodeDepth(ReadPixel(data, i)))));
+      }
+    }
+
+    static void LogarithmicDepth(uint8_t *data, size_t number_of_pixels) {
+      const auto &table = GetLogarithmicDepthTable();
+      for (size_t i = 0u; i < number_of_pixels; ++i) {
+        const uint32_t depth = DecodeDepth(ReadPixel(data, i));
+        uint32_t level = table.bucket_level[depth >> LogarithmicDepthTable::BucketBits];
+        while (depth >= table.first_depth[level + 1u]) {
+          ++level;
+        }
+        WritePixel(data, i, MakeGray(level));
+      }
+    }
+
+    static void CityScapesPalette(uint8_t *data, size_t number_of_pixels) {
+      const auto &palette = GetCityScapesPalette();
+      size_t i = 0u;
+#if defined(__AVX2__)
+      const __m256i mask = _mm256_set1_epi32(0xff);
+      for (; i + 8u <= number_of_pixels; i += 8u) {
+        auto *ptr = reinterpret_cast<__m256i *>(data + 4u * i);
+        const __m256i tags = _mm256_and_si256(_mm256_srli_epi32(_mm256_loadu_si256(ptr), 16), mask);
+        _mm256_storeu_si256(
+            ptr,
+            _mm256_i32gather_epi32(reinterpret_cast<const int *>(palette.data()), tags, 4));
+      }
+#endif
+      for (; i < number_of_pixels; ++i) {
+        WritePixel(data, i, palette[(ReadPixel(data, i) >> 16u) & 0xffu]);
+      }
+    }
+
+    /// Color code the optical flow in @a flow, the hue is the direction of
+    /// the flow and the value its magnitude in logarithmic scale. Writes
+    /// @a number_of_pixels BGRA pixels, with alpha set to zero, in @a output.
+    static void ColorCodedFlow(
+        const sensor::data::OpticalFlowPixel *flow,
+        uint8_t *output,
+        size_t number_of_pixels) {
+      constexpr float pi = 3.1415f;
+      constexpr float rad2ang = 360.f / (2.f * pi);
+      constexpr float shift = 0.999f;
+      const float a = 1.f / std::log(0.1f + shift);
+      for (size_t i = 0u; i < number_of_pixels; ++i) {
+        const float vx = flow[i].x;
+        const float vy = flow[i].y;
+
+        float angle = 180.f + std::atan2(vy, vx) * rad2ang;
+        if (angle < 0) angle = 360.f + angle;
+        angle = std::fmod(angle, 360.f);
+
+        const float norm = std::sqrt(vx * vx + vy * vy);
+        const float V = std::min(std::max(a * std::log(norm + shift), 0.f), 1.f);
+        const float H_60 = angle * (1.f / 60.f);
+
+        // HSV to RGB with S = 1.
+        const float C = V;
+        const float X = C * (1.f - std::abs(std::fmod(H_60, 2.f) - 1.f));
+        const float m = V - C;
+
+        float r = 1.f, g = 1.f, b = 1.f;
+        switch (static_cast<unsigned int>(H_60)) {
+          case 0: r = C; g = X; b = 0; break;
+          case 1: r = X; g = C; b = 0; break;
+          case 2: r = 0; g = C; b = X; break;
+          case 3: r = 0; g = X; b = C; break;
+          case 4: r = X; g = 0; b = C; break;
+          case 5: r = C; g = 0; b = X; break;
+          default: break;
+        }
+
+        uint8_t *pixel = output + 4u * i;
+        pixel[0u] = static_cast<uint8_t>((b + m) * 255.f);
+        pixel[1u] = static_cast<uint8_t>((g + m) * 255.f);
+        pixel[2u] = static_cast<uint8_t>((r + m) * 255.f);
+        pixel[3u] = 0u;
+      }
+    }
+
+    /// Gray level of ColorConverter::Depth for the depth encoded in a pixel.
+    static uint32_t DepthToGray(uint32_t depth) {
+      const float normalized = static_cast<float>(depth) / static_cast<float>(MaxDepth);
+      return static_cast<uint32_t>(normalized * 255.0f + 0.5f);
+    }
+
+    /// Gray level of ColorConverter::LogarithmicDepth for the depth encoded in
+    /// a pixel.
+    static uint32_t LogarithmicDepthToGray(uint32_t depth) {
+      const float normalized = static_cast<float>(depth) / static_cast<float>(MaxDepth);
+      const float value = 1.0f + std::log(normalized) / 5.70378f;
+      const float clamped = std::max(std::min(value, 1.0f), 0.005f);
+      return static_cast<uint32_t>(clamped * 255.0f + 0.5f);
+    }
+
+  private:
+
+    static constexpr uint32_t MaxDepth = 256u * 256u * 256u - 1u;
+
+    static constexpr uint32_t Alpha = 0xff000000u;
+
+    static uint32_t ReadPixel(const uint8_t *data, size_t index) {
+      uint32_t pixel;
+      std::memcpy(&pixel, data + 4u * index, sizeof(pixel));
+      return pixel;
+    }
+
+    static void WritePixel(uint8_t *data, size_t index, uint32_t pixel) {
+      std::memcpy(data + 4u * index, &pixel, sizeof(pixel));
+    }
+
+    /// The depth is encoded as R + G * 256 + B * 256 * 256.
+    static uint32_t DecodeDepth(uint32_t pixel) {
+      return ((pixel >> 16u) & 0xffu) | (pixel & 0xff00u) | ((pixel & 0xffu) << 16u);
+    }
+
+    static uint32_t MakeGray(uint32_t level) {
+      return level | (level << 8u) | (level << 16u) | Alpha;
+    }
+
+#if defined(__AVX2__)
+    static __m256i DepthToGray(__m256i pixels) {
+      const __m256i mask = _mm256_set1_epi32(0xff);
+      const __m256i depth = _mm256_or_si256(
+          _mm256_or_si256(
+              _mm256_and_si256(_mm256_srli_epi32(pixels, 16), mask),
+              _mm256_and_si256(pixels, _mm256_set1_epi32(0xff00))),
+          _mm256_slli_epi32(_mm256_and_si256(pixels, mask), 16));
+      const __m256 normalized = _mm256_div_ps(
+          _mm256_cvtepi32_ps(depth),
+          _mm256_set1_ps(static_cast<float>(MaxDepth)));
+      const __m256i level = _mm256_cvttps_epi32(_mm256_add_ps(
+          _mm256_mul_ps(normalized, _mm256_set1_ps(255.0f)),
+          _mm256_set1_ps(0.5f)));
+      return _mm256_or_si256(
+          _mm256_or_si256(level, _mm256_slli_epi32(level, 8)),
+          _mm256_or_si256(_mm256_slli_epi32(level, 16), _mm256_set1_epi32(static_cast<int>(Alpha))));
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    static __m128i DepthToGray(__m128i pixels) {
+      const __m128i mask = _mm_set1_epi32(0xff);
+      const __m128i depth = _mm_or_si128(
+          _mm_or_si128(
+              _mm_and_si128(_mm_srli_epi32(pixels, 16), mask),
+              _mm_and_si128(pixels, _mm_set1_epi32(0xff00))),
+          _mm_slli_epi32(_mm_and_si128(pixels, mask), 16));
+      const __m128 normalized = _mm_div_ps(
+          _mm_cvtepi32_ps(depth),
+          _mm_set1_ps(static_cast<float>(MaxDepth)));
+      const __m128i level = _mm_cvttps_epi32(_mm_add_ps(
+          _mm_mul_ps(normalized, _mm_set1_ps(255.0f)),
+          _mm_set1_ps(0.5f)));
+      return _mm_or_si128(
+          _mm_or_si128(level, _mm_slli_epi32(level, 8)),
+          _mm_or_si128(_mm_slli_epi32(level, 16), _mm_set1_epi32(static_cast<int>(Alpha))));
+    }
+#endif
+
+    /// The gray level of the logarithmic depth never decreases with the
+    /// depth, so it is found from the first depth of each level. Looking up
+    /// the level at the start of the depth's bucket leaves at most a couple
+    /// of levels to step over.
+    struct LogarithmicDepthTable {
+      static constexpr uint32_t BucketBits = 10u;
+
+      /// First depth of each gray level, plus a sentinel past the last one.
+      std::array<uint32_t, 257u> first_depth;
+
+      std::array<uint8_t, ((MaxDepth + 1u) >> BucketBits)> bucket_level;
+    };
+
+    static const LogarithmicDepthTable &GetLogarithmicDepthTable() {
+      static const LogarithmicDepthTable table = [] {
+        LogarithmicDepthTable result;
+        for (uint32_t level = 0u; level < 256u; ++level) {
+          uint32_t first = 0u;
+          uint32_t last = MaxDepth + 1u;
+          while (first < last) {
+            const uint32_t middle = first + (last - first) / 2u;
+            if (LogarithmicDepthToGray(middle) < level) {
+              first = middle + 1u;
+            } else {
+              last = middle;
+            }
+          }
+          result.first_depth[level] = first;
+        }
+        result.first_depth[256u] = MaxDepth + 1u;
+        for (uint32_t i = 0u; i < result.bucket_level.size(); ++i) {
+          result.bucket_level[i] = static_cast<uint8_t>(
+              LogarithmicDepthToGray(i << LogarithmicDepthTable::BucketBits));
+        }
+        return result;
+      }();
+      return table;
+    }
+
+    static const std::array<uint32_t, 256u> &GetCityScapesPalette() {
+      static const std::array<uint32_t, 256u> palette = [] {
+        std::array<uint32_t, 256u> result;
+        for (uint32_t tag = 0u; tag < result.size(); ++tag) {
+          const auto color = image::CityScapesPalette::GetColor(static_cast<uint8_t>(tag));
+          result[tag] =
+              static_cast<uint32_t>(color[2u]) |
+              (static_cast<uint32_t>(color[1u]) << 8u) |
+              (static_cast<uint32_t>(color[0u]) << 16u) |
+              Alpha;
+        }
+        return result;
+      }();
+      return palette;
+    }
+  };
+
+} // namespace image
+} // namespace carla
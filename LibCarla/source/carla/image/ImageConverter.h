@@ -6,7 +6,14 @@
 
 #pragma once
 
+#include "carla/ThreadPool.h"
+#include "carla/image/BulkColorConverter.h"
 #include "carla/image/ImageView.h"
+#include "carla/sensor/data/Image.h"
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
 
 namespace carla {
 namespace image {
@@ -28,6 +35,112 @@ namespace image {
           ImageView::MakeColorConvertedView<MutableImageView, DstPixelT>(image_view, converter),
           image_view);
     }
+
+    /// @{
+    /// Convert a camera image in place with BulkColorConverter, the result is
+    /// the same as converting its view. Large images are split in blocks of
+    /// rows converted by up to @a number_of_threads threads, the calling one
+    /// included; zero uses a thread per core.
+    static void ConvertInPlace(
+        sensor::data::ImageTmpl<sensor::data::Color> &image,
+        ColorConverter::Depth,
+        size_t number_of_threads = 1u) {
+      ConvertRowsInPlace(image, number_of_threads, BulkColorConverter::Depth);
+    }
+
+    static void ConvertInPlace(
+        sensor::data::ImageTmpl<sensor::data::Color> &image,
+        ColorConverter::LogarithmicDepth,
+        size_t number_of_threads = 1u) {
+      ConvertRowsInPlace(image, number_of_threads, BulkColorConverter::LogarithmicDepth);
+    }
+
+    static void ConvertInPlace(
+        sensor::data::ImageTmpl<sensor::data::Color> &image,
+        ColorConverter::CityScapesPalette,
+        size_t number_of_threads = 1u) {
+      ConvertRowsInPlace(image, number_of_threads, BulkColorConverter::CityScapesPalette);
+    }
+    /// @}
+
+    /// Color code the optical flow of @a image into @a output, which must
+    /// have room for a BGRA8 pixel per flow pixel. Threads as in
+    /// ConvertInPlace.
+    static void ColorCodedFlow(
+        const sensor::data::OpticalFlowImage &image,
+        uint8_t *output,
+        size_t number_of_threads = 1u) {
+      const auto *flow = image.data();
+      ForEachBlockOfRows(
+          image.GetWidth(),
+          image.GetHeight(),
+          number_of_threads,
+          [=](size_t first_pixel, size_t number_of_pixels) {
+        BulkColorConverter::ColorCodedFlow(flow + first_pixel, output + 4u * first_pixel, number_of_pixels);
+      });
+    }
+
+  private:
+
+    /// Below this number of pixels a block is not worth a thread.
+    static constexpr size_t PixelsPerBlock = 128u * 1024u;
+
+    /// Thread pool shared by the conversions, created on first use so the
+    /// threads are not spawned on every frame.
+    static ThreadPool &GetThreadPool() {
+      static ThreadPool thread_pool;
+      static std::once_flag started;
+      std::call_once(started, []() {
+        const size_t hardware_threads = std::thread::hardware_concurrency();
+        if (hardware_threads > 1u) {
+          thread_pool.AsyncRun(hardware_threads - 1u);
+        }
+      });
+      return thread_pool;
+    }
+
+    /// Call @a functor(first_pixel, number_of_pixels) for blocks of rows of
+    /// an image, on up to @a number_of_threads threads.
+    template <typename FuncT>
+    static void ForEachBlockOfRows(
+        size_t width,
+        size_t height,
+        size_t number_of_threads,
+        FuncT &&functor) {
+      if (number_of_threads == 0u) {
+        number_of_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1u);
+      }
+      const size_t rows_per_block = std::max<size_t>(PixelsPerBlock / std::max<size_t>(width, 1u), 1u);
+      const size_t number_of_blocks = (height + rows_per_block - 1u) / rows_per_block;
+      number_of_threads = std::min(number_of_threads, number_of_blocks);
+      if (number_of_threads <= 1u) {
+        functor(0u, width * height);
+        return;
+      }
+      // One chunk of blocks per thread, so at most that many threads work.
+      const size_t rows_per_chunk = rows_per_block * ((number_of_blocks + number_of_threads - 1u) / number_of_threads);
+      const size_t number_of_chunks = (height + rows_per_chunk - 1u) / rows_per_chunk;
+      GetThreadPool().ParallelFor(number_of_chunks, 1u, [&](size_t chunk) {
+        const size_t first_row = chunk * rows_per_chunk;
+        const size_t rows = std::min(rows_per_chunk, height - first_row);
+        functor(width * first_row, width * rows);
+      });
+    }
+
+    template <typename FuncT>
+    static void ConvertRowsInPlace(
+        sensor::data::ImageTmpl<sensor::data::Color> &image,
+        size_t number_of_threads,
+        FuncT &&convert) {
+      auto *data = reinterpret_cast<uint8_t *>(image.data());
+      ForEachBlockOfRows(
+          image.GetWidth(),
+          image.GetHeight(),
+          number_of_threads,
+          [&](size_t first_pixel, size_t number_of_pixels) {
+        convert(data + sizeof(sensor::data::Color) * first_pixel, number_of_pixels);
+      });
+    }
   };
 
 } // namespace image
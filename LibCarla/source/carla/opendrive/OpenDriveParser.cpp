@@ -8,6 +8,7 @@
 
 #include "carla/Logging.h"
 #include "carla/opendrive/parser/ControllerParser.h"
+#include "carla/opendrive/parser/ElementReader.h"
 #include "carla/opendrive/parser/GeoReferenceParser.h"
 #include "carla/opendrive/parser/GeometryParser.h"
 #include "carla/opendrive/parser/JunctionParser.h"
@@ -24,7 +25,7 @@
 namespace carla {
 namespace opendrive {
 
-  boost::optional<road::Map> OpenDriveParser::Load(const std::string &opendrive) {
+  boost::optional<road::Map> OpenDriveParser::Load(const std::string &opendrive, bool parallel) {
     pugi::xml_document xml;
     pugi::xml_parse_result parse_result = xml.load_string(opendrive.c_str());
 
@@ -33,7 +34,7 @@ namespace opendrive {
       return {};
     }
 
-    carla::road::MapBuilder map_builder;
+    carla::road::MapBuilder map_builder(parallel);
 
     parser::GeoReferenceParser::Parse(xml, map_builder);
     parser::RoadParser::Parse(xml, map_builder);
@@ -49,5 +50,52 @@ namespace opendrive {
     return map_builder.Build();
   }
 
+  boost::optional<road::Map> OpenDriveParser::Load(std::istream &opendrive, bool parallel) {
+    carla::road::MapBuilder map_builder(parallel);
+    parser::ElementReader reader(opendrive);
+    bool has_header = false;
+    std::string name;
+    std::string element;
+    pugi::xml_document xml;
+
+    while (reader.Next(name, element)) {
+      // Each element is parsed under its own <OpenDRIVE> root, where the
+      // parsers look for it in a whole document.
+      xml.reset();
+      pugi::xml_node root = xml.append_child("OpenDRIVE");
+      if (!root.append_buffer(element.data(), element.size())) {
+        log_error("unable to parse the OpenDRIVE", name, "element");
+        return {};
+      }
+      if (name == "road") {
+        parser::RoadParser::Parse(xml, map_builder);
+        parser::GeometryParser::Parse(xml, map_builder);
+        parser::LaneParser::Parse(xml, map_builder);
+        parser::ProfilesParser::Parse(xml, map_builder);
+        parser::SignalParser::Parse(xml, map_builder);
+        parser::ObjectParser::Parse(xml, map_builder);
+      } else if (name == "junction") {
+        parser::JunctionParser::Parse(xml, map_builder);
+      } else if (name == "controller") {
+        parser::ControllerParser::Parse(xml, map_builder);
+      } else if (name == "header") {
+        parser::GeoReferenceParser::Parse(xml, map_builder);
+        has_header = true;
+      }
+    }
+
+    if (reader.HasFailed()) {
+      log_error("unable to parse the OpenDRIVE XML stream");
+      return {};
+    }
+    if (!has_header) {
+      // Falls back to the default geo-reference, as Load does.
+      xml.reset();
+      parser::GeoReferenceParser::Parse(xml, map_builder);
+    }
+
+    return map_builder.Build();
+  }
+
 } // namespace opendrive
 } // namespace carla
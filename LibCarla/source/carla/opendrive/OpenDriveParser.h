@@ -10,6 +10,7 @@
 
 #include <boost/optional.hpp>
 
+#include <istream>
 #include <string>
 
 namespace carla {
@@ -18,7 +19,15 @@ namespace opendrive {
   class OpenDriveParser {
   public:
 
-    static boost::optional<road::Map> Load(const std::string &opendrive);
+    /// Parse @a opendrive and build its map. If @a parallel is true, the
+    /// roads are read and the built map is processed using a thread per core;
+    /// the map is the same either way.
+    static boost::optional<road::Map> Load(const std::string &opendrive, bool parallel = false);
+
+    /// Read @a opendrive and build its map one road at a time, without
+    /// holding the whole document in memory. Builds the same map as Load
+    /// with the contents of the stream; meant for very large networks.
+    static boost::optional<road::Map> Load(std::istream &opendrive, bool parallel = false);
   };
 
 } // namespace opendrive
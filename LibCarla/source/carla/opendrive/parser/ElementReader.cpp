@@ -0,0 +1,160 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/opendrive/parser/ElementReader.h"
+
+#include "carla/Debug.h"
+
+#include <cstring>
+
+namespace carla {
+namespace opendrive {
+namespace parser {
+
+  static bool IsNameChar(std::char_traits<char>::int_type c) {
+    return (c != std::char_traits<char>::eof()) &&
+        (c != '>') && (c != '/') &&
+        (c != ' ') && (c != '\t') && (c != '\n') && (c != '\r');
+  }
+
+  bool ElementReader::Next(std::string &name, std::string &element) {
+    if (_done || _failed) {
+      return false;
+    }
+    for (auto c = Get(); c != traits_type::eof(); c = Get()) {
+      if (c != '<') {
+        continue;
+      }
+      const auto next = _input.sgetc();
+      if (next == '?') {
+        if (!SkipPast("?>")) {
+          break;
+        }
+      } else if (next == '!') {
+        Get();
+        if (!SkipDeclaration()) {
+          break;
+        }
+      } else if (next == '/') {
+        bool self_closing;
+        if ((_depth == 0u) || !SkipTag(self_closing)) {
+          break;
+        }
+        --_depth;
+        if (_depth == 0u) {
+          // Closed </OpenDRIVE>, anything after it is ignored.
+          _done = true;
+          return false;
+        }
+        if ((_depth == 1u) && (_element != nullptr)) {
+          _element = nullptr;
+          return true;
+        }
+      } else {
+        std::string root_name;
+        if (_depth == 1u) {
+          element.assign(1u, '<');
+          _element = &element;
+        }
+        bool self_closing;
+        if (!ReadName(_depth == 1u ? name : root_name) || !SkipTag(self_closing)) {
+          break;
+        }
+        if ((_depth == 0u) && (root_name != "OpenDRIVE")) {
+          break;
+        }
+        if (!self_closing) {
+          ++_depth;
+        } else if (_depth == 0u) {
+          _done = true;
+          return false;
+        } else if (_depth == 1u) {
+          _element = nullptr;
+          return true;
+        }
+      }
+    }
+    _element = nullptr;
+    _failed = true;
+    return false;
+  }
+
+  ElementReader::traits_type::int_type ElementReader::Get() {
+    const auto c = _input.sbumpc();
+    if ((c != traits_type::eof()) && (_element != nullptr)) {
+      _element->push_back(traits_type::to_char_type(c));
+    }
+    return c;
+  }
+
+  bool ElementReader::SkipPast(const char *terminator) {
+    const size_t length = std::strlen(terminator);
+    DEBUG_ASSERT((length > 0u) && (length <= 3u));
+    // The last characters read, compared with the terminator after each one.
+    char window[3u] = {};
+    for (auto c = Get(); c != traits_type::eof(); c = Get()) {
+      window[0u] = window[1u];
+      window[1u] = window[2u];
+      window[2u] = traits_type::to_char_type(c);
+      if (std::memcmp(window + 3u - length, terminator, length) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool ElementReader::ReadName(std::string &name) {
+    name.clear();
+    while (IsNameChar(_input.sgetc())) {
+      name.push_back(traits_type::to_char_type(Get()));
+    }
+    return !name.empty();
+  }
+
+  bool ElementReader::SkipTag(bool &self_closing) {
+    traits_type::int_type quote = traits_type::eof();
+    traits_type::int_type previous = traits_type::eof();
+    for (auto c = Get(); c != traits_type::eof(); c = Get()) {
+      if (quote != traits_type::eof()) {
+        if (c == quote) {
+          quote = traits_type::eof();
+        }
+      } else if ((c == '"') || (c == '\'')) {
+        quote = c;
+      } else if (c == '>') {
+        self_closing = (previous == '/');
+        return true;
+      }
+      previous = c;
+    }
+    return false;
+  }
+
+  bool ElementReader::SkipDeclaration() {
+    const auto c = Get();
+    if (c == '-') {
+      return (Get() == '-') && SkipPast("-->");
+    }
+    if (c == '[') {
+      return SkipPast("]]>");
+    }
+    // A <!DOCTYPE>, which may have an internal subset in brackets.
+    size_t brackets = 0u;
+    for (auto d = c; d != traits_type::eof(); d = Get()) {
+      if (d == '[') {
+        ++brackets;
+      } else if ((d == ']') && (brackets > 0u)) {
+        --brackets;
+      } else if ((d == '>') && (brackets == 0u)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+} // namespace parser
+} // namespace opendrive
+} // namespace carla
@@ -0,0 +1,76 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <istream>
+#include <string>
+
+namespace carla {
+namespace opendrive {
+namespace parser {
+
+  /// Reads an OpenDRIVE document from a stream one top-level element, a
+  /// child of <OpenDRIVE>, at a time, so the whole document is never held in
+  /// memory.
+  ///
+  /// This is not an XML parser: it only follows tags, comments, CDATA
+  /// sections, processing instructions and quoted attribute values to find
+  /// where each element ends. The text of the elements is left to pugixml.
+  class ElementReader {
+  public:
+
+    explicit ElementReader(std::istream &input)
+      : _input(*input.rdbuf()) {}
+
+    /// Read the next top-level element, tags included, into @a element and
+    /// its tag name into @a name. Return false at the end of the document,
+    /// or if it is malformed, see HasFailed.
+    bool Next(std::string &name, std::string &element);
+
+    /// Whether the document ended before the closing </OpenDRIVE>, or had no
+    /// <OpenDRIVE> root.
+    bool HasFailed() const {
+      return _failed;
+    }
+
+  private:
+
+    using traits_type = std::char_traits<char>;
+
+    /// Read a character, also appending it to the element being read if any.
+    traits_type::int_type Get();
+
+    /// Read up to and including @a terminator, return false at the end of
+    /// the stream.
+    bool SkipPast(const char *terminator);
+
+    /// Read the name of a tag, after its '<'.
+    bool ReadName(std::string &name);
+
+    /// Read the rest of a tag up to its '>', skipping quoted attribute
+    /// values. Set @a self_closing if the tag ends in "/>".
+    bool SkipTag(bool &self_closing);
+
+    /// Read a "<!" declaration, comment or CDATA section, after its '!'.
+    bool SkipDeclaration();
+
+    std::streambuf &_input;
+
+    std::string *_element = nullptr;
+
+    /// Number of elements open, <OpenDRIVE> included.
+    size_t _depth = 0u;
+
+    /// Whether </OpenDRIVE> was read.
+    bool _done = false;
+
+    bool _failed = false;
+  };
+
+} // namespace parser
+} // namespace opendrive
+} // namespace carla
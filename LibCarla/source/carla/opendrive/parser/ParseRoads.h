@@ -0,0 +1,55 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/ThreadPool.h"
+#include "carla/road/MapBuilder.h"
+
+#include <pugixml/pugixml.hpp>
+
+#include <utility>
+#include <vector>
+
+namespace carla {
+namespace opendrive {
+namespace parser {
+
+  /// Call @a parse_road(node) for every road node of @a xml and return the
+  /// results in the order of the document.
+  ///
+  /// If @a map_builder is parallel and there are enough roads, they are read
+  /// by a thread per core, so @a parse_road must only read the node it
+  /// receives; the calls to the builder are done afterwards with the
+  /// returned results.
+  template <typename FuncT>
+  static auto ParseRoads(
+      const pugi::xml_document &xml,
+      const road::MapBuilder &map_builder,
+      FuncT &&parse_road) {
+    using ResultT = decltype(parse_road(std::declval<pugi::xml_node>()));
+    std::vector<pugi::xml_node> nodes;
+    for (pugi::xml_node node_road : xml.child("OpenDRIVE").children("road")) {
+      nodes.emplace_back(node_road);
+    }
+    std::vector<ResultT> results(nodes.size());
+    constexpr size_t chunk_size = 16u;
+    // A document streamed road by road has a single road node.
+    if (map_builder.IsParallel() && (nodes.size() > chunk_size)) {
+      ParallelFor(nodes.size(), chunk_size, [&](size_t i) {
+        results[i] = parse_road(nodes[i]);
+      });
+    } else {
+      for (size_t i = 0u; i < nodes.size(); ++i) {
+        results[i] = parse_road(nodes[i]);
+      }
+    }
+    return results;
+  }
+
+} // namespace parser
+} // namespace opendrive
+} // namespace carla
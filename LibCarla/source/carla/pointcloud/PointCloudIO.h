@@ -11,6 +11,7 @@
 #include <fstream>
 #include <iterator>
 #include <iomanip>
+#include <type_traits>
 
 namespace carla {
 namespace pointcloud {
@@ -18,6 +19,15 @@ namespace pointcloud {
   class PointCloudIO {
 
   public:
+
+    enum class Format {
+      Ascii,
+      /// The points are written as they are laid out in memory, this requires
+      /// a little-endian host and packed point types whose members follow the
+      /// order of the properties in WritePlyHeaderInfo.
+      BinaryLittleEndian
+    };
+
     template <typename PointIt>
     static void Dump(std::ostream &out, PointIt begin, PointIt end) {
       WriteHeader(out, begin, end);
@@ -28,20 +38,63 @@ namespace pointcloud {
     }
 
     template <typename PointIt>
-    static std::string SaveToDisk(std::string path, PointIt begin, PointIt end) {
+    static void DumpBinary(std::ostream &out, PointIt begin, PointIt end) {
+      WriteHeader(out, begin, end, Format::BinaryLittleEndian);
+      WritePoints(out, begin, end);
+    }
+
+    template <typename PointIt>
+    static std::string SaveToDisk(
+        std::string path,
+        PointIt begin,
+        PointIt end,
+        Format format = Format::Ascii) {
       FileSystem::ValidateFilePath(path, ".ply");
-      std::ofstream out(path);
-      Dump(out, begin, end);
+      if (format == Format::BinaryLittleEndian) {
+        std::ofstream out(path, std::ios::binary);
+        DumpBinary(out, begin, end);
+      } else {
+        std::ofstream out(path);
+        Dump(out, begin, end);
+      }
       return path;
     }
 
+    /// Write the "property" lines of the vertices, without the final newline.
+    template <typename PointT>
+    static void WritePlyProperties(std::ostream &out) {
+      PointT().WritePlyHeaderInfo(out);
+    }
+
+    /// Write the points in binary, straight from memory if they are
+    /// contiguous.
+    template <typename PointT>
+    static void WritePoints(std::ostream &out, PointT *begin, PointT *end) {
+      out.write(
+          reinterpret_cast<const char *>(begin),
+          static_cast<std::streamsize>(sizeof(PointT) * static_cast<size_t>(end - begin)));
+    }
+
+    template <typename PointIt>
+    static void WritePoints(std::ostream &out, PointIt begin, PointIt end) {
+      for (; begin != end; ++begin) {
+        const auto &point = *begin;
+        out.write(reinterpret_cast<const char *>(&point), sizeof(point));
+      }
+    }
+
   private:
-    template <typename PointIt> static void WriteHeader(std::ostream &out, PointIt begin, PointIt end) {
+    template <typename PointIt> static void WriteHeader(
+        std::ostream &out,
+        PointIt begin,
+        PointIt end,
+        Format format = Format::Ascii) {
+      using PointT = typename std::iterator_traits<PointIt>::value_type;
       DEBUG_ASSERT(std::distance(begin, end) >= 0);
       out << "ply\n"
-           "format ascii 1.0\n"
+           "format " << (format == Format::Ascii ? "ascii" : "binary_little_endian") << " 1.0\n"
            "element vertex " << std::to_string(static_cast<size_t>(std::distance(begin, end))) << "\n";
-      begin->WritePlyHeaderInfo(out);
+      WritePlyProperties<PointT>(out);
       out << "\nend_header\n";
       out << std::fixed << std::setprecision(4u);
     }
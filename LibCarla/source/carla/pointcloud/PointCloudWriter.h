@@ -0,0 +1,231 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Exception.h"
+#include "carla/FileSystem.h"
+#include "carla/Logging.h"
+#include "carla/Memory.h"
+#include "carla/NonCopyable.h"
+#include "carla/pointcloud/PointCloudIO.h"
+#include "carla/sensor/data/Array.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace carla {
+namespace pointcloud {
+
+  /// Appends the point clouds of many frames to a single binary PLY file
+  /// without blocking the caller.
+  ///
+  /// Write only queues the measurement, a background thread writes its
+  /// points straight from the measurement's buffer, which is kept alive until
+  /// then. At most @a queue_capacity measurements wait in the queue, Write
+  /// blocks until there is room if the disk does not keep up. The file has a "vertex" element with the points of every frame, in
+  /// the order they were written, followed by a "frame" element with the
+  /// frame number, timestamp and point count of each frame. The element
+  /// counts in the header are filled in by Close.
+  template <typename PointT>
+  class PointCloudWriter : private NonCopyable {
+  public:
+
+    using Measurement = sensor::data::Array<PointT>;
+
+    explicit PointCloudWriter(std::string path, size_t queue_capacity = 16u)
+      : _path(std::move(path)),
+        _queue_capacity(std::max<size_t>(1u, queue_capacity)) {
+      FileSystem::ValidateFilePath(_path, ".ply");
+      _out.open(_path, std::ios::binary);
+      if (!_out.is_open()) {
+        throw_exception(std::runtime_error(_path + ": failed to open file"));
+      }
+      WriteHeader();
+      _thread = std::thread([this]() { Run(); });
+    }
+
+    ~PointCloudWriter() {
+      if (!Finish()) {
+        log_error("failed to write point cloud file", _path);
+      }
+    }
+
+    const std::string &GetPath() const {
+      return _path;
+    }
+
+    /// Queue @a measurement to be appended to the file, waiting for room in
+    /// the queue if it is full.
+    ///
+    /// The last reference to @a measurement is released on the background
+    /// thread.
+    void Write(SharedPtr<const Measurement> measurement) {
+      DEBUG_ASSERT(measurement != nullptr);
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _caller_condition.wait(lock, [this]() {
+          return _done || (_queue.size() < _queue_capacity);
+        });
+        if (_done) {
+          throw_exception(std::logic_error(_path + ": point cloud writer already closed"));
+        }
+        _queue.emplace_back(std::move(measurement));
+      }
+      _condition.notify_one();
+    }
+
+    /// Wait until every queued measurement is written and close the file.
+    ///
+    /// @throw std::runtime_error if writing the file failed.
+    void Close() {
+      if (!Finish()) {
+        throw_exception(std::runtime_error(_path + ": failed to write point cloud file"));
+      }
+    }
+
+  private:
+
+#pragma pack(push, 1)
+    struct FrameInfo {
+      /// PLY has no 64-bit integers, a double holds any frame number exactly
+      /// up to 2^53.
+      double frame;
+      uint32_t point_count;
+      double timestamp;
+    };
+#pragma pack(pop)
+
+    /// Width of the zero-padded element counts, so they can be rewritten in
+    /// place.
+    static constexpr int CountWidth = 15;
+
+    void WriteHeader() {
+      _out << "ply\n"
+              "format binary_little_endian 1.0\n"
+              "element vertex ";
+      _vertex_count_offset = _out.tellp();
+      WriteCount(0u);
+      _out << '\n';
+      PointCloudIO::WritePlyProperties<PointT>(_out);
+      _out << "\nelement frame ";
+      _frame_count_offset = _out.tellp();
+      WriteCount(0u);
+      _out << "\n"
+              "property float64 frame\n"
+              "property uint32 point_count\n"
+              "property float64 timestamp\n"
+              "end_header\n";
+    }
+
+    void WriteCount(uint64_t count) {
+      _out << std::setw(CountWidth) << std::setfill('0') << count;
+    }
+
+    void Run() {
+      std::unique_lock<std::mutex> lock(_mutex);
+      for (;;) {
+        _condition.wait(lock, [this]() { return _done || !_queue.empty(); });
+        if (_queue.empty()) {
+          return;
+        }
+        auto measurement = std::move(_queue.front());
+        _queue.pop_front();
+        lock.unlock();
+        _caller_condition.notify_one();
+        PointCloudIO::WritePoints(_out, measurement->begin(), measurement->end());
+        _vertex_count += measurement->size();
+        _frames.push_back(FrameInfo{
+            static_cast<double>(measurement->GetFrame()),
+            static_cast<uint32_t>(measurement->size()),
+            measurement->GetTimestamp()});
+        measurement = nullptr;
+        lock.lock();
+      }
+    }
+
+    /// Drain the queue, write the frames and the element counts, and close
+    /// the file. Return whether the whole file was written successfully. If
+    /// another thread is already finishing the file, wait for it.
+    bool Finish() {
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (_done) {
+          _caller_condition.wait(lock, [this]() { return _finished; });
+          return _succeeded;
+        }
+        _done = true;
+      }
+      _condition.notify_one();
+      // Wake up the writers waiting for room, they fail now.
+      _caller_condition.notify_all();
+      _thread.join();
+      _out.write(
+          reinterpret_cast<const char *>(_frames.data()),
+          static_cast<std::streamsize>(sizeof(FrameInfo) * _frames.size()));
+      _out.seekp(_vertex_count_offset);
+      WriteCount(_vertex_count);
+      _out.seekp(_frame_count_offset);
+      WriteCount(_frames.size());
+      _out.close();
+      const bool succeeded = !_out.fail();
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _succeeded = succeeded;
+        _finished = true;
+      }
+      _caller_condition.notify_all();
+      return succeeded;
+    }
+
+    std::string _path;
+
+    const size_t _queue_capacity;
+
+    std::ofstream _out;
+
+    std::streampos _vertex_count_offset;
+
+    std::streampos _frame_count_offset;
+
+    /// @{
+    /// Only accessed by the background thread until it is joined.
+    uint64_t _vertex_count = 0u;
+
+    std::vector<FrameInfo> _frames;
+    /// @}
+
+    std::mutex _mutex;
+
+    /// Wakes up the background thread.
+    std::condition_variable _condition;
+
+    /// Wakes up the callers waiting for room in the queue or for the file to
+    /// be finished.
+    std::condition_variable _caller_condition;
+
+    std::deque<SharedPtr<const Measurement>> _queue;
+
+    bool _done = false;
+
+    bool _finished = false;
+
+    bool _succeeded = false;
+
+    std::thread _thread;
+  };
+
+} // namespace pointcloud
+} // namespace carla
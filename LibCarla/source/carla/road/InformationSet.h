@@ -6,67 +6,214 @@
 
 #pragma once
 
+#include "carla/Debug.h"
 #include "carla/NonCopyable.h"
 #include "carla/road/RoadElementSet.h"
 #include "carla/road/element/RoadInfo.h"
-#include "carla/road/element/RoadInfoIterator.h"
+#include "carla/road/element/RoadInfoVisitor.h"
 
-#include <vector>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iterator>
 #include <memory>
+#include <tuple>
+#include <type_traits>
+#include <vector>
 
 namespace carla {
 namespace road {
 
+  class MapSnapshot;
+
+  /// Road infos of a road or a lane, ordered by their position on the road.
+  ///
+  /// Besides the set of all infos, the infos are indexed by type: one array
+  /// per type, sorted by position, built once when the set is created. Asking
+  /// for the info of a type at a given s is a binary search in the array of
+  /// that type, without visiting the infos of other types.
   class InformationSet : private MovableNonCopyable {
   public:
 
     InformationSet() = default;
 
     InformationSet(std::vector<std::unique_ptr<element::RoadInfo>> &&vec)
-      : _road_set(std::move(vec)) {}
+      : _road_set(std::move(vec)) {
+      BuildTypeIndex();
+    }
 
     /// Return all infos given a type from the start of the road
     template <typename T>
     std::vector<const T *> GetInfos() const {
-      std::vector<const T *> vec;
-      auto it = element::MakeRoadInfoIterator<T>(_road_set.GetAll());
-      for (; !it.IsAtEnd(); ++it) {
-        vec.emplace_back(&*it);
-      }
-      return vec;
+      const auto infos = GetInfosOfType<T>();
+      return MakeInfoVector<T>(infos.first, infos.second);
     }
 
     /// Returns single info given a type and a distance (s) from
     /// the start of the road
     template <typename T>
     const T *GetInfo(const double s) const {
-      auto it = element::MakeRoadInfoIterator<T>(_road_set.GetReverseSubset(s));
-      return it.IsAtEnd() ? nullptr : &*it;
+      const auto infos = GetInfosOfType<T>();
+      const auto it = std::upper_bound(infos.first, infos.second, s, LessDistance());
+      return it == infos.first ? nullptr : static_cast<const T *>(*std::prev(it));
     }
 
     /// Return all infos given a type in a given range of the road
     template <typename T>
     std::vector<const T *> GetInfos(const double min_s, const double max_s) const {
-      std::vector<const T *> vec;
+      const auto infos = GetInfosOfType<T>();
       if(min_s < max_s) {
-        auto it = element::MakeRoadInfoIterator<T>(
-            _road_set.GetSubsetInRange(min_s, max_s)); //reverse
-        for (; !it.IsAtEnd(); ++it) {
-          vec.emplace_back(&*it);
-        }
+        return MakeInfoVector<T>(
+            std::lower_bound(infos.first, infos.second, min_s, LessDistance()),
+            std::upper_bound(infos.first, infos.second, max_s, LessDistance()));
       } else {
-        auto it = element::MakeRoadInfoIterator<T>(
-            _road_set.GetReverseSubsetInRange(max_s, min_s)); //reverse
-        for (; !it.IsAtEnd(); ++it) {
-          vec.emplace_back(&*it);
-        }
+        const auto low_bound = std::lower_bound(infos.first, infos.second, max_s, LessDistance());
+        const auto up_bound = std::upper_bound(low_bound, infos.second, min_s, LessDistance());
+        return MakeInfoVector<T>( //reverse
+            std::make_reverse_iterator(up_bound),
+            std::make_reverse_iterator(low_bound));
       }
-      return vec;
     }
 
   private:
 
+    friend MapSnapshot;
+
+    using InfoIterator = std::vector<const element::RoadInfo *>::const_iterator;
+
+    /// Types that can be looked up, the position of each type in this list is
+    /// its index in _type_begin.
+    using RoadInfoTypes = std::tuple<
+        element::RoadInfoElevation,
+        element::RoadInfoGeometry,
+        element::RoadInfoLane,
+        element::RoadInfoLaneAccess,
+        element::RoadInfoLaneBorder,
+        element::RoadInfoLaneHeight,
+        element::RoadInfoLaneMaterial,
+        element::RoadInfoLaneOffset,
+        element::RoadInfoLaneRule,
+        element::RoadInfoLaneVisibility,
+        element::RoadInfoLaneWidth,
+        element::RoadInfoMarkRecord,
+        element::RoadInfoMarkTypeLine,
+        element::RoadInfoSpeed,
+        element::RoadInfoCrosswalk,
+        element::RoadInfoSignal>;
+
+    static constexpr size_t NumberOfTypes = std::tuple_size<RoadInfoTypes>::value;
+
+    template <typename T, typename Tuple>
+    struct TypeIndex;
+
+    template <typename T, typename... Ts>
+    struct TypeIndex<T, std::tuple<T, Ts...>>
+      : std::integral_constant<size_t, 0u> {};
+
+    template <typename T, typename U, typename... Ts>
+    struct TypeIndex<T, std::tuple<U, Ts...>>
+      : std::integral_constant<size_t, 1u + TypeIndex<T, std::tuple<Ts...>>::value> {};
+
+    /// Finds the index in RoadInfoTypes of the type of the infos it visits.
+    class TypeIndexVisitor : public element::RoadInfoVisitor {
+    public:
+
+      size_t Get(element::RoadInfo &info) {
+        _index = NumberOfTypes;
+        info.AcceptVisitor(*this);
+        return _index;
+      }
+
+    private:
+
+      template <typename T>
+      void Set() {
+        _index = TypeIndex<T, RoadInfoTypes>::value;
+      }
+
+      void Visit(element::RoadInfoElevation &) override { Set<element::RoadInfoElevation>(); }
+      void Visit(element::RoadInfoGeometry &) override { Set<element::RoadInfoGeometry>(); }
+      void Visit(element::RoadInfoLane &) override { Set<element::RoadInfoLane>(); }
+      void Visit(element::RoadInfoLaneAccess &) override { Set<element::RoadInfoLaneAccess>(); }
+      void Visit(element::RoadInfoLaneBorder &) override { Set<element::RoadInfoLaneBorder>(); }
+      void Visit(element::RoadInfoLaneHeight &) override { Set<element::RoadInfoLaneHeight>(); }
+      void Visit(element::RoadInfoLaneMaterial &) override { Set<element::RoadInfoLaneMaterial>(); }
+      void Visit(element::RoadInfoLaneOffset &) override { Set<element::RoadInfoLaneOffset>(); }
+      void Visit(element::RoadInfoLaneRule &) override { Set<element::RoadInfoLaneRule>(); }
+      void Visit(element::RoadInfoLaneVisibility &) override { Set<element::RoadInfoLaneVisibility>(); }
+      void Visit(element::RoadInfoLaneWidth &) override { Set<element::RoadInfoLaneWidth>(); }
+      void Visit(element::RoadInfoMarkRecord &) override { Set<element::RoadInfoMarkRecord>(); }
+      void Visit(element::RoadInfoMarkTypeLine &) override { Set<element::RoadInfoMarkTypeLine>(); }
+      void Visit(element::RoadInfoSpeed &) override { Set<element::RoadInfoSpeed>(); }
+      void Visit(element::RoadInfoCrosswalk &) override { Set<element::RoadInfoCrosswalk>(); }
+      void Visit(element::RoadInfoSignal &) override { Set<element::RoadInfoSignal>(); }
+
+      size_t _index = NumberOfTypes;
+    };
+
+    struct LessDistance {
+      bool operator()(double s, const element::RoadInfo *info) const {
+        return s < info->GetDistance();
+      }
+      bool operator()(const element::RoadInfo *info, double s) const {
+        return info->GetDistance() < s;
+      }
+    };
+
+    /// Sort the infos by type, keeping the order by position of the infos of
+    /// each type.
+    void BuildTypeIndex() {
+      const auto &all = _road_set.GetAll();
+      std::vector<uint32_t> types;
+      types.reserve(all.size());
+      std::array<uint32_t, NumberOfTypes + 1u> count{};
+      TypeIndexVisitor visitor;
+      for (auto &info : all) {
+        DEBUG_ASSERT(info != nullptr);
+        const auto type = static_cast<uint32_t>(visitor.Get(*info));
+        types.emplace_back(type);
+        if (type < NumberOfTypes) {
+          ++count[type];
+        }
+      }
+      _type_begin[0u] = 0u;
+      for (auto i = 0u; i < NumberOfTypes; ++i) {
+        _type_begin[i + 1u] = _type_begin[i] + count[i];
+      }
+      _infos_by_type.resize(_type_begin[NumberOfTypes]);
+      auto next = _type_begin;
+      for (auto i = 0u; i < all.size(); ++i) {
+        if (types[i] < NumberOfTypes) {
+          _infos_by_type[next[types[i]]++] = all[i].get();
+        }
+      }
+    }
+
+    template <typename T>
+    std::pair<InfoIterator, InfoIterator> GetInfosOfType() const {
+      constexpr auto index = TypeIndex<T, RoadInfoTypes>::value;
+      return {
+          _infos_by_type.begin() + _type_begin[index],
+          _infos_by_type.begin() + _type_begin[index + 1u]};
+    }
+
+    template <typename T, typename IT>
+    static std::vector<const T *> MakeInfoVector(IT begin, IT end) {
+      std::vector<const T *> vec;
+      vec.reserve(static_cast<size_t>(std::distance(begin, end)));
+      for (; begin != end; ++begin) {
+        vec.emplace_back(static_cast<const T *>(*begin));
+      }
+      return vec;
+    }
+
     RoadElementSet<std::unique_ptr<element::RoadInfo>> _road_set;
+
+    /// Infos grouped by type, the infos of type i are in
+    /// [_type_begin[i], _type_begin[i + 1]).
+    std::vector<const element::RoadInfo *> _infos_by_type;
+
+    std::array<uint32_t, NumberOfTypes + 1u> _type_begin{};
   };
 
 } // road
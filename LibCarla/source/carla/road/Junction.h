@@ -19,6 +19,7 @@ namespace carla {
 namespace road {
 
   class MapBuilder;
+  class MapSnapshot;
 
   class Junction : private MovableNonCopyable {
   public:
@@ -89,6 +90,7 @@ namespace road {
   private:
 
     friend MapBuilder;
+    friend MapSnapshot;
 
     JuncId _id;
 
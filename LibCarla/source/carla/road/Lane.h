@@ -20,6 +20,7 @@ namespace road {
 
   class LaneSection;
   class MapBuilder;
+  class MapSnapshot;
   class Road;
 
   class Lane : private MovableNonCopyable {
@@ -122,6 +123,7 @@ namespace road {
   private:
 
     friend MapBuilder;
+    friend MapSnapshot;
 
     LaneSection *_lane_section = nullptr;
 
@@ -6,6 +6,7 @@
 
 #include "carla/road/Map.h"
 #include "carla/Exception.h"
+#include "carla/ThreadPool.h"
 #include "carla/geom/Math.h"
 #include "carla/road/MeshFactory.h"
 #include "carla/road/element/LaneCrossingCalculator.h"
@@ -19,7 +20,9 @@
 
 #include <vector>
 #include <unordered_map>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
 
 namespace carla {
 namespace road {
@@ -149,6 +152,20 @@ namespace road {
     return section.ContainsLane(waypoint.lane_id);
   }
 
+  /// Pool shared by the batch queries of every map, started on first use so
+  /// the queries do not pay for creating threads.
+  static ThreadPool &GetQueryThreadPool() {
+    static ThreadPool thread_pool;
+    static std::once_flag started;
+    std::call_once(started, []() {
+      const size_t hardware_threads = std::thread::hardware_concurrency();
+      if (hardware_threads > 1u) {
+        thread_pool.AsyncRun(hardware_threads - 1u);
+      }
+    });
+    return thread_pool;
+  }
+
   // ===========================================================================
   // -- Map: Geometry ----------------------------------------------------------
   // ===========================================================================
@@ -156,12 +173,20 @@ namespace road {
   boost::optional<Waypoint> Map::GetClosestWaypointOnRoad(
       const geom::Location &pos,
       int32_t lane_type) const {
-    std::vector<Rtree::TreeElement> query_result =
-        _rtree.GetNearestNeighboursWithFilter(Rtree::BPoint(pos.x, pos.y, pos.z),
+    std::vector<Rtree::TreeElement> query_result;
+    return GetClosestWaypointOnRoad(pos, lane_type, query_result);
+  }
+
+  boost::optional<Waypoint> Map::GetClosestWaypointOnRoad(
+      const geom::Location &pos,
+      int32_t lane_type,
+      std::vector<Rtree::TreeElement> &query_result) const {
+    _rtree.GetNearestNeighboursWithFilter(Rtree::BPoint(pos.x, pos.y, pos.z),
         [&](Rtree::TreeElement const &element) {
           const Lane &lane = GetLane(element.second.first);
           return (lane_type & static_cast<int32_t>(lane.GetType())) > 0;
-        });
+        },
+        query_result);
 
     if (query_result.size() == 0) {
       return boost::optional<Waypoint>{};
@@ -203,7 +228,15 @@ namespace road {
   boost::optional<Waypoint> Map::GetWaypoint(
       const geom::Location &pos,
       int32_t lane_type) const {
-    boost::optional<Waypoint> w = GetClosestWaypointOnRoad(pos, lane_type);
+    std::vector<Rtree::TreeElement> query_result;
+    return GetWaypoint(pos, lane_type, query_result);
+  }
+
+  boost::optional<Waypoint> Map::GetWaypoint(
+      const geom::Location &pos,
+      int32_t lane_type,
+      std::vector<Rtree::TreeElement> &query_result) const {
+    boost::optional<Waypoint> w = GetClosestWaypointOnRoad(pos, lane_type, query_result);
 
     if (!w.has_value()) {
       return w;
@@ -221,6 +254,30 @@ namespace road {
     return boost::optional<Waypoint>{};
   }
 
+  std::vector<boost::optional<Waypoint>> Map::GetWaypoints(
+      const std::vector<geom::Location> &locations,
+      bool project_to_road,
+      int32_t lane_type) const {
+    // Number of queries answered by a thread at a time
+    constexpr size_t queries_per_chunk = 256u;
+
+    std::vector<boost::optional<Waypoint>> result(locations.size());
+    const size_t number_of_chunks =
+        (locations.size() + queries_per_chunk - 1u) / queries_per_chunk;
+
+    // A single chunk runs inline in this thread.
+    GetQueryThreadPool().ParallelFor(number_of_chunks, 1u, [&](size_t chunk) {
+      std::vector<Rtree::TreeElement> query_result;
+      const size_t end = std::min(locations.size(), (chunk + 1u) * queries_per_chunk);
+      for (size_t i = chunk * queries_per_chunk; i < end; ++i) {
+        result[i] = project_to_road ?
+            GetClosestWaypointOnRoad(locations[i], lane_type, query_result) :
+            GetWaypoint(locations[i], lane_type, query_result);
+      }
+    });
+    return result;
+  }
+
   boost::optional<Waypoint> Map::GetWaypoint(
       RoadId road_id,
       LaneId lane_id,
@@ -821,7 +878,7 @@ namespace road {
       geom::Transform &current_transform,
       geom::Transform &next_transform,
       Waypoint &current_waypoint,
-      Waypoint &next_waypoint) {
+      Waypoint &next_waypoint) const {
     Rtree::BPoint init =
         Rtree::BPoint(
         current_transform.location.x,
@@ -841,7 +898,7 @@ namespace road {
       std::vector<Rtree::TreeElement> &rtree_elements,
       geom::Transform &current_transform,
       Waypoint &current_waypoint,
-      Waypoint &next_waypoint) {
+      Waypoint &next_waypoint) const {
     geom::Transform next_transform = ComputeTransform(next_waypoint);
     AddElementToRtree(rtree_elements, current_transform, next_transform,
     current_waypoint, next_waypoint);
@@ -859,7 +916,9 @@ namespace road {
     }
   }
 
-  void Map::CreateRtree() {
+  void Map::AddLaneToRtree(
+      const Waypoint &lane_start_waypoint,
+      std::vector<Rtree::TreeElement> &rtree_elements) const {
     const double epsilon = 0.000001; // small delta in the road (set to 1
                                      // micrometer to prevent numeric errors)
     const double min_delta_s = 1;    // segments of minimum 1m through the road
@@ -869,104 +928,120 @@ namespace road {
     // maximum distance of a segment
     constexpr double max_segment_length = 100.0;
 
-    // Generate waypoints at start of every lane
-    std::vector<Waypoint> topology;
-    for (const auto &pair : _data.GetRoads()) {
-      const auto &road = pair.second;
-      ForEachLane(road, Lane::LaneType::Any, [&](auto &&waypoint) {
-        if(waypoint.lane_id != 0) {
-          topology.push_back(waypoint);
-        }
-      });
-    }
+    auto current_waypoint = lane_start_waypoint;
 
-    // Container of segments and waypoints
-    std::vector<Rtree::TreeElement> rtree_elements;
-    // Loop through all lanes
-    for (auto &waypoint : topology) {
-      auto &lane_start_waypoint = waypoint;
-
-      auto current_waypoint = lane_start_waypoint;
+    const Lane &lane = GetLane(current_waypoint);
 
-      const Lane &lane = GetLane(current_waypoint);
+    geom::Transform current_transform = ComputeTransform(current_waypoint);
 
-      geom::Transform current_transform = ComputeTransform(current_waypoint);
+    // Save computation time in straight lines
+    if (lane.IsStraight()) {
+      double delta_s = min_delta_s;
+      double remaining_length =
+          GetRemainingLength(lane, current_waypoint.s);
+      remaining_length -= epsilon;
+      delta_s = remaining_length;
+      if (delta_s < epsilon) {
+        return;
+      }
+      auto next = GetNext(current_waypoint, delta_s);
+
+      RELEASE_ASSERT(next.size() == 1);
+      RELEASE_ASSERT(next.front().road_id == current_waypoint.road_id);
+      auto next_waypoint = next.front();
+
+      AddElementToRtreeAndUpdateTransforms(
+          rtree_elements,
+          current_transform,
+          current_waypoint,
+          next_waypoint);
+      // end of lane
+    } else {
+      auto next_waypoint = current_waypoint;
 
-      // Save computation time in straight lines
-      if (lane.IsStraight()) {
+      // Loop until the end of the lane
+      // Advance in small s-increments
+      while (true) {
         double delta_s = min_delta_s;
         double remaining_length =
-            GetRemainingLength(lane, current_waypoint.s);
+            GetRemainingLength(lane, next_waypoint.s);
         remaining_length -= epsilon;
-        delta_s = remaining_length;
+        delta_s = std::min(delta_s, remaining_length);
+
         if (delta_s < epsilon) {
-          continue;
+          AddElementToRtreeAndUpdateTransforms(
+              rtree_elements,
+              current_transform,
+              current_waypoint,
+              next_waypoint);
+          break;
         }
-        auto next = GetNext(current_waypoint, delta_s);
-
-        RELEASE_ASSERT(next.size() == 1);
-        RELEASE_ASSERT(next.front().road_id == current_waypoint.road_id);
-        auto next_waypoint = next.front();
-
-        AddElementToRtreeAndUpdateTransforms(
-            rtree_elements,
-            current_transform,
-            current_waypoint,
-            next_waypoint);
-        // end of lane
-      } else {
-        auto next_waypoint = current_waypoint;
-
-        // Loop until the end of the lane
-        // Advance in small s-increments
-        while (true) {
-          double delta_s = min_delta_s;
-          double remaining_length =
-              GetRemainingLength(lane, next_waypoint.s);
-          remaining_length -= epsilon;
-          delta_s = std::min(delta_s, remaining_length);
-
-          if (delta_s < epsilon) {
-            AddElementToRtreeAndUpdateTransforms(
-                rtree_elements,
-                current_transform,
-                current_waypoint,
-                next_waypoint);
-            break;
-          }
 
-          auto next = GetNext(next_waypoint, delta_s);
-          if (next.size() != 1 ||
-          current_waypoint.section_id != next.front().section_id) {
-            AddElementToRtreeAndUpdateTransforms(
-                rtree_elements,
-                current_transform,
-                current_waypoint,
-                next_waypoint);
-            break;
-          }
+        auto next = GetNext(next_waypoint, delta_s);
+        if (next.size() != 1 ||
+        current_waypoint.section_id != next.front().section_id) {
+          AddElementToRtreeAndUpdateTransforms(
+              rtree_elements,
+              current_transform,
+              current_waypoint,
+              next_waypoint);
+          break;
+        }
 
-          next_waypoint = next.front();
-          geom::Transform next_transform = ComputeTransform(next_waypoint);
-          double angle = geom::Math::GetVectorAngle(
-              current_transform.GetForwardVector(), next_transform.GetForwardVector());
-
-          if (std::abs(angle) > angle_threshold ||
-              std::abs(current_waypoint.s - next_waypoint.s) > max_segment_length) {
-            AddElementToRtree(
-                rtree_elements,
-                current_transform,
-                next_transform,
-                current_waypoint,
-                next_waypoint);
-            current_waypoint = next_waypoint;
-            current_transform = next_transform;
-          }
+        next_waypoint = next.front();
+        geom::Transform next_transform = ComputeTransform(next_waypoint);
+        double angle = geom::Math::GetVectorAngle(
+            current_transform.GetForwardVector(), next_transform.GetForwardVector());
+
+        if (std::abs(angle) > angle_threshold ||
+            std::abs(current_waypoint.s - next_waypoint.s) > max_segment_length) {
+          AddElementToRtree(
+              rtree_elements,
+              current_transform,
+              next_transform,
+              current_waypoint,
+              next_waypoint);
+          current_waypoint = next_waypoint;
+          current_transform = next_transform;
         }
       }
     }
-    // Add segments to Rtree
-    _rtree.InsertElements(rtree_elements);
+  }
+
+  void Map::CreateRtree() {
+    // Number of lanes sampled by a thread at a time
+    constexpr size_t lanes_per_chunk = 16u;
+
+    // Generate waypoints at start of every lane
+    std::vector<Waypoint> topology;
+    for (const auto &pair : _data.GetRoads()) {
+      const auto &road = pair.second;
+      ForEachLane(road, Lane::LaneType::Any, [&](auto &&waypoint) {
+        if(waypoint.lane_id != 0) {
+          topology.push_back(waypoint);
+        }
+      });
+    }
+
+    // Sample the lanes in parallel. Each lane fills its own list of segments,
+    // so the tree does not depend on the number of threads.
+    std::vector<std::vector<Rtree::TreeElement>> lane_elements(topology.size());
+    ParallelFor(topology.size(), lanes_per_chunk, [&](size_t i) {
+      AddLaneToRtree(topology[i], lane_elements[i]);
+    });
+
+    // Container of segments and waypoints
+    std::vector<Rtree::TreeElement> rtree_elements;
+    size_t total_elements = 0u;
+    for (auto &elements : lane_elements) {
+      total_elements += elements.size();
+    }
+    rtree_elements.reserve(total_elements);
+    for (auto &elements : lane_elements) {
+      rtree_elements.insert(rtree_elements.end(), elements.begin(), elements.end());
+    }
+    // Build the Rtree with all the segments at once
+    _rtree.BuildTree(rtree_elements);
   }
 
   Junction* Map::GetJunction(JuncId id) {
@@ -977,29 +1052,50 @@ namespace road {
     return _data.GetJunction(id);
   }
 
+  /// Returns pointers to the meshes of @a meshes, in the same order.
+  static std::vector<const geom::Mesh *> GetMeshPointers(
+      const std::vector<std::unique_ptr<geom::Mesh>> &meshes) {
+    std::vector<const geom::Mesh *> result;
+    result.reserve(meshes.size());
+    for (auto &mesh : meshes) {
+      result.push_back(mesh.get());
+    }
+    return result;
+  }
+
   geom::Mesh Map::GenerateMesh(
       const double distance,
       const float extra_width,
       const  bool smooth_junctions) const {
     RELEASE_ASSERT(distance > 0.0);
     geom::MeshFactory mesh_factory;
-    geom::Mesh out_mesh;
 
     mesh_factory.road_param.resolution = static_cast<float>(distance);
     mesh_factory.road_param.extra_lane_width = extra_width;
 
-    // Generate roads outside junctions
+    // Roads outside junctions first, then junctions, in the same order as
+    // they are merged into the output mesh.
+    std::vector<const Road *> roads;
     for (auto &&pair : _data.GetRoads()) {
-      const auto &road = pair.second;
-      if (road.IsJunction()) {
-        continue;
+      if (!pair.second.IsJunction()) {
+        roads.push_back(&pair.second);
       }
-      out_mesh += *mesh_factory.Generate(road);
     }
-
-    // Generate roads within junctions and smooth them
+    std::vector<const Junction *> junctions;
     for (const auto &junc_pair : _data.GetJunctions()) {
-      const auto &junction = junc_pair.second;
+      junctions.push_back(&junc_pair.second);
+    }
+
+    // Generate every road and junction as an independent task. MeshFactory
+    // is stateless so it is shared between the threads.
+    std::vector<std::unique_ptr<geom::Mesh>> meshes(roads.size() + junctions.size());
+    ParallelFor(meshes.size(), 1u, [&](size_t i) {
+      if (i < roads.size()) {
+        meshes[i] = mesh_factory.Generate(*roads[i]);
+        return;
+      }
+      // Generate roads within junctions and smooth them
+      const auto &junction = *junctions[i - roads.size()];
       std::vector<std::unique_ptr<geom::Mesh>> lane_meshes;
       for(const auto &connection_pair : junction.GetConnections()) {
         const auto &connection = connection_pair.second;
@@ -1011,41 +1107,44 @@ namespace road {
         }
       }
       if(smooth_junctions) {
-        out_mesh += *mesh_factory.MergeAndSmooth(lane_meshes);
+        meshes[i] = mesh_factory.MergeAndSmooth(lane_meshes);
       } else {
-        geom::Mesh junction_mesh;
-        for(auto& lane : lane_meshes) {
-          junction_mesh += *lane;
-        }
-        out_mesh += junction_mesh;
+        meshes[i] = std::make_unique<geom::Mesh>();
+        meshes[i]->Merge(GetMeshPointers(lane_meshes));
       }
-    }
+    });
 
+    geom::Mesh out_mesh;
+    out_mesh.Merge(GetMeshPointers(meshes));
     return out_mesh;
   }
 
   std::vector<std::unique_ptr<geom::Mesh>> Map::GenerateChunkedMesh(
       const rpc::OpendriveGenerationParameters& params) const {
     geom::MeshFactory mesh_factory(params);
-    std::vector<std::unique_ptr<geom::Mesh>> out_mesh_list;
 
-    std::unordered_map<JuncId, geom::Mesh> junction_map;
+    std::vector<const Road *> roads;
     for (auto &&pair : _data.GetRoads()) {
-      const auto &road = pair.second;
-      if (!road.IsJunction()) {
-        std::vector<std::unique_ptr<geom::Mesh>> road_mesh_list =
-            mesh_factory.GenerateAllWithMaxLen(road);
-
-        out_mesh_list.insert(
-            out_mesh_list.end(),
-            std::make_move_iterator(road_mesh_list.begin()),
-            std::make_move_iterator(road_mesh_list.end()));
+      if (!pair.second.IsJunction()) {
+        roads.push_back(&pair.second);
       }
     }
-
-    // Generate roads within junctions and smooth them
+    std::vector<const Junction *> junctions;
     for (const auto &junc_pair : _data.GetJunctions()) {
-      const auto &junction = junc_pair.second;
+      junctions.push_back(&junc_pair.second);
+    }
+
+    // Generate every road and junction as an independent task, each one
+    // fills its own list of meshes.
+    std::vector<std::vector<std::unique_ptr<geom::Mesh>>> task_meshes(
+        roads.size() + junctions.size());
+    ParallelFor(task_meshes.size(), 1u, [&](size_t i) {
+      if (i < roads.size()) {
+        task_meshes[i] = mesh_factory.GenerateAllWithMaxLen(*roads[i]);
+        return;
+      }
+      // Generate roads within junctions and smooth them
+      const auto &junction = *junctions[i - roads.size()];
       std::vector<std::unique_ptr<geom::Mesh>> lane_meshes;
       std::vector<std::unique_ptr<geom::Mesh>> sidewalk_lane_meshes;
       for(const auto &connection_pair : junction.GetConnections()) {
@@ -1064,20 +1163,24 @@ namespace road {
       }
       if(params.smooth_junctions) {
         auto merged_mesh = mesh_factory.MergeAndSmooth(lane_meshes);
-        for(auto& lane : sidewalk_lane_meshes) {
-          *merged_mesh += *lane;
-        }
-        out_mesh_list.push_back(std::move(merged_mesh));
+        merged_mesh->Merge(GetMeshPointers(sidewalk_lane_meshes));
+        task_meshes[i].push_back(std::move(merged_mesh));
       } else {
         std::unique_ptr<geom::Mesh> junction_mesh = std::make_unique<geom::Mesh>();
-        for(auto& lane : lane_meshes) {
-          *junction_mesh += *lane;
-        }
-        for(auto& lane : sidewalk_lane_meshes) {
-          *junction_mesh += *lane;
-        }
-        out_mesh_list.push_back(std::move(junction_mesh));
+        auto junction_lanes = GetMeshPointers(lane_meshes);
+        auto sidewalk_lanes = GetMeshPointers(sidewalk_lane_meshes);
+        junction_lanes.insert(junction_lanes.end(), sidewalk_lanes.begin(), sidewalk_lanes.end());
+        junction_mesh->Merge(junction_lanes);
+        task_meshes[i].push_back(std::move(junction_mesh));
       }
+    });
+
+    std::vector<std::unique_ptr<geom::Mesh>> out_mesh_list;
+    for (auto &meshes : task_meshes) {
+      out_mesh_list.insert(
+          out_mesh_list.end(),
+          std::make_move_iterator(meshes.begin()),
+          std::make_move_iterator(meshes.end()));
     }
 
     auto min_pos = geom::Vector2D(
@@ -1093,17 +1196,18 @@ namespace road {
     }
     size_t mesh_amount_x = static_cast<size_t>((max_pos.x - min_pos.x)/params.max_road_length) + 1;
     size_t mesh_amount_y = static_cast<size_t>((max_pos.y - min_pos.y)/params.max_road_length) + 1;
-    std::vector<std::unique_ptr<geom::Mesh>> result;
-    result.reserve(mesh_amount_x*mesh_amount_y);
-    for (size_t i = 0; i < mesh_amount_x*mesh_amount_y; ++i) {
-      result.emplace_back(std::make_unique<geom::Mesh>());
-    }
+    std::vector<std::vector<const geom::Mesh *>> chunk_meshes(mesh_amount_x*mesh_amount_y);
     for (auto & mesh : out_mesh_list) {
       auto vertex = mesh->GetVertices().front();
       size_t x_pos = static_cast<size_t>((vertex.x - min_pos.x) / params.max_road_length);
       size_t y_pos = static_cast<size_t>((vertex.y - min_pos.y) / params.max_road_length);
-      *(result[x_pos + mesh_amount_x*y_pos]) += *mesh;
+      chunk_meshes[x_pos + mesh_amount_x*y_pos].push_back(mesh.get());
     }
+    std::vector<std::unique_ptr<geom::Mesh>> result(chunk_meshes.size());
+    ParallelFor(result.size(), 1u, [&](size_t i) {
+      result[i] = std::make_unique<geom::Mesh>();
+      result[i]->Merge(chunk_meshes[i]);
+    });
 
     return result;
   }
@@ -57,6 +57,15 @@ namespace road {
         const geom::Location &location,
         int32_t lane_type = static_cast<int32_t>(Lane::LaneType::Driving)) const;
 
+    /// Batch version of GetClosestWaypointOnRoad() (if @a project_to_road) or
+    /// GetWaypoint(). Large batches are split among the threads of a pool
+    /// shared by every map, small ones run in the calling thread. The result
+    /// has an entry for each location.
+    std::vector<boost::optional<element::Waypoint>> GetWaypoints(
+        const std::vector<geom::Location> &locations,
+        bool project_to_road = true,
+        int32_t lane_type = static_cast<int32_t>(Lane::LaneType::Driving)) const;
+
     boost::optional<element::Waypoint> GetWaypoint(
         RoadId road_id,
         LaneId lane_id,
@@ -181,26 +190,50 @@ namespace road {
 private:
 
     friend MapBuilder;
+    friend MapSnapshot;
     MapData _data;
 
     using Rtree = geom::SegmentCloudRtree<Waypoint>;
     Rtree _rtree;
 
+    /// Used by MapSnapshot, builds the tree from the segments of a previous
+    /// CreateRtree() instead of sampling the lanes again.
+    Map(MapData m, const std::vector<Rtree::TreeElement> &rtree_elements)
+      : _data(std::move(m)) {
+      _rtree.BuildTree(rtree_elements);
+    }
+
     void CreateRtree();
 
+    /// Query helpers reusing the memory of @a query_result between calls.
+    boost::optional<element::Waypoint> GetClosestWaypointOnRoad(
+        const geom::Location &location,
+        int32_t lane_type,
+        std::vector<Rtree::TreeElement> &query_result) const;
+
+    boost::optional<element::Waypoint> GetWaypoint(
+        const geom::Location &location,
+        int32_t lane_type,
+        std::vector<Rtree::TreeElement> &query_result) const;
+
+    /// Samples the lane starting at @a lane_start_waypoint into segments.
+    void AddLaneToRtree(
+        const Waypoint &lane_start_waypoint,
+        std::vector<Rtree::TreeElement> &rtree_elements) const;
+
     /// Helper Functions for constructing the rtree element list
     void AddElementToRtree(
         std::vector<Rtree::TreeElement> &rtree_elements,
         geom::Transform &current_transform,
         geom::Transform &next_transform,
         Waypoint &current_waypoint,
-        Waypoint &next_waypoint);
+        Waypoint &next_waypoint) const;
 
     void AddElementToRtreeAndUpdateTransforms(
         std::vector<Rtree::TreeElement> &rtree_elements,
         geom::Transform &current_transform,
         Waypoint &current_waypoint,
-        Waypoint &next_waypoint);
+        Waypoint &next_waypoint) const;
   };
 
 } // namespace road
@@ -8,6 +8,7 @@
 #include "carla/road/MapBuilder.h"
 #include "carla/road/element/RoadInfoElevation.h"
 #include "carla/road/element/RoadInfoGeometry.h"
+#include "carla/road/element/RoadInfoIterator.h"
 #include "carla/road/element/RoadInfoLaneAccess.h"
 #include "carla/road/element/RoadInfoLaneBorder.h"
 #include "carla/road/element/RoadInfoLaneHeight.h"
@@ -25,6 +26,7 @@
 #include "carla/road/InformationSet.h"
 #include "carla/road/Signal.h"
 #include "carla/road/SignalType.h"
+#include "carla/ThreadPool.h"
 
 #include <iterator>
 #include <memory>
@@ -35,20 +37,25 @@ using namespace carla::road::element;
 namespace carla {
 namespace road {
 
+  /// Calls @a functor(index) for every index in [0, size), in chunks of
+  /// @a chunk_size indices spread over a thread per core if @a parallel.
+  template <typename FuncT>
+  static void ForEachIndex(bool parallel, size_t size, size_t chunk_size, FuncT &&functor) {
+    if (parallel) {
+      ParallelFor(size, chunk_size, std::forward<FuncT>(functor));
+    } else {
+      for (size_t i = 0u; i < size; ++i) {
+        functor(i);
+      }
+    }
+  }
+
   boost::optional<Map> MapBuilder::Build() {
 
     CreatePointersBetweenRoadSegments();
     RemoveZeroLaneValiditySignalReferences();
 
-    for (auto &&info : _temp_road_info_container) {
-      DEBUG_ASSERT(info.first != nullptr);
-      info.first->_info = InformationSet(std::move(info.second));
-    }
-
-    for (auto &&info : _temp_lane_info_container) {
-      DEBUG_ASSERT(info.first != nullptr);
-      info.first->_info = InformationSet(std::move(info.second));
-    }
+    CreateInformationSets();
 
     // compute transform requires the roads to have the RoadInfo
     SolveSignalReferencesAndTransforms();
@@ -70,6 +77,27 @@ namespace road {
     return map;
   }
 
+  void MapBuilder::CreateInformationSets() {
+    // Sorting and indexing the infos of a road or lane touches nothing else.
+    std::vector<decltype(_temp_road_info_container)::value_type *> road_infos;
+    for (auto &&info : _temp_road_info_container) {
+      DEBUG_ASSERT(info.first != nullptr);
+      road_infos.emplace_back(&info);
+    }
+    ForEachIndex(_parallel, road_infos.size(), 16u, [&](size_t i) {
+      road_infos[i]->first->_info = InformationSet(std::move(road_infos[i]->second));
+    });
+
+    std::vector<decltype(_temp_lane_info_container)::value_type *> lane_infos;
+    for (auto &&info : _temp_lane_info_container) {
+      DEBUG_ASSERT(info.first != nullptr);
+      lane_infos.emplace_back(&info);
+    }
+    ForEachIndex(_parallel, lane_infos.size(), 64u, [&](size_t i) {
+      lane_infos[i]->first->_info = InformationSet(std::move(lane_infos[i]->second));
+    });
+  }
+
   // called from profiles parser
   void MapBuilder::AddRoadElevationProfile(
       Road *road,
@@ -732,38 +760,52 @@ namespace road {
 
   // assign pointers to the next lanes
   void MapBuilder::CreatePointersBetweenRoadSegments(void) {
-    // process each lane to define its nexts
+    struct LaneEntry {
+      RoadId road_id;
+      SectionId section_id;
+      LaneId lane_id;
+      Lane *lane;
+    };
+    std::vector<LaneEntry> lanes;
+    std::vector<Road *> roads;
     for (auto &road : _map_data._roads) {
+      roads.emplace_back(&road.second);
       for (auto &section : road.second._lane_sections) {
         for (auto &lane : section.second._lanes) {
-
-          // assign the next lane pointers
-          lane.second._next_lanes = GetLaneNext(road.first, section.second._id, lane.first);
-
-          // add to each lane found, this as its predecessor
-          for (auto next_lane : lane.second._next_lanes) {
-            // add as previous
-            DEBUG_ASSERT(next_lane != nullptr);
-            next_lane->_prev_lanes.push_back(&lane.second);
-          }
-
+          lanes.push_back({road.first, section.second._id, lane.first, &lane.second});
         }
       }
     }
 
-    // process each lane to define its nexts
-    for (auto &road : _map_data._roads) {
-      for (auto &section : road.second._lane_sections) {
+    // assign the next lane pointers, finding them only reads the map
+    ForEachIndex(_parallel, lanes.size(), 64u, [&](size_t i) {
+      auto &entry = lanes[i];
+      entry.lane->_next_lanes = GetLaneNext(entry.road_id, entry.section_id, entry.lane_id);
+    });
+
+    // add to each lane found, this as its predecessor
+    for (auto &entry : lanes) {
+      for (auto next_lane : entry.lane->_next_lanes) {
+        // add as previous
+        DEBUG_ASSERT(next_lane != nullptr);
+        next_lane->_prev_lanes.push_back(entry.lane);
+      }
+    }
+
+    // process each road to define its nexts and prevs
+    ForEachIndex(_parallel, roads.size(), 16u, [&](size_t i) {
+      auto &road = *roads[i];
+      for (auto &section : road._lane_sections) {
         for (auto &lane : section.second._lanes) {
 
           // add next roads
           for (auto next_lane : lane.second._next_lanes) {
             DEBUG_ASSERT(next_lane != nullptr);
             // avoid same road
-            if (next_lane->GetRoad() != &road.second) {
-              if (std::find(road.second._nexts.begin(), road.second._nexts.end(),
-                  next_lane->GetRoad()) == road.second._nexts.end()) {
-                road.second._nexts.push_back(next_lane->GetRoad());
+            if (next_lane->GetRoad() != &road) {
+              if (std::find(road._nexts.begin(), road._nexts.end(),
+                  next_lane->GetRoad()) == road._nexts.end()) {
+                road._nexts.push_back(next_lane->GetRoad());
               }
             }
           }
@@ -772,17 +814,17 @@ namespace road {
           for (auto prev_lane : lane.second._prev_lanes) {
             DEBUG_ASSERT(prev_lane != nullptr);
             // avoid same road
-            if (prev_lane->GetRoad() != &road.second) {
-              if (std::find(road.second._prevs.begin(), road.second._prevs.end(),
-                  prev_lane->GetRoad()) == road.second._prevs.end()) {
-                road.second._prevs.push_back(prev_lane->GetRoad());
+            if (prev_lane->GetRoad() != &road) {
+              if (std::find(road._prevs.begin(), road._prevs.end(),
+                  prev_lane->GetRoad()) == road._prevs.end()) {
+                road._prevs.push_back(prev_lane->GetRoad());
               }
             }
           }
 
         }
       }
-    }
+    });
   }
 
   geom::Transform MapBuilder::ComputeSignalTransform(std::unique_ptr<Signal> &signal, MapData &data) {
@@ -835,9 +877,20 @@ namespace road {
     }
   }
 
+  /// Pointers to the junctions of @a data, each one can be processed by a
+  /// different thread.
+  static std::vector<Junction *> GetJunctionPointers(MapData &data) {
+    std::vector<Junction *> junctions;
+    for (auto &junctionpair : data.GetJunctions()) {
+      junctions.emplace_back(&junctionpair.second);
+    }
+    return junctions;
+  }
+
   void MapBuilder::CreateJunctionBoundingBoxes(Map &map) {
-    for (auto &junctionpair : map._data.GetJunctions()) {
-      auto* junction = map.GetJunction(junctionpair.first);
+    const auto junctions = GetJunctionPointers(map._data);
+    ForEachIndex(_parallel, junctions.size(), 1u, [&](size_t junction_index) {
+      auto* junction = junctions[junction_index];
       auto waypoints = map.GetJunctionWaypoints(junction->GetId(), Lane::LaneType::Any);
       const int number_intervals = 10;
 
@@ -900,7 +953,7 @@ namespace road {
       carla::geom::Vector3D extent(0.5f * (maxx - minx), 0.5f * (maxy - miny), 0.5f * (maxz - minz));
 
       junction->_bounding_box = carla::geom::BoundingBox(location, extent);
-    }
+    });
   }
 
 void MapBuilder::CreateController(
@@ -932,10 +985,11 @@ void MapBuilder::CreateController(
 }
 
   void MapBuilder::ComputeJunctionRoadConflicts(Map &map) {
-    for (auto &junctionpair : map._data.GetJunctions()) {
-      auto& junction = junctionpair.second;
+    const auto junctions = GetJunctionPointers(map._data);
+    ForEachIndex(_parallel, junctions.size(), 1u, [&](size_t i) {
+      auto& junction = *junctions[i];
       junction._road_conflicts = (map.ComputeJunctionConflicts(junction.GetId()));
-    }
+    });
   }
 
   void MapBuilder::GenerateDefaultValiditiesForSignalReferences() {
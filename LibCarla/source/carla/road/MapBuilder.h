@@ -20,6 +20,17 @@ namespace road {
   class MapBuilder {
   public:
 
+    MapBuilder() = default;
+
+    /// If @a parallel is true, the parsers read the roads and Build processes
+    /// the roads and junctions using a thread per core. The map built is the
+    /// same as with a sequential builder.
+    explicit MapBuilder(bool parallel) : _parallel(parallel) {}
+
+    bool IsParallel() const {
+      return _parallel;
+    }
+
     boost::optional<Map> Build();
 
     // called from road parser
@@ -364,6 +375,12 @@ namespace road {
 
   private:
 
+    /// Create the InformationSet of every road and lane from the infos added
+    /// by the parsers.
+    void CreateInformationSets();
+
+    bool _parallel = false;
+
     MapData _map_data;
 
     /// Create the pointers between RoadSegments based on the ids.
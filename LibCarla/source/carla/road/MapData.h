@@ -86,6 +86,7 @@ namespace road {
   private:
 
     friend class MapBuilder;
+    friend class MapSnapshot;
 
     MapData() = default;
 
@@ -0,0 +1,1087 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/MapSnapshot.h"
+
+#include "carla/Debug.h"
+#include "carla/Logging.h"
+#include "carla/Version.h"
+#include "carla/road/element/RoadInfoCrosswalk.h"
+#include "carla/road/element/RoadInfoElevation.h"
+#include "carla/road/element/RoadInfoGeometry.h"
+#include "carla/road/element/RoadInfoLaneAccess.h"
+#include "carla/road/element/RoadInfoLaneBorder.h"
+#include "carla/road/element/RoadInfoLaneHeight.h"
+#include "carla/road/element/RoadInfoLaneMaterial.h"
+#include "carla/road/element/RoadInfoLaneOffset.h"
+#include "carla/road/element/RoadInfoLaneRule.h"
+#include "carla/road/element/RoadInfoLaneVisibility.h"
+#include "carla/road/element/RoadInfoLaneWidth.h"
+#include "carla/road/element/RoadInfoMarkRecord.h"
+#include "carla/road/element/RoadInfoMarkTypeLine.h"
+#include "carla/road/element/RoadInfoSignal.h"
+#include "carla/road/element/RoadInfoSpeed.h"
+#include "carla/road/element/RoadInfoVisitor.h"
+
+#ifdef _WIN32
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <type_traits>
+
+using namespace carla::road::element;
+
+namespace carla {
+namespace road {
+
+  constexpr uint32_t MapSnapshot::FormatVersion;
+
+  /// "CMAP", written at the start and at the end of the snapshot. Read with
+  /// the other byte order it does not match either.
+  static constexpr uint32_t SnapshotMagic = 0x434d4150u;
+
+  enum class RoadInfoType : uint8_t {
+    Crosswalk,
+    Elevation,
+    Geometry,
+    LaneAccess,
+    LaneBorder,
+    LaneHeight,
+    LaneMaterial,
+    LaneOffset,
+    LaneRule,
+    LaneVisibility,
+    LaneWidth,
+    MarkRecord,
+    MarkTypeLine,
+    Speed,
+    Signal
+  };
+
+  // ===========================================================================
+  // -- MapSnapshot::Writer ----------------------------------------------------
+  // ===========================================================================
+
+  class MapSnapshot::Writer : private RoadInfoVisitor {
+  public:
+
+    using RtreeElement = Map::Rtree::TreeElement;
+
+    std::vector<unsigned char> Release() {
+      return std::move(_data);
+    }
+
+    void WriteMap(const Map &map, uint64_t content_hash) {
+      Write(SnapshotMagic);
+      Write(FormatVersion);
+      Write(std::string(carla::version()));
+      Write(content_hash);
+
+      const MapData &data = map._data;
+      Write(data._geo_reference);
+      WriteSize(data._signals.size());
+      for (auto &pair : data._signals) {
+        // MapBuilder leaves an empty entry for references to unknown signals.
+        Write(pair.first);
+        Write(pair.second != nullptr);
+        if (pair.second != nullptr) {
+          WriteSignal(*pair.second);
+        }
+      }
+      WriteSize(data._controllers.size());
+      for (auto &pair : data._controllers) {
+        WriteController(*pair.second);
+      }
+      WriteSize(data._junctions.size());
+      for (auto &pair : data._junctions) {
+        WriteJunction(pair.second);
+      }
+      WriteSize(data._roads.size());
+      for (auto &pair : data._roads) {
+        WriteRoad(pair.second);
+      }
+
+      const auto elements = map._rtree.GetElements();
+      WriteSize(elements.size());
+      for (auto &element : elements) {
+        WritePoint(element.first.first);
+        WritePoint(element.first.second);
+        WriteWaypoint(element.second.first);
+        WriteWaypoint(element.second.second);
+      }
+      Write(SnapshotMagic);
+    }
+
+  private:
+
+    template <typename T>
+    void Write(const T &value) {
+      static_assert(std::is_trivially_copyable<T>::value, "Type cannot be copied as bytes");
+      const auto *bytes = reinterpret_cast<const unsigned char *>(&value);
+      _data.insert(_data.end(), bytes, bytes + sizeof(T));
+    }
+
+    void Write(const std::string &str) {
+      WriteSize(str.size());
+      _data.insert(_data.end(), str.begin(), str.end());
+    }
+
+    void WriteSize(size_t size) {
+      Write(static_cast<uint64_t>(size));
+    }
+
+    template <typename RangeT>
+    void WriteRange(const RangeT &range) {
+      WriteSize(range.size());
+      for (auto &&item : range) {
+        Write(item);
+      }
+    }
+
+    void WritePoint(const RtreeElement::first_type::first_type &point) {
+      Write(point.get<0>());
+      Write(point.get<1>());
+      Write(point.get<2>());
+    }
+
+    // Member by member, Waypoint has padding.
+    void WriteWaypoint(const Waypoint &waypoint) {
+      Write(waypoint.road_id);
+      Write(waypoint.section_id);
+      Write(waypoint.lane_id);
+      Write(waypoint.s);
+    }
+
+    void WriteLaneReference(const Lane *lane) {
+      DEBUG_ASSERT(lane != nullptr);
+      Write(lane->GetRoad()->GetId());
+      Write(lane->GetLaneSection()->GetId());
+      Write(lane->GetId());
+    }
+
+    void WriteSignal(const Signal &signal) {
+      Write(signal._road_id);
+      Write(signal._signal_id);
+      Write(signal._s);
+      Write(signal._t);
+      Write(signal._name);
+      Write(signal._dynamic);
+      Write(signal._orientation);
+      Write(signal._zOffset);
+      Write(signal._country);
+      Write(signal._type);
+      Write(signal._subtype);
+      Write(signal._value);
+      Write(signal._unit);
+      Write(signal._height);
+      Write(signal._width);
+      Write(signal._text);
+      Write(signal._hOffset);
+      Write(signal._pitch);
+      Write(signal._roll);
+      WriteSize(signal._dependencies.size());
+      for (auto &dependency : signal._dependencies) {
+        Write(dependency._dependency_id);
+        Write(dependency._type);
+      }
+      Write(signal._transform);
+      WriteRange(signal._controllers);
+      Write(signal._using_inertial_position);
+    }
+
+    void WriteController(const Controller &controller) {
+      Write(controller._id);
+      Write(controller._name);
+      Write(controller._sequence);
+      WriteRange(controller._junctions);
+      WriteRange(controller._signals);
+    }
+
+    void WriteJunction(const Junction &junction) {
+      Write(junction._id);
+      Write(junction._name);
+      WriteSize(junction._connections.size());
+      for (auto &pair : junction._connections) {
+        const auto &connection = pair.second;
+        Write(connection.id);
+        Write(connection.incoming_road);
+        Write(connection.connecting_road);
+        WriteRange(connection.lane_links);
+      }
+      WriteRange(junction._controllers);
+      WriteSize(junction._road_conflicts.size());
+      for (auto &pair : junction._road_conflicts) {
+        Write(pair.first);
+        WriteRange(pair.second);
+      }
+      Write(junction._bounding_box);
+    }
+
+    void WriteRoad(const Road &road) {
+      Write(road._id);
+      Write(road._name);
+      Write(road._length);
+      Write(road._is_junction);
+      Write(road._junction_id);
+      Write(road._successor);
+      Write(road._predecessor);
+      WriteSize(road._nexts.size());
+      for (auto *next : road._nexts) {
+        Write(next->GetId());
+      }
+      WriteSize(road._prevs.size());
+      for (auto *prev : road._prevs) {
+        Write(prev->GetId());
+      }
+      WriteInformationSet(road._info);
+      WriteSize(static_cast<size_t>(
+          std::distance(road._lane_sections.begin(), road._lane_sections.end())));
+      for (auto &pair : road._lane_sections) {
+        const auto &section = pair.second;
+        Write(section._id);
+        Write(section._s);
+        Write(section._lane_offset);
+        WriteSize(section._lanes.size());
+        for (auto &lane_pair : section._lanes) {
+          WriteLane(lane_pair.second);
+        }
+      }
+    }
+
+    void WriteLane(const Lane &lane) {
+      Write(lane._id);
+      Write(lane._type);
+      Write(lane._level);
+      Write(lane._successor);
+      Write(lane._predecessor);
+      WriteInformationSet(lane._info);
+      WriteSize(lane._next_lanes.size());
+      for (auto *next : lane._next_lanes) {
+        WriteLaneReference(next);
+      }
+      WriteSize(lane._prev_lanes.size());
+      for (auto *prev : lane._prev_lanes) {
+        WriteLaneReference(prev);
+      }
+    }
+
+    void WriteInformationSet(const InformationSet &info) {
+      const auto &infos = info._road_set.GetAll();
+      WriteSize(infos.size());
+      for (auto &item : infos) {
+        const auto size_before = _data.size();
+        item->AcceptVisitor(*this);
+        DEBUG_ASSERT(_data.size() > size_before);
+        (void)size_before;
+      }
+    }
+
+    template <typename InfoT>
+    void WriteHeader(RoadInfoType type, const InfoT &info) {
+      Write(type);
+      Write(info.GetDistance());
+    }
+
+    void WriteMarkTypeLine(const RoadInfoMarkTypeLine &line) {
+      Write(line.GetRoadMarkId());
+      Write(line.GetLength());
+      Write(line.GetSpace());
+      Write(line.GetTOffset());
+      Write(line.GetRule());
+      Write(line.GetWidth());
+    }
+
+    void Visit(RoadInfoCrosswalk &info) final {
+      WriteHeader(RoadInfoType::Crosswalk, info);
+      Write(info.GetName());
+      Write(info.GetT());
+      Write(info.GetZOffset());
+      Write(info.GetHeading());
+      Write(info.GetPitch());
+      Write(info.GetRoll());
+      Write(info.GetOrientation());
+      Write(info.GetWidth());
+      Write(info.GetLength());
+      WriteRange(info.GetPoints());
+    }
+
+    void Visit(RoadInfoElevation &info) final {
+      WriteHeader(RoadInfoType::Elevation, info);
+      Write(info.GetPolynomial());
+    }
+
+    void Visit(RoadInfoGeometry &info) final {
+      WriteHeader(RoadInfoType::Geometry, info);
+      const auto &geometry = info.GetGeometry();
+      Write(geometry.GetType());
+      Write(geometry.GetStartOffset());
+      Write(geometry.GetLength());
+      Write(geometry.GetHeading());
+      Write(geometry.GetStartPosition());
+      switch (geometry.GetType()) {
+        case GeometryType::LINE:
+          break;
+        case GeometryType::ARC: {
+          const auto &arc = static_cast<const GeometryArc &>(geometry);
+          Write(arc.GetCurvature());
+          break;
+        }
+        case GeometryType::SPIRAL: {
+          const auto &spiral = static_cast<const GeometrySpiral &>(geometry);
+          Write(spiral.GetCurveStart());
+          Write(spiral.GetCurveEnd());
+          break;
+        }
+        case GeometryType::POLY3: {
+          const auto &poly3 = static_cast<const GeometryPoly3 &>(geometry);
+          Write(poly3.Geta());
+          Write(poly3.Getb());
+          Write(poly3.Getc());
+          Write(poly3.Getd());
+          break;
+        }
+        case GeometryType::POLY3PARAM: {
+          const auto &poly3 = static_cast<const GeometryParamPoly3 &>(geometry);
+          Write(poly3.GetaU());
+          Write(poly3.GetbU());
+          Write(poly3.GetcU());
+          Write(poly3.GetdU());
+          Write(poly3.GetaV());
+          Write(poly3.GetbV());
+          Write(poly3.GetcV());
+          Write(poly3.GetdV());
+          Write(poly3.IsArcLength());
+          break;
+        }
+      }
+    }
+
+    void Visit(RoadInfoLaneAccess &info) final {
+      WriteHeader(RoadInfoType::LaneAccess, info);
+      Write(info.GetRestriction());
+    }
+
+    void Visit(RoadInfoLaneBorder &info) final {
+      WriteHeader(RoadInfoType::LaneBorder, info);
+      Write(info.GetPolynomial());
+    }
+
+    void Visit(RoadInfoLaneHeight &info) final {
+      WriteHeader(RoadInfoType::LaneHeight, info);
+      Write(info.GetInner());
+      Write(info.GetOuter());
+    }
+
+    void Visit(RoadInfoLaneMaterial &info) final {
+      WriteHeader(RoadInfoType::LaneMaterial, info);
+      Write(info.GetSurface());
+      Write(info.GetFriction());
+      Write(info.GetRoughness());
+    }
+
+    void Visit(RoadInfoLaneOffset &info) final {
+      WriteHeader(RoadInfoType::LaneOffset, info);
+      Write(info.GetPolynomial());
+    }
+
+    void Visit(RoadInfoLaneRule &info) final {
+      WriteHeader(RoadInfoType::LaneRule, info);
+      Write(info.GetValue());
+    }
+
+    void Visit(RoadInfoLaneVisibility &info) final {
+      WriteHeader(RoadInfoType::LaneVisibility, info);
+      Write(info.GetForward());
+      Write(info.GetBack());
+      Write(info.GetLeft());
+      Write(info.GetRight());
+    }
+
+    void Visit(RoadInfoLaneWidth &info) final {
+      WriteHeader(RoadInfoType::LaneWidth, info);
+      Write(info.GetPolynomial());
+    }
+
+    void Visit(RoadInfoMarkRecord &info) final {
+      WriteHeader(RoadInfoType::MarkRecord, info);
+      Write(info.GetRoadMarkId());
+      Write(info.GetType());
+      Write(info.GetWeight());
+      Write(info.GetColor());
+      Write(info.GetMaterial());
+      Write(info.GetWidth());
+      Write(info.GetLaneChange());
+      Write(info.GetHeight());
+      Write(info.GetTypeName());
+      Write(info.GetTypeWidth());
+      WriteSize(info.GetLines().size());
+      for (auto &line : info.GetLines()) {
+        Write(line->GetDistance());
+        WriteMarkTypeLine(*line);
+      }
+    }
+
+    void Visit(RoadInfoMarkTypeLine &info) final {
+      WriteHeader(RoadInfoType::MarkTypeLine, info);
+      WriteMarkTypeLine(info);
+    }
+
+    void Visit(RoadInfoSpeed &info) final {
+      WriteHeader(RoadInfoType::Speed, info);
+      Write(info.GetSpeed());
+    }
+
+    void Visit(RoadInfoSignal &info) final {
+      WriteHeader(RoadInfoType::Signal, info);
+      Write(info._signal_id);
+      Write(info._road_id);
+      Write(info._t);
+      Write(info._orientation);
+      WriteRange(info._validities);
+    }
+
+    std::vector<unsigned char> _data;
+  };
+
+  // ===========================================================================
+  // -- MapSnapshot::Reader ----------------------------------------------------
+  // ===========================================================================
+
+  /// Reads a snapshot written by Writer, in the same order. Reading past the
+  /// end or finding an unknown value marks the reader as failed, after that
+  /// every read returns a default value and every size zero.
+  class MapSnapshot::Reader {
+  public:
+
+    using RtreeElement = Map::Rtree::TreeElement;
+
+    Reader(const unsigned char *data, size_t size)
+      : _position(data),
+        _end(data + size) {}
+
+    boost::optional<Map> ReadMap(const uint64_t content_hash) {
+      if ((Read<uint32_t>() != SnapshotMagic) ||
+          (Read<uint32_t>() != FormatVersion) ||
+          (Read<std::string>() != carla::version()) ||
+          (Read<uint64_t>() != content_hash)) {
+        return boost::none;
+      }
+
+      MapData data;
+      Read(data._geo_reference);
+      for (auto n = ReadSize(); n > 0u; --n) {
+        auto id = Read<SignId>();
+        data._signals.emplace(std::move(id), Read<bool>() ? ReadSignal() : nullptr);
+      }
+      for (auto n = ReadSize(); n > 0u; --n) {
+        auto controller = ReadController();
+        const auto id = controller->GetControllerId();
+        data._controllers.emplace(id, std::move(controller));
+      }
+      for (auto n = ReadSize(); n > 0u; --n) {
+        ReadJunction(data);
+      }
+      for (auto n = ReadSize(); n > 0u; --n) {
+        ReadRoad(data);
+      }
+      ResolveReferences(data);
+
+      std::vector<RtreeElement> elements;
+      const auto number_of_elements = ReadSize();
+      elements.reserve(number_of_elements);
+      for (auto n = number_of_elements; n > 0u; --n) {
+        const auto start = ReadPoint();
+        const auto end = ReadPoint();
+        const auto start_waypoint = ReadWaypoint();
+        const auto end_waypoint = ReadWaypoint();
+        elements.emplace_back(
+            RtreeElement::first_type(start, end),
+            std::make_pair(start_waypoint, end_waypoint));
+      }
+
+      if ((Read<uint32_t>() != SnapshotMagic) || _failed || (_position != _end)) {
+        return boost::none;
+      }
+      return Map(std::move(data), elements);
+    }
+
+  private:
+
+    struct LaneReference {
+      RoadId road_id;
+      SectionId section_id;
+      LaneId lane_id;
+    };
+
+    struct PendingRoad {
+      Road *road;
+      std::vector<RoadId> nexts;
+      std::vector<RoadId> prevs;
+    };
+
+    struct PendingLane {
+      Lane *lane;
+      std::vector<LaneReference> nexts;
+      std::vector<LaneReference> prevs;
+    };
+
+    void Fail() {
+      _failed = true;
+      _position = _end;
+    }
+
+    bool Consume(size_t size, const unsigned char *&data) {
+      if (size > static_cast<size_t>(_end - _position)) {
+        Fail();
+        return false;
+      }
+      data = _position;
+      _position += size;
+      return true;
+    }
+
+    template <typename T>
+    void Read(T &value) {
+      static_assert(std::is_trivially_copyable<T>::value, "Type cannot be copied as bytes");
+      const unsigned char *data;
+      if (Consume(sizeof(T), data)) {
+        std::memcpy(&value, data, sizeof(T));
+      }
+    }
+
+    void Read(std::string &str) {
+      const auto size = ReadSize();
+      const unsigned char *data;
+      if (Consume(size, data)) {
+        str.assign(reinterpret_cast<const char *>(data), size);
+      }
+    }
+
+    template <typename T>
+    T Read() {
+      T value{};
+      Read(value);
+      return value;
+    }
+
+    /// Sizes larger than the bytes left cannot be right, as every element
+    /// takes at least one byte.
+    size_t ReadSize() {
+      const auto size = Read<uint64_t>();
+      if (size > static_cast<uint64_t>(_end - _position)) {
+        Fail();
+        return 0u;
+      }
+      return static_cast<size_t>(size);
+    }
+
+    template <typename SetT>
+    void ReadSet(SetT &set) {
+      for (auto n = ReadSize(); n > 0u; --n) {
+        set.insert(Read<typename SetT::value_type>());
+      }
+    }
+
+    RtreeElement::first_type::first_type ReadPoint() {
+      const auto x = Read<float>();
+      const auto y = Read<float>();
+      const auto z = Read<float>();
+      return {x, y, z};
+    }
+
+    Waypoint ReadWaypoint() {
+      Waypoint waypoint;
+      Read(waypoint.road_id);
+      Read(waypoint.section_id);
+      Read(waypoint.lane_id);
+      Read(waypoint.s);
+      return waypoint;
+    }
+
+    LaneReference ReadLaneReference() {
+      LaneReference reference;
+      Read(reference.road_id);
+      Read(reference.section_id);
+      Read(reference.lane_id);
+      return reference;
+    }
+
+    std::unique_ptr<Signal> ReadSignal() {
+      const auto road_id = Read<RoadId>();
+      const auto signal_id = Read<SignId>();
+      const auto s = Read<double>();
+      const auto t = Read<double>();
+      const auto name = Read<std::string>();
+      const auto dynamic = Read<std::string>();
+      const auto orientation = Read<std::string>();
+      const auto zOffset = Read<double>();
+      const auto country = Read<std::string>();
+      const auto type = Read<std::string>();
+      const auto subtype = Read<std::string>();
+      const auto value = Read<double>();
+      const auto unit = Read<std::string>();
+      const auto height = Read<double>();
+      const auto width = Read<double>();
+      const auto text = Read<std::string>();
+      const auto hOffset = Read<double>();
+      const auto pitch = Read<double>();
+      const auto roll = Read<double>();
+      auto signal = std::make_unique<Signal>(
+          road_id, signal_id, s, t, name, dynamic, orientation, zOffset, country,
+          type, subtype, value, unit, height, width, text, hOffset, pitch, roll);
+      for (auto n = ReadSize(); n > 0u; --n) {
+        auto dependency_id = Read<std::string>();
+        auto dependency_type = Read<std::string>();
+        signal->_dependencies.emplace_back(std::move(dependency_id), std::move(dependency_type));
+      }
+      Read(signal->_transform);
+      ReadSet(signal->_controllers);
+      Read(signal->_using_inertial_position);
+      return signal;
+    }
+
+    std::unique_ptr<Controller> ReadController() {
+      const auto id = Read<ContId>();
+      const auto name = Read<std::string>();
+      const auto sequence = Read<uint32_t>();
+      auto controller = std::make_unique<Controller>(id, name, sequence);
+      ReadSet(controller->_junctions);
+      ReadSet(controller->_signals);
+      return controller;
+    }
+
+    void ReadJunction(MapData &data) {
+      const auto id = Read<JuncId>();
+      const auto name = Read<std::string>();
+      auto &junction = data._junctions.emplace(id, Junction(id, name)).first->second;
+      for (auto n = ReadSize(); n > 0u; --n) {
+        const auto connection_id = Read<ConId>();
+        const auto incoming_road = Read<RoadId>();
+        const auto connecting_road = Read<RoadId>();
+        auto &connection = junction._connections.emplace(
+            connection_id,
+            Junction::Connection(connection_id, incoming_road, connecting_road)).first->second;
+        for (auto m = ReadSize(); m > 0u; --m) {
+          connection.lane_links.push_back(Read<Junction::LaneLink>());
+        }
+      }
+      ReadSet(junction._controllers);
+      for (auto n = ReadSize(); n > 0u; --n) {
+        const auto road_id = Read<RoadId>();
+        ReadSet(junction._road_conflicts[road_id]);
+      }
+      Read(junction._bounding_box);
+    }
+
+    void ReadRoad(MapData &data) {
+      const auto id = Read<RoadId>();
+      Road &road = data._roads[id];
+      road._map_data = &data;
+      road._id = id;
+      Read(road._name);
+      Read(road._length);
+      Read(road._is_junction);
+      Read(road._junction_id);
+      Read(road._successor);
+      Read(road._predecessor);
+      PendingRoad pending{&road, {}, {}};
+      for (auto n = ReadSize(); n > 0u; --n) {
+        pending.nexts.push_back(Read<RoadId>());
+      }
+      for (auto n = ReadSize(); n > 0u; --n) {
+        pending.prevs.push_back(Read<RoadId>());
+      }
+      _pending_roads.emplace_back(std::move(pending));
+      road._info = ReadInformationSet(data);
+      for (auto n = ReadSize(); n > 0u; --n) {
+        const auto section_id = Read<SectionId>();
+        const auto s = Read<double>();
+        LaneSection &section = road._lane_sections.Emplace(section_id, s);
+        section._road = &road;
+        Read(section._lane_offset);
+        for (auto m = ReadSize(); m > 0u; --m) {
+          ReadLane(data, section);
+        }
+      }
+    }
+
+    void ReadLane(MapData &data, LaneSection &section) {
+      const auto id = Read<LaneId>();
+      Lane &lane = section._lanes[id];
+      lane._lane_section = &section;
+      lane._id = id;
+      Read(lane._type);
+      Read(lane._level);
+      Read(lane._successor);
+      Read(lane._predecessor);
+      lane._info = ReadInformationSet(data);
+      PendingLane pending{&lane, {}, {}};
+      for (auto n = ReadSize(); n > 0u; --n) {
+        pending.nexts.push_back(ReadLaneReference());
+      }
+      for (auto n = ReadSize(); n > 0u; --n) {
+        pending.prevs.push_back(ReadLaneReference());
+      }
+      _pending_lanes.emplace_back(std::move(pending));
+    }
+
+    Road *FindRoad(MapData &data, RoadId id) {
+      auto it = data._roads.find(id);
+      if (it == data._roads.end()) {
+        Fail();
+        return nullptr;
+      }
+      return &it->second;
+    }
+
+    Lane *FindLane(MapData &data, const LaneReference &reference) {
+      Road *road = FindRoad(data, reference.road_id);
+      if (road != nullptr) {
+        for (auto &pair : road->_lane_sections) {
+          if (pair.second._id == reference.section_id) {
+            auto it = pair.second._lanes.find(reference.lane_id);
+            if (it != pair.second._lanes.end()) {
+              return &it->second;
+            }
+          }
+        }
+      }
+      Fail();
+      return nullptr;
+    }
+
+    /// Turn the ids of the neighbouring roads and lanes into pointers, once
+    /// every road is read.
+    void ResolveReferences(MapData &data) {
+      for (auto &pending : _pending_roads) {
+        for (auto id : pending.nexts) {
+          pending.road->_nexts.push_back(FindRoad(data, id));
+        }
+        for (auto id : pending.prevs) {
+          pending.road->_prevs.push_back(FindRoad(data, id));
+        }
+      }
+      for (auto &pending : _pending_lanes) {
+        for (auto &reference : pending.nexts) {
+          pending.lane->_next_lanes.push_back(FindLane(data, reference));
+        }
+        for (auto &reference : pending.prevs) {
+          pending.lane->_prev_lanes.push_back(FindLane(data, reference));
+        }
+      }
+    }
+
+    InformationSet ReadInformationSet(MapData &data) {
+      std::vector<std::unique_ptr<RoadInfo>> infos;
+      for (auto n = ReadSize(); n > 0u; --n) {
+        auto info = ReadRoadInfo(data);
+        if (info == nullptr) {
+          Fail();
+          break;
+        }
+        infos.emplace_back(std::move(info));
+      }
+      return InformationSet(std::move(infos));
+    }
+
+    std::unique_ptr<RoadInfoMarkTypeLine> ReadMarkTypeLine(double s) {
+      const auto road_mark_id = Read<int>();
+      const auto length = Read<double>();
+      const auto space = Read<double>();
+      const auto t_offset = Read<double>();
+      const auto rule = Read<std::string>();
+      const auto width = Read<double>();
+      return std::make_unique<RoadInfoMarkTypeLine>(
+          s, road_mark_id, length, space, t_offset, rule, width);
+    }
+
+    std::unique_ptr<RoadInfo> ReadGeometry(double s) {
+      const auto type = Read<GeometryType>();
+      const auto start_offset = Read<double>();
+      const auto length = Read<double>();
+      const auto heading = Read<double>();
+      const auto start_position = Read<geom::Location>();
+      std::unique_ptr<Geometry> geometry;
+      switch (type) {
+        case GeometryType::LINE:
+          geometry = std::make_unique<GeometryLine>(start_offset, length, heading, start_position);
+          break;
+        case GeometryType::ARC: {
+          const auto curvature = Read<double>();
+          geometry = std::make_unique<GeometryArc>(
+              start_offset, length, heading, start_position, curvature);
+          break;
+        }
+        case GeometryType::SPIRAL: {
+          const auto curve_start = Read<double>();
+          const auto curve_end = Read<double>();
+          geometry = std::make_unique<GeometrySpiral>(
+              start_offset, length, heading, start_position, curve_start, curve_end);
+          break;
+        }
+        case GeometryType::POLY3: {
+          double v[4u];
+          for (auto &x : v) {
+            Read(x);
+          }
+          geometry = std::make_unique<GeometryPoly3>(
+              start_offset, length, heading, start_position, v[0u], v[1u], v[2u], v[3u]);
+          break;
+        }
+        case GeometryType::POLY3PARAM: {
+          double v[8u];
+          for (auto &x : v) {
+            Read(x);
+          }
+          const auto arc_length = Read<bool>();
+          geometry = std::make_unique<GeometryParamPoly3>(
+              start_offset, length, heading, start_position,
+              v[0u], v[1u], v[2u], v[3u], v[4u], v[5u], v[6u], v[7u], arc_length);
+          break;
+        }
+        default:
+          return nullptr;
+      }
+      return std::make_unique<RoadInfoGeometry>(s, std::move(geometry));
+    }
+
+    std::unique_ptr<RoadInfo> ReadRoadInfo(MapData &data) {
+      const auto type = Read<RoadInfoType>();
+      const auto s = Read<double>();
+      if (_failed) {
+        return nullptr;
+      }
+      switch (type) {
+        case RoadInfoType::Crosswalk: {
+          const auto name = Read<std::string>();
+          const auto t = Read<double>();
+          const auto z_offset = Read<double>();
+          const auto heading = Read<double>();
+          const auto pitch = Read<double>();
+          const auto roll = Read<double>();
+          const auto orientation = Read<std::string>();
+          const auto width = Read<double>();
+          const auto length = Read<double>();
+          std::vector<CrosswalkPoint> points;
+          for (auto n = ReadSize(); n > 0u; --n) {
+            const auto u = Read<double>();
+            const auto v = Read<double>();
+            const auto z = Read<double>();
+            points.emplace_back(u, v, z);
+          }
+          return std::make_unique<RoadInfoCrosswalk>(
+              s, name, t, z_offset, heading, pitch, roll, orientation, width, length, points);
+        }
+        case RoadInfoType::Elevation:
+          return std::make_unique<RoadInfoElevation>(s, Read<geom::CubicPolynomial>());
+        case RoadInfoType::Geometry:
+          return ReadGeometry(s);
+        case RoadInfoType::LaneAccess:
+          return std::make_unique<RoadInfoLaneAccess>(s, Read<std::string>());
+        case RoadInfoType::LaneBorder:
+          return std::make_unique<RoadInfoLaneBorder>(s, Read<geom::CubicPolynomial>());
+        case RoadInfoType::LaneHeight: {
+          const auto inner = Read<double>();
+          const auto outer = Read<double>();
+          return std::make_unique<RoadInfoLaneHeight>(s, inner, outer);
+        }
+        case RoadInfoType::LaneMaterial: {
+          const auto surface = Read<std::string>();
+          const auto friction = Read<double>();
+          const auto roughness = Read<double>();
+          return std::make_unique<RoadInfoLaneMaterial>(s, surface, friction, roughness);
+        }
+        case RoadInfoType::LaneOffset:
+          return std::make_unique<RoadInfoLaneOffset>(s, Read<geom::CubicPolynomial>());
+        case RoadInfoType::LaneRule:
+          return std::make_unique<RoadInfoLaneRule>(s, Read<std::string>());
+        case RoadInfoType::LaneVisibility: {
+          const auto forward = Read<double>();
+          const auto back = Read<double>();
+          const auto left = Read<double>();
+          const auto right = Read<double>();
+          return std::make_unique<RoadInfoLaneVisibility>(s, forward, back, left, right);
+        }
+        case RoadInfoType::LaneWidth:
+          return std::make_unique<RoadInfoLaneWidth>(s, Read<geom::CubicPolynomial>());
+        case RoadInfoType::MarkRecord: {
+          const auto road_mark_id = Read<int>();
+          const auto mark_type = Read<std::string>();
+          const auto weight = Read<std::string>();
+          const auto color = Read<std::string>();
+          const auto material = Read<std::string>();
+          const auto width = Read<double>();
+          const auto lane_change = Read<RoadInfoMarkRecord::LaneChange>();
+          const auto height = Read<double>();
+          const auto type_name = Read<std::string>();
+          const auto type_width = Read<double>();
+          auto record = std::make_unique<RoadInfoMarkRecord>(
+              s, road_mark_id, mark_type, weight, color, material, width,
+              lane_change, height, type_name, type_width);
+          for (auto n = ReadSize(); n > 0u; --n) {
+            const auto line_s = Read<double>();
+            record->GetLines().emplace_back(ReadMarkTypeLine(line_s));
+          }
+          return record;
+        }
+        case RoadInfoType::MarkTypeLine:
+          return ReadMarkTypeLine(s);
+        case RoadInfoType::Speed:
+          return std::make_unique<RoadInfoSpeed>(s, Read<double>());
+        case RoadInfoType::Signal: {
+          const auto signal_id = Read<SignId>();
+          const auto road_id = Read<RoadId>();
+          const auto t = Read<double>();
+          const auto orientation = Read<std::string>();
+          auto it = data._signals.find(signal_id);
+          auto reference = std::make_unique<RoadInfoSignal>(
+              signal_id,
+              it != data._signals.end() ? it->second.get() : nullptr,
+              road_id,
+              s,
+              t,
+              orientation);
+          for (auto n = ReadSize(); n > 0u; --n) {
+            const auto from_lane = Read<LaneId>();
+            const auto to_lane = Read<LaneId>();
+            reference->_validities.emplace_back(from_lane, to_lane);
+          }
+          return reference;
+        }
+        default:
+          return nullptr;
+      }
+    }
+
+    const unsigned char *_position;
+
+    const unsigned char *const _end;
+
+    bool _failed = false;
+
+    std::vector<PendingRoad> _pending_roads;
+
+    std::vector<PendingLane> _pending_lanes;
+  };
+
+  // ===========================================================================
+  // -- MapSnapshot ------------------------------------------------------------
+  // ===========================================================================
+
+  uint64_t MapSnapshot::ComputeContentHash(const std::string &opendrive_contents) {
+    // 64-bit FNV-1a, stable across platforms and runs unlike std::hash.
+    uint64_t hash = 14695981039346656037ull;
+    for (const char c : opendrive_contents) {
+      hash ^= static_cast<unsigned char>(c);
+      hash *= 1099511628211ull;
+    }
+    return hash;
+  }
+
+  std::vector<unsigned char> MapSnapshot::Serialize(const Map &map, const uint64_t content_hash) {
+    Writer writer;
+    writer.WriteMap(map, content_hash);
+    return writer.Release();
+  }
+
+  boost::optional<Map> MapSnapshot::Deserialize(
+      const unsigned char *data,
+      const size_t size,
+      const uint64_t content_hash) {
+    DEBUG_ASSERT(data != nullptr);
+    return Reader(data, size).ReadMap(content_hash);
+  }
+
+  bool MapSnapshot::Save(const std::string &path, const Map &map, const uint64_t content_hash) {
+    const auto data = Serialize(map, content_hash);
+    // Other processes may be saving the same snapshot.
+    const auto temporary_path = path + "." + std::to_string(std::random_device{}()) + ".tmp";
+    std::ofstream out(temporary_path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+    out.close();
+    if (out.fail() || (std::rename(temporary_path.c_str(), path.c_str()) != 0)) {
+      log_debug("map snapshot: failed to write", path);
+      std::remove(temporary_path.c_str());
+      return false;
+    }
+    return true;
+  }
+
+#ifdef _WIN32
+
+  boost::optional<Map> MapSnapshot::Load(const std::string &path, const uint64_t content_hash) {
+    HANDLE file = CreateFileA(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_DELETE,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+      return boost::none;
+    }
+    boost::optional<Map> result;
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(file, &size) && (size.QuadPart > 0)) {
+      HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0u, 0u, nullptr);
+      if (mapping != nullptr) {
+        const void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0u, 0u, 0u);
+        if (data != nullptr) {
+          result = Deserialize(
+              static_cast<const unsigned char *>(data),
+              static_cast<size_t>(size.QuadPart),
+              content_hash);
+          UnmapViewOfFile(data);
+        }
+        CloseHandle(mapping);
+      }
+    }
+    CloseHandle(file);
+    return result;
+  }
+
+#else
+
+  boost::optional<Map> MapSnapshot::Load(const std::string &path, const uint64_t content_hash) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      return boost::none;
+    }
+    boost::optional<Map> result;
+    struct stat info;
+    if ((::fstat(fd, &info) == 0) && (info.st_size > 0)) {
+      const auto size = static_cast<size_t>(info.st_size);
+      void *data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED) {
+        result = Deserialize(static_cast<const unsigned char *>(data), size, content_hash);
+        ::munmap(data, size);
+      }
+    }
+    ::close(fd);
+    return result;
+  }
+
+#endif // _WIN32
+
+} // namespace road
+} // namespace carla
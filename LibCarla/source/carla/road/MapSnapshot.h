@@ -0,0 +1,65 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/road/Map.h"
+
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace road {
+
+  /// Binary snapshot of a built Map, loading it skips parsing the OpenDRIVE
+  /// file and everything MapBuilder computes afterwards.
+  ///
+  /// The snapshot holds the roads, lane sections, lanes, road infos,
+  /// junctions, signals and controllers as MapBuilder left them, with the
+  /// references between them stored as ids, and the segments of the R-tree,
+  /// which are bulk-loaded again instead of sampling every lane.
+  ///
+  /// A snapshot is tied to the OpenDRIVE contents it was made from, through
+  /// ComputeContentHash, and to the version of LibCarla and the byte order of
+  /// the machine that made it; loading it anywhere else fails.
+  class MapSnapshot {
+  public:
+
+    /// Increase every time the layout of the snapshot changes.
+    static constexpr uint32_t FormatVersion = 1u;
+
+    /// Hash identifying the OpenDRIVE contents a map is built from.
+    static uint64_t ComputeContentHash(const std::string &opendrive_contents);
+
+    static std::vector<unsigned char> Serialize(const Map &map, uint64_t content_hash);
+
+    /// Return boost::none if @a data is not a snapshot of the contents of
+    /// @a content_hash made by this version of LibCarla, or is corrupted.
+    static boost::optional<Map> Deserialize(
+        const unsigned char *data,
+        size_t size,
+        uint64_t content_hash);
+
+    /// Write a snapshot of @a map to @a path. The snapshot is written to a
+    /// temporary file first and renamed, so readers never see half a file.
+    static bool Save(const std::string &path, const Map &map, uint64_t content_hash);
+
+    /// Memory-map the file at @a path and load the snapshot it contains, see
+    /// Deserialize.
+    static boost::optional<Map> Load(const std::string &path, uint64_t content_hash);
+
+  private:
+
+    class Writer;
+
+    class Reader;
+  };
+
+} // namespace road
+} // namespace carla
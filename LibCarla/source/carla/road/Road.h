@@ -28,6 +28,7 @@ namespace road {
   class MapData;
   class Elevation;
   class MapBuilder;
+  class MapSnapshot;
 
   class Road : private MovableNonCopyable {
   public:
@@ -181,6 +182,7 @@ namespace road {
   private:
 
     friend MapBuilder;
+    friend MapSnapshot;
 
     MapData *_map_data { nullptr };
 
@@ -106,12 +106,62 @@ namespace element {
     return {location.x - _start_position.x, location.y - _start_position.y};
   }
 
+  /// Index of the segment of @a samples, sorted by arc length, to interpolate
+  /// @a dist in: the last one that starts at or before @a dist, but never
+  /// past the last segment so that distances out of the curve extrapolate
+  /// from its ends. The search starts at @a hint when @a dist is not behind
+  /// it.
+  template <typename SampleT>
+  static size_t FindSegment(const std::vector<SampleT> &samples, double dist, size_t hint = 0u) {
+    DEBUG_ASSERT(samples.size() >= 2u);
+    const size_t last = samples.size() - 2u;
+    if ((hint > last) || (dist < samples[hint].s)) {
+      hint = 0u;
+    }
+    // Distances of a sorted batch mostly land in the same or the next segment.
+    if ((hint < last) && (samples[hint + 1u].s <= dist)) {
+      ++hint;
+      if ((hint < last) && (samples[hint + 1u].s <= dist)) {
+        const auto it = std::upper_bound(
+            samples.begin() + static_cast<std::ptrdiff_t>(hint + 1u),
+            samples.end(),
+            dist,
+            [](double value, const SampleT &sample) { return value < sample.s; });
+        hint = std::min(static_cast<size_t>(it - samples.begin()) - 1u, last);
+      }
+    }
+    return hint;
+  }
+
+  std::vector<DirectedPoint> Geometry::PosFromDistances(
+      const std::vector<double> &distances) const {
+    std::vector<DirectedPoint> result;
+    result.reserve(distances.size());
+    for (auto dist : distances) {
+      result.emplace_back(PosFromDist(dist));
+    }
+    return result;
+  }
+
   DirectedPoint GeometryPoly3::PosFromDist(double dist) const {
-    auto result = _rtree.GetNearestNeighbours(
-        Rtree::BPoint(static_cast<float>(dist))).front();
+    return PosFromSegment(FindSegment(_samples, dist), dist);
+  }
 
-    auto &val1 = result.second.first;
-    auto &val2 = result.second.second;
+  std::vector<DirectedPoint> GeometryPoly3::PosFromDistances(
+      const std::vector<double> &distances) const {
+    std::vector<DirectedPoint> result;
+    result.reserve(distances.size());
+    size_t segment = 0u;
+    for (auto dist : distances) {
+      segment = FindSegment(_samples, dist, segment);
+      result.emplace_back(PosFromSegment(segment, dist));
+    }
+    return result;
+  }
+
+  DirectedPoint GeometryPoly3::PosFromSegment(size_t segment, double dist) const {
+    auto &val1 = _samples[segment];
+    auto &val2 = _samples[segment + 1u];
 
     double rate = (val2.s - dist) / (val2.s - val1.s);
     double u = rate * val1.u + (1.0 - rate) * val2.u;
@@ -137,38 +187,42 @@ namespace element {
     const double delta_u = interval_size; // interval between values of u
     double current_s = 0;
     double current_u = 0;
-    double last_u = 0;
-    double last_v = _poly.Evaluate(current_u);
-    double last_s = 0;
-    RtreeValue last_val{last_u, last_v, last_s, _poly.Tangent(current_u)};
+    _samples.clear();
+    _samples.reserve(static_cast<size_t>(_length / delta_u) + 3u);
+    _samples.push_back({current_u, _poly.Evaluate(current_u), current_s, _poly.Tangent(current_u)});
     while (current_s < _length + delta_u) {
+      const auto &last_val = _samples.back();
       current_u += delta_u;
       double current_v = _poly.Evaluate(current_u);
-      double du = current_u - last_u;
-      double dv = current_v - last_v;
+      double du = current_u - last_val.u;
+      double dv = current_v - last_val.v;
       double ds = sqrt(du * du + dv * dv);
       current_s += ds;
       double current_t = _poly.Tangent(current_u);
-      RtreeValue current_val{current_u, current_v, current_s, current_t};
-
-      Rtree::BPoint p1(static_cast<float>(last_s));
-      Rtree::BPoint p2(static_cast<float>(current_s));
-      _rtree.InsertElement(Rtree::BSegment(p1, p2), last_val, current_val);
+      _samples.push_back({current_u, current_v, current_s, current_t});
+    }
+  }
 
-      last_u = current_u;
-      last_v = current_v;
-      last_s = current_s;
-      last_val = current_val;
+  DirectedPoint GeometryParamPoly3::PosFromDist(double dist) const {
+    return PosFromSegment(FindSegment(_samples, dist), dist);
+  }
 
+  std::vector<DirectedPoint> GeometryParamPoly3::PosFromDistances(
+      const std::vector<double> &distances) const {
+    std::vector<DirectedPoint> result;
+    result.reserve(distances.size());
+    size_t segment = 0u;
+    for (auto dist : distances) {
+      segment = FindSegment(_samples, dist, segment);
+      result.emplace_back(PosFromSegment(segment, dist));
     }
+    return result;
   }
 
-  DirectedPoint GeometryParamPoly3::PosFromDist(double dist) const {
-    auto result = _rtree.GetNearestNeighbours(
-        Rtree::BPoint(static_cast<float>(dist))).front();
+  DirectedPoint GeometryParamPoly3::PosFromSegment(size_t segment, double dist) const {
+    auto &val1 = _samples[segment];
+    auto &val2 = _samples[segment + 1u];
 
-    auto &val1 = result.second.first;
-    auto &val2 = result.second.second;
     double rate = (val2.s - dist) / (val2.s - val1.s);
     double u = rate * val1.u + (1.0 - rate) * val2.u;
     double v = rate * val1.v + (1.0 - rate) * val2.v;
@@ -182,6 +236,7 @@ namespace element {
     p.location.y += pos.y;
     return p;
   }
+
   std::pair<float, float> GeometryParamPoly3::DistanceTo(const geom::Location &) const {
     // No analytical expression (Newton-Raphson?/point search)
     // throw_exception(std::runtime_error("not implemented"));
@@ -199,40 +254,29 @@ namespace element {
     }
     double param_p = 0;
     double current_s = 0;
-    double last_u = _polyU.Evaluate(param_p);
-    double last_v = _polyV.Evaluate(param_p);
-    double last_s = 0;
-    RtreeValue last_val{
-        last_u,
-        last_v,
-        last_s,
+    _samples.clear();
+    _samples.reserve(number_intervals + 1u);
+    _samples.push_back({
+        _polyU.Evaluate(param_p),
+        _polyV.Evaluate(param_p),
+        current_s,
         _polyU.Tangent(param_p),
-        _polyV.Tangent(param_p) };
+        _polyV.Tangent(param_p) });
     for(size_t i = 0; i < number_intervals; ++i) {
+      const auto &last_val = _samples.back();
       param_p += delta_p;
       double current_u = _polyU.Evaluate(param_p);
       double current_v = _polyV.Evaluate(param_p);
-      double du = current_u - last_u;
-      double dv = current_v - last_v;
+      double du = current_u - last_val.u;
+      double dv = current_v - last_val.v;
       double ds = sqrt(du * du + dv * dv);
       current_s += ds;
-      double current_t_u = _polyU.Tangent(param_p);
-      double current_t_v = _polyV.Tangent(param_p);
-      RtreeValue current_val{
+      _samples.push_back({
           current_u,
           current_v,
           current_s,
-          current_t_u,
-          current_t_v };
-
-      Rtree::BPoint p1(static_cast<float>(last_s));
-      Rtree::BPoint p2(static_cast<float>(current_s));
-      _rtree.InsertElement(Rtree::BSegment(p1, p2), last_val, current_val);
-
-      last_u = current_u;
-      last_v = current_v;
-      last_s = current_s;
-      last_val = current_val;
+          _polyU.Tangent(param_p),
+          _polyV.Tangent(param_p) });
 
       if(current_s > _length){
         break;
@@ -9,7 +9,8 @@
 #include "carla/geom/Location.h"
 #include "carla/geom/Math.h"
 #include "carla/geom/CubicPolynomial.h"
-#include "carla/geom/Rtree.h"
+
+#include <vector>
 
 namespace carla {
 namespace road {
@@ -62,7 +63,7 @@ namespace element {
       return _heading;
     }
 
-    const geom::Location &GetStartPosition() {
+    const geom::Location &GetStartPosition() const {
       return _start_position;
     }
 
@@ -70,6 +71,11 @@ namespace element {
 
     virtual DirectedPoint PosFromDist(double dist) const = 0;
 
+    /// Same as calling PosFromDist for each of @a distances. Geometries that
+    /// look up a table are faster when @a distances are sorted.
+    virtual std::vector<DirectedPoint> PosFromDistances(
+        const std::vector<double> &distances) const;
+
     virtual std::pair<float, float> DistanceTo(const geom::Location &p) const = 0;
 
   protected:
@@ -175,11 +181,11 @@ namespace element {
         _curve_start(curv_s),
         _curve_end(curv_e) {}
 
-    double GetCurveStart() {
+    double GetCurveStart() const {
       return _curve_start;
     }
 
-    double GetCurveEnd() {
+    double GetCurveEnd() const {
       return _curve_end;
     }
 
@@ -229,6 +235,9 @@ namespace element {
 
     DirectedPoint PosFromDist(double dist) const override;
 
+    std::vector<DirectedPoint> PosFromDistances(
+        const std::vector<double> &distances) const override;
+
     std::pair<float, float> DistanceTo(const geom::Location &) const override;
 
   private:
@@ -240,16 +249,23 @@ namespace element {
     double _c;
     double _d;
 
-    struct RtreeValue {
+    /// Point of the curve sampled at a given arc length @a s, @a t is the
+    /// slope dv/du.
+    struct SplineSample {
       double u = 0;
       double v = 0;
       double s = 0;
       double t = 0;
     };
-    using Rtree = geom::SegmentCloudRtree<RtreeValue, 1>;
-    using TreeElement = Rtree::TreeElement;
-    Rtree _rtree;
+
+    /// Samples sorted by arc length, consecutive samples are joined by
+    /// straight segments.
+    std::vector<SplineSample> _samples;
+
     void PreComputeSpline();
+
+    /// Interpolate @a dist in the segment starting at _samples[segment].
+    DirectedPoint PosFromSegment(size_t segment, double dist) const;
   };
 
   class GeometryParamPoly3 final : public Geometry {
@@ -308,9 +324,15 @@ namespace element {
     double GetdV() const {
       return _dV;
     }
+    bool IsArcLength() const {
+      return _arcLength;
+    }
 
     DirectedPoint PosFromDist(double dist) const override;
 
+    std::vector<DirectedPoint> PosFromDistances(
+        const std::vector<double> &distances) const override;
+
     std::pair<float, float> DistanceTo(const geom::Location &) const override;
 
   private:
@@ -327,17 +349,24 @@ namespace element {
     double _dV;
     bool _arcLength;
 
-    struct RtreeValue {
+    /// Point of the curve sampled at a given arc length @a s, with the
+    /// derivatives of u and v at that point.
+    struct SplineSample {
       double u = 0;
       double v = 0;
       double s = 0;
       double t_u = 0;
       double t_v = 0;
     };
-    using Rtree = geom::SegmentCloudRtree<RtreeValue, 1>;
-    using TreeElement = Rtree::TreeElement;
-    Rtree _rtree;
+
+    /// Samples sorted by arc length, consecutive samples are joined by
+    /// straight segments.
+    std::vector<SplineSample> _samples;
+
     void PreComputeSpline();
+
+    /// Interpolate @a dist in the segment starting at _samples[segment].
+    DirectedPoint PosFromSegment(size_t segment, double dist) const;
   };
 
 } // namespace element
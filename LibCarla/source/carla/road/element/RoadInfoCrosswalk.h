@@ -50,6 +50,7 @@ namespace element {
       v.Visit(*this);
     }
 
+    const std::string &GetName() const { return _name; };
     double GetS() const { return GetDistance(); };
     double GetT() const { return _t; };
     double GetWidth() const { return _width; };
@@ -88,6 +88,7 @@ namespace element {
 
   private:
     friend MapBuilder;
+    friend MapSnapshot;
 
     SignId _signal_id;
 
@@ -45,9 +45,11 @@ namespace rpc {
 
     float actor_active_distance = 2000.f; // 2km
 
+    bool delta_episode_state = false;
+
     MSGPACK_DEFINE_ARRAY(synchronous_mode, no_rendering_mode, fixed_delta_seconds, substepping,
         max_substep_delta_time, max_substeps, max_culling_distance, deterministic_ragdolls,
-        tile_stream_distance, actor_active_distance);
+        tile_stream_distance, actor_active_distance, delta_episode_state);
 
     // =========================================================================
     // -- Constructors ---------------------------------------------------------
@@ -65,7 +67,8 @@ namespace rpc {
         float max_culling_distance = 0.0f,
         bool deterministic_ragdolls = true,
         float tile_stream_distance = 3000.f,
-        float actor_active_distance = 2000.f)
+        float actor_active_distance = 2000.f,
+        bool delta_episode_state = false)
       : synchronous_mode(synchronous_mode),
         no_rendering_mode(no_rendering_mode),
         fixed_delta_seconds(
@@ -76,7 +79,8 @@ namespace rpc {
         max_culling_distance(max_culling_distance),
         deterministic_ragdolls(deterministic_ragdolls),
         tile_stream_distance(tile_stream_distance),
-        actor_active_distance(actor_active_distance) {}
+        actor_active_distance(actor_active_distance),
+        delta_episode_state(delta_episode_state) {}
 
     // =========================================================================
     // -- Comparison operators -------------------------------------------------
@@ -93,7 +97,8 @@ namespace rpc {
           (max_culling_distance == rhs.max_culling_distance) &&
           (deterministic_ragdolls == rhs.deterministic_ragdolls) &&
           (tile_stream_distance == tile_stream_distance) &&
-          (actor_active_distance == actor_active_distance);
+          (actor_active_distance == actor_active_distance) &&
+          (delta_episode_state == rhs.delta_episode_state);
     }
 
     bool operator!=(const EpisodeSettings &rhs) const {
@@ -117,7 +122,8 @@ namespace rpc {
             Settings.MaxCullingDistance,
             Settings.bDeterministicRagdolls,
             Settings.TileStreamingDistance,
-            Settings.ActorActiveDistance) {
+            Settings.ActorActiveDistance,
+            Settings.bDeltaEpisodeState) {
       constexpr float CMTOM = 1.f/100.f;
       tile_stream_distance = CMTOM * Settings.TileStreamingDistance;
       actor_active_distance = CMTOM * Settings.ActorActiveDistance;
@@ -138,6 +144,7 @@ namespace rpc {
       Settings.bDeterministicRagdolls = deterministic_ragdolls;
       Settings.TileStreamingDistance = MTOCM * tile_stream_distance;
       Settings.ActorActiveDistance = MTOCM * actor_active_distance;
+      Settings.bDeltaEpisodeState = delta_episode_state;
 
       return Settings;
     }
@@ -9,6 +9,7 @@
 #include "carla/rpc/Location.h"
 #include "carla/sensor/data/SemanticLidarData.h"
 
+#include <array>
 #include <cstdint>
 #include <vector>
 
@@ -80,21 +81,19 @@ namespace data {
     ~LidarData() = default;
 
     virtual void ResetMemory(std::vector<uint32_t> points_per_channel) {
-      DEBUG_ASSERT(GetChannelCount() > points_per_channel.size());
+      DEBUG_ASSERT(GetChannelCount() == points_per_channel.size());
       std::memset(_header.data() + Index::SIZE, 0, sizeof(uint32_t) * GetChannelCount());
 
       uint32_t total_points = static_cast<uint32_t>(
           std::accumulate(points_per_channel.begin(), points_per_channel.end(), 0));
 
-      _points.clear();
-      _points.reserve(total_points * 4);
+      ResetPoints(total_points * 4u * sizeof(float));
     }
 
     void WritePointSync(LidarDetection &detection) {
-      _points.emplace_back(detection.point.x);
-      _points.emplace_back(detection.point.y);
-      _points.emplace_back(detection.point.z);
-      _points.emplace_back(detection.intensity);
+      const std::array<float, 4u> point = {
+          detection.point.x, detection.point.y, detection.point.z, detection.intensity};
+      WritePoint(point);
     }
 
     virtual void WritePointSync(SemanticLidarDetection &detection) {
@@ -103,8 +102,6 @@ namespace data {
     }
 
   private:
-    std::vector<float> _points;
-
     friend class s11n::LidarSerializer;
     friend class s11n::LidarHeaderView;
   };
@@ -6,7 +6,11 @@
 
 #pragma once
 
+#include "carla/Buffer.h"
+
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <vector>
 #include <cstdio>
 
@@ -42,31 +46,56 @@ namespace data {
     ///
     /// @warning This is expensive, not to be called each tick!
     void SetResolution(uint32_t resolution) {
-      // Remove the capacity of the vector to zero
-      _detections.clear();
-      _detections.shrink_to_fit();
-      // Set the new vector's capacity
-      _detections.reserve(resolution);
+      // Release the current memory and allocate room for a full measurement.
+      _buffer.clear();
+      _resolution = resolution;
+      Reset();
+    }
+
+    /// Use @a buffer as storage for the next measurement, the detections are
+    /// written in place so serializing the measurement only hands the buffer
+    /// over to the stream. Usually @a buffer is popped from the stream's
+    /// BufferPool.
+    void AcquireBuffer(Buffer &&buffer) {
+      _buffer = std::move(buffer);
     }
 
     /// Returns the number of current detections.
     size_t GetDetectionCount() const {
-      return _detections.size();
+      return _detection_count;
     }
 
     /// Deletes the current detections.
     /// It doesn't change the resolution nor the allocated memory.
     void Reset() {
-      _detections.clear();
+      _buffer.reset(static_cast<uint64_t>(_resolution * detection_size));
+      _detection_count = 0u;
     }
 
     /// Adds a new detection.
     void WriteDetection(RadarDetection detection) {
-      _detections.push_back(detection);
+      const size_t offset = _detection_count * detection_size;
+      if (_buffer.size() < offset + detection_size) {
+        _buffer.resize(std::max<uint64_t>(2u * _buffer.size(), offset + detection_size));
+      }
+      std::memcpy(_buffer.data() + offset, &detection, detection_size);
+      ++_detection_count;
     }
 
   private:
-    std::vector<RadarDetection> _detections;
+
+    /// Hand over the buffer holding the serialized detections.
+    Buffer PopBuffer() {
+      _buffer.resize(static_cast<uint64_t>(_detection_count * detection_size));
+      _detection_count = 0u;
+      return std::move(_buffer);
+    }
+
+    Buffer _buffer;
+
+    size_t _resolution = 0u;
+
+    size_t _detection_count = 0u;
 
   friend class s11n::RadarSerializer;
   };
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "carla/Debug.h"
+#include "carla/ListView.h"
 #include "carla/sensor/data/ActorDynamicState.h"
 #include "carla/sensor/data/Array.h"
 #include "carla/sensor/s11n/EpisodeStateSerializer.h"
@@ -25,7 +26,9 @@ namespace data {
     friend Serializer;
 
     explicit RawEpisodeState(RawData &&data)
-      : Super(Serializer::header_offset, std::move(data)) {}
+      : Super(std::move(data), [](const RawData &message) {
+          return Serializer::GetActorsOffset(message);
+        }) {}
 
   private:
 
@@ -66,6 +69,28 @@ namespace data {
       return GetHeader().simulation_state;
     }
 
+    /// Whether this message only contains the actors that changed since
+    /// GetBaseFrame().
+    bool IsDelta() const {
+      return Serializer::IsDelta(Super::GetRawData());
+    }
+
+    /// Frame the delta was computed from.
+    ///
+    /// @pre IsDelta().
+    uint64_t GetBaseFrame() const {
+      return Serializer::DeserializeDeltaHeader(Super::GetRawData()).base_frame;
+    }
+
+    /// Ids of the actors removed since GetBaseFrame(), empty if this is not a
+    /// delta.
+    auto GetRemovedActorIds() const {
+      const auto &data = Super::GetRawData();
+      const ActorId *begin = IsDelta() ? Serializer::DeserializeRemovedActorIds(data) : nullptr;
+      const size_t count = IsDelta() ? Serializer::DeserializeDeltaHeader(data).removed_count : 0u;
+      return MakeListView(begin, begin + count);
+    }
+
   };
 
 } // namespace data
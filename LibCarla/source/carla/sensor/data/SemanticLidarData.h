@@ -6,9 +6,12 @@
 
 #pragma once
 
+#include "carla/Buffer.h"
 #include "carla/rpc/Location.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <vector>
 #include <numeric>
 
@@ -46,6 +49,11 @@ namespace data {
   ///      Xn, Yn, Zn, Cos(THn), idx_n, tag_n
   ///    }
   ///
+  /// The detections are written in place into a Buffer right after the space
+  /// reserved for the header, so the measurement is already serialized when
+  /// it is sent. Use AcquireBuffer to provide a buffer from the stream's
+  /// BufferPool before calling ResetMemory.
+  ///
 
   #pragma pack(push, 1)
   class SemanticLidarDetection {
@@ -110,15 +118,21 @@ namespace data {
       return _header[Index::ChannelCount];
     }
 
+    /// Use @a buffer as storage for the next measurement. Buffers popped from
+    /// a BufferPool keep their capacity, so after the first few frames
+    /// ResetMemory does not allocate.
+    void AcquireBuffer(Buffer &&buffer) {
+      _buffer = std::move(buffer);
+    }
+
     virtual void ResetMemory(std::vector<uint32_t> points_per_channel) {
-      DEBUG_ASSERT(GetChannelCount() > points_per_channel.size());
+      DEBUG_ASSERT(GetChannelCount() == points_per_channel.size());
       std::memset(_header.data() + Index::SIZE, 0, sizeof(uint32_t) * GetChannelCount());
 
       uint32_t total_points = static_cast<uint32_t>(
           std::accumulate(points_per_channel.begin(), points_per_channel.end(), 0));
 
-      _ser_points.clear();
-      _ser_points.reserve(total_points);
+      ResetPoints(total_points * sizeof(SemanticLidarDetection));
     }
 
     virtual void WriteChannelCount(std::vector<uint32_t> points_per_channel) {
@@ -127,15 +141,55 @@ namespace data {
     }
 
     virtual void WritePointSync(SemanticLidarDetection &detection) {
-      _ser_points.emplace_back(detection);
+      WritePoint(detection);
     }
 
   protected:
+
+    size_t GetHeaderSize() const {
+      return sizeof(uint32_t) * _header.size();
+    }
+
+    /// Discard the points written and reserve @a size bytes for the new ones.
+    void ResetPoints(size_t size) {
+      _buffer.reset(static_cast<uint64_t>(GetHeaderSize() + size));
+      _points_size = 0u;
+    }
+
+    template <typename T>
+    void WritePoint(const T &point) {
+      const size_t offset = GetHeaderSize() + _points_size;
+      if (_buffer.size() < offset + sizeof(T)) {
+        _buffer.resize(std::max<uint64_t>(2u * _buffer.size(), offset + sizeof(T)));
+      }
+      std::memcpy(_buffer.data() + offset, &point, sizeof(T));
+      _points_size += sizeof(T);
+    }
+
+    /// Copy the header in front of the points and hand over the buffer, which
+    /// then holds the serialized measurement.
+    Buffer PopBuffer() {
+      _buffer.resize(static_cast<uint64_t>(GetHeaderSize() + _points_size));
+      std::memcpy(_buffer.data(), _header.data(), GetHeaderSize());
+      _points_size = 0u;
+      return std::move(_buffer);
+    }
+
+    /// View of the points written since the last ResetMemory.
+    boost::asio::const_buffer GetPoints() const {
+      return _buffer.size() == 0u ?
+          boost::asio::const_buffer() :
+          boost::asio::buffer(_buffer.data() + GetHeaderSize(), _points_size);
+    }
+
     std::vector<uint32_t> _header;
     uint32_t _max_channel_points;
 
   private:
-    std::vector<SemanticLidarDetection> _ser_points;
+
+    Buffer _buffer;
+
+    size_t _points_size = 0u;
 
   friend class s11n::SemanticLidarHeaderView;
   friend class s11n::SemanticLidarSerializer;
@@ -0,0 +1,227 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/Debug.h"
+#include "carla/sensor/data/ActorDynamicState.h"
+#include "carla/sensor/s11n/EpisodeStateSerializer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace carla {
+namespace sensor {
+namespace s11n {
+
+  /// Writes the messages of the episode state stream.
+  ///
+  /// A keyframe contains the state of every actor. In delta mode, between
+  /// keyframes only the actors whose state moved further than the quantization
+  /// thresholds below from the state last sent are written, together with the
+  /// ids of the actors removed. The client rebuilds the full state from the
+  /// previous one, so the error of any value is bounded by its threshold.
+  ///
+  /// Usage: Begin, Add every actor of the frame, End.
+  class EpisodeStateEncoder {
+  public:
+
+    using Serializer = EpisodeStateSerializer;
+    using ActorDynamicState = data::ActorDynamicState;
+
+    /// Every how many frames a keyframe is sent in delta mode. Clients that
+    /// fall behind catch up at the next keyframe, clients that connect get
+    /// one right away, see ForceKeyframe.
+    static constexpr uint64_t KeyframeInterval = 60u;
+
+    /// Quantization thresholds, in meters, degrees and seconds.
+    static constexpr float LocationThreshold = 0.01f;
+    static constexpr float RotationThreshold = 0.1f;
+    static constexpr float VelocityThreshold = 0.01f;
+    static constexpr float AngularVelocityThreshold = 0.1f;
+    static constexpr float AccelerationThreshold = 0.1f;
+
+    /// Start the message of @a frame in @a buffer. @a actor_count is the
+    /// number of actors that will be added, used to reserve memory.
+    void Begin(
+        Buffer &&buffer,
+        uint64_t frame,
+        Serializer::Header header,
+        size_t actor_count,
+        bool delta_mode) {
+      _buffer = std::move(buffer);
+      _is_keyframe =
+          !delta_mode ||
+          _is_keyframe_forced ||
+          !_has_previous_frame ||
+          (header.episode_id != _previous_episode_id) ||
+          (frame <= _previous_frame) ||
+          (frame - _last_keyframe >= KeyframeInterval);
+      _frame = frame;
+      _episode_id = header.episode_id;
+      _offset = 0u;
+      if (!delta_mode) {
+        _sent.clear();
+      }
+      _is_keyframe_forced = false;
+      if (_is_keyframe) {
+        _last_keyframe = frame;
+      } else {
+        header.simulation_state = static_cast<Serializer::SimulationState>(
+            header.simulation_state | Serializer::SimulationState::DeltaState);
+      }
+      _delta_mode = delta_mode;
+      _buffer.reset(static_cast<uint64_t>(
+          sizeof(header) +
+          (_is_keyframe ? 0u : sizeof(Serializer::DeltaHeader)) +
+          sizeof(ActorDynamicState) * actor_count));
+      Write(header);
+      if (!_is_keyframe) {
+        Write(Serializer::DeltaHeader{_previous_frame, 0u});
+      }
+      _actors_offset = _offset;
+    }
+
+    /// Add the state of an actor present in the current frame.
+    void Add(const ActorDynamicState &state) {
+      if (!_delta_mode) {
+        Write(state);
+        return;
+      }
+      auto result = _sent.emplace(state.id, Entry{state, _frame});
+      Entry &entry = result.first->second;
+      entry.last_seen = _frame;
+      if (_is_keyframe || result.second || HasChanged(entry.state, state)) {
+        entry.state = state;
+        Write(state);
+      }
+    }
+
+    /// Finish the message and return the buffer holding it.
+    Buffer End() {
+      if (_delta_mode) {
+        _removed.clear();
+        for (auto it = _sent.begin(); it != _sent.end();) {
+          if (it->second.last_seen != _frame) {
+            _removed.emplace_back(it->first);
+            it = _sent.erase(it);
+          } else {
+            ++it;
+          }
+        }
+        if (!_is_keyframe && !_removed.empty()) {
+          InsertRemovedActorIds();
+        }
+      }
+      _buffer.resize(static_cast<uint64_t>(_offset));
+      _has_previous_frame = _delta_mode;
+      _previous_frame = _frame;
+      _previous_episode_id = _episode_id;
+      return std::move(_buffer);
+    }
+
+    /// Make the next message a keyframe, clients that just subscribed have no
+    /// state to apply deltas to.
+    void ForceKeyframe() {
+      _is_keyframe_forced = true;
+    }
+
+    /// Whether the message being written is a keyframe.
+    bool IsKeyframe() const {
+      return _is_keyframe;
+    }
+
+    /// Whether two states of the same actor differ beyond the quantization
+    /// thresholds.
+    static bool HasChanged(const ActorDynamicState &lhs, const ActorDynamicState &rhs) {
+      return
+          (lhs.actor_state != rhs.actor_state) ||
+          IsFar(lhs.transform.location, rhs.transform.location, LocationThreshold) ||
+          (std::abs(lhs.transform.rotation.pitch - rhs.transform.rotation.pitch) > RotationThreshold) ||
+          (std::abs(lhs.transform.rotation.yaw - rhs.transform.rotation.yaw) > RotationThreshold) ||
+          (std::abs(lhs.transform.rotation.roll - rhs.transform.rotation.roll) > RotationThreshold) ||
+          IsFar(lhs.velocity, rhs.velocity, VelocityThreshold) ||
+          IsFar(lhs.angular_velocity, rhs.angular_velocity, AngularVelocityThreshold) ||
+          IsFar(lhs.acceleration, rhs.acceleration, AccelerationThreshold) ||
+          (std::memcmp(&lhs.state, &rhs.state, sizeof(lhs.state)) != 0);
+    }
+
+  private:
+
+    struct Entry {
+      ActorDynamicState state;
+      uint64_t last_seen;
+    };
+
+    static bool IsFar(const geom::Vector3D &lhs, const geom::Vector3D &rhs, float threshold) {
+      return (lhs - rhs).SquaredLength() > threshold * threshold;
+    }
+
+    template <typename T>
+    void Write(const T &data) {
+      if (_buffer.size() < _offset + sizeof(T)) {
+        _buffer.resize(std::max<uint64_t>(2u * _buffer.size(), _offset + sizeof(T)));
+      }
+      std::memcpy(_buffer.data() + _offset, &data, sizeof(T));
+      _offset += sizeof(T);
+    }
+
+    /// Make room for the removed actor ids in front of the actors written.
+    void InsertRemovedActorIds() {
+      const size_t ids_size = sizeof(ActorId) * _removed.size();
+      const size_t actors_size = _offset - _actors_offset;
+      if (_buffer.size() < _offset + ids_size) {
+        _buffer.resize(static_cast<uint64_t>(_offset + ids_size));
+      }
+      auto *actors = _buffer.data() + _actors_offset;
+      std::memmove(actors + ids_size, actors, actors_size);
+      std::memcpy(actors, _removed.data(), ids_size);
+      const uint32_t removed_count = static_cast<uint32_t>(_removed.size());
+      std::memcpy(
+          _buffer.data() + _actors_offset - sizeof(Serializer::DeltaHeader) +
+              offsetof(Serializer::DeltaHeader, removed_count),
+          &removed_count,
+          sizeof(uint32_t));
+      _offset += ids_size;
+    }
+
+    Buffer _buffer;
+
+    size_t _offset = 0u;
+
+    size_t _actors_offset = 0u;
+
+    uint64_t _episode_id = 0u;
+
+    uint64_t _previous_episode_id = 0u;
+
+    uint64_t _frame = 0u;
+
+    uint64_t _previous_frame = 0u;
+
+    uint64_t _last_keyframe = 0u;
+
+    bool _has_previous_frame = false;
+
+    bool _delta_mode = false;
+
+    bool _is_keyframe = true;
+
+    bool _is_keyframe_forced = false;
+
+    std::unordered_map<ActorId, Entry> _sent;
+
+    std::vector<ActorId> _removed;
+  };
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
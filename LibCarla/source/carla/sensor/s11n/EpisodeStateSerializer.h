@@ -30,7 +30,10 @@ namespace s11n {
     enum SimulationState {
       None               = (0x0 << 0),
       MapChange          = (0x1 << 0),
-      PendingLightUpdate = (0x1 << 1)
+      PendingLightUpdate = (0x1 << 1),
+      /// The message only contains the actors that changed since the frame
+      /// given in its DeltaHeader, see EpisodeStateEncoder.
+      DeltaState         = (0x1 << 2)
     };
 
 #pragma pack(push, 1)
@@ -41,6 +44,14 @@ namespace s11n {
       geom::Vector3DInt map_origin;
       SimulationState simulation_state = SimulationState::None;
     };
+
+    /// Follows the Header in delta messages. It is followed by the ids of the
+    /// actors removed since @a base_frame, and then by the actors whose state
+    /// changed.
+    struct DeltaHeader {
+      uint64_t base_frame;
+      uint32_t removed_count;
+    };
 #pragma pack(pop)
 
     constexpr static auto header_offset = sizeof(Header);
@@ -49,6 +60,31 @@ namespace s11n {
       return *reinterpret_cast<const Header *>(message.begin());
     }
 
+    static bool IsDelta(const RawData &message) {
+      return (DeserializeHeader(message).simulation_state & SimulationState::DeltaState) != 0;
+    }
+
+    /// @pre IsDelta(message).
+    static const DeltaHeader &DeserializeDeltaHeader(const RawData &message) {
+      DEBUG_ASSERT(IsDelta(message));
+      return *reinterpret_cast<const DeltaHeader *>(message.begin() + header_offset);
+    }
+
+    /// @pre IsDelta(message).
+    static const ActorId *DeserializeRemovedActorIds(const RawData &message) {
+      return reinterpret_cast<const ActorId *>(
+          message.begin() + header_offset + sizeof(DeltaHeader));
+    }
+
+    /// Offset of the first ActorDynamicState in @a message.
+    static size_t GetActorsOffset(const RawData &message) {
+      if (!IsDelta(message)) {
+        return header_offset;
+      }
+      return header_offset + sizeof(DeltaHeader) +
+          sizeof(ActorId) * DeserializeDeltaHeader(message).removed_count;
+    }
+
     template <typename SensorT>
     static Buffer Serialize(const SensorT &, Buffer &&buffer) {
       return std::move(buffer);
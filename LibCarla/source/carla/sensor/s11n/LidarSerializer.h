@@ -67,12 +67,20 @@ namespace s11n {
       return sizeof(uint32_t) * (View.GetChannelCount() + data::LidarData::Index::SIZE);
     }
 
+    /// Copy the header and the points of @a data into @a output.
     template <typename Sensor>
     static Buffer Serialize(
         const Sensor &sensor,
         const data::LidarData &data,
         Buffer &&output);
 
+    /// Hand over the buffer @a data wrote its points into, only the
+    /// header is copied.
+    template <typename Sensor>
+    static Buffer Serialize(
+        const Sensor &sensor,
+        data::LidarData &data);
+
     static SharedPtr<SensorData> Deserialize(RawData &&data);
   };
 
@@ -87,11 +95,18 @@ namespace s11n {
       Buffer &&output) {
     std::array<boost::asio::const_buffer, 2u> seq = {
         boost::asio::buffer(data._header),
-        boost::asio::buffer(data._points)};
+        data.GetPoints()};
     output.copy_from(seq);
     return std::move(output);
   }
 
+  template <typename Sensor>
+  inline Buffer LidarSerializer::Serialize(
+      const Sensor &,
+      data::LidarData &data) {
+    return data.PopBuffer();
+  }
+
 } // namespace s11n
 } // namespace sensor
 } // namespace carla
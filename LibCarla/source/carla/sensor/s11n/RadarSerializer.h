@@ -28,12 +28,20 @@ namespace s11n {
   class RadarSerializer {
   public:
 
+    /// Copy the detections of @a measurement into @a output.
     template <typename Sensor>
     static Buffer Serialize(
         const Sensor &sensor,
         const data::RadarData &measurement,
         Buffer &&output);
 
+    /// Hand over the buffer @a measurement wrote its detections into, no
+    /// copy involved.
+    template <typename Sensor>
+    static Buffer Serialize(
+        const Sensor &sensor,
+        data::RadarData &measurement);
+
     static SharedPtr<SensorData> Deserialize(RawData &&data);
   };
 
@@ -42,10 +50,19 @@ namespace s11n {
       const Sensor &,
       const data::RadarData &measurement,
       Buffer &&output) {
-    output.copy_from(measurement._detections);
+    output.copy_from(boost::asio::buffer(
+        measurement._buffer.data(),
+        measurement._detection_count * data::RadarData::detection_size));
     return std::move(output);
   }
 
+  template <typename Sensor>
+  inline Buffer RadarSerializer::Serialize(
+      const Sensor &,
+      data::RadarData &measurement) {
+    return measurement.PopBuffer();
+  }
+
 } // namespace s11n
 } // namespace sensor
 } // namespace carla
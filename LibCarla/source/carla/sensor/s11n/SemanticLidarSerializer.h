@@ -68,12 +68,20 @@ namespace s11n {
       return sizeof(uint32_t) * (View.GetChannelCount() + data::SemanticLidarData::Index::SIZE);
     }
 
+    /// Copy the header and the points of @a measurement into @a output.
     template <typename Sensor>
     static Buffer Serialize(
         const Sensor &sensor,
         const data::SemanticLidarData &measurement,
         Buffer &&output);
 
+    /// Hand over the buffer @a measurement wrote its points into, only the
+    /// header is copied.
+    template <typename Sensor>
+    static Buffer Serialize(
+        const Sensor &sensor,
+        data::SemanticLidarData &measurement);
+
     static SharedPtr<SensorData> Deserialize(RawData &&data);
   };
 
@@ -88,11 +96,18 @@ namespace s11n {
       Buffer &&output) {
     std::array<boost::asio::const_buffer, 2u> seq = {
         boost::asio::buffer(measurement._header),
-        boost::asio::buffer(measurement._ser_points)};
+        measurement.GetPoints()};
     output.copy_from(seq);
     return std::move(output);
   }
 
+  template <typename Sensor>
+  inline Buffer SemanticLidarSerializer::Serialize(
+      const Sensor &,
+      data::SemanticLidarData &measurement) {
+    return measurement.PopBuffer();
+  }
+
 } // namespace s11n
 } // namespace sensor
 } // namespace carla
@@ -8,12 +8,16 @@
 
 #include "carla/Logging.h"
 #include "carla/ThreadPool.h"
+#include "carla/streaming/Compression.h"
 #include "carla/streaming/Token.h"
+#include "carla/streaming/Transport.h"
 #include "carla/streaming/detail/tcp/Client.h"
 #include "carla/streaming/low_level/Client.h"
 
 #include <boost/asio/io_context.hpp>
 
+#include <atomic>
+
 namespace carla {
 namespace streaming {
 
@@ -37,7 +41,41 @@ namespace streaming {
     /// MultiStream).
     template <typename Functor>
     void Subscribe(const Token &token, Functor &&callback) {
-      _client.Subscribe(_service.io_context(), token, std::forward<Functor>(callback));
+      Subscribe(token, Compression::None, std::forward<Functor>(callback));
+    }
+
+    /// Subscribe asking the server to send the messages compressed with
+    /// @a compression. The callback receives them already decompressed.
+    ///
+    /// @warning cannot subscribe twice to the same stream (even if it's a
+    /// MultiStream).
+    template <typename Functor>
+    void Subscribe(const Token &token, Compression compression, Functor &&callback) {
+      stream_token subscription(token);
+      subscription.set_compression(compression);
+      subscription.set_transport(_transport);
+      _client.Subscribe(_service.io_context(), subscription, std::forward<Functor>(callback));
+    }
+
+    /// Transport requested by the subscriptions made after this call. With
+    /// Transport::SharedMemory, streams of a server on this host are read
+    /// from shared memory, the others keep using TCP.
+    void SetTransport(Transport transport) {
+      _transport = transport;
+    }
+
+    Transport GetTransport() const {
+      return _transport;
+    }
+
+    /// Maximum number of bytes of memory kept to receive the messages of
+    /// every stream, see BufferPool.
+    void SetBufferPoolMaxBytes(size_t max_bytes) {
+      _client.GetBufferPool().SetMaxBytes(max_bytes);
+    }
+
+    BufferPool::Statistics GetBufferPoolStatistics() {
+      return _client.GetBufferPool().GetStatistics();
     }
 
     void UnSubscribe(const Token &token) {
@@ -59,6 +97,8 @@ namespace streaming {
     ThreadPool _service;
 
     underlying_client _client;
+
+    std::atomic<Transport> _transport{Transport::Tcp};
   };
 
 } // namespace streaming
@@ -0,0 +1,29 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+
+namespace carla {
+namespace streaming {
+
+  /// Compression a client requests when subscribing to a stream. The server
+  /// compresses the messages of that client's session before sending them,
+  /// and the client decompresses them before calling the callback. Every
+  /// codec is lossless.
+  enum class Compression : uint8_t {
+    None,
+    /// LZ4 block compression, for any kind of data.
+    LZ4,
+    /// LZ4 after replacing every byte by its difference with the same byte of
+    /// the previous 4-byte pixel. Much better on BGRA8 images, where
+    /// neighbouring pixels are similar, than LZ4 alone.
+    LZ4Bgra
+  };
+
+} // namespace streaming
+} // namespace carla
@@ -22,6 +22,10 @@ namespace streaming {
     using protocol_type = low_level::Server<detail::tcp::Server>::protocol_type;
   public:
 
+    using SendQueuePolicy = detail::tcp::SendQueuePolicy;
+
+    using SendQueueStatistics = detail::tcp::SendQueueStatistics;
+
     explicit Server(uint16_t port)
       : _server(_pool.io_context(), make_endpoint<protocol_type>(port)) {}
 
@@ -64,6 +68,30 @@ namespace streaming {
       _server.SetSynchronousMode(is_synchro);
     }
 
+    /// Maximum number of messages each client session keeps waiting to be
+    /// sent. Applies only to newly connected clients.
+    void SetSendQueueCapacity(size_t capacity) {
+      _server.SetSendQueueCapacity(capacity);
+    }
+
+    /// What to do when a client is too slow and its send queue is full.
+    /// Applies only to newly connected clients.
+    void SetSendQueuePolicy(SendQueuePolicy policy) {
+      _server.SetSendQueuePolicy(policy);
+    }
+
+    /// Maximum size in bytes of the ring buffer shared with each client on
+    /// this host that subscribes with Transport::SharedMemory, zero disables
+    /// shared memory. Applies only to newly connected clients.
+    void SetSharedMemorySize(size_t size) {
+      _server.SetSharedMemorySize(size);
+    }
+
+    /// Drop and queue depth counters of all the sessions of this server.
+    SendQueueStatistics GetSendQueueStatistics() const {
+      return _server.GetSendQueueStatistics();
+    }
+
   private:
 
     // The order of these two arguments is very important.
@@ -0,0 +1,25 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+
+namespace carla {
+namespace streaming {
+
+  /// How a client asks to receive the messages of a stream.
+  enum class Transport : uint8_t {
+    /// Every message is sent through the TCP connection.
+    Tcp,
+    /// The server writes the messages to a ring buffer in shared memory and
+    /// only sends their position through the TCP connection. Clients on
+    /// another host, or that fail to map the ring, fall back to Tcp.
+    SharedMemory
+  };
+
+} // namespace streaming
+} // namespace carla
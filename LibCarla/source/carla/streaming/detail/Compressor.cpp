@@ -0,0 +1,141 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/Compressor.h"
+
+#include "carla/Debug.h"
+#include "carla/streaming/detail/Lz4.h"
+
+#include <cstring>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+
+  /// Distance in bytes between the bytes the delta filter subtracts, the size
+  /// of a BGRA8 pixel.
+  static constexpr size_t DeltaStride = 4u;
+
+  static constexpr uint32_t HighBits = 0x80808080u;
+
+  /// Subtract each byte of @a rhs from the same byte of @a lhs, modulo 256.
+  static uint32_t SubtractBytes(uint32_t lhs, uint32_t rhs) {
+    return ((lhs | HighBits) - (rhs & ~HighBits)) ^ ((lhs ^ ~rhs) & HighBits);
+  }
+
+  /// Add each byte of @a rhs to the same byte of @a lhs, modulo 256.
+  static uint32_t AddBytes(uint32_t lhs, uint32_t rhs) {
+    return ((lhs & ~HighBits) + (rhs & ~HighBits)) ^ ((lhs ^ rhs) & HighBits);
+  }
+
+  static uint32_t Load(const unsigned char *data) {
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+  }
+
+  static void Store(unsigned char *data, uint32_t value) {
+    std::memcpy(data, &value, sizeof(value));
+  }
+
+  /// Replace each byte by its difference with the byte DeltaStride before,
+  /// a whole pixel at a time.
+  static void DeltaEncode(unsigned char *data, size_t size) {
+    if (size <= DeltaStride) {
+      return;
+    }
+    size_t i = size;
+    for (; (i % DeltaStride != 0u) && (i > DeltaStride); --i) {
+      data[i - 1u] = static_cast<unsigned char>(data[i - 1u] - data[i - 1u - DeltaStride]);
+    }
+    for (i -= DeltaStride; i >= DeltaStride; i -= DeltaStride) {
+      Store(data + i, SubtractBytes(Load(data + i), Load(data + i - DeltaStride)));
+    }
+  }
+
+  static void DeltaDecode(unsigned char *data, size_t size) {
+    if (size < DeltaStride) {
+      return;
+    }
+    size_t i = DeltaStride;
+    uint32_t previous = Load(data);
+    for (; i + DeltaStride <= size; i += DeltaStride) {
+      previous = AddBytes(Load(data + i), previous);
+      Store(data + i, previous);
+    }
+    for (; i < size; ++i) {
+      data[i] = static_cast<unsigned char>(data[i] + data[i - DeltaStride]);
+    }
+  }
+
+  std::vector<unsigned char> &Compressor::GetScratch() {
+    thread_local std::vector<unsigned char> scratch;
+    return scratch;
+  }
+
+  void Compressor::Compress(
+      const Compression compression,
+      std::vector<unsigned char> &message,
+      Buffer &frame) {
+    DEBUG_ASSERT(compression != Compression::None);
+    FrameHeader header{0u, static_cast<uint32_t>(message.size())};
+    if (compression == Compression::LZ4Bgra) {
+      DeltaEncode(message.data(), message.size());
+      header.flags |= DeltaFlag;
+    }
+    frame.reset(GetMaxFrameSize(message.size()));
+    unsigned char *body = frame.data() + sizeof(FrameHeader);
+    size_t body_size = Lz4::Compress(message.data(), message.size(), body);
+    if (body_size < message.size()) {
+      header.flags |= Lz4Flag;
+    } else {
+      std::memcpy(body, message.data(), message.size());
+      body_size = message.size();
+    }
+    std::memcpy(frame.data(), &header, sizeof(FrameHeader));
+    frame.resize(sizeof(FrameHeader) + body_size);
+  }
+
+  size_t Compressor::GetMaxFrameSize(const size_t message_size) {
+    return sizeof(FrameHeader) + Lz4::CompressBound(message_size);
+  }
+
+  size_t Compressor::GetMessageSize(const Buffer &frame) {
+    FrameHeader header;
+    if (frame.size() < sizeof(FrameHeader)) {
+      return 0u;
+    }
+    std::memcpy(&header, frame.data(), sizeof(FrameHeader));
+    return header.size;
+  }
+
+  bool Compressor::Decompress(const Buffer &frame, Buffer &message) {
+    FrameHeader header;
+    if (frame.size() < sizeof(FrameHeader)) {
+      return false;
+    }
+    std::memcpy(&header, frame.data(), sizeof(FrameHeader));
+    const unsigned char *body = frame.data() + sizeof(FrameHeader);
+    const size_t body_size = frame.size() - sizeof(FrameHeader);
+    message.reset(header.size);
+    if ((header.flags & Lz4Flag) != 0u) {
+      if (!Lz4::Decompress(body, body_size, message.data(), message.size())) {
+        return false;
+      }
+    } else if (body_size == message.size()) {
+      std::memcpy(message.data(), body, body_size);
+    } else {
+      return false;
+    }
+    if ((header.flags & DeltaFlag) != 0u) {
+      DeltaDecode(message.data(), message.size());
+    }
+    return true;
+  }
+
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,77 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/streaming/Compression.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+
+  /// Packs messages into compressed frames and back. A frame is a FrameHeader
+  /// followed by the message, filtered and compressed as its flags say. Data
+  /// that does not compress is stored as is, so a frame is never much larger
+  /// than its message.
+  class Compressor {
+  public:
+
+    /// Compress the concatenation of the buffers in @a payload into @a frame.
+    template <typename ConstBufferSequence>
+    static void Compress(
+        Compression compression,
+        const ConstBufferSequence &payload,
+        Buffer &frame) {
+      auto &scratch = GetScratch();
+      scratch.clear();
+      for (auto &&buffer : payload) {
+        const auto *data = static_cast<const unsigned char *>(buffer.data());
+        scratch.insert(scratch.end(), data, data + buffer.size());
+      }
+      Compress(compression, scratch, frame);
+    }
+
+    /// Restore the message compressed in @a frame into @a message. Return
+    /// false if the frame is malformed.
+    static bool Decompress(const Buffer &frame, Buffer &message);
+
+    /// Largest frame Compress may produce for a message of @a message_size
+    /// bytes.
+    static size_t GetMaxFrameSize(size_t message_size);
+
+    /// Size of the message compressed in @a frame, zero if malformed.
+    static size_t GetMessageSize(const Buffer &frame);
+
+  private:
+
+    enum Flags : uint8_t {
+      Lz4Flag = 1u << 0u,
+      DeltaFlag = 1u << 1u
+    };
+
+#pragma pack(push, 1)
+    struct FrameHeader {
+      uint8_t flags;
+      uint32_t size;
+    };
+#pragma pack(pop)
+
+    static std::vector<unsigned char> &GetScratch();
+
+    /// Compress @a message, modifying it in place if a filter applies.
+    static void Compress(
+        Compression compression,
+        std::vector<unsigned char> &message,
+        Buffer &frame);
+  };
+
+} // namespace detail
+} // namespace streaming
+} // namespace carla
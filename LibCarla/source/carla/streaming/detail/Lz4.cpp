@@ -0,0 +1,252 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/Lz4.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+
+  /// A match is at least this long.
+  static constexpr size_t MinMatch = 4u;
+
+  /// The last bytes of a block are always literals.
+  static constexpr size_t LastLiterals = 5u;
+
+  /// The last match starts at least this many bytes before the end.
+  static constexpr size_t MatchFindLimit = 12u;
+
+  static constexpr size_t MaxOffset = 65535u;
+
+  static constexpr unsigned HashLog = 16u;
+
+  static uint32_t Read32(const unsigned char *ptr) {
+    uint32_t value;
+    std::memcpy(&value, ptr, sizeof(value));
+    return value;
+  }
+
+  static uint64_t Read64(const unsigned char *ptr) {
+    uint64_t value;
+    std::memcpy(&value, ptr, sizeof(value));
+    return value;
+  }
+
+  static uint32_t Hash(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32u - HashLog);
+  }
+
+  static size_t CountTrailingZeroBytes(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<size_t>(__builtin_ctzll(value)) / 8u;
+#else
+    size_t count = 0u;
+    while ((value & 0xffu) == 0u) {
+      value >>= 8u;
+      ++count;
+    }
+    return count;
+#endif
+  }
+
+  /// Length of the common prefix of @a lhs and @a rhs, not going past
+  /// @a rhs_end.
+  static size_t MatchLength(
+      const unsigned char *lhs,
+      const unsigned char *rhs,
+      const unsigned char *rhs_end) {
+    const unsigned char *start = rhs;
+    while (rhs + sizeof(uint64_t) <= rhs_end) {
+      const uint64_t diff = Read64(lhs) ^ Read64(rhs);
+      if (diff != 0u) {
+        return static_cast<size_t>(rhs - start) + CountTrailingZeroBytes(diff);
+      }
+      lhs += sizeof(uint64_t);
+      rhs += sizeof(uint64_t);
+    }
+    while ((rhs < rhs_end) && (*lhs == *rhs)) {
+      ++lhs;
+      ++rhs;
+    }
+    return static_cast<size_t>(rhs - start);
+  }
+
+  static unsigned char *WriteLength(unsigned char *out, size_t length) {
+    for (; length >= 255u; length -= 255u) {
+      *out++ = 255u;
+    }
+    *out++ = static_cast<unsigned char>(length);
+    return out;
+  }
+
+  static unsigned char *WriteSequence(
+      unsigned char *out,
+      const unsigned char *literals,
+      size_t literal_length,
+      size_t offset,
+      size_t match_length) {
+    unsigned char &token = *out++;
+    token = static_cast<unsigned char>(std::min<size_t>(literal_length, 15u) << 4u);
+    if (literal_length >= 15u) {
+      out = WriteLength(out, literal_length - 15u);
+    }
+    std::memcpy(out, literals, literal_length);
+    out += literal_length;
+    if (match_length == 0u) {
+      return out;
+    }
+    *out++ = static_cast<unsigned char>(offset & 0xffu);
+    *out++ = static_cast<unsigned char>(offset >> 8u);
+    const size_t length = match_length - MinMatch;
+    token |= static_cast<unsigned char>(std::min<size_t>(length, 15u));
+    if (length >= 15u) {
+      out = WriteLength(out, length - 15u);
+    }
+    return out;
+  }
+
+  size_t Lz4::Compress(
+      const unsigned char *source,
+      const size_t size,
+      unsigned char *destination) {
+    unsigned char *out = destination;
+    const unsigned char *anchor = source;
+    if (size > MatchFindLimit) {
+      // Positions plus one of the last sequence seen with each hash, zero
+      // means none.
+      thread_local std::unique_ptr<std::array<uint32_t, 1u << HashLog>> table;
+      if (table == nullptr) {
+        table = std::make_unique<std::array<uint32_t, 1u << HashLog>>();
+      }
+      table->fill(0u);
+      const unsigned char *ip = source;
+      const unsigned char *const match_limit = source + size - MatchFindLimit;
+      const unsigned char *const match_end = source + size - LastLiterals;
+      while (ip < match_limit) {
+        const uint32_t sequence = Read32(ip);
+        uint32_t &entry = (*table)[Hash(sequence)];
+        const unsigned char *ref = source + entry - 1u;
+        const bool found =
+            (entry != 0u) &&
+            (static_cast<size_t>(ip - ref) <= MaxOffset) &&
+            (Read32(ref) == sequence);
+        entry = static_cast<uint32_t>(ip - source) + 1u;
+        if (!found) {
+          // Skip faster over data that does not compress.
+          ip += 1u + (static_cast<size_t>(ip - anchor) >> 6u);
+          continue;
+        }
+        const size_t length =
+            MinMatch + MatchLength(ref + MinMatch, ip + MinMatch, match_end);
+        out = WriteSequence(
+            out,
+            anchor,
+            static_cast<size_t>(ip - anchor),
+            static_cast<size_t>(ip - ref),
+            length);
+        ip += length;
+        anchor = ip;
+      }
+    }
+    out = WriteSequence(out, anchor, static_cast<size_t>(source + size - anchor), 0u, 0u);
+    return static_cast<size_t>(out - destination);
+  }
+
+  /// Copy @a length bytes 8 at a time, may write up to 7 bytes past the end.
+  static void WildCopy(unsigned char *out, const unsigned char *in, size_t length) {
+    unsigned char *const end = out + length;
+    do {
+      std::memcpy(out, in, 8u);
+      out += 8u;
+      in += 8u;
+    } while (out < end);
+  }
+
+  /// Read a length extension, return false if it runs past @a end.
+  static bool ReadLength(const unsigned char *&in, const unsigned char *end, size_t &length) {
+    unsigned char byte;
+    do {
+      if (in >= end) {
+        return false;
+      }
+      byte = *in++;
+      length += byte;
+    } while (byte == 255u);
+    return true;
+  }
+
+  bool Lz4::Decompress(
+      const unsigned char *source,
+      const size_t size,
+      unsigned char *destination,
+      const size_t decompressed_size) {
+    const unsigned char *in = source;
+    const unsigned char *const in_end = source + size;
+    unsigned char *out = destination;
+    unsigned char *const out_end = destination + decompressed_size;
+    while (in < in_end) {
+      const unsigned char token = *in++;
+      size_t literal_length = token >> 4u;
+      if ((literal_length == 15u) && !ReadLength(in, in_end, literal_length)) {
+        return false;
+      }
+      if ((static_cast<size_t>(in_end - in) < literal_length) ||
+          (static_cast<size_t>(out_end - out) < literal_length)) {
+        return false;
+      }
+      if ((static_cast<size_t>(in_end - in) >= literal_length + 8u) &&
+          (static_cast<size_t>(out_end - out) >= literal_length + 8u)) {
+        WildCopy(out, in, literal_length);
+      } else {
+        std::memcpy(out, in, literal_length);
+      }
+      in += literal_length;
+      out += literal_length;
+      if (in == in_end) {
+        // The last sequence has only literals.
+        break;
+      }
+      if (in_end - in < 2) {
+        return false;
+      }
+      const size_t offset = static_cast<size_t>(in[0u]) | (static_cast<size_t>(in[1u]) << 8u);
+      in += 2u;
+      size_t match_length = token & 0x0fu;
+      if ((match_length == 15u) && !ReadLength(in, in_end, match_length)) {
+        return false;
+      }
+      match_length += MinMatch;
+      if ((offset == 0u) ||
+          (offset > static_cast<size_t>(out - destination)) ||
+          (static_cast<size_t>(out_end - out) < match_length)) {
+        return false;
+      }
+      const unsigned char *match = out - offset;
+      if ((offset >= 8u) && (static_cast<size_t>(out_end - out) >= match_length + 8u)) {
+        WildCopy(out, match, match_length);
+        out += match_length;
+      } else if (offset >= match_length) {
+        std::memcpy(out, match, match_length);
+        out += match_length;
+      } else {
+        // Overlapping copy, repeats the last offset bytes.
+        for (size_t i = 0u; i < match_length; ++i) {
+          *out++ = *match++;
+        }
+      }
+    }
+    return out == out_end;
+  }
+
+} // namespace detail
+} // namespace streaming
+} // namespace carla
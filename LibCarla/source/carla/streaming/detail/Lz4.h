@@ -0,0 +1,47 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstddef>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+
+  /// Compressor and decompressor of the LZ4 block format, see
+  /// https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md. The output
+  /// can be read by any LZ4 implementation and vice versa. The compressor is
+  /// a single-pass greedy matcher, it trades some compression ratio for
+  /// speed.
+  class Lz4 {
+  public:
+
+    /// Maximum size of the compressed data of @a size bytes.
+    static constexpr size_t CompressBound(size_t size) {
+      return size + size / 255u + 16u;
+    }
+
+    /// Compress @a size bytes of @a source into @a destination, which must
+    /// have room for CompressBound(size) bytes. Return the compressed size.
+    static size_t Compress(
+        const unsigned char *source,
+        size_t size,
+        unsigned char *destination);
+
+    /// Decompress @a size bytes of @a source into @a destination, which must
+    /// have exactly @a decompressed_size bytes. Return false if the input is
+    /// malformed or does not decompress to @a decompressed_size bytes.
+    static bool Decompress(
+        const unsigned char *source,
+        size_t size,
+        unsigned char *destination,
+        size_t decompressed_size);
+  };
+
+} // namespace detail
+} // namespace streaming
+} // namespace carla
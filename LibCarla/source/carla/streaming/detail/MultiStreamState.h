@@ -32,6 +32,12 @@ namespace detail {
       _session(nullptr)
       {};
 
+    /// Number of sessions connected since the stream was created, changes
+    /// every time a client subscribes.
+    size_t GetConnectionCount() const {
+      return _connection_count;
+    }
+
     template <typename... Buffers>
     void Write(Buffers &&... buffers) {
       auto message = Session::MakeMessage(std::move(buffers)...);
@@ -60,6 +66,7 @@ namespace detail {
       DEBUG_ASSERT(session != nullptr);
       std::lock_guard<std::mutex> lock(_mutex);
       _sessions.emplace_back(std::move(session));
+      ++_connection_count;
       log_debug("Connecting multistream sessions:", _sessions.size());
       if (_sessions.size() == 1) {
         _session.store(_sessions[0]);
@@ -104,6 +111,8 @@ namespace detail {
     AtomicSharedPtr<Session> _session;
     // if there are more than one session, we use vector of sessions with mutex
     std::vector<std::shared_ptr<Session>> _sessions;
+
+    std::atomic_size_t _connection_count{0u};
   };
 
 } // namespace detail
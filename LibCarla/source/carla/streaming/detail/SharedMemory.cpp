@@ -0,0 +1,166 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/SharedMemory.h"
+
+#include "carla/Logging.h"
+
+#ifdef _WIN32
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+
+  SharedMemory::~SharedMemory() {
+    Unmap();
+  }
+
+  bool SharedMemory::Create(const std::string &name, size_t size) {
+    return Map(name, size, true);
+  }
+
+  bool SharedMemory::Open(const std::string &name, size_t size) {
+    return Map(name, size, false);
+  }
+
+#ifdef _WIN32
+
+  static std::string GetMappingName(const std::string &name) {
+    return "Local\\" + name;
+  }
+
+  bool SharedMemory::Map(const std::string &name, const size_t size, const bool create) {
+    Unmap();
+    const auto mapping_name = GetMappingName(name);
+    HANDLE handle;
+    if (create) {
+      const uint64_t size64 = size;
+      handle = CreateFileMappingA(
+          INVALID_HANDLE_VALUE,
+          nullptr,
+          PAGE_READWRITE,
+          static_cast<DWORD>(size64 >> 32u),
+          static_cast<DWORD>(size64 & 0xffffffffu),
+          mapping_name.c_str());
+      if ((handle != nullptr) && (GetLastError() == ERROR_ALREADY_EXISTS)) {
+        CloseHandle(handle);
+        handle = nullptr;
+      }
+    } else {
+      handle = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, mapping_name.c_str());
+    }
+    if (handle == nullptr) {
+      log_debug("shared memory: failed to map", name, "error", GetLastError());
+      return false;
+    }
+    void *data = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0u, 0u, size);
+    if (data == nullptr) {
+      log_debug("shared memory: failed to map", name, "error", GetLastError());
+      CloseHandle(handle);
+      return false;
+    }
+    _handle = handle;
+    _data = static_cast<unsigned char *>(data);
+    _size = size;
+    return true;
+  }
+
+  void SharedMemory::Unmap() {
+    if (_data != nullptr) {
+      UnmapViewOfFile(_data);
+      CloseHandle(_handle);
+    }
+    _data = nullptr;
+    _size = 0u;
+    _handle = nullptr;
+  }
+
+  void SharedMemory::Remove(const std::string &) {
+    // Named mappings disappear with their last handle.
+  }
+
+#else
+
+  static std::string GetPath(const std::string &name) {
+    return "/dev/shm/" + name;
+  }
+
+  bool SharedMemory::Map(const std::string &name, const size_t size, const bool create) {
+    Unmap();
+    const auto path = GetPath(name);
+    const int flags = create ? (O_RDWR | O_CREAT | O_EXCL) : O_RDWR;
+    const int fd = ::open(path.c_str(), flags | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+      log_debug("shared memory: failed to open", path, ':', std::strerror(errno));
+      return false;
+    }
+    bool succeeded = false;
+    struct stat info;
+    // Reserve the pages now, a sparse file would make the writer crash with
+    // SIGBUS if /dev/shm fills up while streaming.
+    const int error = create ? ::posix_fallocate(fd, 0, static_cast<off_t>(size)) : 0;
+    if (error != 0) {
+      log_debug("shared memory: failed to allocate", size, "bytes for", path, ':', std::strerror(error));
+      ::unlink(path.c_str());
+    } else if ((::fstat(fd, &info) != 0) || (static_cast<size_t>(info.st_size) < size)) {
+      log_debug("shared memory:", path, "is too small");
+    } else {
+      int map_flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+      // Fault in the whole region now rather than page by page while
+      // streaming.
+      map_flags |= MAP_POPULATE;
+#endif // MAP_POPULATE
+      void *data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, map_flags, fd, 0);
+      if (data == MAP_FAILED) {
+        log_debug("shared memory: failed to map", path, ':', std::strerror(errno));
+        if (create) {
+          ::unlink(path.c_str());
+        }
+      } else {
+        _data = static_cast<unsigned char *>(data);
+        _size = size;
+        succeeded = true;
+      }
+    }
+    ::close(fd);
+    return succeeded;
+  }
+
+  void SharedMemory::Unmap() {
+    if (_data != nullptr) {
+      ::munmap(_data, _size);
+    }
+    _data = nullptr;
+    _size = 0u;
+  }
+
+  void SharedMemory::Remove(const std::string &name) {
+    ::unlink(GetPath(name).c_str());
+  }
+
+#endif // _WIN32
+
+} // namespace detail
+} // namespace streaming
+} // namespace carla
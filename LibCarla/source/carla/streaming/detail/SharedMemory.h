@@ -0,0 +1,67 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+
+#include <cstddef>
+#include <string>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+
+  /// A named region of memory shared between processes of the same host. On
+  /// Linux it is a file in /dev/shm, on Windows a named file mapping.
+  ///
+  /// Errors are reported by return value, this class is used by the server
+  /// which is built without exceptions.
+  class SharedMemory : private NonCopyable {
+  public:
+
+    SharedMemory() = default;
+
+    ~SharedMemory();
+
+    /// Create a new region named @a name of @a size bytes, initialized to
+    /// zero. Fail if the name already exists or if there is not enough room
+    /// left to reserve the whole region.
+    bool Create(const std::string &name, size_t size);
+
+    /// Map the existing region named @a name, of at least @a size bytes.
+    bool Open(const std::string &name, size_t size);
+
+    /// Remove @a name so no other process can open it, regions already
+    /// mapped stay valid until unmapped.
+    static void Remove(const std::string &name);
+
+    unsigned char *data() const {
+      return _data;
+    }
+
+    size_t size() const {
+      return _size;
+    }
+
+  private:
+
+    bool Map(const std::string &name, size_t size, bool create);
+
+    void Unmap();
+
+    unsigned char *_data = nullptr;
+
+    size_t _size = 0u;
+
+#ifdef _WIN32
+    void *_handle = nullptr;
+#endif // _WIN32
+  };
+
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,139 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/SharedMemoryRing.h"
+
+#include "carla/Debug.h"
+#include "carla/Logging.h"
+
+#include <chrono>
+#include <cstdio>
+#include <new>
+#include <random>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+
+  static_assert(
+      ATOMIC_LLONG_LOCK_FREE == 2,
+      "The read position is shared between processes, it must be lock-free.");
+
+  /// Placed at the beginning of the shared memory, the messages follow it.
+  struct alignas(64) SharedMemoryRing::Header {
+    uint64_t nonce;
+
+    uint64_t capacity;
+
+    /// Written by the client only.
+    std::atomic<uint64_t> read_position;
+  };
+
+  static uint64_t MakeNonce() {
+    static std::atomic<uint64_t> counter{0u};
+    std::random_device device;
+    const uint64_t random = (static_cast<uint64_t>(device()) << 32u) ^ device();
+    const uint64_t time = static_cast<uint64_t>(
+        std::chrono::high_resolution_clock::now().time_since_epoch().count());
+    // splitmix64 finalizer, so nonces differ even if random_device is not
+    // random on this platform.
+    uint64_t x = random ^ time ^ (counter++ * 0x9e3779b97f4a7c15u);
+    x = (x ^ (x >> 30u)) * 0xbf58476d1ce4e5b9u;
+    x = (x ^ (x >> 27u)) * 0x94d049bb133111ebu;
+    return x ^ (x >> 31u);
+  }
+
+  std::unique_ptr<SharedMemoryRing> SharedMemoryRing::Create(const size_t capacity) {
+    DEBUG_ASSERT(capacity > 0u);
+    // Retry in the unlikely case of a name collision.
+    for (auto attempt = 0u; attempt < 3u; ++attempt) {
+      std::unique_ptr<SharedMemoryRing> ring{new SharedMemoryRing{MakeNonce(), capacity, true}};
+      if (ring->_memory.Create(GetName(ring->_nonce), sizeof(Header) + capacity)) {
+        auto *header = new (ring->_memory.data()) Header;
+        header->nonce = ring->_nonce;
+        header->capacity = capacity;
+        header->read_position.store(0u, std::memory_order_release);
+        return ring;
+      }
+    }
+    log_warning("streaming server: failed to create shared memory ring buffer");
+    return nullptr;
+  }
+
+  std::unique_ptr<SharedMemoryRing> SharedMemoryRing::Open(const uint64_t nonce, const uint64_t capacity) {
+    const auto name = GetName(nonce);
+    std::unique_ptr<SharedMemoryRing> ring{new SharedMemoryRing{nonce, capacity, false}};
+    if (!ring->_memory.Open(name, sizeof(Header) + capacity)) {
+      return nullptr;
+    }
+    // The server shares the ring with this client only, nobody else needs
+    // the name, removing it now ensures it disappears with the mappings.
+    SharedMemory::Remove(name);
+    const auto &header = ring->GetHeader();
+    if ((header.nonce != nonce) || (header.capacity != capacity)) {
+      return nullptr;
+    }
+    return ring;
+  }
+
+  SharedMemoryRing::SharedMemoryRing(uint64_t nonce, uint64_t capacity, bool is_owner)
+    : _nonce(nonce),
+      _capacity(capacity),
+      _is_owner(is_owner) {}
+
+  SharedMemoryRing::~SharedMemoryRing() {
+    if (_is_owner && (_memory.data() != nullptr)) {
+      SharedMemory::Remove(GetName(_nonce));
+    }
+  }
+
+  std::string SharedMemoryRing::GetName(const uint64_t nonce) {
+    char name[32u];
+    std::snprintf(
+        name, sizeof(name), "carla-stream-%016llx",
+        static_cast<unsigned long long>(nonce));
+    return name;
+  }
+
+  SharedMemoryRing::Header &SharedMemoryRing::GetHeader() const {
+    DEBUG_ASSERT(_memory.data() != nullptr);
+    return *reinterpret_cast<Header *>(_memory.data());
+  }
+
+  unsigned char *SharedMemoryRing::GetData() const {
+    return _memory.data() + sizeof(Header);
+  }
+
+  bool SharedMemoryRing::Reserve(const size_t size, uint64_t &position) const {
+    if ((size == 0u) || (size > _capacity)) {
+      return false;
+    }
+    position = _write_position;
+    const uint64_t offset = position % _capacity;
+    if (offset + size > _capacity) {
+      position += _capacity - offset;
+    }
+    const uint64_t read_position = GetHeader().read_position.load(std::memory_order_acquire);
+    return position + size - read_position <= _capacity;
+  }
+
+  bool SharedMemoryRing::Read(const uint64_t position, const size_t size, Buffer &buffer) {
+    auto &header = GetHeader();
+    const uint64_t offset = position % _capacity;
+    if ((size == 0u) ||
+        (offset + size > _capacity) ||
+        (position < header.read_position.load(std::memory_order_relaxed))) {
+      return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    buffer.copy_from(GetData() + offset, static_cast<Buffer::size_type>(size));
+    header.read_position.store(position + size, std::memory_order_release);
+    return true;
+  }
+
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,136 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/NonCopyable.h"
+#include "carla/streaming/detail/SharedMemory.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+
+  /// When a client subscribes with Transport::SharedMemory, the first message
+  /// the server sends is a SharedMemoryAnnouncement. If it announces a ring,
+  /// every following message ends with a SharedMemoryMessageKind byte;
+  /// otherwise the session goes on as a plain TCP session.
+  enum class SharedMemoryMessageKind : uint8_t {
+    /// A SharedMemoryDescriptor, the position and size of the message in
+    /// the ring.
+    Descriptor,
+    /// The message itself, sent when the ring is full.
+    Inline
+  };
+
+#pragma pack(push, 1)
+
+  struct SharedMemoryAnnouncement {
+    uint64_t nonce = 0u;
+
+    /// Zero if the server did not create a ring for this session.
+    uint64_t capacity = 0u;
+  };
+
+  struct SharedMemoryDescriptor {
+    uint64_t position = 0u;
+
+    uint32_t size = 0u;
+
+    SharedMemoryMessageKind kind = SharedMemoryMessageKind::Descriptor;
+  };
+
+#pragma pack(pop)
+
+  /// Single producer, single consumer ring buffer in shared memory, used by
+  /// the server to hand messages to a client on the same host without
+  /// pushing them through the TCP connection.
+  ///
+  /// The server writes each message contiguously and sends its position and
+  /// size through the TCP connection, which keeps them ordered. Positions
+  /// grow forever, a message that does not fit before the end of the ring
+  /// starts at the beginning of the next lap. The client copies the message
+  /// out and publishes how far it has read, the server never overwrites
+  /// what the client has not read yet.
+  class SharedMemoryRing : private NonCopyable {
+  public:
+
+    /// Create a ring of @a capacity bytes with a new random name. Return
+    /// nullptr on failure.
+    static std::unique_ptr<SharedMemoryRing> Create(size_t capacity);
+
+    /// Map the ring created with @a nonce and @a capacity. Return nullptr if
+    /// there is no such ring on this host.
+    static std::unique_ptr<SharedMemoryRing> Open(uint64_t nonce, uint64_t capacity);
+
+    ~SharedMemoryRing();
+
+    /// Random number identifying the ring, its name is derived from it.
+    uint64_t GetNonce() const {
+      return _nonce;
+    }
+
+    uint64_t GetCapacity() const {
+      return _capacity;
+    }
+
+    /// Copy the concatenation of @a buffers, of @a size bytes, to the ring.
+    /// Return false if there is not enough free space, the client is
+    /// lagging behind.
+    template <typename ConstBufferSequence>
+    bool TryWrite(const ConstBufferSequence &buffers, size_t size, uint64_t &position) {
+      if (!Reserve(size, position)) {
+        return false;
+      }
+      unsigned char *dest = GetData() + position % _capacity;
+      for (auto &&buffer : buffers) {
+        std::memcpy(dest, buffer.data(), buffer.size());
+        dest += buffer.size();
+      }
+      _write_position = position + size;
+      std::atomic_thread_fence(std::memory_order_release);
+      return true;
+    }
+
+    /// Copy the message at @a position into @a buffer and release its space.
+    /// Return false if the position is not valid.
+    bool Read(uint64_t position, size_t size, Buffer &buffer);
+
+  private:
+
+    struct Header;
+
+    SharedMemoryRing(uint64_t nonce, uint64_t capacity, bool is_owner);
+
+    static std::string GetName(uint64_t nonce);
+
+    Header &GetHeader() const;
+
+    unsigned char *GetData() const;
+
+    bool Reserve(size_t size, uint64_t &position) const;
+
+    const uint64_t _nonce;
+
+    const uint64_t _capacity;
+
+    const bool _is_owner;
+
+    SharedMemory _memory;
+
+    /// Only used by the server.
+    uint64_t _write_position = 0u;
+  };
+
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -36,6 +36,12 @@ namespace detail {
       return _shared_state->token();
     }
 
+    /// Number of clients that subscribed to this stream so far, can be used
+    /// to detect new subscribers.
+    size_t GetConnectionCount() const {
+      return _shared_state->GetConnectionCount();
+    }
+
     /// Pull a buffer from the buffer pool associated to this stream. Discarded
     /// buffers are re-used to avoid memory allocations.
     ///
@@ -7,8 +7,10 @@
 #pragma once
 
 #include "carla/Debug.h"
+#include "carla/streaming/Compression.h"
 #include "carla/streaming/EndPoint.h"
 #include "carla/streaming/Token.h"
+#include "carla/streaming/Transport.h"
 #include "carla/streaming/detail/Types.h"
 
 #include <boost/asio/ip/address.hpp>
@@ -159,11 +161,35 @@ namespace detail {
       return get_endpoint<boost::asio::ip::tcp>();
     }
 
+    /// Compression requested when subscribing with this token. Not part of
+    /// the serialized Token, it is chosen by each client.
+    Compression get_compression() const {
+      return _compression;
+    }
+
+    void set_compression(Compression compression) {
+      _compression = compression;
+    }
+
+    /// Transport requested when subscribing with this token. Like the
+    /// compression, it is not part of the serialized Token.
+    Transport get_transport() const {
+      return _transport;
+    }
+
+    void set_transport(Transport transport) {
+      _transport = transport;
+    }
+
   private:
 
     friend class Dispatcher;
 
     token_data _token;
+
+    Compression _compression = Compression::None;
+
+    Transport _transport = Transport::Tcp;
   };
 
 } // namespace detail
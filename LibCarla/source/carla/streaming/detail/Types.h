@@ -7,6 +7,8 @@
 #pragma once
 
 #include "carla/Buffer.h"
+#include "carla/streaming/Compression.h"
+#include "carla/streaming/Transport.h"
 
 #include <cstdint>
 #include <type_traits>
@@ -23,6 +25,20 @@ namespace detail {
       std::is_same<message_size_type, Buffer::size_type>::value,
       "uint type mismatch!");
 
+#pragma pack(push, 1)
+
+  /// What a client sends to the server when it connects to subscribe to a
+  /// stream.
+  struct SubscriptionRequest {
+    stream_id_type stream_id = 0u;
+
+    Compression compression = Compression::None;
+
+    Transport transport = Transport::Tcp;
+  };
+
+#pragma pack(pop)
+
 } // namespace detail
 } // namespace streaming
 } // namespace carla
@@ -11,6 +11,8 @@
 #include "carla/Exception.h"
 #include "carla/Logging.h"
 #include "carla/Time.h"
+#include "carla/streaming/detail/Compressor.h"
+#include "carla/streaming/detail/SharedMemoryRing.h"
 
 #include <boost/asio/connect.hpp>
 #include <boost/asio/read.hpp>
@@ -18,6 +20,7 @@
 #include <boost/asio/post.hpp>
 #include <boost/asio/bind_executor.hpp>
 
+#include <cstring>
 #include <exception>
 
 namespace carla {
@@ -30,11 +33,11 @@ namespace tcp {
   // ===========================================================================
 
   /// Helper for reading incoming TCP messages. Allocates the whole message in
-  /// a single buffer.
+  /// a single buffer from @a pool, once its size is known.
   class IncomingMessage {
   public:
 
-    explicit IncomingMessage(Buffer &&buffer) : _message(std::move(buffer)) {}
+    explicit IncomingMessage(std::shared_ptr<BufferPool> pool) : _pool(std::move(pool)) {}
 
     boost::asio::mutable_buffer size_as_buffer() {
       return boost::asio::buffer(&_size, sizeof(_size));
@@ -42,7 +45,7 @@ namespace tcp {
 
     boost::asio::mutable_buffer buffer() {
       DEBUG_ASSERT(_size > 0u);
-      _message.reset(_size);
+      _message = _pool->Pop(_size);
       return _message.buffer();
     }
 
@@ -56,6 +59,8 @@ namespace tcp {
 
   private:
 
+    std::shared_ptr<BufferPool> _pool;
+
     message_size_type _size = 0u;
 
     Buffer _message;
@@ -68,7 +73,8 @@ namespace tcp {
   Client::Client(
       boost::asio::io_context &io_context,
       const token_type &token,
-      callback_function_type callback)
+      callback_function_type callback,
+      std::shared_ptr<BufferPool> buffer_pool)
     : LIBCARLA_INITIALIZE_LIFETIME_PROFILER(
           std::string("tcp client ") + std::to_string(token.get_stream_id())),
       _token(token),
@@ -76,10 +82,13 @@ namespace tcp {
       _socket(io_context),
       _strand(io_context),
       _connection_timer(io_context),
-      _buffer_pool(std::make_shared<BufferPool>()) {
+      _buffer_pool(buffer_pool != nullptr ? std::move(buffer_pool) : std::make_shared<BufferPool>()) {
     if (!_token.protocol_is_tcp()) {
       throw_exception(std::invalid_argument("invalid token, only TCP tokens supported"));
     }
+    _subscription.stream_id = _token.get_stream_id();
+    _subscription.compression = _token.get_compression();
+    _subscription.transport = _token.get_transport();
   }
 
   Client::~Client() = default;
@@ -97,6 +106,9 @@ namespace tcp {
         _socket.close();
       }
 
+      _ring = nullptr;
+      _is_waiting_announcement = (_subscription.transport == Transport::SharedMemory);
+
       DEBUG_ASSERT(_token.is_valid());
       DEBUG_ASSERT(_token.protocol_is_tcp());
       const auto ep = _token.to_tcp_endpoint();
@@ -111,18 +123,17 @@ namespace tcp {
           _socket.set_option(boost::asio::ip::tcp::no_delay(true));
           log_debug("streaming client: connected to", ep);
           // Send the stream id to subscribe to the stream.
-          const auto &stream_id = _token.get_stream_id();
-          log_debug("streaming client: sending stream id", stream_id);
+          log_debug("streaming client: sending stream id", _subscription.stream_id);
           boost::asio::async_write(
               _socket,
-              boost::asio::buffer(&stream_id, sizeof(stream_id)),
+              boost::asio::buffer(&_subscription, sizeof(_subscription)),
               boost::asio::bind_executor(_strand, [=](error_code ec, size_t DEBUG_ONLY(bytes)) {
                 // Ensures to stop the execution once the connection has been stopped.
                 if (_done) {
                   return;
                 }
                 if (!ec) {
-                  DEBUG_ASSERT_EQ(bytes, sizeof(stream_id));
+                  DEBUG_ASSERT_EQ(bytes, sizeof(_subscription));
                   // If succeeded start reading data.
                   ReadData();
                 } else {
@@ -163,6 +174,73 @@ namespace tcp {
     });
   }
 
+  void Client::Dispatch(Buffer message) {
+    if (_is_waiting_announcement) {
+      _is_waiting_announcement = false;
+      OpenSharedMemory(message);
+      return;
+    }
+    if ((_ring != nullptr) && !ReadFromSharedMemory(message)) {
+      log_error("streaming client: invalid shared memory message in stream", _subscription.stream_id);
+      return;
+    }
+    if (_subscription.compression == Compression::None) {
+      _callback(std::move(message));
+      return;
+    }
+    auto decompressed = _buffer_pool->Pop(Compressor::GetMessageSize(message));
+    if (!Compressor::Decompress(message, decompressed)) {
+      log_error("streaming client: failed to decompress message of stream", _subscription.stream_id);
+      return;
+    }
+    // Return the compressed frame to the pool before running the callback.
+    message = Buffer();
+    _callback(std::move(decompressed));
+  }
+
+  void Client::OpenSharedMemory(const Buffer &message) {
+    SharedMemoryAnnouncement announcement;
+    if (message.size() != sizeof(announcement)) {
+      log_error("streaming client: invalid shared memory announcement in stream", _subscription.stream_id);
+      Connect();
+      return;
+    }
+    std::memcpy(&announcement, message.data(), sizeof(announcement));
+    if (announcement.capacity == 0u) {
+      log_debug("streaming client: stream", _subscription.stream_id, "not shared through shared memory");
+      return;
+    }
+    _ring = SharedMemoryRing::Open(announcement.nonce, announcement.capacity);
+    if (_ring == nullptr) {
+      log_info("streaming client: failed to map shared memory of stream", _subscription.stream_id, ", falling back to TCP");
+      _subscription.transport = Transport::Tcp;
+      Connect();
+    }
+  }
+
+  bool Client::ReadFromSharedMemory(Buffer &message) {
+    if (message.empty()) {
+      return false;
+    }
+    const auto kind = static_cast<SharedMemoryMessageKind>(message.data()[message.size() - 1u]);
+    if (kind == SharedMemoryMessageKind::Inline) {
+      // Drop the kind, keeping the rest of the message in place.
+      message.resize(message.size() - 1u);
+      return true;
+    }
+    SharedMemoryDescriptor descriptor;
+    if ((kind != SharedMemoryMessageKind::Descriptor) || (message.size() != sizeof(descriptor))) {
+      return false;
+    }
+    std::memcpy(&descriptor, message.data(), sizeof(descriptor));
+    auto buffer = _buffer_pool->Pop(descriptor.size);
+    if (!_ring->Read(descriptor.position, descriptor.size, buffer)) {
+      return false;
+    }
+    message = std::move(buffer);
+    return true;
+  }
+
   void Client::ReadData() {
     auto self = shared_from_this();
     boost::asio::post(_strand, [this, self]() {
@@ -172,7 +250,7 @@ namespace tcp {
 
       // log_debug("streaming client: Client::ReadData");
 
-      auto message = std::make_shared<IncomingMessage>(_buffer_pool->Pop());
+      auto message = std::make_shared<IncomingMessage>(_buffer_pool);
 
       auto handle_read_data = [this, self, message](boost::system::error_code ec, size_t DEBUG_ONLY(bytes)) {
         DEBUG_ONLY(log_debug("streaming client: Client::ReadData.handle_read_data", bytes, "bytes"));
@@ -182,7 +260,7 @@ namespace tcp {
           // Move the buffer to the callback function and start reading the next
           // piece of data.
           // log_debug("streaming client: success reading data, calling the callback");
-          boost::asio::post(_strand, [self, message]() { self->_callback(message->pop()); });
+          boost::asio::post(_strand, [self, message]() { self->Dispatch(message->pop()); });
           ReadData();
         } else {
           // As usual, if anything fails start over from the very top.
@@ -27,10 +27,18 @@ namespace carla {
 
 namespace streaming {
 namespace detail {
+
+  class SharedMemoryRing;
+
 namespace tcp {
 
   /// A client that connects to a single stream.
   ///
+  /// If the token asks for Transport::SharedMemory, the client maps the ring
+  /// the server announces and copies each message out of it. If the ring
+  /// cannot be mapped, e.g. the server runs on another host, it reconnects
+  /// asking for Transport::Tcp.
+  ///
   /// @warning This client should be stopped before releasing the shared pointer
   /// or won't be destroyed.
   class Client
@@ -43,10 +51,13 @@ namespace tcp {
     using protocol_type = endpoint::protocol_type;
     using callback_function_type = std::function<void (Buffer)>;
 
+    /// Incoming messages are allocated from @a buffer_pool, or from a pool of
+    /// this client if null.
     Client(
         boost::asio::io_context &io_context,
         const token_type &token,
-        callback_function_type callback);
+        callback_function_type callback,
+        std::shared_ptr<BufferPool> buffer_pool = nullptr);
 
     ~Client();
 
@@ -64,8 +75,20 @@ namespace tcp {
 
     void ReadData();
 
+    /// Decompress @a message if needed and pass it to the callback.
+    void Dispatch(Buffer message);
+
+    /// Map the ring announced in @a message, or fall back to TCP.
+    void OpenSharedMemory(const Buffer &message);
+
+    /// Replace @a message, a descriptor or an inline message, by the message
+    /// it refers to. Return false if it is malformed.
+    bool ReadFromSharedMemory(Buffer &message);
+
     const token_type _token;
 
+    SubscriptionRequest _subscription;
+
     callback_function_type _callback;
 
     boost::asio::ip::tcp::socket _socket;
@@ -76,6 +99,14 @@ namespace tcp {
 
     std::shared_ptr<BufferPool> _buffer_pool;
 
+    /// @{
+    /// State of the shared memory transport of the current connection, only
+    /// accessed from within the strand.
+    bool _is_waiting_announcement = false;
+
+    std::unique_ptr<SharedMemoryRing> _ring;
+    /// @}
+
     std::atomic_bool _done{false};
   };
 
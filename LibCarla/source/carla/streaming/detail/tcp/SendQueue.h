@@ -0,0 +1,96 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace tcp {
+
+  /// What a server session does with a new message when its send queue is
+  /// full.
+  enum class SendQueuePolicy : uint8_t {
+    /// Discard the oldest message in the queue to make room for the new one.
+    DropOldest,
+    /// Discard the new message.
+    DropNewest,
+    /// Block the writer until there is room in the queue, or until the
+    /// session times out.
+    Block
+  };
+
+  /// Snapshot of the send queue counters of a server.
+  struct SendQueueStatistics {
+    /// Number of messages discarded because a send queue was full.
+    size_t dropped_messages = 0u;
+    /// Number of messages currently waiting in the send queues.
+    size_t queued_messages = 0u;
+    /// Maximum number of messages ever waiting in a single send queue.
+    size_t max_queue_depth = 0u;
+    /// Number of socket writes issued, each one may coalesce several messages.
+    size_t number_of_writes = 0u;
+    /// Number of messages successfully sent.
+    size_t sent_messages = 0u;
+  };
+
+  /// Thread-safe send queue counters shared by all the sessions of a server.
+  class SendQueueCounters : private NonCopyable {
+  public:
+
+    void AddDropped() {
+      ++_dropped_messages;
+    }
+
+    void AddQueued(size_t queue_depth) {
+      ++_queued_messages;
+      auto max = _max_queue_depth.load();
+      while ((max < queue_depth) &&
+             !_max_queue_depth.compare_exchange_weak(max, queue_depth));
+    }
+
+    void RemoveQueued(size_t count) {
+      _queued_messages -= count;
+    }
+
+    void AddWrite(size_t number_of_messages) {
+      ++_number_of_writes;
+      _sent_messages += number_of_messages;
+    }
+
+    SendQueueStatistics GetStatistics() const {
+      SendQueueStatistics stats;
+      stats.dropped_messages = _dropped_messages;
+      stats.queued_messages = _queued_messages;
+      stats.max_queue_depth = _max_queue_depth;
+      stats.number_of_writes = _number_of_writes;
+      stats.sent_messages = _sent_messages;
+      return stats;
+    }
+
+  private:
+
+    std::atomic_size_t _dropped_messages{0u};
+
+    std::atomic_size_t _queued_messages{0u};
+
+    std::atomic_size_t _max_queue_depth{0u};
+
+    std::atomic_size_t _number_of_writes{0u};
+
+    std::atomic_size_t _sent_messages{0u};
+  };
+
+} // namespace tcp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -8,6 +8,7 @@
 
 #include <boost/asio/post.hpp>
 
+#include "carla/BufferPool.h"
 #include "carla/Logging.h"
 
 #include <memory>
@@ -21,7 +22,11 @@ namespace tcp {
     : _io_context(io_context),
       _acceptor(_io_context, std::move(ep)),
       _timeout(time_duration::seconds(10u)),
-      _synchronous(false) {}
+      _synchronous(false),
+      _send_queue_capacity(4u),
+      _send_queue_policy(SendQueuePolicy::DropOldest),
+      _shared_memory_size(32u << 20u),
+      _buffer_pool(std::make_shared<BufferPool>()) {}
 
   void Server::OpenSession(
       time_duration timeout,
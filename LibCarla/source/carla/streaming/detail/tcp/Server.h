@@ -8,6 +8,7 @@
 
 #include "carla/NonCopyable.h"
 #include "carla/Time.h"
+#include "carla/streaming/detail/tcp/SendQueue.h"
 #include "carla/streaming/detail/tcp/ServerSession.h"
 
 #include <boost/asio/io_context.hpp>
@@ -15,6 +16,7 @@
 #include <boost/asio/post.hpp>
 
 #include <atomic>
+#include <memory>
 
 namespace carla {
 namespace streaming {
@@ -62,6 +64,53 @@ namespace tcp {
       return _synchronous;
     }
 
+    /// Set the maximum number of messages each session keeps waiting to be
+    /// sent. Applies only to newly created sessions. By default 4 messages.
+    void SetSendQueueCapacity(size_t capacity) {
+      _send_queue_capacity = capacity;
+    }
+
+    size_t GetSendQueueCapacity() const {
+      return _send_queue_capacity;
+    }
+
+    /// Set what sessions do when their send queue is full. Applies only to
+    /// newly created sessions, and is ignored in synchronous mode where
+    /// writers always block. By default the oldest message is dropped.
+    void SetSendQueuePolicy(SendQueuePolicy policy) {
+      _send_queue_policy = policy;
+    }
+
+    SendQueuePolicy GetSendQueuePolicy() const {
+      return _send_queue_policy;
+    }
+
+    /// Set the maximum size in bytes of the shared memory ring buffer created
+    /// for each session of a client on this host that asks for
+    /// Transport::SharedMemory, zero disables it. Each ring is sized after the
+    /// first messages of its stream, up to this limit. Applies only to newly
+    /// created sessions. By default 32 MiB.
+    void SetSharedMemorySize(size_t size) {
+      _shared_memory_size = size;
+    }
+
+    size_t GetSharedMemorySize() const {
+      return _shared_memory_size;
+    }
+
+    /// Pool shared by the sessions for the messages they compress or frame.
+    const std::shared_ptr<BufferPool> &GetBufferPool() const {
+      return _buffer_pool;
+    }
+
+    SendQueueCounters &GetSendQueueCounters() {
+      return _send_queue_counters;
+    }
+
+    SendQueueStatistics GetSendQueueStatistics() const {
+      return _send_queue_counters.GetStatistics();
+    }
+
   private:
 
     void OpenSession(
@@ -76,6 +125,16 @@ namespace tcp {
     std::atomic<time_duration> _timeout;
 
     bool _synchronous;
+
+    std::atomic_size_t _send_queue_capacity;
+
+    std::atomic<SendQueuePolicy> _send_queue_policy;
+
+    std::atomic_size_t _shared_memory_size;
+
+    SendQueueCounters _send_queue_counters;
+
+    const std::shared_ptr<BufferPool> _buffer_pool;
   };
 
 } // namespace tcp
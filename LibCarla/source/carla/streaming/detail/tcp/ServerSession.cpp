@@ -7,16 +7,21 @@
 #include "carla/streaming/detail/tcp/ServerSession.h"
 #include "carla/streaming/detail/tcp/Server.h"
 
+#include "carla/BufferPool.h"
 #include "carla/Debug.h"
 #include "carla/Logging.h"
+#include "carla/streaming/detail/Compressor.h"
+#include "carla/streaming/detail/SharedMemoryRing.h"
 
+#include <boost/asio/buffer.hpp>
 #include <boost/asio/read.hpp>
 #include <boost/asio/write.hpp>
 #include <boost/asio/bind_executor.hpp>
 #include <boost/asio/post.hpp>
 
+#include <algorithm>
 #include <atomic>
-#include <thread>
+#include <iterator>
 
 namespace carla {
 namespace streaming {
@@ -36,7 +41,12 @@ namespace tcp {
       _socket(io_context),
       _timeout(timeout),
       _deadline(io_context),
-      _strand(io_context) {}
+      _strand(io_context),
+      _policy(server.GetSendQueuePolicy()),
+      _queue(std::max<size_t>(1u, server.GetSendQueueCapacity())),
+      _buffer_pool(server.GetBufferPool()) {}
+
+  ServerSession::~ServerSession() = default;
 
   void ServerSession::Open(
       callback_function_type on_opened,
@@ -57,8 +67,17 @@ namespace tcp {
           const boost::system::error_code &ec,
           size_t DEBUG_ONLY(bytes_received)) {
         if (!ec) {
-          DEBUG_ASSERT_EQ(bytes_received, sizeof(_stream_id));
-          log_debug("session", _session_id, "for stream", _stream_id, " started");
+          DEBUG_ASSERT_EQ(bytes_received, sizeof(_subscription));
+          if ((_subscription.compression > Compression::LZ4Bgra) ||
+              (_subscription.transport > Transport::SharedMemory)) {
+            log_error("session", _session_id, ": invalid subscription requested");
+            CloseNow();
+            return;
+          }
+          log_debug("session", _session_id, "for stream", _subscription.stream_id, " started");
+          // The shared memory ring is sized from the first messages, it is
+          // announced together with them.
+          _is_announcement_pending = (_subscription.transport == Transport::SharedMemory);
           boost::asio::post(_strand.context(), [=]() { callback(self); });
         } else {
           log_error("session", _session_id, ": error retrieving stream id :", ec.message());
@@ -70,7 +89,7 @@ namespace tcp {
       _deadline.expires_from_now(_timeout);
       boost::asio::async_read(
           _socket,
-          boost::asio::buffer(&_stream_id, sizeof(_stream_id)),
+          boost::asio::buffer(&_subscription, sizeof(_subscription)),
           boost::asio::bind_executor(_strand, handle_query));
     });
   }
@@ -78,44 +97,207 @@ namespace tcp {
   void ServerSession::Write(std::shared_ptr<const Message> message) {
     DEBUG_ASSERT(message != nullptr);
     DEBUG_ASSERT(!message->empty());
-    auto self = shared_from_this();
-    boost::asio::post(_strand, [=]() {
-      if (!_socket.is_open()) {
-        return;
-      }
-      if (_is_writing) {
-        if (_server.IsSynchronousMode()) {
-          // wait until previous message has been sent
-          while (_is_writing) {
-            std::this_thread::yield();
+    auto &counters = _server.GetSendQueueCounters();
+    std::unique_lock<std::mutex> lock(_queue_mutex);
+    if (_is_closed) {
+      return;
+    }
+    if (_queue.full()) {
+      const auto policy = _server.IsSynchronousMode() ? SendQueuePolicy::Block : _policy;
+      switch (policy) {
+        case SendQueuePolicy::Block: {
+          // Apply back-pressure on the writer until the queue has room again.
+          const bool has_room = _queue_condition.wait_for(
+              lock,
+              _timeout.to_chrono(),
+              [this]() { return _is_closed || !_queue.full(); });
+          if (_is_closed) {
+            return;
           }
-        } else {
-          // ignore this message
+          if (!has_room) {
+            log_debug("session", _session_id, ": connection too slow: message discarded");
+            counters.AddDropped();
+            return;
+          }
+          break;
+        }
+        case SendQueuePolicy::DropNewest:
           log_debug("session", _session_id, ": connection too slow: message discarded");
+          counters.AddDropped();
           return;
-        }      
+        case SendQueuePolicy::DropOldest:
+          log_debug("session", _session_id, ": connection too slow: oldest message discarded");
+          _queue.pop_front();
+          counters.RemoveQueued(1u);
+          counters.AddDropped();
+          break;
       }
+    }
+    _queue.push_back(std::move(message));
+    counters.AddQueued(_queue.size());
+    if (!_is_writing) {
       _is_writing = true;
+      boost::asio::post(_strand, [self=shared_from_this()]() {
+        self->WriteQueuedMessages();
+      });
+    }
+  }
 
-      auto handle_sent = [this, self, message](const boost::system::error_code &ec, size_t DEBUG_ONLY(bytes)) {
+  void ServerSession::WriteQueuedMessages() {
+    DEBUG_ASSERT(_messages_in_flight.empty());
+    {
+      std::lock_guard<std::mutex> lock(_queue_mutex);
+      if (_queue.empty() || _is_closed) {
         _is_writing = false;
-        if (ec) {
-          log_info("session", _session_id, ": error sending data :", ec.message());
-          CloseNow();
-        } else {
-          DEBUG_ONLY(log_debug("session", _session_id, ": successfully sent", bytes, "bytes"));
-          DEBUG_ASSERT_EQ(bytes, sizeof(message_size_type) + message->size());
+        return;
+      }
+      _messages_in_flight.assign(
+          std::make_move_iterator(_queue.begin()),
+          std::make_move_iterator(_queue.end()));
+      _queue.clear();
+      _server.GetSendQueueCounters().RemoveQueued(_messages_in_flight.size());
+    }
+    _queue_condition.notify_all();
+
+    if (_subscription.compression != Compression::None) {
+      CompressMessagesInFlight();
+    }
+
+    _buffer_sequence.clear();
+    if (_is_announcement_pending) {
+      AnnounceSharedMemory();
+    }
+    if (_ring != nullptr) {
+      MakeSharedMemoryBufferSequence();
+    } else {
+      for (auto &message : _messages_in_flight) {
+        for (auto &&buffer : message->GetBufferSequence()) {
+          _buffer_sequence.emplace_back(buffer);
         }
-      };
+      }
+    }
 
-      log_debug("session", _session_id, ": sending message of", message->size(), "bytes");
+    auto handle_sent = [this, self=shared_from_this()](
+        const boost::system::error_code &ec,
+        size_t DEBUG_ONLY(bytes)) {
+      const auto number_of_messages = _messages_in_flight.size();
+      _messages_in_flight.clear();
+      _shared_memory_framing.clear();
+      if (ec) {
+        log_info("session", _session_id, ": error sending data :", ec.message());
+        CloseNow();
+      } else {
+        DEBUG_ONLY(log_debug("session", _session_id, ": successfully sent", bytes, "bytes"));
+        DEBUG_ASSERT_EQ(bytes, boost::asio::buffer_size(_buffer_sequence));
+        _server.GetSendQueueCounters().AddWrite(number_of_messages);
+        WriteQueuedMessages();
+      }
+    };
 
-      _deadline.expires_from_now(_timeout);
-      boost::asio::async_write(
-          _socket,
-          message->GetBufferSequence(),
-          handle_sent);
-    });
+    log_debug("session", _session_id, ": sending", _messages_in_flight.size(), "messages");
+
+    _deadline.expires_from_now(_timeout);
+    boost::asio::async_write(
+        _socket,
+        _buffer_sequence,
+        boost::asio::bind_executor(_strand, handle_sent));
+  }
+
+  void ServerSession::CompressMessagesInFlight() {
+    for (auto &message : _messages_in_flight) {
+      auto frame = _buffer_pool->Pop(Compressor::GetMaxFrameSize(message->size()));
+      Compressor::Compress(_subscription.compression, message->GetPayloadBufferSequence(), frame);
+      message = MakeMessage(std::move(frame));
+    }
+  }
+
+  bool ServerSession::IsClientOnSameHost() {
+    boost::system::error_code ec;
+    const auto remote = _socket.remote_endpoint(ec).address();
+    if (ec) {
+      return false;
+    }
+    const auto local = _socket.local_endpoint(ec).address();
+    return !ec && (remote.is_loopback() || (remote == local));
+  }
+
+  void ServerSession::AnnounceSharedMemory() {
+    DEBUG_ASSERT(_is_announcement_pending);
+    _is_announcement_pending = false;
+    const size_t max_capacity = _server.GetSharedMemorySize();
+    size_t message_size = 0u;
+    for (auto &message : _messages_in_flight) {
+      message_size = std::max<size_t>(message_size, message->size());
+    }
+    size_t number_of_messages;
+    {
+      std::lock_guard<std::mutex> lock(_queue_mutex);
+      number_of_messages = _queue.capacity();
+    }
+    // Room for a full send queue plus the message the client is reading,
+    // rounded up to whole pages. Bigger messages that may come later are
+    // sent inline.
+    constexpr size_t page_size = 4096u;
+    const size_t capacity = std::min(
+        max_capacity,
+        (message_size * (number_of_messages + 1u) + page_size - 1u) / page_size * page_size);
+    if ((capacity > 0u) && (capacity >= message_size) && IsClientOnSameHost()) {
+      // On failure, for instance if /dev/shm is full, the session goes on
+      // through TCP.
+      _ring = SharedMemoryRing::Create(capacity);
+    }
+
+#pragma pack(push, 1)
+    struct AnnouncementMessage {
+      message_size_type size = sizeof(SharedMemoryAnnouncement);
+      SharedMemoryAnnouncement announcement;
+    };
+#pragma pack(pop)
+    AnnouncementMessage announcement_message;
+    if (_ring != nullptr) {
+      announcement_message.announcement.nonce = _ring->GetNonce();
+      announcement_message.announcement.capacity = _ring->GetCapacity();
+      log_debug("session", _session_id, ": sending through shared memory of", capacity, "bytes");
+    }
+    auto framing = _buffer_pool->Pop(sizeof(announcement_message));
+    framing.copy_from(reinterpret_cast<const unsigned char *>(&announcement_message), sizeof(announcement_message));
+    _buffer_sequence.emplace_back(framing.cbuffer());
+    _shared_memory_framing.emplace_back(std::move(framing));
+  }
+
+  void ServerSession::MakeSharedMemoryBufferSequence() {
+#pragma pack(push, 1)
+    struct DescriptorMessage {
+      message_size_type size = sizeof(SharedMemoryDescriptor);
+      SharedMemoryDescriptor descriptor;
+    };
+    struct InlineFraming {
+      message_size_type size;
+      SharedMemoryMessageKind kind = SharedMemoryMessageKind::Inline;
+    };
+#pragma pack(pop)
+    for (auto &message : _messages_in_flight) {
+      auto framing = _buffer_pool->Pop(sizeof(DescriptorMessage));
+      DescriptorMessage descriptor_message;
+      auto &descriptor = descriptor_message.descriptor;
+      descriptor.size = message->size();
+      if (_ring->TryWrite(message->GetPayloadBufferSequence(), descriptor.size, descriptor.position)) {
+        framing.copy_from(reinterpret_cast<const unsigned char *>(&descriptor_message), sizeof(descriptor_message));
+        _buffer_sequence.emplace_back(framing.cbuffer());
+      } else {
+        // Send the message itself, followed by its kind, without copying it.
+        log_debug("session", _session_id, ": shared memory full, sending message inline");
+        InlineFraming inline_framing;
+        inline_framing.size = message->size() + 1u;
+        framing.copy_from(reinterpret_cast<const unsigned char *>(&inline_framing), sizeof(inline_framing));
+        _buffer_sequence.emplace_back(framing.data(), sizeof(message_size_type));
+        for (auto &&buffer : message->GetPayloadBufferSequence()) {
+          _buffer_sequence.emplace_back(buffer);
+        }
+        _buffer_sequence.emplace_back(framing.data() + sizeof(message_size_type), 1u);
+      }
+      _shared_memory_framing.emplace_back(std::move(framing));
+    }
   }
 
   void ServerSession::Close() {
@@ -138,6 +320,14 @@ namespace tcp {
   }
 
   void ServerSession::CloseNow() {
+    {
+      std::lock_guard<std::mutex> lock(_queue_mutex);
+      _is_closed = true;
+      _is_writing = false;
+      _server.GetSendQueueCounters().RemoveQueued(_queue.size());
+      _queue.clear();
+    }
+    _queue_condition.notify_all();
     _deadline.cancel();
     if (_socket.is_open()) {
       _socket.close();
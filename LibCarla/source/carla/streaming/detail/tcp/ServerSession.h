@@ -12,25 +12,52 @@
 #include "carla/profiler/LifetimeProfiled.h"
 #include "carla/streaming/detail/Types.h"
 #include "carla/streaming/detail/tcp/Message.h"
+#include "carla/streaming/detail/tcp/SendQueue.h"
 
 #include <boost/asio/deadline_timer.hpp>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/strand.hpp>
+#include <boost/circular_buffer.hpp>
 
+#include <condition_variable>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace carla {
+
+  class BufferPool;
+
 namespace streaming {
 namespace detail {
+
+  class SharedMemoryRing;
+
 namespace tcp {
 
   class Server;
 
   /// A TCP server session. When a session opens, it reads from the socket a
-  /// stream id object and passes itself to the callback functor. The session
-  /// closes itself after @a timeout of inactivity is met.
+  /// SubscriptionRequest and passes itself to the callback functor. The
+  /// session closes itself after @a timeout of inactivity is met.
+  ///
+  /// Outgoing messages are kept in a bounded send queue, when the queue is
+  /// full the server's SendQueuePolicy decides which message is discarded (in
+  /// synchronous mode the writer always blocks). Every message queued while a
+  /// write is in progress is sent together in a single scatter-gather write.
+  ///
+  /// If the client requested compression, the messages are compressed right
+  /// before being written, on the session's strand, so the writer never pays
+  /// for it. Each session compresses its own copy.
+  ///
+  /// If the client requested Transport::SharedMemory and runs on the same
+  /// host, the session creates a SharedMemoryRing with its first write, sized
+  /// after the messages of the stream, and announces it to the client ahead
+  /// of them. From then on the messages are copied to the ring and only their
+  /// descriptors go through the socket, except when the ring is full, then
+  /// the message is sent inline.
   class ServerSession
     : public std::enable_shared_from_this<ServerSession>,
       private profiler::LifetimeProfiled,
@@ -45,6 +72,8 @@ namespace tcp {
         time_duration timeout,
         Server &server);
 
+    ~ServerSession();
+
     /// Starts the session and calls @a on_opened after successfully reading the
     /// stream id, and @a on_closed once the session is closed.
     void Open(
@@ -54,7 +83,7 @@ namespace tcp {
     /// @warning This function should only be called after the session is
     /// opened. It is safe to call this function from within the @a callback.
     stream_id_type get_stream_id() const {
-      return _stream_id;
+      return _subscription.stream_id;
     }
 
     template <typename... Buffers>
@@ -65,7 +94,7 @@ namespace tcp {
       return std::make_shared<const Message>(std::move(buffers)...);
     }
 
-    /// Writes some data to the socket.
+    /// Queues a message to be written to the socket.
     void Write(std::shared_ptr<const Message> message);
 
     /// Writes some data to the socket.
@@ -81,15 +110,34 @@ namespace tcp {
 
     void StartTimer();
 
+    /// Sends every queued message in a single write. Must be called from
+    /// within the strand.
+    void WriteQueuedMessages();
+
     void CloseNow();
 
+    /// Replace the messages in flight by their compressed frames.
+    void CompressMessagesInFlight();
+
+    bool IsClientOnSameHost();
+
+    /// Create the shared memory ring if possible, sized from the messages in
+    /// flight, and add its announcement to the buffer sequence. Must be
+    /// called from within the strand.
+    void AnnounceSharedMemory();
+
+    /// Copy the messages in flight to the ring and fill the buffer sequence
+    /// with their descriptors, or with the messages themselves if the ring is
+    /// full.
+    void MakeSharedMemoryBufferSequence();
+
     friend class Server;
 
     Server &_server;
 
     const size_t _session_id;
 
-    stream_id_type _stream_id = 0u;
+    SubscriptionRequest _subscription;
 
     socket_type _socket;
 
@@ -101,7 +149,41 @@ namespace tcp {
 
     callback_function_type _on_closed;
 
+    const SendQueuePolicy _policy;
+
+    std::mutex _queue_mutex;
+
+    std::condition_variable _queue_condition;
+
+    boost::circular_buffer<std::shared_ptr<const Message>> _queue;
+
     bool _is_writing = false;
+
+    bool _is_closed = false;
+
+    /// Messages being written, only accessed from within the strand.
+    std::vector<std::shared_ptr<const Message>> _messages_in_flight;
+
+    /// Buffer sequence of the messages being written, only accessed from
+    /// within the strand.
+    std::vector<boost::asio::const_buffer> _buffer_sequence;
+
+    /// Memory of the compressed frames and of the shared memory descriptors,
+    /// reused from one write to the next. Shared by every session of the
+    /// server.
+    std::shared_ptr<BufferPool> _buffer_pool;
+
+    /// Header and trailer of each message in flight when using shared
+    /// memory, only accessed from within the strand.
+    std::vector<Buffer> _shared_memory_framing;
+
+    /// Set if the client asked for shared memory and the announcement has not
+    /// been sent yet, only accessed from within the strand.
+    bool _is_announcement_pending = false;
+
+    /// Set if the client asked for shared memory and runs on this host, only
+    /// accessed from within the strand.
+    std::unique_ptr<SharedMemoryRing> _ring;
   };
 
 } // namespace tcp
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "carla/BufferPool.h"
 #include "carla/streaming/detail/Token.h"
 #include "carla/streaming/detail/tcp/Client.h"
 
@@ -19,7 +20,8 @@ namespace streaming {
 namespace low_level {
 
   /// A client able to subscribe to multiple streams. Accepts an external
-  /// io_context.
+  /// io_context. The messages of every stream are allocated from a single
+  /// BufferPool.
   ///
   /// @warning The client should not be destroyed before the @a io_context is
   /// stopped.
@@ -60,7 +62,8 @@ namespace low_level {
       auto client = std::make_shared<underlying_client>(
           io_context,
           token,
-          std::forward<Functor>(callback));
+          std::forward<Functor>(callback),
+          _buffer_pool);
       client->Connect();
       _clients.emplace(token.get_stream_id(), std::move(client));
     }
@@ -73,10 +76,16 @@ namespace low_level {
       }
     }
 
+    BufferPool &GetBufferPool() {
+      return *_buffer_pool;
+    }
+
   private:
 
     boost::asio::ip::address _fallback_address;
 
+    const std::shared_ptr<BufferPool> _buffer_pool = std::make_shared<BufferPool>();
+
     std::unordered_map<
         detail::stream_id_type,
         std::shared_ptr<underlying_client>> _clients;
@@ -68,6 +68,22 @@ namespace low_level {
       _server.SetSynchronousMode(is_synchro);
     }
 
+    void SetSendQueueCapacity(size_t capacity) {
+      _server.SetSendQueueCapacity(capacity);
+    }
+
+    void SetSendQueuePolicy(detail::tcp::SendQueuePolicy policy) {
+      _server.SetSendQueuePolicy(policy);
+    }
+
+    void SetSharedMemorySize(size_t size) {
+      _server.SetSharedMemorySize(size);
+    }
+
+    detail::tcp::SendQueueStatistics GetSendQueueStatistics() const {
+      return _server.GetSendQueueStatistics();
+    }
+
   private:
 
     void StartServer() {
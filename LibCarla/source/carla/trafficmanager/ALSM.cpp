@@ -50,11 +50,12 @@ void ALSM::Update() {
   std::set<ActorId> world_pedestrian_ids;
   std::vector<ActorId> unregistered_list_to_be_deleted;
 
-  current_timestamp = world.GetSnapshot().GetTimestamp();
-  ActorList world_actors = world.GetActors();
+  // Every actor state of this cycle is read from the same snapshot.
+  const cc::WorldSnapshot world_snapshot = world.GetSnapshot();
+  current_timestamp = world_snapshot.GetTimestamp();
 
   // Find destroyed actors and perform clean up.
-  const ALSM::DestroyeddActors destroyed_actors = IdentifyDestroyedActors(world_actors);
+  const ALSM::DestroyeddActors destroyed_actors = IdentifyDestroyedActors(world_snapshot);
 
   const ActorIdSet &destroyed_registered = destroyed_actors.first;
   for (const auto &deletion_id: destroyed_registered) {
@@ -84,11 +85,11 @@ void ALSM::Update() {
   }
 
   // Scan for new unregistered actors.
-  IdentifyNewActors(world_actors);
+  IdentifyNewActors(world_snapshot);
 
   // Update dynamic state and static attributes for all registered vehicles.
   ALSM::IdleInfo max_idle_time = std::make_pair(0u, current_timestamp.elapsed_seconds);
-  UpdateRegisteredActorsData(hybrid_physics_mode, max_idle_time);
+  UpdateRegisteredActorsData(hybrid_physics_mode, max_idle_time, world_snapshot);
 
   // Destroy registered vehicle if stuck at a location for too long.
   if (IsVehicleStuck(max_idle_time.first)
@@ -109,47 +110,52 @@ void ALSM::Update() {
   }
 
   // Update dynamic state and static attributes for unregistered actors.
-  UpdateUnregisteredActorsData();
+  UpdateUnregisteredActorsData(world_snapshot);
 }
 
-void ALSM::IdentifyNewActors(const ActorList &actor_list) {
-  for (auto iter = actor_list->begin(); iter != actor_list->end(); ++iter) {
+void ALSM::IdentifyNewActors(const cc::WorldSnapshot &world_snapshot) {
+  // Only the actors seen for the first time are retrieved from the episode.
+  std::vector<ActorId> new_actor_ids;
+  for (const cc::ActorSnapshot &actor_snapshot : world_snapshot) {
+    const ActorId actor_id = actor_snapshot.id;
+    if (!registered_vehicles.Contains(actor_id)
+        && unregistered_actors.find(actor_id) == unregistered_actors.end()) {
+      new_actor_ids.push_back(actor_id);
+    }
+  }
+  if (new_actor_ids.empty()) {
+    return;
+  }
+
+  ActorList new_actors = world.GetActors(new_actor_ids);
+  for (auto iter = new_actors->begin(); iter != new_actors->end(); ++iter) {
     ActorPtr actor = *iter;
-    ActorId actor_id = actor->GetId();
     // Identify any new hero vehicle
     if (actor->GetTypeId().front() == 'v') {
-     if (hero_actors.size() == 0u || hero_actors.find(actor_id) == hero_actors.end()) {
-      for (auto&& attribute: actor->GetAttributes()) {
-        if (attribute.GetId() == "role_name" && attribute.GetValue() == "hero") {
-          hero_actors.insert({actor_id, actor});
-        }
-      }
+      IdentifyHeroActor(actor);
     }
+    unregistered_actors.insert({actor->GetId(), actor});
   }
-    if (!registered_vehicles.Contains(actor_id)
-        && unregistered_actors.find(actor_id) == unregistered_actors.end()) {
+}
 
-      unregistered_actors.insert({actor_id, actor});
+void ALSM::IdentifyHeroActor(const ActorPtr &vehicle) {
+  for (auto&& attribute: vehicle->GetAttributes()) {
+    if (attribute.GetId() == "role_name" && attribute.GetValue() == "hero") {
+      hero_actors.insert({vehicle->GetId(), vehicle});
     }
   }
 }
 
-ALSM::DestroyeddActors ALSM::IdentifyDestroyedActors(const ActorList &actor_list) {
+ALSM::DestroyeddActors ALSM::IdentifyDestroyedActors(const cc::WorldSnapshot &world_snapshot) {
 
   ALSM::DestroyeddActors destroyed_actors;
   ActorIdSet &deleted_registered = destroyed_actors.first;
   ActorIdSet &deleted_unregistered = destroyed_actors.second;
 
-  // Building hash set of actors present in current frame.
-  ActorIdSet current_actors;
-  for  (auto iter = actor_list->begin(); iter != actor_list->end(); ++iter) {
-    current_actors.insert((*iter)->GetId());
-  }
-
   // Searching for destroyed registered actors.
   std::vector<ActorId> registered_ids = registered_vehicles.GetIDList();
   for (const ActorId &actor_id : registered_ids) {
-    if (current_actors.find(actor_id) == current_actors.end()) {
+    if (!world_snapshot.Contains(actor_id)) {
       deleted_registered.insert(actor_id);
     }
   }
@@ -157,7 +163,7 @@ ALSM::DestroyeddActors ALSM::IdentifyDestroyedActors(const ActorList &actor_list
   // Searching for destroyed unregistered actors.
   for (const auto &actor_info: unregistered_actors) {
     const ActorId &actor_id = actor_info.first;
-     if (current_actors.find(actor_id) == current_actors.end()
+     if (!world_snapshot.Contains(actor_id)
          || registered_vehicles.Contains(actor_id)) {
       deleted_unregistered.insert(actor_id);
     }
@@ -166,9 +172,17 @@ ALSM::DestroyeddActors ALSM::IdentifyDestroyedActors(const ActorList &actor_list
   return destroyed_actors;
 }
 
-void ALSM::UpdateRegisteredActorsData(const bool hybrid_physics_mode, ALSM::IdleInfo &max_idle_time) {
+void ALSM::UpdateRegisteredActorsData(const bool hybrid_physics_mode,
+                                      ALSM::IdleInfo &max_idle_time,
+                                      const cc::WorldSnapshot &world_snapshot) {
 
   std::vector<ActorPtr> vehicle_list = registered_vehicles.GetList();
+  // The role of newly registered vehicles is checked once.
+  for (const Actor &vehicle : vehicle_list) {
+    if (!simulation_state.ContainsActor(vehicle->GetId())) {
+      IdentifyHeroActor(vehicle);
+    }
+  }
   bool hero_actor_present = hero_actors.size() != 0u;
   float physics_radius = parameters.GetHybridPhysicsRadius();
   float physics_radius_square = SQUARE(physics_radius);
@@ -178,29 +192,38 @@ void ALSM::UpdateRegisteredActorsData(const bool hybrid_physics_mode, ALSM::Idle
   }
   // Update first the information regarding any hero vehicle.
   for (auto &hero_actor_info: hero_actors){
+    const auto hero_snapshot = world_snapshot.Find(hero_actor_info.first);
+    if (!hero_snapshot) {
+      continue;
+    }
     if (is_respawn_vehicles) {
-      track_traffic.SetHeroLocation(hero_actor_info.second->GetTransform().location);
+      track_traffic.SetHeroLocation(hero_snapshot->transform.location);
     }
-    UpdateData(hybrid_physics_mode, max_idle_time, hero_actor_info.second, hero_actor_present, physics_radius_square);
+    UpdateData(hybrid_physics_mode, max_idle_time, hero_actor_info.second, *hero_snapshot,
+               hero_actor_present, physics_radius_square);
   }
   // Update information for all other registered vehicles.
   for (const Actor &vehicle : vehicle_list) {
     ActorId actor_id = vehicle->GetId();
     if (hero_actors.find(actor_id) == hero_actors.end()) {
-      UpdateData(hybrid_physics_mode, max_idle_time, vehicle, hero_actor_present, physics_radius_square);
+      const auto vehicle_snapshot = world_snapshot.Find(actor_id);
+      if (vehicle_snapshot) {
+        UpdateData(hybrid_physics_mode, max_idle_time, vehicle, *vehicle_snapshot,
+                   hero_actor_present, physics_radius_square);
+      }
     }
   }
 }
 
 void ALSM::UpdateData(const bool hybrid_physics_mode,
                       ALSM::IdleInfo &max_idle_time, const Actor &vehicle,
+                      const cc::ActorSnapshot &vehicle_snapshot,
                       const bool hero_actor_present, const float physics_radius_square) {
 
-  ActorId actor_id = vehicle->GetId();
-  cg::Transform vehicle_transform = vehicle->GetTransform();
-  cg::Location vehicle_location = vehicle_transform.location;
-  cg::Rotation vehicle_rotation = vehicle_transform.rotation;
-  cg::Vector3D vehicle_velocity = vehicle->GetVelocity();
+  ActorId actor_id = vehicle_snapshot.id;
+  cg::Location vehicle_location = vehicle_snapshot.transform.location;
+  cg::Rotation vehicle_rotation = vehicle_snapshot.transform.rotation;
+  cg::Vector3D vehicle_velocity = vehicle_snapshot.velocity;
 
   // Initializing idle times.
   if (idle_time.find(actor_id) == idle_time.end() && current_timestamp.elapsed_seconds != 0.0) {
@@ -247,13 +270,13 @@ void ALSM::UpdateData(const bool hybrid_physics_mode,
   }
 
   // Updated kinematic state object.
-  auto vehicle_ptr = boost::static_pointer_cast<cc::Vehicle>(vehicle);
+  const auto &vehicle_data = vehicle_snapshot.state.vehicle_data;
   KinematicState kinematic_state{vehicle_location, vehicle_rotation,
-                                  vehicle_velocity, vehicle_ptr->GetSpeedLimit(),
-                                  enable_physics, vehicle->IsDormant()};
+                                  vehicle_velocity, vehicle_data.speed_limit,
+                                  enable_physics, vehicle_snapshot.actor_state == rpc::ActorState::Dormant};
 
   // Updated traffic light state object.
-  TrafficLightState tl_state = {vehicle_ptr->GetTrafficLightState(), vehicle_ptr->IsAtTrafficLight()};
+  TrafficLightState tl_state = {vehicle_data.traffic_light_state, vehicle_data.has_traffic_light};
 
   // Update simulation state.
   if (state_entry_present) {
@@ -261,6 +284,8 @@ void ALSM::UpdateData(const bool hybrid_physics_mode,
     simulation_state.UpdateTrafficLightState(actor_id, tl_state);
   }
   else {
+    // Static attributes are only read when the vehicle is added.
+    auto vehicle_ptr = boost::static_pointer_cast<cc::Vehicle>(vehicle);
     cg::Vector3D dimensions = vehicle_ptr->GetBoundingBox().extent;
     StaticAttributes attributes{ActorType::Vehicle, dimensions.x, dimensions.y, dimensions.z};
 
@@ -272,18 +297,25 @@ void ALSM::UpdateData(const bool hybrid_physics_mode,
 }
 
 
-void ALSM::UpdateUnregisteredActorsData() {
+void ALSM::UpdateUnregisteredActorsData(const cc::WorldSnapshot &world_snapshot) {
   for (auto &actor_info: unregistered_actors) {
 
     const ActorId actor_id = actor_info.first;
     const ActorPtr actor_ptr = actor_info.second;
-    const std::string type_id = actor_ptr->GetTypeId();
+    const std::string &type_id = actor_ptr->GetTypeId();
+    const char actor_class = type_id.front();
+    if (actor_class != 'v' && actor_class != 'w') {
+      continue;
+    }
+    const auto actor_snapshot = world_snapshot.Find(actor_id);
+    if (!actor_snapshot) {
+      continue;
+    }
 
-    const cg::Transform actor_transform = actor_ptr->GetTransform();
-    const cg::Location actor_location = actor_transform.location;
-    const cg::Rotation actor_rotation = actor_transform.rotation;
-    const cg::Vector3D actor_velocity = actor_ptr->GetVelocity();
-    const bool actor_is_dormant = actor_ptr->IsDormant();
+    const cg::Location actor_location = actor_snapshot->transform.location;
+    const cg::Rotation actor_rotation = actor_snapshot->transform.rotation;
+    const cg::Vector3D actor_velocity = actor_snapshot->velocity;
+    const bool actor_is_dormant = actor_snapshot->actor_state == rpc::ActorState::Dormant;
     KinematicState kinematic_state {actor_location, actor_rotation, actor_velocity, -1.0f, true, actor_is_dormant};
 
     TrafficLightState tl_state;
@@ -292,13 +324,14 @@ void ALSM::UpdateUnregisteredActorsData() {
     std::vector<SimpleWaypointPtr> nearest_waypoints;
 
     bool state_entry_not_present = !simulation_state.ContainsActor(actor_id);
-    if (type_id.front() == 'v') {
-      auto vehicle_ptr = boost::static_pointer_cast<cc::Vehicle>(actor_ptr);
-      kinematic_state.speed_limit = vehicle_ptr->GetSpeedLimit();
+    if (actor_class == 'v') {
+      const auto &vehicle_data = actor_snapshot->state.vehicle_data;
+      kinematic_state.speed_limit = vehicle_data.speed_limit;
 
-      tl_state = {vehicle_ptr->GetTrafficLightState(), vehicle_ptr->IsAtTrafficLight()};
+      tl_state = {vehicle_data.traffic_light_state, vehicle_data.has_traffic_light};
 
       if (state_entry_not_present) {
+        auto vehicle_ptr = boost::static_pointer_cast<cc::Vehicle>(actor_ptr);
         dimensions = vehicle_ptr->GetBoundingBox().extent;
         actor_type = ActorType::Vehicle;
         StaticAttributes attributes {actor_type, dimensions.x, dimensions.y, dimensions.z};
@@ -310,20 +343,19 @@ void ALSM::UpdateUnregisteredActorsData() {
       }
 
       // Identify occupied waypoints.
-      cg::Vector3D extent = vehicle_ptr->GetBoundingBox().extent;
-      cg::Vector3D heading_vector = vehicle_ptr->GetTransform().GetForwardVector();
-      std::vector<cg::Location> corners = {actor_location + cg::Location(extent.x * heading_vector),
+      const float half_length = simulation_state.GetDimensions(actor_id).x;
+      cg::Vector3D heading_vector = simulation_state.GetHeading(actor_id);
+      std::vector<cg::Location> corners = {actor_location + cg::Location(half_length * heading_vector),
                                            actor_location,
-                                           actor_location + cg::Location(-extent.x * heading_vector)};
+                                           actor_location + cg::Location(-half_length * heading_vector)};
       for (cg::Location &vertex: corners) {
         SimpleWaypointPtr nearest_waypoint = local_map->GetWaypoint(vertex);
         nearest_waypoints.push_back(nearest_waypoint);
       }
     }
-    else if (type_id.front() == 'w') {
-      auto walker_ptr = boost::static_pointer_cast<cc::Walker>(actor_ptr);
-
+    else {
       if (state_entry_not_present) {
+        auto walker_ptr = boost::static_pointer_cast<cc::Walker>(actor_ptr);
         dimensions = walker_ptr->GetBoundingBox().extent;
         actor_type = ActorType::Pedestrian;
         StaticAttributes attributes {actor_type, dimensions.x, dimensions.y, dimensions.z};
@@ -6,6 +6,7 @@
 #include "carla/client/ActorList.h"
 #include "carla/client/Timestamp.h"
 #include "carla/client/World.h"
+#include "carla/client/WorldSnapshot.h"
 #include "carla/Memory.h"
 
 #include "carla/trafficmanager/AtomicActorSet.h"
@@ -73,21 +74,30 @@ private:
   bool IsVehicleStuck(const ActorId& actor_id);
 
   // Method to identify actors newly spawned in the simulation since last tick.
-  void IdentifyNewActors(const ActorList &actor_list);
+  // Only these are retrieved from the episode.
+  void IdentifyNewActors(const cc::WorldSnapshot &world_snapshot);
+
+  // Method to add a vehicle to the hero actors if its role name is hero.
+  void IdentifyHeroActor(const ActorPtr &vehicle);
 
   using DestroyeddActors = std::pair<ActorIdSet, ActorIdSet>;
   // Method to identify actors deleted in the last frame.
   // Arrays of registered and unregistered actors are returned separately.
-  DestroyeddActors IdentifyDestroyedActors(const ActorList &actor_list);
+  DestroyeddActors IdentifyDestroyedActors(const cc::WorldSnapshot &world_snapshot);
 
   using IdleInfo = std::pair<ActorId, double>;
-  void UpdateRegisteredActorsData(const bool hybrid_physics_mode, IdleInfo &max_idle_time);
+  void UpdateRegisteredActorsData(const bool hybrid_physics_mode,
+                                  IdleInfo &max_idle_time,
+                                  const cc::WorldSnapshot &world_snapshot);
 
   void UpdateData(const bool hybrid_physics_mode,
                   ALSM::IdleInfo &max_idle_time, const Actor &vehicle,
+                  const cc::ActorSnapshot &vehicle_snapshot,
                   const bool hero_actor_present, const float physics_radius_square);
 
-  void UpdateUnregisteredActorsData();
+  // Dynamic states of all actors are read from @a world_snapshot, static
+  // attributes are only read when an actor is first added.
+  void UpdateUnregisteredActorsData(const cc::WorldSnapshot &world_snapshot);
 
 public:
   ALSM(AtomicActorSet &registered_vehicles,
@@ -15,6 +15,44 @@ namespace traffic_manager {
 
   using SimpleWaypointPtr = std::shared_ptr<SimpleWaypoint>;
 
+  /// Header of the InMemoryMap cache. It is followed by the waypoint records
+  /// and by the array of link indices the records point into.
+  struct CachedMapHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t total_waypoints;
+    uint32_t total_links;
+  };
+  static_assert(sizeof(CachedMapHeader) == 16u, "Invalid InMemoryMap cache header size");
+
+  /// Fixed-size waypoint record of the InMemoryMap cache. Waypoints refer to
+  /// each other by their index in the cache, so the records can be copied in
+  /// a single block and linked without any lookup.
+  struct CachedWaypointRecord {
+    uint64_t waypoint_id;
+    uint32_t road_id;
+    uint32_t section_id;
+    int32_t lane_id;
+    float s;
+    float location[3];
+    /// Pitch, yaw and roll.
+    float rotation[3];
+    int32_t geodesic_grid_id;
+    int32_t junction_id;
+    uint32_t left_index;
+    uint32_t right_index;
+    /// Position of the next waypoints in the link array, followed by the
+    /// previous waypoints.
+    uint32_t links_offset;
+    uint16_t total_next;
+    uint16_t total_previous;
+    uint8_t is_junction;
+    uint8_t padding[7];
+  };
+  static_assert(sizeof(CachedWaypointRecord) == 80u, "Invalid InMemoryMap cache record size");
+
+  /// Variable-size waypoint record of the unversioned cache, kept to read
+  /// caches cooked by previous versions.
   class CachedSimpleWaypoint {
   public:
     uint64_t waypoint_id;
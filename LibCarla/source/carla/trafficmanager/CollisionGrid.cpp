@@ -0,0 +1,76 @@
+
+#include <cmath>
+
+#include "carla/trafficmanager/CollisionGrid.h"
+
+namespace carla {
+namespace traffic_manager {
+
+CollisionGrid::CollisionGrid(const float _cell_size)
+  : inv_cell_size(1.0f / _cell_size) {}
+
+int32_t CollisionGrid::GetCellCoordinate(const float value) const {
+  return static_cast<int32_t>(std::floor(value * inv_cell_size));
+}
+
+uint64_t CollisionGrid::GetCellKey(const int32_t x, const int32_t y) const {
+  uint64_t key = static_cast<uint32_t>(x);
+  key <<= 32;
+  key |= static_cast<uint32_t>(y);
+  return key;
+}
+
+void CollisionGrid::Clear() {
+  for (auto it = cells.begin(); it != cells.end();) {
+    if (it->second.empty()) {
+      it = cells.erase(it);
+    } else {
+      it->second.clear();
+      ++it;
+    }
+  }
+}
+
+void CollisionGrid::Insert(const ActorId actor_id, const cg::Location &location) {
+  const uint64_t key = GetCellKey(GetCellCoordinate(location.x), GetCellCoordinate(location.y));
+  cells[key].emplace_back(actor_id, location);
+}
+
+void CollisionGrid::Query(const cg::Location &location,
+                          const float radius,
+                          std::vector<ActorId> &result) const {
+  const int32_t min_x = GetCellCoordinate(location.x - radius);
+  const int32_t max_x = GetCellCoordinate(location.x + radius);
+  const int32_t min_y = GetCellCoordinate(location.y - radius);
+  const int32_t max_y = GetCellCoordinate(location.y + radius);
+
+  for (int32_t x = min_x; x <= max_x; ++x) {
+    for (int32_t y = min_y; y <= max_y; ++y) {
+      auto it = cells.find(GetCellKey(x, y));
+      if (it != cells.end()) {
+        for (auto &element : it->second) {
+          const cg::Location &actor_location = element.second;
+          if (std::abs(actor_location.x - location.x) <= radius
+              && std::abs(actor_location.y - location.y) <= radius) {
+            result.push_back(element.first);
+          }
+        }
+      }
+    }
+  }
+}
+
+size_t CollisionGrid::Size() const {
+  size_t size = 0u;
+  for (auto &cell : cells) {
+    size += cell.second.size();
+  }
+  return size;
+}
+
+size_t CollisionGrid::NumberOfCells() const {
+  return cells.size();
+}
+
+} // namespace traffic_manager
+} // namespace carla
@@ -0,0 +1,58 @@
+
+#pragma once
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "carla/geom/Location.h"
+#include "carla/rpc/ActorId.h"
+
+namespace carla {
+namespace traffic_manager {
+
+namespace cg = carla::geom;
+
+using ActorId = carla::ActorId;
+
+/// Uniform grid over the top view of the actors' locations, rebuilt every
+/// cycle to select the actors near a vehicle without visiting every actor.
+class CollisionGrid {
+
+private:
+  using Cell = std::vector<std::pair<ActorId, cg::Location>>;
+  using CellMap = std::unordered_map<uint64_t, Cell>;
+
+  float inv_cell_size;
+  CellMap cells;
+
+  int32_t GetCellCoordinate(const float value) const;
+  uint64_t GetCellKey(const int32_t x, const int32_t y) const;
+
+public:
+  explicit CollisionGrid(const float _cell_size);
+
+  /// Method to remove every actor from the grid. The cells occupied since the
+  /// previous call are kept to reuse their memory, the others are erased so
+  /// the grid only holds the cells around the actors.
+  void Clear();
+
+  /// Method to add an actor at the given location.
+  void Insert(const ActorId actor_id, const cg::Location &location);
+
+  /// Method to append to @a result every actor in the cells overlapping the
+  /// square of half side @a radius around @a location. The result is a
+  /// superset of the actors within @a radius of @a location.
+  void Query(const cg::Location &location,
+             const float radius,
+             std::vector<ActorId> &result) const;
+
+  /// Number of actors in the grid.
+  size_t Size() const;
+
+  /// Number of cells allocated.
+  size_t NumberOfCells() const;
+};
+
+} // namespace traffic_manager
+} // namespace carla
@@ -29,6 +29,7 @@ CollisionStage::CollisionStage(
     track_traffic(track_traffic),
     parameters(parameters),
     output_array(output_array),
+    collision_grid(BROAD_PHASE_CELL_SIZE),
     random_devices(random_devices) {}
 
 void CollisionStage::Update(const unsigned long index) {
@@ -37,11 +38,21 @@ void CollisionStage::Update(const unsigned long index) {
   float available_distance_margin = std::numeric_limits<float>::infinity();
 
   const ActorId ego_actor_id = vehicle_id_list.at(index);
+  OptionalCollisionLock ego_lock;
+  {
+    std::lock_guard<std::mutex> lock(collision_locks_mutex);
+    auto it = collision_locks.find(ego_actor_id);
+    if (it != collision_locks.end()) {
+      ego_lock = it->second;
+    }
+  }
+
   if (simulation_state.ContainsActor(ego_actor_id)) {
-    const cg::Location ego_location = simulation_state.GetLocation(ego_actor_id);
+    const size_t ego_slot = simulation_state.GetVehicleSlot(index, ego_actor_id);
+    const cg::Location ego_location = simulation_state.GetLocationAt(ego_slot);
     const Buffer &ego_buffer = buffer_map.at(ego_actor_id);
     const unsigned long look_ahead_index = GetTargetWaypoint(ego_buffer, JUNCTION_LOOK_AHEAD).second;
-    const float velocity = simulation_state.GetVelocity(ego_actor_id).Length();
+    const float velocity = simulation_state.GetVelocityAt(ego_slot).Length();
 
     ActorIdSet overlapping_actors = track_traffic.GetOverlappingVehicles(ego_actor_id);
     std::vector<ActorId> collision_candidate_ids;
@@ -52,23 +63,28 @@ void CollisionStage::Update(const unsigned long index) {
     if (velocity < 1.0f) {
       collision_radius_square = SQUARE(COLLISION_RADIUS_STOP) + parameters.GetDistanceToLeadingVehicle(ego_actor_id);
     }
-    for (ActorId overlapping_actor_id : overlapping_actors) {
-      // If actor is within maximum collision avoidance and vertical overlap range.
-      const cg::Location &overlapping_actor_location = simulation_state.GetLocation(overlapping_actor_id);
-      if (overlapping_actor_id != ego_actor_id
-          && cg::Math::DistanceSquared(overlapping_actor_location, ego_location) < collision_radius_square
-          && std::abs(ego_location.z - overlapping_actor_location.z) < VERTICAL_OVERLAP_THRESHOLD) {
-        collision_candidate_ids.push_back(overlapping_actor_id);
+    // Only actors in the grid cells around the vehicle can be within the collision radius.
+    std::vector<ActorId> nearby_actors;
+    collision_grid.Query(ego_location, std::sqrt(collision_radius_square), nearby_actors);
+    for (ActorId nearby_actor_id : nearby_actors) {
+      // If actor has an overlapping path and is within maximum collision avoidance and vertical overlap range.
+      const cg::Location &nearby_actor_location = simulation_state.GetLocation(nearby_actor_id);
+      if (nearby_actor_id != ego_actor_id
+          && cg::Math::DistanceSquared(nearby_actor_location, ego_location) < collision_radius_square
+          && std::abs(ego_location.z - nearby_actor_location.z) < VERTICAL_OVERLAP_THRESHOLD
+          && overlapping_actors.find(nearby_actor_id) != overlapping_actors.end()) {
+        collision_candidate_ids.push_back(nearby_actor_id);
       }
     }
 
-    // Sorting collision candidates in accending order of distance to current vehicle.
+    // Sorting collision candidates in accending order of distance to current vehicle,
+    // ties broken by id so the order does not depend on the grid layout.
     std::sort(collision_candidate_ids.begin(), collision_candidate_ids.end(),
               [this, &ego_location](const ActorId &a_id_1, const ActorId &a_id_2) {
                 const cg::Location &e_loc = ego_location;
-                const cg::Location &loc_1 = simulation_state.GetLocation(a_id_1);
-                const cg::Location &loc_2 = simulation_state.GetLocation(a_id_2);
-                return (cg::Math::DistanceSquared(e_loc, loc_1) < cg::Math::DistanceSquared(e_loc, loc_2));
+                const float distance_1 = cg::Math::DistanceSquared(e_loc, simulation_state.GetLocation(a_id_1));
+                const float distance_2 = cg::Math::DistanceSquared(e_loc, simulation_state.GetLocation(a_id_2));
+                return distance_1 < distance_2 || (distance_1 == distance_2 && a_id_1 < a_id_2);
               });
 
     // Check every actor in the vicinity if it poses a collision hazard.
@@ -83,7 +99,12 @@ void CollisionStage::Update(const unsigned long index) {
           && simulation_state.ContainsActor(other_actor_id)) {
         std::pair<bool, float> negotiation_result = NegotiateCollision(ego_actor_id,
                                                                        other_actor_id,
-                                                                       look_ahead_index);
+                                                                       look_ahead_index,
+                                                                       ego_lock);
+        if (!is_parallel_cycle) {
+          // Serial updates see the lock as soon as it changes.
+          SetCollisionLock(ego_actor_id, ego_lock);
+        }
         if (negotiation_result.first) {
           if ((other_actor_type == ActorType::Vehicle
                && parameters.GetPercentageIgnoreVehicles(ego_actor_id) <= random_devices.at(ego_actor_id).next())
@@ -98,6 +119,8 @@ void CollisionStage::Update(const unsigned long index) {
     }
   }
 
+  SetCollisionLock(ego_actor_id, ego_lock);
+
   CollisionHazardData &output_element = output_array.at(index);
   output_element.hazard_actor_id = obstacle_id;
   output_element.hazard = collision_hazard;
@@ -106,21 +129,50 @@ void CollisionStage::Update(const unsigned long index) {
 
 void CollisionStage::RemoveActor(const ActorId actor_id) {
   collision_locks.erase(actor_id);
+  previous_collision_locks.erase(actor_id);
 }
 
 void CollisionStage::Reset() {
   collision_locks.clear();
+  previous_collision_locks.clear();
+  collision_grid.Clear();
+}
+
+OptionalCollisionLock CollisionStage::GetCollisionLock(const ActorId actor_id) {
+  if (is_parallel_cycle) {
+    auto it = previous_collision_locks.find(actor_id);
+    if (it != previous_collision_locks.end()) {
+      return it->second;
+    }
+    return boost::none;
+  }
+  std::lock_guard<std::mutex> lock(collision_locks_mutex);
+  auto it = collision_locks.find(actor_id);
+  if (it != collision_locks.end()) {
+    return it->second;
+  }
+  return boost::none;
+}
+
+void CollisionStage::SetCollisionLock(const ActorId actor_id, const OptionalCollisionLock &collision_lock) {
+  std::lock_guard<std::mutex> lock(collision_locks_mutex);
+  if (collision_lock) {
+    collision_locks[actor_id] = *collision_lock;
+  } else {
+    collision_locks.erase(actor_id);
+  }
 }
 
-float CollisionStage::GetBoundingBoxExtention(const ActorId actor_id) {
+float CollisionStage::GetBoundingBoxExtention(const ActorId actor_id, const OptionalCollisionLock &collision_lock) {
 
-  const float velocity = cg::Math::Dot(simulation_state.GetVelocity(actor_id), simulation_state.GetHeading(actor_id));
+  const size_t slot = simulation_state.GetSlot(actor_id);
+  const float velocity = cg::Math::Dot(simulation_state.GetVelocityAt(slot), simulation_state.GetHeadingAt(slot));
   float bbox_extension;
   // Using a linear function to calculate boundary length.
   bbox_extension = BOUNDARY_EXTENSION_RATE * velocity + BOUNDARY_EXTENSION_MINIMUM;
   // If a valid collision lock present, change boundary length to maintain lock.
-  if (collision_locks.find(actor_id) != collision_locks.end()) {
-    const CollisionLock &lock = collision_locks.at(actor_id);
+  if (collision_lock) {
+    const CollisionLock &lock = *collision_lock;
     float lock_boundary_length = static_cast<float>(lock.distance_to_lead_vehicle + LOCKING_DISTANCE_PADDING);
     // Only extend boundary track vehicle if the leading vehicle
     // if it is not further than velocity dependent extension by MAX_LOCKING_EXTENSION.
@@ -133,16 +185,17 @@ float CollisionStage::GetBoundingBoxExtention(const ActorId actor_id) {
 }
 
 LocationVector CollisionStage::GetBoundary(const ActorId actor_id) {
-  const ActorType actor_type = simulation_state.GetType(actor_id);
-  const cg::Vector3D heading_vector = simulation_state.GetHeading(actor_id);
+  const size_t slot = simulation_state.GetSlot(actor_id);
+  const ActorType actor_type = simulation_state.GetTypeAt(slot);
+  const cg::Vector3D heading_vector = simulation_state.GetHeadingAt(slot);
 
   float forward_extension = 0.0f;
   if (actor_type == ActorType::Pedestrian) {
     // Extend the pedestrians bbox to "predict" where they'll be and avoid collisions.
-    forward_extension = simulation_state.GetVelocity(actor_id).Length() * WALKER_TIME_EXTENSION;
+    forward_extension = simulation_state.GetVelocityAt(slot).Length() * WALKER_TIME_EXTENSION;
   }
 
-  cg::Vector3D dimensions = simulation_state.GetDimensions(actor_id);
+  cg::Vector3D dimensions = simulation_state.GetDimensionsAt(slot);
 
   float bbox_x = dimensions.x;
   float bbox_y = dimensions.y;
@@ -152,7 +205,7 @@ LocationVector CollisionStage::GetBoundary(const ActorId actor_id) {
   const cg::Vector3D y_boundary_vector = perpendicular_vector * (bbox_y + forward_extension);
 
   // Four corners of the vehicle in top view clockwise order (left-handed system).
-  const cg::Location location = simulation_state.GetLocation(actor_id);
+  const cg::Location location = simulation_state.GetLocationAt(slot);
   LocationVector bbox_boundary = {
       location + cg::Location(x_boundary_vector - y_boundary_vector),
       location + cg::Location(-1.0f * x_boundary_vector - y_boundary_vector),
@@ -166,13 +219,19 @@ LocationVector CollisionStage::GetBoundary(const ActorId actor_id) {
 LocationVector CollisionStage::GetGeodesicBoundary(const ActorId actor_id) {
   LocationVector geodesic_boundary;
 
-  if (geodesic_boundary_map.find(actor_id) != geodesic_boundary_map.end()) {
-    geodesic_boundary = geodesic_boundary_map.at(actor_id);
-  } else {
+  {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto it = geodesic_boundary_map.find(actor_id);
+    if (it != geodesic_boundary_map.end()) {
+      return it->second;
+    }
+  }
+
+  {
     const LocationVector bbox = GetBoundary(actor_id);
 
     if (buffer_map.find(actor_id) != buffer_map.end()) {
-      float bbox_extension = GetBoundingBoxExtention(actor_id);
+      float bbox_extension = GetBoundingBoxExtention(actor_id, GetCollisionLock(actor_id));
       const float specific_lead_distance = parameters.GetDistanceToLeadingVehicle(actor_id);
       bbox_extension = std::max(specific_lead_distance, bbox_extension);
       const float bbox_extension_square = SQUARE(bbox_extension);
@@ -230,6 +289,7 @@ LocationVector CollisionStage::GetGeodesicBoundary(const ActorId actor_id) {
       geodesic_boundary = bbox;
     }
 
+    std::lock_guard<std::mutex> lock(cache_mutex);
     geodesic_boundary_map.insert({actor_id, geodesic_boundary});
   }
 
@@ -263,22 +323,26 @@ GeometryComparison CollisionStage::GetGeometryBetweenActors(const ActorId refere
   actor_id_key <<= 32;
   actor_id_key |= key_parts.second;
 
+  // The cache stores the comparison as seen from the actor with the lowest id.
   GeometryComparison comparision_result{-1.0, -1.0, -1.0, -1.0};
+  bool cached = false;
+  {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto it = geometry_cache.find(actor_id_key);
+    if (it != geometry_cache.end()) {
+      comparision_result = it->second;
+      cached = true;
+    }
+  }
 
-  if (geometry_cache.find(actor_id_key) != geometry_cache.end()) {
-
-    comparision_result = geometry_cache.at(actor_id_key);
-    double mref_veh_other = comparision_result.reference_vehicle_to_other_geodesic;
-    comparision_result.reference_vehicle_to_other_geodesic = comparision_result.other_vehicle_to_reference_geodesic;
-    comparision_result.other_vehicle_to_reference_geodesic = mref_veh_other;
-  } else {
+  if (!cached) {
 
-    const Polygon reference_polygon = GetPolygon(GetBoundary(reference_vehicle_id));
-    const Polygon other_polygon = GetPolygon(GetBoundary(other_actor_id));
+    const Polygon reference_polygon = GetPolygon(GetBoundary(key_parts.first));
+    const Polygon other_polygon = GetPolygon(GetBoundary(key_parts.second));
 
-    const Polygon reference_geodesic_polygon = GetPolygon(GetGeodesicBoundary(reference_vehicle_id));
+    const Polygon reference_geodesic_polygon = GetPolygon(GetGeodesicBoundary(key_parts.first));
 
-    const Polygon other_geodesic_polygon = GetPolygon(GetGeodesicBoundary(other_actor_id));
+    const Polygon other_geodesic_polygon = GetPolygon(GetGeodesicBoundary(key_parts.second));
 
     const double reference_vehicle_to_other_geodesic = bg::distance(reference_polygon, other_geodesic_polygon);
     const double other_vehicle_to_reference_geodesic = bg::distance(other_polygon, reference_geodesic_polygon);
@@ -290,40 +354,49 @@ GeometryComparison CollisionStage::GetGeometryBetweenActors(const ActorId refere
               inter_geodesic_distance,
               inter_bbox_distance};
 
+    std::lock_guard<std::mutex> lock(cache_mutex);
     geometry_cache.insert({actor_id_key, comparision_result});
   }
 
+  if (reference_vehicle_id != key_parts.first) {
+    std::swap(comparision_result.reference_vehicle_to_other_geodesic,
+              comparision_result.other_vehicle_to_reference_geodesic);
+  }
+
   return comparision_result;
 }
 
 std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId reference_vehicle_id,
                                                           const ActorId other_actor_id,
-                                                          const uint64_t reference_junction_look_ahead_index) {
+                                                          const uint64_t reference_junction_look_ahead_index,
+                                                          OptionalCollisionLock &reference_lock) {
   // Output variables for the method.
   bool hazard = false;
   float available_distance_margin = std::numeric_limits<float>::infinity();
 
-  const cg::Location reference_location = simulation_state.GetLocation(reference_vehicle_id);
-  const cg::Location other_location = simulation_state.GetLocation(other_actor_id);
+  const size_t reference_slot = simulation_state.GetSlot(reference_vehicle_id);
+  const size_t other_slot = simulation_state.GetSlot(other_actor_id);
+  const cg::Location reference_location = simulation_state.GetLocationAt(reference_slot);
+  const cg::Location other_location = simulation_state.GetLocationAt(other_slot);
 
   // Ego and other vehicle heading.
-  const cg::Vector3D reference_heading = simulation_state.GetHeading(reference_vehicle_id);
+  const cg::Vector3D reference_heading = simulation_state.GetHeadingAt(reference_slot);
   // Vector from ego position to position of the other vehicle.
   cg::Vector3D reference_to_other = other_location - reference_location;
   reference_to_other = reference_to_other.MakeSafeUnitVector(EPSILON);
 
   // Other vehicle heading.
-  const cg::Vector3D other_heading = simulation_state.GetHeading(other_actor_id);
+  const cg::Vector3D other_heading = simulation_state.GetHeadingAt(other_slot);
   // Vector from other vehicle position to ego position.
   cg::Vector3D other_to_reference = reference_location - other_location;
   other_to_reference = other_to_reference.MakeSafeUnitVector(EPSILON);
 
-  float reference_vehicle_length = simulation_state.GetDimensions(reference_vehicle_id).x * SQUARE_ROOT_OF_TWO;
-  float other_vehicle_length = simulation_state.GetDimensions(other_actor_id).x * SQUARE_ROOT_OF_TWO;
+  float reference_vehicle_length = simulation_state.GetDimensionsAt(reference_slot).x * SQUARE_ROOT_OF_TWO;
+  float other_vehicle_length = simulation_state.GetDimensionsAt(other_slot).x * SQUARE_ROOT_OF_TWO;
 
   float inter_vehicle_distance = cg::Math::DistanceSquared(reference_location, other_location);
-  float ego_bounding_box_extension = GetBoundingBoxExtention(reference_vehicle_id);
-  float other_bounding_box_extension = GetBoundingBoxExtention(other_actor_id);
+  float ego_bounding_box_extension = GetBoundingBoxExtention(reference_vehicle_id, reference_lock);
+  float other_bounding_box_extension = GetBoundingBoxExtention(other_actor_id, GetCollisionLock(other_actor_id));
   // Calculate minimum distance between vehicle to consider collision negotiation.
   float inter_vehicle_length = reference_vehicle_length + other_vehicle_length;
   float ego_detection_range = SQUARE(ego_bounding_box_extension + inter_vehicle_length);
@@ -337,7 +410,7 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
   const Buffer &reference_vehicle_buffer = buffer_map.at(reference_vehicle_id);
   SimpleWaypointPtr closest_point = reference_vehicle_buffer.front();
   bool ego_inside_junction = closest_point->CheckJunction();
-  TrafficLightState reference_tl_state = simulation_state.GetTLS(reference_vehicle_id);
+  const TrafficLightState &reference_tl_state = simulation_state.GetTLSAt(reference_slot);
   bool ego_at_traffic_light = reference_tl_state.at_traffic_light;
   bool ego_stopped_by_light = reference_tl_state.tl_state != TLS::Green && reference_tl_state.tl_state != TLS::Off;
   SimpleWaypointPtr look_ahead_point = reference_vehicle_buffer.at(reference_junction_look_ahead_index);
@@ -346,7 +419,8 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
   // Conditions to consider collision negotiation.
   if (!(ego_at_junction_entrance && ego_at_traffic_light && ego_stopped_by_light)
       && ((ego_inside_junction && other_vehicles_in_cross_detection_range)
-          || (!ego_inside_junction && other_vehicle_in_front && other_vehicle_in_ego_range))) {
+          || (!ego_inside_junction && other_vehicle_in_front && other_vehicle_in_ego_range))
+      && AreGeodesicBoundsOverlapping(reference_vehicle_id, other_actor_id)) {
     GeometryComparison geometry_comparison = GetGeometryBetweenActors(reference_vehicle_id, other_actor_id);
 
     // Conditions for collision negotiation.
@@ -379,8 +453,8 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
       // This enables us to smoothly approach the lead vehicle.
 
       // When possible collision found, check if an entry for collision lock present.
-      if (collision_locks.find(reference_vehicle_id) != collision_locks.end()) {
-        CollisionLock &lock = collision_locks.at(reference_vehicle_id);
+      if (reference_lock) {
+        CollisionLock &lock = *reference_lock;
         // Check if the same vehicle is under lock.
         if (other_actor_id == lock.lead_vehicle_id) {
           // If the body of the lead vehicle is touching the reference vehicle bounding box.
@@ -397,25 +471,60 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
         }
       } else {
         // Insert and initialize lock entry if not present.
-        collision_locks.insert({reference_vehicle_id,
-                                {geometry_comparison.inter_bbox_distance,
-                                 geometry_comparison.inter_bbox_distance,
-                                 other_actor_id}});
+        reference_lock = CollisionLock{geometry_comparison.inter_bbox_distance,
+                                       geometry_comparison.inter_bbox_distance,
+                                       other_actor_id};
       }
     }
   }
 
   // If no collision hazard detected, then flush collision lock held by the vehicle.
-  if (!hazard && collision_locks.find(reference_vehicle_id) != collision_locks.end()) {
-    collision_locks.erase(reference_vehicle_id);
+  if (!hazard) {
+    reference_lock = boost::none;
   }
 
   return {hazard, available_distance_margin};
 }
 
+bool CollisionStage::AreGeodesicBoundsOverlapping(const ActorId reference_vehicle_id,
+                                                  const ActorId other_actor_id) {
+  // If the bounding rectangles are further apart than the overlap threshold so
+  // are the boundaries, and no collision negotiation can report a hazard.
+  const LocationVector reference_boundary = GetGeodesicBoundary(reference_vehicle_id);
+  const LocationVector other_boundary = GetGeodesicBoundary(other_actor_id);
+
+  auto get_bounds = [](const LocationVector &boundary) {
+    cg::Location min_corner = boundary.front();
+    cg::Location max_corner = boundary.front();
+    for (const cg::Location &location : boundary) {
+      min_corner.x = std::min(min_corner.x, location.x);
+      min_corner.y = std::min(min_corner.y, location.y);
+      max_corner.x = std::max(max_corner.x, location.x);
+      max_corner.y = std::max(max_corner.y, location.y);
+    }
+    return std::make_pair(min_corner, max_corner);
+  };
+  const auto reference_bounds = get_bounds(reference_boundary);
+  const auto other_bounds = get_bounds(other_boundary);
+
+  return reference_bounds.first.x - other_bounds.second.x < OVERLAP_THRESHOLD
+      && other_bounds.first.x - reference_bounds.second.x < OVERLAP_THRESHOLD
+      && reference_bounds.first.y - other_bounds.second.y < OVERLAP_THRESHOLD
+      && other_bounds.first.y - reference_bounds.second.y < OVERLAP_THRESHOLD;
+}
+
+void CollisionStage::PrepareCycle(const bool is_parallel) {
+  is_parallel_cycle = is_parallel;
+  collision_grid.Clear();
+  for (size_t slot = 0u; slot < simulation_state.Size(); ++slot) {
+    collision_grid.Insert(simulation_state.GetActorIdAt(slot), simulation_state.GetLocationAt(slot));
+  }
+}
+
 void CollisionStage::ClearCycleCache() {
   geodesic_boundary_map.clear();
   geometry_cache.clear();
+  previous_collision_locks = collision_locks;
 }
 
 } // namespace traffic_manager
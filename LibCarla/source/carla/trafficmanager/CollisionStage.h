@@ -2,12 +2,15 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 
 #include "boost/geometry.hpp"
 #include "boost/geometry/geometries/geometries.hpp"
 #include "boost/geometry/geometries/point_xy.hpp"
 #include "boost/geometry/geometries/polygon.hpp"
+#include "boost/optional.hpp"
 
+#include "carla/trafficmanager/CollisionGrid.h"
 #include "carla/trafficmanager/DataStructures.h"
 #include "carla/trafficmanager/Parameters.h"
 #include "carla/trafficmanager/RandomGenerator.h"
@@ -30,6 +33,7 @@ struct CollisionLock {
   ActorId lead_vehicle_id;
 };
 using CollisionLockMap = std::unordered_map<ActorId, CollisionLock>;
+using OptionalCollisionLock = boost::optional<CollisionLock>;
 
 namespace cc = carla::client;
 namespace bg = boost::geometry;
@@ -42,6 +46,15 @@ using GeometryComparisonMap = std::unordered_map<uint64_t, GeometryComparison>;
 using Polygon = bg::model::polygon<bg::model::d2::point_xy<double>>;
 
 /// This class has functionality to detect potential collision with a nearby actor.
+///
+/// Update can run concurrently for different vehicles: in that case the
+/// collision locks of other vehicles are read as they were at the end of the
+/// previous cycle, so the result does not depend on the order of the updates.
+/// When the updates run serially, locks are read as soon as they are updated.
+///
+/// Collision candidates are selected through a grid over the actors' locations
+/// built once per cycle, and pairs whose geodesic boundaries are far apart skip
+/// the polygon distance computations.
 class CollisionStage : Stage {
 private:
   const std::vector<ActorId> &vehicle_id_list;
@@ -52,20 +65,41 @@ private:
   CollisionFrame &output_array;
   // Structure keeping track of blocking lead vehicles.
   CollisionLockMap collision_locks;
+  // Collision locks at the end of the previous cycle.
+  CollisionLockMap previous_collision_locks;
+  std::mutex collision_locks_mutex;
+  // Whether the updates of the current cycle run concurrently.
+  bool is_parallel_cycle = false;
   // Structures to cache geodesic boundaries of vehicle and
   // comparision between vehicle boundaries
   // to avoid repeated computation within a cycle.
   GeometryComparisonMap geometry_cache;
   GeodesicBoundaryMap geodesic_boundary_map;
+  std::mutex cache_mutex;
+  // Grid of the actors' locations for the current cycle.
+  CollisionGrid collision_grid;
   RandomGeneratorMap &random_devices;
 
   // Method to determine if a vehicle is on a collision path to another.
   std::pair<bool, float> NegotiateCollision(const ActorId reference_vehicle_id,
                                             const ActorId other_actor_id,
-                                            const uint64_t reference_junction_look_ahead_index);
+                                            const uint64_t reference_junction_look_ahead_index,
+                                            OptionalCollisionLock &reference_lock);
 
   // Method to calculate bounding box extention length ahead of the vehicle.
-  float GetBoundingBoxExtention(const ActorId actor_id);
+  float GetBoundingBoxExtention(const ActorId actor_id, const OptionalCollisionLock &lock);
+
+  // Method to retrieve the collision lock held by another vehicle, as seen by
+  // the updates of the current cycle.
+  OptionalCollisionLock GetCollisionLock(const ActorId actor_id);
+
+  // Method to store the collision lock held by a vehicle.
+  void SetCollisionLock(const ActorId actor_id, const OptionalCollisionLock &lock);
+
+  // Method to check if the bounding rectangles of the geodesic boundaries of
+  // two actors are close enough for the boundaries to overlap.
+  bool AreGeodesicBoundsOverlapping(const ActorId reference_vehicle_id,
+                                    const ActorId other_actor_id);
 
   // Method to calculate polygon points around the vehicle's bounding box.
   LocationVector GetBoundary(const ActorId actor_id);
@@ -98,7 +132,13 @@ public:
 
   void Reset() override;
 
-  // Method to flush cache for current update cycle.
+  // Method to index the locations of all actors for the current update cycle.
+  // If the updates of the cycle run concurrently, they read the collision
+  // locks of the previous cycle.
+  void PrepareCycle(const bool is_parallel);
+
+  // Method to flush cache for current update cycle, and to keep the current
+  // collision locks to be read by the next one.
   void ClearCycleCache();
 };
 
@@ -80,6 +80,7 @@ static const float SQUARE_ROOT_OF_TWO = 1.414f;
 static const float VERTICAL_OVERLAP_THRESHOLD = 4.0f;
 static const float EPSILON = 2.0f * std::numeric_limits<float>::epsilon();
 static const float MIN_REFERENCE_DISTANCE = 1.0f;
+static const float BROAD_PHASE_CELL_SIZE = 20.0f;
 } // namespace Collision
 
 namespace FrameMemory {
@@ -97,6 +98,9 @@ static const double MAX_WPT_DISTANCE = MAP_RESOLUTION/2.0 + SQUARE(MAP_RESOLUTIO
 static const float MAX_WPT_RADIANS = 0.1745f;  // 10º
 static float const DELTA = 25.0f;
 static float const Z_DELTA = 500.0f;
+static const char CACHE_MAGIC[4] = {'T', 'M', 'W', 'P'};
+static const uint32_t CACHE_VERSION = 1u;
+static const uint32_t CACHE_NO_LINK = std::numeric_limits<uint32_t>::max();
 } // namespace Map
 
 namespace TrafficLight {
@@ -143,6 +147,11 @@ static const uint64_t BUFFER_STEP_THROUGH = 5;
 static const float INV_BUFFER_STEP_THROUGH = 1.0f / static_cast<float>(BUFFER_STEP_THROUGH);
 } // namespace TrackTraffic
 
+namespace StageExecution {
+// Number of consecutive vehicles updated by a worker thread at a time.
+static const uint64_t VEHICLES_PER_CHUNK = 16u;
+} // namespace StageExecution
+
 } // namespace constants
 } // namespace traffic_manager
 } // namespace carla
@@ -10,6 +10,8 @@
 #include "carla/trafficmanager/InMemoryMap.h"
 #include <boost/geometry/geometries/box.hpp>
 
+#include <cstring>
+
 namespace carla {
 namespace traffic_manager {
 
@@ -89,33 +91,171 @@ namespace traffic_manager {
       return;
     }
 
-    // write total records
-    uint32_t total = static_cast<uint32_t>(dense_topology.size());
-    out_file.write(reinterpret_cast<const char *>(&total), sizeof(uint32_t));
-
-    // write simple waypoints
-    std::unordered_set<uint64_t> used_ids;
-    for (auto& wp: dense_topology) {
-      if (used_ids.find(wp->GetId()) != used_ids.end()) {
+    std::unordered_map<uint64_t, uint32_t> id2index;
+    for (uint32_t i = 0u; i < dense_topology.size(); ++i) {
+      if (!id2index.insert({dense_topology.at(i)->GetId(), i}).second) {
         log_error("Could not generate the binary file. There are repeated waypoints");
       }
-      CachedSimpleWaypoint cached_wp(wp);
-      cached_wp.Write(out_file);
+    }
+    auto index_of = [&id2index](const SimpleWaypointPtr &swp) {
+      return swp != nullptr ? id2index.at(swp->GetId()) : CACHE_NO_LINK;
+    };
 
-      used_ids.insert(wp->GetId());
+    // build waypoint records and links
+    std::vector<CachedWaypointRecord> records(dense_topology.size());
+    std::vector<uint32_t> links;
+    for (uint32_t i = 0u; i < dense_topology.size(); ++i) {
+      const SimpleWaypointPtr &swp = dense_topology.at(i);
+      const WaypointPtr waypoint = swp->GetWaypoint();
+      const cg::Transform transform = swp->GetTransform();
+      const NodeList next_waypoints = swp->GetNextWaypoint();
+      const NodeList previous_waypoints = swp->GetPreviousWaypoint();
+
+      CachedWaypointRecord &record = records.at(i);
+      std::memset(&record, 0, sizeof(record));
+      record.waypoint_id = swp->GetId();
+      record.road_id = waypoint->GetRoadId();
+      record.section_id = waypoint->GetSectionId();
+      record.lane_id = waypoint->GetLaneId();
+      record.s = static_cast<float>(waypoint->GetDistance());
+      record.location[0] = transform.location.x;
+      record.location[1] = transform.location.y;
+      record.location[2] = transform.location.z;
+      record.rotation[0] = transform.rotation.pitch;
+      record.rotation[1] = transform.rotation.yaw;
+      record.rotation[2] = transform.rotation.roll;
+      record.geodesic_grid_id = swp->GetGeodesicGridId();
+      record.junction_id = swp->GetJunctionId();
+      record.left_index = index_of(swp->GetLeftWaypoint());
+      record.right_index = index_of(swp->GetRightWaypoint());
+      record.links_offset = static_cast<uint32_t>(links.size());
+      record.total_next = static_cast<uint16_t>(next_waypoints.size());
+      record.total_previous = static_cast<uint16_t>(previous_waypoints.size());
+      record.is_junction = swp->CheckJunction() ? 1u : 0u;
+      for (auto &next : next_waypoints) {
+        links.push_back(index_of(next));
+      }
+      for (auto &previous : previous_waypoints) {
+        links.push_back(index_of(previous));
+      }
     }
 
+    // write header, records and links
+    CachedMapHeader header;
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+    header.version = CACHE_VERSION;
+    header.total_waypoints = static_cast<uint32_t>(records.size());
+    header.total_links = static_cast<uint32_t>(links.size());
+    out_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out_file.write(reinterpret_cast<const char *>(records.data()),
+        static_cast<std::streamsize>(records.size() * sizeof(CachedWaypointRecord)));
+    out_file.write(reinterpret_cast<const char *>(links.data()),
+        static_cast<std::streamsize>(links.size() * sizeof(uint32_t)));
+
     out_file.close();
     return;
   }
 
   bool InMemoryMap::Load(const std::vector<uint8_t>& content) {
+    CachedMapHeader header;
+    if (content.size() < sizeof(header)) {
+      return LoadUnversioned(content);
+    }
+    std::memcpy(&header, content.data(), sizeof(header));
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(header.magic)) != 0) {
+      return LoadUnversioned(content);
+    }
+    if (header.version != CACHE_VERSION) {
+      log_warning("InMemoryMap cache version", header.version, "is not supported");
+      return false;
+    }
+    const size_t records_size = header.total_waypoints * sizeof(CachedWaypointRecord);
+    const size_t links_size = header.total_links * sizeof(uint32_t);
+    if (content.size() != sizeof(header) + records_size + links_size) {
+      log_warning("InMemoryMap cache is corrupted");
+      return false;
+    }
+
+    // read waypoint records and links
+    std::vector<CachedWaypointRecord> records(header.total_waypoints);
+    std::vector<uint32_t> links(header.total_links);
+    std::memcpy(records.data(), content.data() + sizeof(header), records_size);
+    std::memcpy(links.data(), content.data() + sizeof(header) + records_size, links_size);
+
+    auto is_valid_link = [&records](uint32_t index) {
+      return index == CACHE_NO_LINK || index < records.size();
+    };
+    for (auto &record : records) {
+      const size_t links_end = static_cast<size_t>(record.links_offset) + record.total_next + record.total_previous;
+      if (links_end > links.size() || !is_valid_link(record.left_index) || !is_valid_link(record.right_index)) {
+        log_warning("InMemoryMap cache is corrupted");
+        return false;
+      }
+    }
+    for (auto index : links) {
+      if (index >= records.size()) {
+        log_warning("InMemoryMap cache is corrupted");
+        return false;
+      }
+    }
+
+    // create simple waypoints, the waypoint objects are created on demand
+    dense_topology.reserve(records.size());
+    for (auto &record : records) {
+      const cg::Transform transform(
+          cg::Location(record.location[0], record.location[1], record.location[2]),
+          cg::Rotation(record.rotation[0], record.rotation[1], record.rotation[2]));
+      SimpleWaypointPtr wp = std::make_shared<SimpleWaypoint>(
+          _world_map, record.road_id, record.lane_id, record.s, record.waypoint_id, transform, record.junction_id);
+      wp->SetGeodesicGridId(record.geodesic_grid_id);
+      wp->SetIsJunction(record.is_junction != 0u);
+      dense_topology.push_back(wp);
+    }
+
+    // connect waypoints
+    for (uint32_t i = 0u; i < records.size(); ++i) {
+      const CachedWaypointRecord &record = records.at(i);
+      SimpleWaypointPtr &wp = dense_topology.at(i);
+
+      const auto next_begin = links.begin() + record.links_offset;
+      const auto previous_begin = next_begin + record.total_next;
+      const auto previous_end = previous_begin + record.total_previous;
+      NodeList next_waypoints;
+      next_waypoints.reserve(record.total_next);
+      for (auto it = next_begin; it != previous_begin; ++it) {
+        next_waypoints.push_back(dense_topology.at(*it));
+      }
+      NodeList previous_waypoints;
+      previous_waypoints.reserve(record.total_previous);
+      for (auto it = previous_begin; it != previous_end; ++it) {
+        previous_waypoints.push_back(dense_topology.at(*it));
+      }
+      wp->SetNextWaypoint(next_waypoints);
+      wp->SetPreviousWaypoint(previous_waypoints);
+      if (record.left_index != CACHE_NO_LINK) {
+        wp->SetLeftWaypoint(dense_topology.at(record.left_index));
+      }
+      if (record.right_index != CACHE_NO_LINK) {
+        wp->SetRightWaypoint(dense_topology.at(record.right_index));
+      }
+    }
+
+    // create spatial tree
+    SetUpSpatialTree();
+
+    return true;
+  }
+
+  bool InMemoryMap::LoadUnversioned(const std::vector<uint8_t>& content) {
     unsigned long pos = 0;
     std::vector<CachedSimpleWaypoint> cached_waypoints;
     std::unordered_map<uint64_t, uint32_t> id2index;
 
     // read total records
     uint32_t total;
+    if (content.size() < sizeof(total)) {
+      return false;
+    }
     memcpy(&total, &content[pos], sizeof(total));
     pos += sizeof(total);
 
@@ -128,6 +268,8 @@ namespace traffic_manager {
 
       WaypointPtr waypoint_ptr = _world_map->GetWaypointXODR(cached_wp.road_id, cached_wp.lane_id, cached_wp.s);
       SimpleWaypointPtr wp = std::make_shared<SimpleWaypoint>(waypoint_ptr);
+      wp->SetGeodesicGridId(cached_wp.geodesic_grid_id);
+      wp->SetIsJunction(cached_wp.is_junction);
       dense_topology.push_back(wp);
     }
 
@@ -351,13 +493,16 @@ namespace traffic_manager {
   }
 
   void InMemoryMap::SetUpSpatialTree() {
+    std::vector<SpatialTreeEntry> entries;
+    entries.reserve(dense_topology.size());
     for (auto &simple_waypoint: dense_topology) {
       if (simple_waypoint != nullptr) {
         const cg::Location loc = simple_waypoint->GetLocation();
         Point3D point(loc.x, loc.y, loc.z);
-        rtree.insert(std::make_pair(point, simple_waypoint));
+        entries.emplace_back(point, simple_waypoint);
       }
     }
+    rtree = Rtree(entries.begin(), entries.end());
   }
 
   SimpleWaypointPtr InMemoryMap::GetWaypoint(const cg::Location loc) const {
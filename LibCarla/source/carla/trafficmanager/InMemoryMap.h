@@ -72,7 +72,8 @@ namespace bgi = boost::geometry::index;
 
     static void Cook(WorldMap world_map, const std::string& path);
 
-    //bool Load(const std::string& filename);
+    /// Restores the local map from a cache written by Cook(). Returns false
+    /// if the cache is not valid, in which case SetUp() has to be used.
     bool Load(const std::vector<uint8_t>& content);
 
     /// This method constructs the local map with a resolution of
@@ -96,6 +97,10 @@ namespace bgi = boost::geometry::index;
   private:
     void Save(const std::string& path);
 
+    /// Restores the local map from a cache without header, as written by
+    /// previous versions of Cook().
+    bool LoadUnversioned(const std::vector<uint8_t>& content);
+
     void SetUpDenseTopology();
     void SetUpSpatialTree();
 
@@ -33,9 +33,10 @@ LocalizationStage::LocalizationStage(
 void LocalizationStage::Update(const unsigned long index) {
 
   const ActorId actor_id = vehicle_id_list.at(index);
-  const cg::Location vehicle_location = simulation_state.GetLocation(actor_id);
-  const cg::Vector3D heading_vector = simulation_state.GetHeading(actor_id);
-  const cg::Vector3D vehicle_velocity_vector = simulation_state.GetVelocity(actor_id);
+  const size_t slot = simulation_state.GetVehicleSlot(index, actor_id);
+  const cg::Location vehicle_location = simulation_state.GetLocationAt(slot);
+  const cg::Vector3D heading_vector = simulation_state.GetHeadingAt(slot);
+  const cg::Vector3D vehicle_velocity_vector = simulation_state.GetVelocityAt(slot);
   const float vehicle_speed = vehicle_velocity_vector.Length();
 
   // Speed dependent waypoint horizon length.
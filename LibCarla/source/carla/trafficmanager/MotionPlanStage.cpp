@@ -71,36 +71,31 @@ MotionPlanStage::MotionPlanStage(
 
 void MotionPlanStage::Update(const unsigned long index) {
   const ActorId actor_id = vehicle_id_list.at(index);
-  const cg::Location vehicle_location = simulation_state.GetLocation(actor_id);
-  const cg::Vector3D vehicle_velocity = simulation_state.GetVelocity(actor_id);
-  const cg::Rotation vehicle_rotation = simulation_state.GetRotation(actor_id);
+  const size_t slot = simulation_state.GetVehicleSlot(index, actor_id);
+  const cg::Location vehicle_location = simulation_state.GetLocationAt(slot);
+  const cg::Vector3D vehicle_velocity = simulation_state.GetVelocityAt(slot);
+  const cg::Rotation vehicle_rotation = simulation_state.GetRotationAt(slot);
   const float vehicle_speed = vehicle_velocity.Length();
-  const cg::Vector3D vehicle_heading = simulation_state.GetHeading(actor_id);
-  const bool vehicle_physics_enabled = simulation_state.IsPhysicsEnabled(actor_id);
+  const cg::Vector3D vehicle_heading = simulation_state.GetHeadingAt(slot);
+  const bool vehicle_physics_enabled = simulation_state.IsPhysicsEnabledAt(slot);
   const Buffer &waypoint_buffer = buffer_map.at(actor_id);
   const LocalizationData &localization = localization_frame.at(index);
   const CollisionHazardData &collision_hazard = collision_frame.at(index);
   const bool &tl_hazard = tl_frame.at(index);
-  current_timestamp = world.GetSnapshot().GetTimestamp();
+  const cc::Timestamp current_timestamp = world.GetSnapshot().GetTimestamp();
   StateEntry current_state;
 
   // Instanciating teleportation transform as current vehicle transform.
   cg::Transform teleportation_transform = cg::Transform(vehicle_location, vehicle_rotation);
 
-  // Get information about the hero location from the actor_id state.
-  cg::Location hero_location = track_traffic.GetHeroLocation();
-  bool is_hero_alive = hero_location != cg::Location(0, 0, 0);
-
-  if (simulation_state.IsDormant(actor_id) && parameters.GetRespawnDormantVehicles() && is_hero_alive) {
+  if (IsRespawning(index)) {
     // Flushing controller state for vehicle.
     current_state = {current_timestamp,
                     0.0f, 0.0f,
                     0.0f};
 
     // Add entry to teleportation duration clock table if not present.
-    if (teleportation_instance.find(actor_id) == teleportation_instance.end()) {
-      teleportation_instance.insert({actor_id, current_timestamp});
-    }
+    const cc::Timestamp &teleportation_time = GetTeleportationInstance(actor_id, current_timestamp);
 
     // Get lower and upper bound for teleporting vehicle.
     float lower_bound = parameters.GetLowerBoundaryRespawnDormantVehicles();
@@ -108,11 +103,11 @@ void MotionPlanStage::Update(const unsigned long index) {
     float dilate_factor = (upper_bound-lower_bound)/100.0f;
 
     // Measuring time elapsed since last teleportation for the vehicle.
-    double elapsed_time = current_timestamp.elapsed_seconds - teleportation_instance.at(actor_id).elapsed_seconds;
+    double elapsed_time = current_timestamp.elapsed_seconds - teleportation_time.elapsed_seconds;
 
     if (parameters.GetSynchronousMode() || elapsed_time > HYBRID_MODE_DT) {
       float random_sample = (static_cast<float>(random_devices.at(actor_id).next())*dilate_factor) + lower_bound;
-      NodeList teleport_waypoint_list = local_map->GetWaypointsInDelta(hero_location, ATTEMPTS_TO_TELEPORT, random_sample);
+      NodeList teleport_waypoint_list = local_map->GetWaypointsInDelta(cycle_hero_location, ATTEMPTS_TO_TELEPORT, random_sample);
       if (!teleport_waypoint_list.empty()) {
         for (auto &teleport_waypoint : teleport_waypoint_list) {
           GeoGridId geogrid_id = teleport_waypoint->GetGeodesicGridId();
@@ -131,7 +126,7 @@ void MotionPlanStage::Update(const unsigned long index) {
   else {
 
     // Target velocity for vehicle.
-    const float vehicle_speed_limit = simulation_state.GetSpeedLimit(actor_id);
+    const float vehicle_speed_limit = simulation_state.GetSpeedLimitAt(slot);
     float max_target_velocity = parameters.GetVehicleTargetVelocity(actor_id, vehicle_speed_limit) / 3.6f;
 
     // Algorithm to reduce speed near landmarks
@@ -153,7 +148,7 @@ void MotionPlanStage::Update(const unsigned long index) {
     // In case of collision or traffic light hazard.
     bool emergency_stop = tl_hazard || collision_emergency_stop || !safe_after_junction;
 
-    if (vehicle_physics_enabled && !simulation_state.IsDormant(actor_id)) {
+    if (vehicle_physics_enabled && !simulation_state.IsDormantAt(slot)) {
       ActuationSignal actuation_signal{0.0f, 0.0f, 0.0f};
 
       const float target_point_distance = std::max(vehicle_speed * TARGET_WAYPOINT_TIME_HORIZON,
@@ -169,14 +164,11 @@ void MotionPlanStage::Update(const unsigned long index) {
       const float angular_deviation = dot_product;
       const float velocity_deviation = (dynamic_target_velocity - vehicle_speed) / dynamic_target_velocity;
       // If previous state for vehicle not found, initialize state entry.
-      if (pid_state_map.find(actor_id) == pid_state_map.end()) {
-        const auto initial_state = StateEntry{current_timestamp, 0.0f, 0.0f, 0.0f};
-        pid_state_map.insert({actor_id, initial_state});
-      }
+      StateEntry &state = GetControllerState(actor_id, current_timestamp);
 
       // Retrieving the previous state.
       traffic_manager::StateEntry previous_state;
-      previous_state = pid_state_map.at(actor_id);
+      previous_state = state;
 
       // Select PID parameters.
       std::vector<float> longitudinal_parameters;
@@ -213,7 +205,6 @@ void MotionPlanStage::Update(const unsigned long index) {
 
       // Updating PID state.
       current_state.steer = actuation_signal.steer;
-      StateEntry &state = pid_state_map.at(actor_id);
       state = current_state;
 
     }
@@ -225,12 +216,10 @@ void MotionPlanStage::Update(const unsigned long index) {
                       0.0f};
 
       // Add entry to teleportation duration clock table if not present.
-      if (teleportation_instance.find(actor_id) == teleportation_instance.end()) {
-        teleportation_instance.insert({actor_id, current_timestamp});
-      }
+      const cc::Timestamp &teleportation_time = GetTeleportationInstance(actor_id, current_timestamp);
 
       // Measuring time elapsed since last teleportation for the vehicle.
-      double elapsed_time = current_timestamp.elapsed_seconds - teleportation_instance.at(actor_id).elapsed_seconds;
+      double elapsed_time = current_timestamp.elapsed_seconds - teleportation_time.elapsed_seconds;
 
       // Find a location ahead of the vehicle for teleportation to achieve intended velocity.
       if (!emergency_stop && (parameters.GetSynchronousMode() || elapsed_time > HYBRID_MODE_DT)) {
@@ -254,7 +243,7 @@ void MotionPlanStage::Update(const unsigned long index) {
       // In case of an emergency stop, stay in the same location.
       // Also, teleport only once every dt in asynchronous mode.
       } else {
-        teleportation_transform = cg::Transform(vehicle_location, simulation_state.GetRotation(actor_id));
+        teleportation_transform = cg::Transform(vehicle_location, vehicle_rotation);
       }
       // Constructing the actuation signal.
       output_array.at(index) = carla::rpc::Command::ApplyTransform(actor_id, teleportation_transform);
@@ -262,6 +251,33 @@ void MotionPlanStage::Update(const unsigned long index) {
   }
 }
 
+void MotionPlanStage::PrepareCycle() {
+  // Get information about the hero location from the actor_id state.
+  cycle_hero_location = track_traffic.GetHeroLocation();
+  const bool is_hero_alive = cycle_hero_location != cg::Location(0, 0, 0);
+  cycle_respawn_dormant_vehicles = parameters.GetRespawnDormantVehicles() && is_hero_alive;
+}
+
+bool MotionPlanStage::IsRespawning(const unsigned long index) const {
+  const ActorId actor_id = vehicle_id_list.at(index);
+  return cycle_respawn_dormant_vehicles
+      && simulation_state.IsDormantAt(simulation_state.GetVehicleSlot(index, actor_id));
+}
+
+StateEntry &MotionPlanStage::GetControllerState(const ActorId actor_id,
+                                                const cc::Timestamp &timestamp) {
+  // Elements of unordered maps are not moved on rehash, so the reference is
+  // safe to use once the lock is released.
+  std::lock_guard<std::mutex> lock(state_mutex);
+  return pid_state_map.insert({actor_id, StateEntry{timestamp, 0.0f, 0.0f, 0.0f}}).first->second;
+}
+
+const cc::Timestamp &MotionPlanStage::GetTeleportationInstance(const ActorId actor_id,
+                                                               const cc::Timestamp &timestamp) {
+  std::lock_guard<std::mutex> lock(state_mutex);
+  return teleportation_instance.insert({actor_id, timestamp}).first->second;
+}
+
 bool MotionPlanStage::SafeAfterJunction(const LocalizationData &localization,
                                         const bool tl_hazard,
                                         const bool collision_emergency_stop) {
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <mutex>
+
 #include "carla/trafficmanager/DataStructures.h"
 #include "carla/trafficmanager/InMemoryMap.h"
 #include "carla/trafficmanager/LocalizationUtils.h"
@@ -40,11 +42,21 @@ private:
   // Structure to keep track of duration between teleportation
   // in hybrid physics mode.
   std::unordered_map<ActorId, cc::Timestamp> teleportation_instance;
+  // Mutex guarding insertions into the per-vehicle state maps, so that
+  // different vehicles can be updated concurrently.
+  std::mutex state_mutex;
   ControlFrame &output_array;
-  cc::Timestamp current_timestamp;
   RandomGeneratorMap &random_devices;
   const LocalMapPtr &local_map;
   TLMap tl_map;
+  // Hero location and respawn switch, fixed at the start of each cycle.
+  cg::Location cycle_hero_location;
+  bool cycle_respawn_dormant_vehicles {false};
+
+  // Methods to retrieve the per-vehicle controller state and last
+  // teleportation time, initializing them if not present.
+  StateEntry &GetControllerState(const ActorId actor_id, const cc::Timestamp &timestamp);
+  const cc::Timestamp &GetTeleportationInstance(const ActorId actor_id, const cc::Timestamp &timestamp);
 
   std::pair<bool, float> CollisionHandling(const CollisionHazardData &collision_hazard,
                                            const bool tl_hazard,
@@ -88,6 +100,14 @@ public:
 
   void Update(const unsigned long index);
 
+  // Method to fix the hero location and respawn switch for the current cycle.
+  void PrepareCycle();
+
+  // Method to query whether a vehicle is teleported near the hero this cycle.
+  // Respawning vehicles claim free geodesic grids and must be updated serially
+  // in index order, every other vehicle can be updated concurrently.
+  bool IsRespawning(const unsigned long index) const;
+
   void RemoveActor(const ActorId actor_id);
 
   void Reset();
@@ -153,6 +153,10 @@ void Parameters::SetOSMMode(const bool mode_switch) {
   osm_mode.store(mode_switch);
 }
 
+void Parameters::SetWorkerThreads(const uint64_t number_of_threads) {
+  worker_threads.store(std::max(number_of_threads, static_cast<uint64_t>(1u)));
+}
+
 //////////////////////////////////// GETTERS //////////////////////////////////
 
 float Parameters::GetHybridPhysicsRadius() const {
@@ -310,5 +314,10 @@ bool Parameters::GetOSMMode() const {
   return osm_mode.load();
 }
 
+uint64_t Parameters::GetWorkerThreads() const {
+
+  return worker_threads.load();
+}
+
 } // namespace traffic_manager
 } // namespace carla
@@ -76,6 +76,8 @@ private:
   std::atomic<float> hybrid_physics_radius {70.0};
   /// Parameter specifying Open Street Map mode.
   std::atomic<bool> osm_mode {true};
+  /// Number of threads running the per-vehicle stage updates.
+  std::atomic<uint64_t> worker_threads {1u};
 
 public:
   Parameters();
@@ -150,6 +152,9 @@ public:
   /// Method to set limits for boundaries when respawning vehicles.
   void SetMaxBoundaries(const float lower, const float upper);
 
+  /// Method to set the number of threads running the per-vehicle stage updates.
+  void SetWorkerThreads(const uint64_t number_of_threads);
+
   ///////////////////////////////// GETTERS /////////////////////////////////////
 
   /// Method to retrieve hybrid physics radius.
@@ -206,6 +211,9 @@ public:
   /// Method to get Open Street Map mode.
   bool GetOSMMode() const;
 
+  /// Method to get the number of threads running the per-vehicle stage updates.
+  uint64_t GetWorkerThreads() const;
+
   /// Synchronous mode time out variable.
   std::chrono::duration<double, std::milli> synchronous_time_out;
 };
@@ -15,6 +15,30 @@ namespace traffic_manager {
 
   SimpleWaypoint::SimpleWaypoint(WaypointPtr _waypoint) {
     waypoint = _waypoint;
+    road_id = waypoint->GetRoadId();
+    lane_id = waypoint->GetLaneId();
+    s = static_cast<float>(waypoint->GetDistance());
+    waypoint_id = waypoint->GetId();
+    transform = waypoint->GetTransform();
+    junction_id = waypoint->IsJunction() ? waypoint->GetJunctionId() : -1;
+    next_left_waypoint = nullptr;
+    next_right_waypoint = nullptr;
+  }
+
+  SimpleWaypoint::SimpleWaypoint(WorldMap _world_map,
+                                 carla::road::RoadId _road_id,
+                                 carla::road::LaneId _lane_id,
+                                 float _s,
+                                 uint64_t _waypoint_id,
+                                 const cg::Transform &_transform,
+                                 carla::road::JuncId _junction_id)
+    : world_map(std::move(_world_map)),
+      road_id(_road_id),
+      lane_id(_lane_id),
+      s(_s),
+      waypoint_id(_waypoint_id),
+      transform(_transform),
+      junction_id(_junction_id) {
     next_left_waypoint = nullptr;
     next_right_waypoint = nullptr;
   }
@@ -29,11 +53,17 @@ namespace traffic_manager {
   }
 
   WaypointPtr SimpleWaypoint::GetWaypoint() const {
+    // Stages may ask for the same waypoint from several worker threads.
+    std::call_once(waypoint_flag, [this]() {
+      if (waypoint == nullptr && world_map != nullptr) {
+        waypoint = world_map->GetWaypointXODR(road_id, lane_id, s);
+      }
+    });
     return waypoint;
   }
 
   uint64_t SimpleWaypoint::GetId() const {
-    return waypoint->GetId();
+    return waypoint_id;
   }
 
   SimpleWaypointPtr SimpleWaypoint::GetLeftWaypoint() {
@@ -45,11 +75,11 @@ namespace traffic_manager {
   }
 
   cg::Location SimpleWaypoint::GetLocation() const {
-    return waypoint->GetTransform().location;
+    return transform.location;
   }
 
   cg::Vector3D SimpleWaypoint::GetForwardVector() const {
-    return waypoint->GetTransform().rotation.GetForwardVector();
+    return transform.rotation.GetForwardVector();
   }
 
   uint64_t SimpleWaypoint::SetNextWaypoint(const std::vector<SimpleWaypointPtr> &waypoints) {
@@ -68,7 +98,7 @@ namespace traffic_manager {
 
   void SimpleWaypoint::SetLeftWaypoint(SimpleWaypointPtr &_waypoint) {
 
-    const cg::Vector3D heading_vector = waypoint->GetTransform().GetForwardVector();
+    const cg::Vector3D heading_vector = transform.GetForwardVector();
     const cg::Vector3D relative_vector = GetLocation() - _waypoint->GetLocation();
     if ((heading_vector.x * relative_vector.y - heading_vector.y * relative_vector.x) > 0.0f) {
       next_left_waypoint = _waypoint;
@@ -77,7 +107,7 @@ namespace traffic_manager {
 
   void SimpleWaypoint::SetRightWaypoint(SimpleWaypointPtr &_waypoint) {
 
-    const cg::Vector3D heading_vector = waypoint->GetTransform().GetForwardVector();
+    const cg::Vector3D heading_vector = transform.GetForwardVector();
     const cg::Vector3D relative_vector = GetLocation() - _waypoint->GetLocation();
     if ((heading_vector.x * relative_vector.y - heading_vector.y * relative_vector.x) < 0.0f) {
       next_right_waypoint = _waypoint;
@@ -118,8 +148,8 @@ namespace traffic_manager {
 
   GeoGridId SimpleWaypoint::GetGeodesicGridId() {
     GeoGridId grid_id;
-    if (waypoint->IsJunction()) {
-      grid_id = waypoint->GetJunctionId();
+    if (junction_id != -1) {
+      grid_id = junction_id;
     } else {
       grid_id = geodesic_grid_id;
     }
@@ -127,11 +157,11 @@ namespace traffic_manager {
   }
 
   GeoGridId SimpleWaypoint::GetJunctionId() const {
-    return waypoint->GetJunctionId();
+    return junction_id;
   }
 
   cg::Transform SimpleWaypoint::GetTransform() const {
-    return waypoint->GetTransform();
+    return transform;
   }
 
 } // namespace traffic_manager
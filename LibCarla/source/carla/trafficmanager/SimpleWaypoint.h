@@ -7,7 +7,9 @@
 #pragma once
 
 #include <memory.h>
+#include <mutex>
 
+#include "carla/client/Map.h"
 #include "carla/client/Waypoint.h"
 #include "carla/geom/Location.h"
 #include "carla/geom/Transform.h"
@@ -22,6 +24,7 @@ namespace traffic_manager {
   namespace cg = carla::geom;
   using WaypointPtr = carla::SharedPtr<cc::Waypoint>;
   using GeoGridId = carla::road::JuncId;
+  using WorldMap = carla::SharedPtr<const cc::Map>;
 
   /// This is a simple wrapper class on Carla's waypoint object.
   /// The class is used to represent discrete samples of the world map.
@@ -32,7 +35,18 @@ namespace traffic_manager {
   private:
 
     /// Pointer to Carla's waypoint object around which this class wraps around.
-    WaypointPtr waypoint;
+    /// Waypoints restored from a cache create it on first request.
+    mutable WaypointPtr waypoint;
+    mutable std::once_flag waypoint_flag;
+    /// Map and OpenDRIVE coordinates used to create the waypoint object.
+    WorldMap world_map;
+    carla::road::RoadId road_id = 0u;
+    carla::road::LaneId lane_id = 0;
+    float s = 0.0f;
+    /// Values of the waypoint object read on every simulation cycle.
+    uint64_t waypoint_id = 0u;
+    cg::Transform transform;
+    carla::road::JuncId junction_id = -1;
     /// List of pointers to next connecting waypoints.
     std::vector<SimpleWaypointPtr> next_waypoints;
     /// List of pointers to previous connecting waypoints.
@@ -49,6 +63,15 @@ namespace traffic_manager {
   public:
 
     SimpleWaypoint(WaypointPtr _waypoint);
+    /// Restores a waypoint from cached values, the waypoint object is only
+    /// created from @a _world_map if GetWaypoint() is called.
+    SimpleWaypoint(WorldMap _world_map,
+                   carla::road::RoadId _road_id,
+                   carla::road::LaneId _lane_id,
+                   float _s,
+                   uint64_t _waypoint_id,
+                   const cg::Transform &_transform,
+                   carla::road::JuncId _junction_id);
     ~SimpleWaypoint();
 
     /// Returns the location object for this waypoint.
@@ -1,4 +1,6 @@
 
+#include <algorithm>
+
 #include "carla/trafficmanager/SimulationState.h"
 
 namespace carla {
@@ -10,77 +12,187 @@ void SimulationState::AddActor(ActorId actor_id,
                                KinematicState kinematic_state,
                                StaticAttributes attributes,
                                TrafficLightState tl_state) {
-  actor_set.insert(actor_id);
-  kinematic_state_map.insert({actor_id, kinematic_state});
-  static_attribute_map.insert({actor_id, attributes});
-  tl_state_map.insert({actor_id, tl_state});
+  if (ContainsActor(actor_id)) {
+    return;
+  }
+  actor_slots.insert({actor_id, actor_ids.size()});
+  actor_ids.push_back(actor_id);
+  locations.push_back(kinematic_state.location);
+  rotations.push_back(kinematic_state.rotation);
+  headings.push_back(kinematic_state.rotation.GetForwardVector());
+  velocities.push_back(kinematic_state.velocity);
+  speed_limits.push_back(kinematic_state.speed_limit);
+  physics_enabled.push_back(kinematic_state.physics_enabled);
+  dormant.push_back(kinematic_state.is_dormant);
+  actor_types.push_back(attributes.actor_type);
+  dimensions.emplace_back(attributes.half_length, attributes.half_width, attributes.half_height);
+  tl_states.push_back(tl_state);
 }
 
 bool SimulationState::ContainsActor(ActorId actor_id) const {
-  return actor_set.find(actor_id) != actor_set.end();
+  return actor_slots.find(actor_id) != actor_slots.end();
 }
 
 void SimulationState::RemoveActor(ActorId actor_id) {
-  actor_set.erase(actor_id);
-  kinematic_state_map.erase(actor_id);
-  static_attribute_map.erase(actor_id);
-  tl_state_map.erase(actor_id);
+  auto it = actor_slots.find(actor_id);
+  if (it == actor_slots.end()) {
+    return;
+  }
+  // Fill the slot with the last actor to keep the arrays dense.
+  const size_t slot = it->second;
+  const size_t last_slot = actor_ids.size() - 1u;
+  actor_slots.erase(it);
+  if (slot != last_slot) {
+    MoveSlot(last_slot, slot);
+    actor_slots.at(actor_ids[slot]) = slot;
+  }
+
+  actor_ids.pop_back();
+  locations.pop_back();
+  rotations.pop_back();
+  headings.pop_back();
+  velocities.pop_back();
+  speed_limits.pop_back();
+  physics_enabled.pop_back();
+  dormant.pop_back();
+  actor_types.pop_back();
+  dimensions.pop_back();
+  tl_states.pop_back();
 }
 
 void SimulationState::Reset() {
-  actor_set.clear();
-  kinematic_state_map.clear();
-  static_attribute_map.clear();
-  tl_state_map.clear();
+  actor_slots.clear();
+  actor_ids.clear();
+  locations.clear();
+  rotations.clear();
+  headings.clear();
+  velocities.clear();
+  speed_limits.clear();
+  physics_enabled.clear();
+  dormant.clear();
+  actor_types.clear();
+  dimensions.clear();
+  tl_states.clear();
 }
 
 void SimulationState::UpdateKinematicState(ActorId actor_id, KinematicState state) {
-  kinematic_state_map.at(actor_id) = state;
+  const size_t slot = GetSlot(actor_id);
+  locations[slot] = state.location;
+  rotations[slot] = state.rotation;
+  headings[slot] = state.rotation.GetForwardVector();
+  velocities[slot] = state.velocity;
+  speed_limits[slot] = state.speed_limit;
+  physics_enabled[slot] = state.physics_enabled;
+  dormant[slot] = state.is_dormant;
 }
 
 void SimulationState::UpdateTrafficLightState(ActorId actor_id, TrafficLightState state) {
-  tl_state_map.at(actor_id) = state;
+  tl_states[GetSlot(actor_id)] = state;
 }
 
 cg::Location SimulationState::GetLocation(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).location;
+  return locations[GetSlot(actor_id)];
 }
 
 cg::Rotation SimulationState::GetRotation(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).rotation;
+  return rotations[GetSlot(actor_id)];
 }
 
 cg::Vector3D SimulationState::GetHeading(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).rotation.GetForwardVector();
+  return headings[GetSlot(actor_id)];
 }
 
 cg::Vector3D SimulationState::GetVelocity(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).velocity;
+  return velocities[GetSlot(actor_id)];
 }
 
 float SimulationState::GetSpeedLimit(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).speed_limit;
+  return speed_limits[GetSlot(actor_id)];
 }
 
 bool SimulationState::IsPhysicsEnabled(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).physics_enabled;
+  return physics_enabled[GetSlot(actor_id)];
 }
 
 bool SimulationState::IsDormant(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).is_dormant;
+  return dormant[GetSlot(actor_id)];
 }
 
 TrafficLightState SimulationState::GetTLS(ActorId actor_id) const {
-  return tl_state_map.at(actor_id);
+  return tl_states[GetSlot(actor_id)];
 }
 
 ActorType SimulationState::GetType(ActorId actor_id) const {
-  return static_attribute_map.at(actor_id).actor_type;
+  return actor_types[GetSlot(actor_id)];
 }
 
 cg::Vector3D SimulationState::GetDimensions(ActorId actor_id) const {
-  const StaticAttributes &attributes = static_attribute_map.at(actor_id);
-  return cg::Vector3D(attributes.half_length, attributes.half_width, attributes.half_height);
+  return dimensions[GetSlot(actor_id)];
+}
+
+void SimulationState::ArrangeSlots(const std::vector<ActorId> &vehicle_id_list) {
+  if (vehicle_id_list.size() <= actor_ids.size()
+      && std::equal(vehicle_id_list.begin(), vehicle_id_list.end(), actor_ids.begin())) {
+    return;
+  }
+  size_t target_slot = 0u;
+  for (const ActorId vehicle_id : vehicle_id_list) {
+    auto it = actor_slots.find(vehicle_id);
+    if (it == actor_slots.end()) {
+      // Vehicles missing from the state are skipped, the ones after them are
+      // found through the id to slot table.
+      continue;
+    }
+    if (it->second != target_slot) {
+      SwapSlots(it->second, target_slot);
+    }
+    ++target_slot;
+  }
+}
+
+size_t SimulationState::Size() const {
+  return actor_ids.size();
+}
+
+size_t SimulationState::GetSlot(const ActorId actor_id) const {
+  return actor_slots.at(actor_id);
+}
+
+size_t SimulationState::GetVehicleSlot(const unsigned long index, const ActorId actor_id) const {
+  if (index < actor_ids.size() && actor_ids[index] == actor_id) {
+    return index;
+  }
+  return GetSlot(actor_id);
+}
+
+void SimulationState::MoveSlot(const size_t from, const size_t to) {
+  actor_ids[to] = actor_ids[from];
+  locations[to] = locations[from];
+  rotations[to] = rotations[from];
+  headings[to] = headings[from];
+  velocities[to] = velocities[from];
+  speed_limits[to] = speed_limits[from];
+  physics_enabled[to] = physics_enabled[from];
+  dormant[to] = dormant[from];
+  actor_types[to] = actor_types[from];
+  dimensions[to] = dimensions[from];
+  tl_states[to] = tl_states[from];
+}
+
+void SimulationState::SwapSlots(const size_t first, const size_t second) {
+  std::swap(actor_ids[first], actor_ids[second]);
+  std::swap(locations[first], locations[second]);
+  std::swap(rotations[first], rotations[second]);
+  std::swap(headings[first], headings[second]);
+  std::swap(velocities[first], velocities[second]);
+  std::swap(speed_limits[first], speed_limits[second]);
+  std::vector<bool>::swap(physics_enabled[first], physics_enabled[second]);
+  std::vector<bool>::swap(dormant[first], dormant[second]);
+  std::swap(actor_types[first], actor_types[second]);
+  std::swap(dimensions[first], dimensions[second]);
+  std::swap(tl_states[first], tl_states[second]);
+  actor_slots.at(actor_ids[first]) = first;
+  actor_slots.at(actor_ids[second]) = second;
 }
 
 } // namespace  traffic_manager
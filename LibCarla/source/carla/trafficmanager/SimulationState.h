@@ -1,7 +1,8 @@
 
 #pragma once
 
-#include <unordered_set>
+#include <unordered_map>
+#include <vector>
 
 #include "carla/trafficmanager/DataStructures.h"
 
@@ -39,17 +40,37 @@ struct StaticAttributes {
 using StaticAttributeMap = std::unordered_map<ActorId, StaticAttributes>;
 
 /// This class holds the state of all the vehicles in the simlation.
+///
+/// States are stored in dense arrays indexed by slot, with a table mapping
+/// actor ids to slots. After ArrangeSlots, the vehicle at position i of the
+/// vehicle id list is at slot i, so the per-vehicle stage updates read the
+/// state of consecutive vehicles from contiguous memory.
 class SimulationState {
 
 private:
-  // Structure to hold ids of all actors in the simulation.
-  std::unordered_set<ActorId> actor_set;
-  // Structure containing dynamic motion related state of actors.
-  KinematicStateMap kinematic_state_map;
-  // Structure containing static attributes of actors.
-  StaticAttributeMap static_attribute_map;
-  // Structure containing dynamic traffic light related state of actors.
-  TrafficLightStateMap tl_state_map;
+  // Structure mapping the ids of all actors in the simulation to their slot.
+  std::unordered_map<ActorId, size_t> actor_slots;
+  // Actor ids per slot.
+  std::vector<ActorId> actor_ids;
+  // Dynamic motion related state of actors, per slot.
+  std::vector<cg::Location> locations;
+  std::vector<cg::Rotation> rotations;
+  std::vector<cg::Vector3D> headings;
+  std::vector<cg::Vector3D> velocities;
+  std::vector<float> speed_limits;
+  std::vector<bool> physics_enabled;
+  std::vector<bool> dormant;
+  // Static attributes of actors, per slot.
+  std::vector<ActorType> actor_types;
+  std::vector<cg::Vector3D> dimensions;
+  // Dynamic traffic light related state of actors, per slot.
+  std::vector<TrafficLightState> tl_states;
+
+  // Method to move the actor in slot @a from to slot @a to, overwriting it.
+  void MoveSlot(const size_t from, const size_t to);
+
+  // Method to exchange the actors in two slots.
+  void SwapSlots(const size_t first, const size_t second);
 
 public :
   SimulationState();
@@ -95,6 +116,68 @@ public :
 
   cg::Vector3D GetDimensions(const ActorId actor_id) const;
 
+  /// @name Slot based access
+  /// @{
+
+  // Method to move the vehicles in @a vehicle_id_list to the slots matching
+  // their position in the list. Nothing is moved if they are already there.
+  void ArrangeSlots(const std::vector<ActorId> &vehicle_id_list);
+
+  // Number of actors, valid slots are in the range [0, Size()).
+  size_t Size() const;
+
+  // Method to retrieve the slot of an actor.
+  size_t GetSlot(const ActorId actor_id) const;
+
+  // Method to retrieve the slot of the vehicle at position @a index of the
+  // arranged vehicle id list, without hashing if the slots are arranged.
+  size_t GetVehicleSlot(const unsigned long index, const ActorId actor_id) const;
+
+  ActorId GetActorIdAt(const size_t slot) const {
+    return actor_ids[slot];
+  }
+
+  const cg::Location &GetLocationAt(const size_t slot) const {
+    return locations[slot];
+  }
+
+  const cg::Rotation &GetRotationAt(const size_t slot) const {
+    return rotations[slot];
+  }
+
+  const cg::Vector3D &GetHeadingAt(const size_t slot) const {
+    return headings[slot];
+  }
+
+  const cg::Vector3D &GetVelocityAt(const size_t slot) const {
+    return velocities[slot];
+  }
+
+  float GetSpeedLimitAt(const size_t slot) const {
+    return speed_limits[slot];
+  }
+
+  bool IsPhysicsEnabledAt(const size_t slot) const {
+    return physics_enabled[slot];
+  }
+
+  bool IsDormantAt(const size_t slot) const {
+    return dormant[slot];
+  }
+
+  const TrafficLightState &GetTLSAt(const size_t slot) const {
+    return tl_states[slot];
+  }
+
+  ActorType GetTypeAt(const size_t slot) const {
+    return actor_types[slot];
+  }
+
+  const cg::Vector3D &GetDimensionsAt(const size_t slot) const {
+    return dimensions[slot];
+  }
+
+  /// @}
 };
 
 } // namespace traffic_manager
@@ -30,14 +30,15 @@ void TrafficLightStage::Update(const unsigned long index) {
   bool traffic_light_hazard = false;
 
   const ActorId ego_actor_id = vehicle_id_list.at(index);
-  if (!simulation_state.IsDormant(ego_actor_id)) {
+  const size_t ego_slot = simulation_state.GetVehicleSlot(index, ego_actor_id);
+  if (!simulation_state.IsDormantAt(ego_slot)) {
     const Buffer &waypoint_buffer = buffer_map.at(ego_actor_id);
     const SimpleWaypointPtr look_ahead_point = GetTargetWaypoint(waypoint_buffer, JUNCTION_LOOK_AHEAD).first;
 
-    const JunctionID junction_id = look_ahead_point->GetWaypoint()->GetJunctionId();
+    const JunctionID junction_id = look_ahead_point->GetJunctionId();
     current_timestamp = world.GetSnapshot().GetTimestamp();
 
-    const TrafficLightState tl_state = simulation_state.GetTLS(ego_actor_id);
+    const TrafficLightState tl_state = simulation_state.GetTLSAt(ego_slot);
     const TLS traffic_light_state = tl_state.tl_state;
     const bool is_at_traffic_light = tl_state.at_traffic_light;
 
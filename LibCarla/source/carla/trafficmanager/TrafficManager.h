@@ -88,6 +88,15 @@ public:
     }
   }
 
+  /// Method to set the number of threads running the per-vehicle stage
+  /// updates. A single thread (the default) updates every vehicle serially.
+  void SetWorkerThreads(const uint64_t number_of_threads) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if (tm_ptr != nullptr) {
+      tm_ptr->SetWorkerThreads(number_of_threads);
+    }
+  }
+
   /// This method sets the hybrid physics mode.
   void SetHybridPhysicsMode(const bool mode_switch) {
     TrafficManagerBase* tm_ptr = GetTM(_port);
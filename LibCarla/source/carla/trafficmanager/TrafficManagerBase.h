@@ -116,6 +116,9 @@ public:
   /// Method to set limits for boundaries when respawning vehicles.
   virtual void SetMaxBoundaries(const float lower, const float upper) = 0;
 
+  /// Method to set the number of threads running the per-vehicle stage updates.
+  virtual void SetWorkerThreads(const uint64_t number_of_threads) = 0;
+
   virtual void ShutDown() = 0;
 
 protected:
@@ -217,6 +217,12 @@ public:
     _client->call("set_max_boundaries", lower, upper);
   }
 
+  /// Method to set the number of threads running the per-vehicle stage updates.
+  void SetWorkerThreads(const uint64_t number_of_threads) {
+    DEBUG_ASSERT(_client != nullptr);
+    _client->call("set_worker_threads", number_of_threads);
+  }
+
   void ShutDown() {
     DEBUG_ASSERT(_client != nullptr);
     _client->call("shut_down");
@@ -44,13 +44,13 @@ TrafficManagerLocal::TrafficManagerLocal(
                                          localization_frame,
                                          random_devices)),
 
-    collision_stage(CollisionStage(vehicle_id_list,
-                                   simulation_state,
-                                   buffer_map,
-                                   track_traffic,
-                                   parameters,
-                                   collision_frame,
-                                   random_devices)),
+    collision_stage(vehicle_id_list,
+                    simulation_state,
+                    buffer_map,
+                    track_traffic,
+                    parameters,
+                    collision_frame,
+                    random_devices),
 
     traffic_light_stage(TrafficLightStage(vehicle_id_list,
                                           simulation_state,
@@ -60,22 +60,22 @@ TrafficManagerLocal::TrafficManagerLocal(
                                           tl_frame,
                                           random_devices)),
 
-    motion_plan_stage(MotionPlanStage(vehicle_id_list,
-                                      simulation_state,
-                                      parameters,
-                                      buffer_map,
-                                      track_traffic,
-                                      longitudinal_PID_parameters,
-                                      longitudinal_highway_PID_parameters,
-                                      lateral_PID_parameters,
-                                      lateral_highway_PID_parameters,
-                                      localization_frame,
-                                      collision_frame,
-                                      tl_frame,
-                                      world,
-                                      control_frame,
-                                      random_devices,
-                                      local_map)),
+    motion_plan_stage(vehicle_id_list,
+                      simulation_state,
+                      parameters,
+                      buffer_map,
+                      track_traffic,
+                      longitudinal_PID_parameters,
+                      longitudinal_highway_PID_parameters,
+                      lateral_PID_parameters,
+                      lateral_highway_PID_parameters,
+                      localization_frame,
+                      collision_frame,
+                      tl_frame,
+                      world,
+                      control_frame,
+                      random_devices,
+                      local_map),
 
     alsm(ALSM(registered_vehicles,
               buffer_map,
@@ -114,16 +114,13 @@ void TrafficManagerLocal::SetupLocalMap() {
   auto files = episode_proxy.Lock()->GetRequiredFiles("TM");
   if (!files.empty()) {
     auto content = episode_proxy.Lock()->GetCacheFile(files[0], true);
-    if (content.size() != 0) {
-      local_map->Load(content);
-    } else {
-      log_warning("No InMemoryMap cache found. Setting up local map. This may take a while...");
-      local_map->SetUp();
+    if (content.size() != 0 && local_map->Load(content)) {
+      return;
     }
-  } else {
-    log_warning("No InMemoryMap cache found. Setting up local map. This may take a while...");
-    local_map->SetUp();
   }
+  log_warning("No InMemoryMap cache found. Setting up local map. This may take a while...");
+  local_map = std::make_shared<InMemoryMap>(world_map);
+  local_map->SetUp();
 }
 
 void TrafficManagerLocal::Start() {
@@ -202,6 +199,9 @@ void TrafficManagerLocal::Run() {
       registered_vehicles_state = registered_vehicles.GetState();
     }
 
+    // Keeping the state of registered vehicles in the order of the vehicle id list.
+    simulation_state.ArrangeSlots(vehicle_id_list);
+
     // Reset frames for current cycle.
     localization_frame.clear();
     localization_frame.resize(number_of_vehicles);
@@ -213,17 +213,30 @@ void TrafficManagerLocal::Run() {
     control_frame.resize(number_of_vehicles);
 
     // Run core operation stages.
+    UpdateStagePool();
 
+    // Localization and junction tickets at non-signalised junctions depend on
+    // the order in which vehicles are updated, so these always run serially.
     for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
       localization_stage.Update(index);
     }
-    for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
-      collision_stage.Update(index);
-    }
+    collision_stage.PrepareCycle(stage_pool != nullptr);
+    RunStage([this](const unsigned long index) { collision_stage.Update(index); });
     collision_stage.ClearCycleCache();
     for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
       traffic_light_stage.Update(index);
-      motion_plan_stage.Update(index);
+    }
+    motion_plan_stage.PrepareCycle();
+    RunStage([this](const unsigned long index) {
+      if (!motion_plan_stage.IsRespawning(index)) {
+        motion_plan_stage.Update(index);
+      }
+    });
+    // Respawning vehicles compete for free geodesic grids, resolve them in order.
+    for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
+      if (motion_plan_stage.IsRespawning(index)) {
+        motion_plan_stage.Update(index);
+      }
     }
 
     registration_lock.unlock();
@@ -253,6 +266,19 @@ bool TrafficManagerLocal::SynchronousTick() {
   return true;
 }
 
+void TrafficManagerLocal::UpdateStagePool() {
+  const uint64_t requested_threads = parameters.GetWorkerThreads();
+  if (requested_threads != stage_pool_threads) {
+    stage_pool.reset();
+    if (requested_threads > 1u) {
+      // The worker thread also takes part in every stage.
+      stage_pool = std::make_unique<ThreadPool>();
+      stage_pool->AsyncRun(requested_threads - 1u);
+    }
+    stage_pool_threads = requested_threads;
+  }
+}
+
 void TrafficManagerLocal::Stop() {
 
   run_traffic_manger.store(false);
@@ -266,6 +292,8 @@ void TrafficManagerLocal::Stop() {
     }
     worker_thread.release();
   }
+  stage_pool.reset();
+  stage_pool_threads = 1u;
 
   vehicle_id_list.clear();
   registered_vehicles.Clear();
@@ -401,6 +429,10 @@ void TrafficManagerLocal::SetMaxBoundaries(const float lower, const float upper)
   parameters.SetMaxBoundaries(lower, upper);
 }
 
+void TrafficManagerLocal::SetWorkerThreads(const uint64_t number_of_threads) {
+  parameters.SetWorkerThreads(number_of_threads);
+}
+
 bool TrafficManagerLocal::CheckAllFrozen(TLGroup tl_to_freeze) {
   for (auto &elem : tl_to_freeze) {
     if (!elem->IsFrozen() || elem->GetState() != TLS::Red) {
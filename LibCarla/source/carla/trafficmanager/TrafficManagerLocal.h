@@ -17,6 +17,7 @@
 #include "carla/client/World.h"
 #include "carla/Memory.h"
 #include "carla/rpc/Command.h"
+#include "carla/ThreadPool.h"
 
 #include "carla/trafficmanager/AtomicActorSet.h"
 #include "carla/trafficmanager/InMemoryMap.h"
@@ -108,6 +109,10 @@ private:
   std::condition_variable step_end_trigger;
   /// Single worker thread for sequential execution of sub-components.
   std::unique_ptr<std::thread> worker_thread;
+  /// Thread pool sharing the per-vehicle stage updates with the worker thread.
+  std::unique_ptr<ThreadPool> stage_pool;
+  /// Number of threads, including the worker thread, of the current pool.
+  uint64_t stage_pool_threads {1u};
   /// Structure holding random devices per vehicle.
   RandomGeneratorMap random_devices;
   /// Randomization seed.
@@ -120,6 +125,25 @@ private:
   /// Method to check if all traffic lights are frozen in a group.
   bool CheckAllFrozen(TLGroup tl_to_freeze);
 
+  /// Method to resize the stage thread pool to the requested number of threads.
+  void UpdateStagePool();
+
+  /// Method to run a stage update for every registered vehicle, spread over
+  /// the stage thread pool if there is one.
+  template <typename StageUpdate>
+  void RunStage(StageUpdate &&update) {
+    const unsigned long number_of_vehicles = vehicle_id_list.size();
+    if (stage_pool == nullptr) {
+      for (unsigned long index = 0u; index < number_of_vehicles; ++index) {
+        update(index);
+      }
+    } else {
+      stage_pool->ParallelFor(number_of_vehicles,
+                              constants::StageExecution::VEHICLES_PER_CHUNK,
+                              std::forward<StageUpdate>(update));
+    }
+  }
+
 public:
   /// Private constructor for singleton lifecycle management.
   TrafficManagerLocal(std::vector<float> longitudinal_PID_parameters,
@@ -234,6 +258,9 @@ public:
   // Method to set limits for boundaries when respawning dormant vehicles.
   void SetMaxBoundaries(const float lower, const float upper);
 
+  /// Method to set the number of threads running the per-vehicle stage updates.
+  void SetWorkerThreads(const uint64_t number_of_threads);
+
   void ShutDown() {};
 };
 
@@ -199,6 +199,10 @@ void TrafficManagerRemote::SetMaxBoundaries(const float lower, const float upper
   client.SetMaxBoundaries(lower, upper);
 }
 
+void TrafficManagerRemote::SetWorkerThreads(const uint64_t number_of_threads) {
+  client.SetWorkerThreads(number_of_threads);
+}
+
 void TrafficManagerRemote::ShutDown() {
   client.ShutDown();
 }
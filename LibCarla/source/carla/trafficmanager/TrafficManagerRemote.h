@@ -114,6 +114,9 @@ public:
   // Method to set boundaries to respawn of dormant vehicles.
   void SetMaxBoundaries(const float lower, const float upper);
 
+  /// Method to set the number of threads running the per-vehicle stage updates.
+  void SetWorkerThreads(const uint64_t number_of_threads);
+
   virtual void ShutDown();
 
   /// Method to provide synchronous tick
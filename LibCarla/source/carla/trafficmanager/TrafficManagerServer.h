@@ -178,6 +178,11 @@ public:
         tm->SetBoundariesRespawnDormantVehicles(lower_bound, upper_bound);
       });
 
+      /// Method to set the number of threads running the per-vehicle stage updates.
+      server->bind("set_worker_threads", [=](const uint64_t number_of_threads) {
+        tm->SetWorkerThreads(number_of_threads);
+      });
+
       server->bind("shut_down", [=]() {
         tm->Release();
       });
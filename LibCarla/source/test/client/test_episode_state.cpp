@@ -0,0 +1,285 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "Random.h"
+
+#include <carla/StopWatch.h>
+#include <carla/client/detail/EpisodeState.h>
+#include <carla/geom/Math.h>
+#include <carla/sensor/SensorRegistry.h>
+#include <carla/sensor/data/RawEpisodeState.h>
+#include <carla/sensor/s11n/EpisodeStateEncoder.h>
+#include <carla/sensor/s11n/SensorHeaderSerializer.h>
+
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <map>
+
+using carla::client::detail::EpisodeState;
+using carla::sensor::data::ActorDynamicState;
+using carla::sensor::data::RawEpisodeState;
+using carla::sensor::s11n::EpisodeStateEncoder;
+using carla::sensor::s11n::EpisodeStateSerializer;
+
+namespace cg = carla::geom;
+
+static ActorDynamicState MakeActor(carla::ActorId id) {
+  ActorDynamicState actor{};
+  actor.id = id;
+  actor.actor_state = carla::rpc::ActorState::Active;
+  actor.transform.location = cg::Location(
+      static_cast<float>(util::Random::Uniform(-1000.0, 1000.0)),
+      static_cast<float>(util::Random::Uniform(-1000.0, 1000.0)),
+      0.0f);
+  return actor;
+}
+
+/// The actors of a simulated world, a fraction of them moves every tick.
+class FakeWorld {
+public:
+
+  explicit FakeWorld(size_t actor_count) {
+    for (auto i = 0u; i < actor_count; ++i) {
+      AddActor();
+    }
+  }
+
+  void Tick(double moving_ratio) {
+    ++_frame;
+    for (auto &pair : _actors) {
+      auto &actor = pair.second;
+      if (util::Random::Uniform(0.0, 1.0) < moving_ratio) {
+        const float speed = static_cast<float>(util::Random::Uniform(0.0, 10.0));
+        actor.velocity = cg::Vector3D(speed, 0.0f, 0.0f);
+        actor.transform.location.x += 0.05f * speed;
+        actor.transform.rotation.yaw += 0.05f * speed;
+      } else {
+        actor.velocity = cg::Vector3D();
+      }
+    }
+  }
+
+  void AddActor() {
+    ++_last_id;
+    _actors.emplace(_last_id, MakeActor(_last_id));
+  }
+
+  void RemoveActor() {
+    if (!_actors.empty()) {
+      _actors.erase(_actors.begin());
+    }
+  }
+
+  carla::Buffer Encode(EpisodeStateEncoder &encoder, bool delta_mode) const {
+    EpisodeStateSerializer::Header header;
+    header.episode_id = 1u;
+    header.platform_timestamp = 0.0;
+    header.delta_seconds = 0.05f;
+    header.map_origin = cg::Vector3DInt();
+    encoder.Begin(carla::Buffer(), _frame, header, _actors.size(), delta_mode);
+    for (auto &pair : _actors) {
+      encoder.Add(pair.second);
+    }
+    return encoder.End();
+  }
+
+  uint64_t GetFrame() const {
+    return _frame;
+  }
+
+  const std::map<carla::ActorId, ActorDynamicState> &GetActors() const {
+    return _actors;
+  }
+
+private:
+
+  uint64_t _frame = 1u;
+
+  carla::ActorId _last_id = 0u;
+
+  std::map<carla::ActorId, ActorDynamicState> _actors;
+};
+
+/// Prepend the sensor header the streaming server adds to every message and
+/// deserialize it as the client does.
+static carla::SharedPtr<const RawEpisodeState> Receive(uint64_t frame, const carla::Buffer &payload) {
+  using namespace carla::sensor;
+  const auto header = s11n::SensorHeaderSerializer::Serialize(
+      SensorRegistry::get<FWorldObserver *>::index,
+      frame,
+      0.0,
+      carla::rpc::Transform{});
+  carla::Buffer message;
+  message.reset(header.size() + payload.size());
+  std::memcpy(message.data(), header.data(), header.size());
+  std::memcpy(message.data() + header.size(), payload.data(), payload.size());
+  return boost::static_pointer_cast<const RawEpisodeState>(
+      SensorRegistry::Deserialize(std::move(message)));
+}
+
+/// Mimics client::detail::Episode, deltas are only applied on top of their
+/// base frame.
+static std::shared_ptr<const EpisodeState> Apply(
+    std::shared_ptr<const EpisodeState> prev,
+    carla::SharedPtr<const RawEpisodeState> raw_state) {
+  if (!raw_state->IsDelta()) {
+    return std::make_shared<const EpisodeState>(std::move(raw_state));
+  }
+  if (prev->GetFrame() != raw_state->GetBaseFrame()) {
+    return prev;
+  }
+  return std::make_shared<const EpisodeState>(*raw_state, *prev);
+}
+
+static void CheckState(const FakeWorld &world, const EpisodeState &state) {
+  const float location_threshold = EpisodeStateEncoder::LocationThreshold;
+  const float rotation_threshold = EpisodeStateEncoder::RotationThreshold;
+  const float velocity_threshold = EpisodeStateEncoder::VelocityThreshold;
+  ASSERT_EQ(state.GetFrame(), world.GetFrame());
+  ASSERT_EQ(state.size(), world.GetActors().size());
+  ASSERT_FALSE(state.ContainsActorSnapshot(0u));
+  ASSERT_FALSE(state.GetActorSnapshotIfPresent(std::prev(world.GetActors().end())->first + 1u).has_value());
+  size_t count = 0u;
+  for (auto id : state.GetActorIds()) {
+    ASSERT_EQ(world.GetActors().count(id), 1u);
+    ++count;
+  }
+  ASSERT_EQ(count, world.GetActors().size());
+  for (auto &pair : world.GetActors()) {
+    auto &expected = pair.second;
+    auto snapshot = state.GetActorSnapshotIfPresent(pair.first);
+    ASSERT_TRUE(snapshot.has_value());
+    ASSERT_LE(
+        cg::Math::Distance(snapshot->transform.location, expected.transform.location),
+        location_threshold);
+    ASSERT_LE(
+        std::abs(snapshot->transform.rotation.yaw - expected.transform.rotation.yaw),
+        rotation_threshold);
+    ASSERT_LE((snapshot->velocity - expected.velocity).Length(), velocity_threshold);
+  }
+}
+
+TEST(episode_state, delta_round_trip) {
+  FakeWorld world(500u);
+  EpisodeStateEncoder encoder;
+  auto state = std::make_shared<const EpisodeState>(1u);
+  size_t keyframes = 0u;
+  for (auto tick = 0u; tick < 3u * EpisodeStateEncoder::KeyframeInterval; ++tick) {
+    world.Tick(0.2);
+    if (tick % 7u == 0u) {
+      world.RemoveActor();
+    }
+    if (tick % 5u == 0u) {
+      world.AddActor();
+    }
+    const auto payload = world.Encode(encoder, true);
+    keyframes += encoder.IsKeyframe() ? 1u : 0u;
+    auto raw_state = Receive(world.GetFrame(), payload);
+    ASSERT_EQ(raw_state->IsDelta(), !encoder.IsKeyframe());
+    state = Apply(state, raw_state);
+    CheckState(world, *state);
+  }
+  ASSERT_EQ(keyframes, 3u);
+
+  // A client that missed a message ignores the deltas until the next keyframe.
+  world.Tick(0.2);
+  world.Encode(encoder, true);
+  auto stale_state = state;
+  for (auto tick = 0u; tick < EpisodeStateEncoder::KeyframeInterval; ++tick) {
+    world.Tick(0.2);
+    const auto payload = world.Encode(encoder, true);
+    stale_state = Apply(stale_state, Receive(world.GetFrame(), payload));
+    if (encoder.IsKeyframe()) {
+      break;
+    }
+    ASSERT_EQ(stale_state, state);
+  }
+  CheckState(world, *stale_state);
+
+  // Without delta mode every message is a full, exact copy of the state.
+  world.Tick(0.2);
+  const auto payload = world.Encode(encoder, false);
+  ASSERT_TRUE(encoder.IsKeyframe());
+  ASSERT_EQ(
+      payload.size(),
+      sizeof(EpisodeStateSerializer::Header) + sizeof(ActorDynamicState) * world.GetActors().size());
+  auto raw_state = Receive(world.GetFrame(), payload);
+  ASSERT_FALSE(raw_state->IsDelta());
+  auto it = raw_state->begin();
+  for (auto &pair : world.GetActors()) {
+    ASSERT_EQ(std::memcmp(&*it, &pair.second, sizeof(ActorDynamicState)), 0);
+    ++it;
+  }
+}
+
+TEST(episode_state, late_subscriber) {
+  FakeWorld world(200u);
+  EpisodeStateEncoder encoder;
+  auto state = std::make_shared<const EpisodeState>(1u);
+  for (auto tick = 0u; tick < EpisodeStateEncoder::KeyframeInterval / 2u; ++tick) {
+    world.Tick(0.2);
+    state = Apply(state, Receive(world.GetFrame(), world.Encode(encoder, true)));
+  }
+  ASSERT_FALSE(encoder.IsKeyframe());
+
+  // A client joins between keyframes, the server forces a keyframe so it gets
+  // the whole state with its first message.
+  auto late_state = std::make_shared<const EpisodeState>(1u);
+  encoder.ForceKeyframe();
+  world.Tick(0.2);
+  auto payload = world.Encode(encoder, true);
+  ASSERT_TRUE(encoder.IsKeyframe());
+  state = Apply(state, Receive(world.GetFrame(), payload));
+  late_state = Apply(late_state, Receive(world.GetFrame(), payload));
+  CheckState(world, *state);
+  CheckState(world, *late_state);
+
+  // Then both clients go on with the deltas.
+  for (auto tick = 0u; tick < 5u; ++tick) {
+    world.Tick(0.2);
+    payload = world.Encode(encoder, true);
+    ASSERT_FALSE(encoder.IsKeyframe());
+    state = Apply(state, Receive(world.GetFrame(), payload));
+    late_state = Apply(late_state, Receive(world.GetFrame(), payload));
+    CheckState(world, *state);
+    CheckState(world, *late_state);
+  }
+}
+
+TEST(episode_state, benchmark_delta) {
+  constexpr auto number_of_ticks = 120u;
+  for (double moving_ratio : {0.05, 0.2}) {
+    for (bool delta_mode : {false, true}) {
+      FakeWorld world(5000u);
+      EpisodeStateEncoder encoder;
+      auto state = std::make_shared<const EpisodeState>(1u);
+      size_t bytes = 0u;
+      size_t encode_time = 0u;
+      size_t decode_time = 0u;
+      for (auto tick = 0u; tick < number_of_ticks; ++tick) {
+        world.Tick(moving_ratio);
+        carla::StopWatch stop_watch;
+        const auto payload = world.Encode(encoder, delta_mode);
+        stop_watch.Stop();
+        encode_time += stop_watch.GetElapsedTime<std::chrono::microseconds>();
+        bytes += payload.size();
+        stop_watch.Restart();
+        state = Apply(state, Receive(world.GetFrame(), payload));
+        stop_watch.Stop();
+        decode_time += stop_watch.GetElapsedTime<std::chrono::microseconds>();
+      }
+      ASSERT_EQ(state->GetFrame(), world.GetFrame());
+      carla::logging::log(
+          delta_mode ? "delta" : "full",
+          "episode state, 5000 actors,", 100.0 * moving_ratio, "% moving:",
+          bytes / number_of_ticks / 1000u, "kB per tick, encode",
+          encode_time / number_of_ticks, "us, decode",
+          decode_time / number_of_ticks, "us");
+    }
+  }
+}
@@ -5,12 +5,21 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 #include "test.h"
+#include "Random.h"
 
+#include <carla/StopWatch.h>
+#include <carla/image/BulkColorConverter.h>
 #include <carla/image/ImageConverter.h>
 #include <carla/image/ImageIO.h>
 #include <carla/image/ImageView.h>
+#include <carla/sensor/SensorRegistry.h>
+#include <carla/sensor/data/Image.h>
+#include <carla/sensor/s11n/SensorHeaderSerializer.h>
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
+#include <vector>
 
 template <typename ViewT, typename PixelT>
 struct TestImage {
@@ -186,3 +195,176 @@ TEST(image, semantic_segmentation) {
     }
   }
 }
+
+/// Random BGRA8 pixels; the first @a number_of_depths pixels encode every
+/// depth value in order.
+static std::vector<uint8_t> MakeRandomPixels(size_t number_of_pixels, size_t number_of_depths = 0u) {
+  std::vector<uint8_t> pixels(4u * number_of_pixels);
+  for (auto i = 0u; i < number_of_pixels; ++i) {
+    for (auto c = 0u; c < 4u; ++c) {
+      pixels[4u * i + c] = static_cast<uint8_t>(util::Random::Uniform(0.0, 256.0));
+    }
+    if (i < number_of_depths) {
+      pixels[4u * i + 2u] = static_cast<uint8_t>(i);
+      pixels[4u * i + 1u] = static_cast<uint8_t>(i >> 8u);
+      pixels[4u * i + 0u] = static_cast<uint8_t>(i >> 16u);
+    }
+  }
+  return pixels;
+}
+
+/// Convert @a pixels in place pixel by pixel through a boost::gil view.
+template <typename ColorConverter>
+static void ConvertWithView(std::vector<uint8_t> &pixels, ColorConverter converter) {
+  auto view = boost::gil::interleaved_view(
+      pixels.size() / 4u,
+      1u,
+      reinterpret_cast<boost::gil::bgra8_pixel_t *>(pixels.data()),
+      static_cast<long>(pixels.size()));
+  carla::image::ImageConverter::ConvertInPlace(view, converter);
+}
+
+/// Index of the first byte that differs, or the size if they are equal.
+static size_t FirstMismatch(const std::vector<uint8_t> &lhs, const std::vector<uint8_t> &rhs) {
+  return static_cast<size_t>(std::mismatch(lhs.begin(), lhs.end(), rhs.begin()).first - lhs.begin());
+}
+
+TEST(image, bulk_color_converters) {
+  using namespace carla::image;
+#ifdef NDEBUG
+  constexpr size_t number_of_depths = 256u * 256u * 256u;
+#else
+  constexpr size_t number_of_depths = 256u * 256u;
+#endif // NDEBUG
+  const auto pixels = MakeRandomPixels(number_of_depths + 1001u, number_of_depths);
+
+  auto expected = pixels;
+  auto result = pixels;
+  ConvertWithView(expected, ColorConverter::Depth());
+  BulkColorConverter::Depth(result.data(), result.size() / 4u);
+  ASSERT_EQ(FirstMismatch(result, expected), result.size());
+
+  expected = pixels;
+  result = pixels;
+  ConvertWithView(expected, ColorConverter::LogarithmicDepth());
+  BulkColorConverter::LogarithmicDepth(result.data(), result.size() / 4u);
+  ASSERT_EQ(FirstMismatch(result, expected), result.size());
+
+  expected = pixels;
+  result = pixels;
+  ConvertWithView(expected, ColorConverter::CityScapesPalette());
+  BulkColorConverter::CityScapesPalette(result.data(), result.size() / 4u);
+  ASSERT_EQ(FirstMismatch(result, expected), result.size());
+}
+
+/// Deserialize @a pixels as the client does with the images of a camera of
+/// type @a SensorT.
+template <typename SensorT, typename ImageT = carla::sensor::data::Image>
+static carla::SharedPtr<ImageT> MakeSensorImage(
+    uint32_t width,
+    uint32_t height,
+    const std::vector<uint8_t> &pixels) {
+  using namespace carla::sensor;
+  const auto header = s11n::SensorHeaderSerializer::Serialize(
+      SensorRegistry::get<SensorT *>::index,
+      1u,
+      0.0,
+      carla::rpc::Transform{});
+  const s11n::ImageSerializer::ImageHeader image_header{width, height, 90.0f};
+  carla::Buffer message;
+  message.reset(header.size() + sizeof(image_header) + pixels.size());
+  auto *data = message.data();
+  std::memcpy(data, header.data(), header.size());
+  data += header.size();
+  std::memcpy(data, &image_header, sizeof(image_header));
+  std::memcpy(data + sizeof(image_header), pixels.data(), pixels.size());
+  return boost::static_pointer_cast<ImageT>(SensorRegistry::Deserialize(std::move(message)));
+}
+
+template <typename ColorConverter>
+static void BenchmarkColorConverter(const char *name, ColorConverter converter) {
+  using namespace carla::image;
+  constexpr uint32_t width = 1920u;
+  constexpr uint32_t height = 1080u;
+  constexpr auto number_of_frames = 10u;
+  const auto pixels = MakeRandomPixels(width * height);
+
+  auto expected = MakeSensorImage<ASceneCaptureCamera>(width, height, pixels);
+  auto view = ImageView::MakeView(*expected);
+  carla::StopWatch stop_watch;
+  for (auto i = 0u; i < number_of_frames; ++i) {
+    ImageConverter::ConvertInPlace(view, converter);
+    std::memcpy(expected->data(), pixels.data(), pixels.size());
+  }
+  stop_watch.Stop();
+  const auto view_time = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+  ImageConverter::ConvertInPlace(view, converter);
+
+  size_t bulk_time[2u];
+  const size_t number_of_threads[2u] = {1u, 0u};
+  for (auto j = 0u; j < 2u; ++j) {
+    auto image = MakeSensorImage<ASceneCaptureCamera>(width, height, pixels);
+    stop_watch.Restart();
+    for (auto i = 0u; i < number_of_frames; ++i) {
+      std::memcpy(image->data(), pixels.data(), pixels.size());
+      ImageConverter::ConvertInPlace(*image, converter, number_of_threads[j]);
+    }
+    stop_watch.Stop();
+    bulk_time[j] = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+    ASSERT_EQ(std::memcmp(image->data(), expected->data(), pixels.size()), 0);
+  }
+
+  carla::logging::log(
+      name, "conversion of a", width, "x", height, "image: view",
+      view_time / number_of_frames, "us, bulk",
+      bulk_time[0u] / number_of_frames, "us, bulk with a thread per core",
+      bulk_time[1u] / number_of_frames, "us");
+}
+
+TEST(image, benchmark_color_converters) {
+  using namespace carla::image;
+  BenchmarkColorConverter("Depth", ColorConverter::Depth());
+  BenchmarkColorConverter("LogarithmicDepth", ColorConverter::LogarithmicDepth());
+  BenchmarkColorConverter("CityScapesPalette", ColorConverter::CityScapesPalette());
+}
+
+TEST(image, color_coded_flow) {
+  using namespace carla::image;
+  using carla::sensor::data::OpticalFlowImage;
+  using carla::sensor::data::OpticalFlowPixel;
+  constexpr uint32_t width = 1920u;
+  constexpr uint32_t height = 1080u;
+  std::vector<uint8_t> flow(sizeof(OpticalFlowPixel) * width * height);
+  for (auto i = 0u; i < width * height; ++i) {
+    const OpticalFlowPixel pixel{
+        static_cast<float>(util::Random::Uniform(-2.0, 2.0)),
+        static_cast<float>(util::Random::Uniform(-2.0, 2.0))};
+    std::memcpy(flow.data() + sizeof(pixel) * i, &pixel, sizeof(pixel));
+  }
+  // Without motion the pixel is black.
+  std::memset(flow.data(), 0, sizeof(OpticalFlowPixel));
+  const auto image = MakeSensorImage<AOpticalFlowCamera, OpticalFlowImage>(width, height, flow);
+
+  std::vector<uint8_t> expected(4u * image->size());
+  carla::StopWatch stop_watch;
+  ImageConverter::ColorCodedFlow(*image, expected.data(), 1u);
+  stop_watch.Stop();
+  const auto serial_time = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+  ASSERT_EQ(expected[0u], 0u);
+  ASSERT_EQ(expected[1u], 0u);
+  ASSERT_EQ(expected[2u], 0u);
+
+  constexpr auto number_of_frames = 10u;
+  std::vector<uint8_t> output(expected.size());
+  stop_watch.Restart();
+  for (auto i = 0u; i < number_of_frames; ++i) {
+    ImageConverter::ColorCodedFlow(*image, output.data(), 0u);
+  }
+  stop_watch.Stop();
+  const auto parallel_time = stop_watch.GetElapsedTime<std::chrono::microseconds>() / number_of_frames;
+  ASSERT_EQ(FirstMismatch(output, expected), output.size());
+
+  carla::logging::log(
+      "Color coded optical flow of a", width, "x", height, "image:",
+      serial_time, "us, with the shared thread pool", parallel_time, "us");
+}
@@ -10,19 +10,34 @@
 
 #include <carla/StopWatch.h>
 #include <carla/ThreadPool.h>
+#include <carla/geom/CubicPolynomial.h>
 #include <carla/geom/Location.h>
 #include <carla/geom/Math.h>
+#include <carla/geom/Rtree.h>
 #include <carla/opendrive/OpenDriveParser.h>
+#include <carla/road/InformationSet.h>
 #include <carla/road/MapBuilder.h>
+#include <carla/road/MapSnapshot.h>
+#include <carla/road/MeshFactory.h>
+#include <carla/road/element/Geometry.h>
 #include <carla/road/element/RoadInfoElevation.h>
 #include <carla/road/element/RoadInfoGeometry.h>
+#include <carla/road/element/RoadInfoLaneOffset.h>
+#include <carla/road/element/RoadInfoLaneWidth.h>
 #include <carla/road/element/RoadInfoMarkRecord.h>
+#include <carla/road/element/RoadInfoSpeed.h>
 #include <carla/road/element/RoadInfoVisitor.h>
 
 #include <pugixml/pugixml.hpp>
 
+#include <cmath>
+#include <cstdio>
 #include <fstream>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
 
 using namespace carla::road;
 using namespace carla::road::element;
@@ -424,3 +439,561 @@ TEST(road, get_waypoint) {
     result.get();
   }
 }
+
+TEST(road, benchmark_map_load_and_query) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    const auto xodr = util::OpenDrive::Load(file);
+    carla::StopWatch stop_watch;
+    auto m = OpenDriveParser::Load(xodr);
+    stop_watch.Stop();
+    ASSERT_TRUE(m.has_value());
+    const auto load_time = stop_watch.GetElapsedTime();
+    auto &map = *m;
+
+    std::vector<Location> locations;
+    for (auto i = 0u; i < 10'000u; ++i) {
+      locations.push_back(Random::Location(-500.0f, 500.0f));
+    }
+    stop_watch.Restart();
+    for (auto &location : locations) {
+      ASSERT_TRUE(map.GetClosestWaypointOnRoad(location).has_value());
+    }
+    stop_watch.Stop();
+    carla::logging::log(file, "loaded in", load_time, "ms,", locations.size(),
+        "closest waypoint queries in", stop_watch.GetElapsedTime(), "ms.");
+  }
+}
+
+TEST(road, information_set_lookup) {
+  std::vector<std::unique_ptr<RoadInfo>> infos;
+  for (auto s : {0.0, 10.0, 10.0, 25.0, 40.0}) {
+    infos.emplace_back(std::make_unique<RoadInfoLaneWidth>(s, CubicPolynomial(s, 0.0, 0.0, 0.0)));
+  }
+  for (auto s : {5.0, 10.0, 30.0}) {
+    infos.emplace_back(std::make_unique<RoadInfoLaneOffset>(s, CubicPolynomial(s, 0.0, 0.0, 0.0)));
+  }
+  infos.emplace_back(std::make_unique<RoadInfoSpeed>(0.0, 30.0));
+  Random::Shuffle(infos);
+
+  // Expected order of the widths: by position, equal positions as given.
+  std::vector<const RoadInfoLaneWidth *> widths;
+  for (auto &info : infos) {
+    if (auto width = dynamic_cast<const RoadInfoLaneWidth *>(info.get())) {
+      widths.emplace_back(width);
+    }
+  }
+  std::stable_sort(widths.begin(), widths.end(), [](auto *lhs, auto *rhs) {
+    return lhs->GetDistance() < rhs->GetDistance();
+  });
+
+  const InformationSet set(std::move(infos));
+  ASSERT_EQ(set.GetInfos<RoadInfoLaneWidth>(), widths);
+  ASSERT_EQ(set.GetInfos<RoadInfoLaneOffset>().size(), 3u);
+  ASSERT_EQ(set.GetInfos<RoadInfoSpeed>().size(), 1u);
+  ASSERT_TRUE(set.GetInfos<RoadInfoElevation>().empty());
+  ASSERT_EQ(set.GetInfo<RoadInfoElevation>(10.0), nullptr);
+
+  for (auto s = -1.0; s < 45.0; s += 0.5) {
+    const RoadInfoLaneWidth *expected = nullptr;
+    for (auto *width : widths) {
+      if (width->GetDistance() <= s) {
+        expected = width;
+      }
+    }
+    ASSERT_EQ(set.GetInfo<RoadInfoLaneWidth>(s), expected) << "s = " << s;
+    const auto offset = set.GetInfo<RoadInfoLaneOffset>(s);
+    ASSERT_EQ(offset == nullptr, s < 5.0) << "s = " << s;
+    if (offset != nullptr) {
+      ASSERT_LE(offset->GetDistance(), s);
+    }
+  }
+
+  std::vector<const RoadInfoLaneWidth *> in_range(widths.begin() + 1, widths.begin() + 4);
+  ASSERT_EQ(set.GetInfos<RoadInfoLaneWidth>(10.0, 25.0), in_range);
+  std::reverse(in_range.begin(), in_range.end());
+  ASSERT_EQ(set.GetInfos<RoadInfoLaneWidth>(25.0, 10.0), in_range);
+}
+
+TEST(road, benchmark_compute_transform) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    const auto &map = *m;
+    const auto waypoints = map.GenerateWaypoints(0.5);
+    constexpr auto number_of_passes = 5u;
+    float checksum = 0.0f;
+    carla::StopWatch stop_watch;
+    for (auto pass = 0u; pass < number_of_passes; ++pass) {
+      for (auto &waypoint : waypoints) {
+        checksum += map.ComputeTransform(waypoint).location.x;
+      }
+    }
+    stop_watch.Stop();
+    const auto count = number_of_passes * waypoints.size();
+    const auto elapsed = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+    carla::logging::log(file, count, "waypoint transforms in", elapsed / 1000u, "ms,",
+        elapsed == 0u ? 0.0 : static_cast<double>(count) / static_cast<double>(elapsed),
+        "per us, checksum", checksum);
+  }
+}
+
+TEST(road, get_waypoints_batch) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    auto &map = *m;
+
+    std::vector<Location> locations;
+    for (auto i = 0u; i < 10'000u; ++i) {
+      locations.push_back(Random::Location(-500.0f, 500.0f));
+    }
+    for (bool project_to_road : {true, false}) {
+      carla::StopWatch stop_watch;
+      std::vector<boost::optional<Waypoint>> expected;
+      for (auto &location : locations) {
+        expected.push_back(project_to_road ?
+            map.GetClosestWaypointOnRoad(location) :
+            map.GetWaypoint(location));
+      }
+      stop_watch.Stop();
+      const auto single_time = stop_watch.GetElapsedTime();
+
+      stop_watch.Restart();
+      const auto waypoints = map.GetWaypoints(locations, project_to_road);
+      stop_watch.Stop();
+      carla::logging::log(file, project_to_road ? "projected" : "exact",
+          "waypoints one by one in", single_time, "ms, batched in",
+          stop_watch.GetElapsedTime(), "ms.");
+
+      ASSERT_EQ(waypoints.size(), locations.size());
+      for (auto i = 0u; i < locations.size(); ++i) {
+        ASSERT_EQ(waypoints[i].has_value(), expected[i].has_value());
+        if (expected[i].has_value()) {
+          ASSERT_EQ(*waypoints[i], *expected[i]);
+        }
+      }
+    }
+  }
+}
+
+/// Reference serial implementation of Map::GenerateMesh.
+static Mesh GenerateMeshSerially(Map &map, double distance) {
+  MeshFactory mesh_factory;
+  mesh_factory.road_param.resolution = static_cast<float>(distance);
+  mesh_factory.road_param.extra_lane_width = 0.6f;
+  Mesh out_mesh;
+  for (auto &&pair : map.GetMap().GetRoads()) {
+    if (!pair.second.IsJunction()) {
+      out_mesh += *mesh_factory.Generate(pair.second);
+    }
+  }
+  for (const auto &junc_pair : map.GetMap().GetJunctions()) {
+    std::vector<std::unique_ptr<Mesh>> lane_meshes;
+    for (const auto &connection_pair : junc_pair.second.GetConnections()) {
+      const auto &road = map.GetMap().GetRoads().at(connection_pair.second.connecting_road);
+      for (auto &&lane_section : road.GetLaneSections()) {
+        for (auto &&lane_pair : lane_section.GetLanes()) {
+          lane_meshes.push_back(mesh_factory.Generate(lane_pair.second));
+        }
+      }
+    }
+    out_mesh += *mesh_factory.MergeAndSmooth(lane_meshes);
+  }
+  return out_mesh;
+}
+
+TEST(road, generate_mesh) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    auto &map = *m;
+
+    carla::StopWatch stop_watch;
+    const Mesh expected = GenerateMeshSerially(map, 2.0);
+    stop_watch.Stop();
+    const auto serial_time = stop_watch.GetElapsedTime();
+
+    stop_watch.Restart();
+    const Mesh mesh = map.GenerateMesh(2.0);
+    stop_watch.Stop();
+    const auto mesh_time = stop_watch.GetElapsedTime();
+
+    ASSERT_EQ(mesh.GetVertices(), expected.GetVertices());
+    ASSERT_EQ(mesh.GetIndexes(), expected.GetIndexes());
+
+    stop_watch.Restart();
+    const auto chunks = map.GenerateChunkedMesh(carla::rpc::OpendriveGenerationParameters());
+    stop_watch.Stop();
+    size_t chunked_vertices = 0u;
+    for (auto &chunk : chunks) {
+      chunked_vertices += chunk->GetVerticesNum();
+    }
+    ASSERT_GT(chunked_vertices, 0u);
+
+    carla::logging::log(file, "mesh with", mesh.GetVerticesNum(),
+        "vertices: serial", serial_time, "ms, parallel", mesh_time,
+        "ms; chunked mesh in", stop_watch.GetElapsedTime(), "ms.");
+  }
+}
+
+TEST(road, map_snapshot) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    const auto xodr = util::OpenDrive::Load(file);
+    const auto content_hash = MapSnapshot::ComputeContentHash(xodr);
+    carla::StopWatch stop_watch;
+    auto m = OpenDriveParser::Load(xodr);
+    stop_watch.Stop();
+    ASSERT_TRUE(m.has_value());
+    const auto parse_time = stop_watch.GetElapsedTime();
+    const auto &map = *m;
+
+    const std::string path = "test_map_snapshot.bin";
+    ASSERT_TRUE(MapSnapshot::Save(path, map, content_hash));
+    ASSERT_FALSE(MapSnapshot::Load(path, content_hash + 1u).has_value());
+    stop_watch.Restart();
+    auto s = MapSnapshot::Load(path, content_hash);
+    stop_watch.Stop();
+    std::remove(path.c_str());
+    ASSERT_TRUE(s.has_value());
+    auto &snapshot = *s;
+
+    const auto data = MapSnapshot::Serialize(map, content_hash);
+    carla::logging::log(file, "parsed in", parse_time, "ms, snapshot of",
+        data.size() / 1000u, "KB loaded in", stop_watch.GetElapsedTime(), "ms.");
+    ASSERT_FALSE(MapSnapshot::Deserialize(data.data(), data.size() - 1u, content_hash).has_value());
+
+    // The roads are stored in unordered maps, their order may change.
+    const auto waypoints = map.GenerateWaypoints(2.0);
+    const auto snapshot_waypoints = snapshot.GenerateWaypoints(2.0);
+    ASSERT_EQ(snapshot_waypoints.size(), waypoints.size());
+    ASSERT_EQ(
+        std::unordered_set<Waypoint>(snapshot_waypoints.begin(), snapshot_waypoints.end()),
+        std::unordered_set<Waypoint>(waypoints.begin(), waypoints.end()));
+    for (auto &waypoint : waypoints) {
+      ASSERT_EQ(snapshot.ComputeTransform(waypoint), map.ComputeTransform(waypoint));
+      ASSERT_EQ(snapshot.GetLane(waypoint).GetWidth(waypoint.s), map.GetLane(waypoint).GetWidth(waypoint.s));
+      ASSERT_EQ(snapshot.GetNext(waypoint, 5.0), map.GetNext(waypoint, 5.0));
+      ASSERT_EQ(snapshot.GetPrevious(waypoint, 5.0), map.GetPrevious(waypoint, 5.0));
+      ASSERT_EQ(snapshot.IsJunction(waypoint.road_id), map.IsJunction(waypoint.road_id));
+    }
+    ASSERT_EQ(snapshot.GetSignals().size(), map.GetSignals().size());
+    ASSERT_EQ(snapshot.GetControllers().size(), map.GetControllers().size());
+
+    for (auto i = 0u; i < 10'000u; ++i) {
+      const auto location = Random::Location(-500.0f, 500.0f);
+      ASSERT_TRUE(snapshot.GetClosestWaypointOnRoad(location) == map.GetClosestWaypointOnRoad(location));
+      ASSERT_TRUE(snapshot.GetWaypoint(location) == map.GetWaypoint(location));
+    }
+  }
+}
+
+TEST(road, benchmark_parallel_load) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    const auto xodr = util::OpenDrive::Load(file);
+    carla::StopWatch stop_watch;
+    auto m = OpenDriveParser::Load(xodr);
+    stop_watch.Stop();
+    ASSERT_TRUE(m.has_value());
+    const auto sequential_time = stop_watch.GetElapsedTime();
+    stop_watch.Restart();
+    auto p = OpenDriveParser::Load(xodr, true);
+    stop_watch.Stop();
+    ASSERT_TRUE(p.has_value());
+    carla::logging::log(file, "loaded in", sequential_time, "ms sequentially,",
+        stop_watch.GetElapsedTime(), "ms in parallel with",
+        std::thread::hardware_concurrency(), "threads.");
+    auto &map = *m;
+    auto &parallel = *p;
+
+    // Both builders insert the roads in the same order.
+    const auto waypoints = map.GenerateWaypoints(2.0);
+    ASSERT_EQ(parallel.GenerateWaypoints(2.0), waypoints);
+    for (auto &waypoint : waypoints) {
+      ASSERT_EQ(parallel.ComputeTransform(waypoint), map.ComputeTransform(waypoint));
+      ASSERT_EQ(parallel.GetLane(waypoint).GetWidth(waypoint.s), map.GetLane(waypoint).GetWidth(waypoint.s));
+      ASSERT_EQ(parallel.GetNext(waypoint, 5.0), map.GetNext(waypoint, 5.0));
+      ASSERT_EQ(parallel.GetPrevious(waypoint, 5.0), map.GetPrevious(waypoint, 5.0));
+    }
+
+    const auto &junctions = map.GetMap().GetJunctions();
+    ASSERT_EQ(parallel.GetMap().GetJunctions().size(), junctions.size());
+    for (auto &pair : junctions) {
+      const auto &junction = pair.second;
+      const auto *parallel_junction = parallel.GetJunction(pair.first);
+      ASSERT_NE(parallel_junction, nullptr);
+      ASSERT_EQ(parallel_junction->GetBoundingBox(), junction.GetBoundingBox());
+      for (auto &connection : junction.GetConnections()) {
+        const auto road_id = connection.second.connecting_road;
+        ASSERT_EQ(parallel_junction->RoadHasConflicts(road_id), junction.RoadHasConflicts(road_id));
+        if (junction.RoadHasConflicts(road_id)) {
+          ASSERT_EQ(parallel_junction->GetConflictsOfRoad(road_id), junction.GetConflictsOfRoad(road_id));
+        }
+      }
+    }
+  }
+}
+
+TEST(road, stream_load) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    const auto xodr = util::OpenDrive::Load(file);
+    carla::StopWatch stop_watch;
+    auto m = OpenDriveParser::Load(xodr);
+    stop_watch.Stop();
+    ASSERT_TRUE(m.has_value());
+    const auto document_time = stop_watch.GetElapsedTime();
+    std::istringstream stream(xodr);
+    stop_watch.Restart();
+    auto s = OpenDriveParser::Load(stream);
+    stop_watch.Stop();
+    ASSERT_TRUE(s.has_value());
+    carla::logging::log(file, "loaded in", document_time, "ms from the document,",
+        stop_watch.GetElapsedTime(), "ms streamed.");
+    auto &map = *m;
+    auto &streamed = *s;
+
+    const auto waypoints = map.GenerateWaypoints(2.0);
+    ASSERT_EQ(streamed.GenerateWaypoints(2.0), waypoints);
+    for (auto &waypoint : waypoints) {
+      ASSERT_EQ(streamed.ComputeTransform(waypoint), map.ComputeTransform(waypoint));
+      ASSERT_EQ(streamed.GetLane(waypoint).GetWidth(waypoint.s), map.GetLane(waypoint).GetWidth(waypoint.s));
+      ASSERT_EQ(streamed.GetNext(waypoint, 5.0), map.GetNext(waypoint, 5.0));
+      ASSERT_EQ(streamed.GetPrevious(waypoint, 5.0), map.GetPrevious(waypoint, 5.0));
+      ASSERT_EQ(streamed.IsJunction(waypoint.road_id), map.IsJunction(waypoint.road_id));
+    }
+    ASSERT_EQ(streamed.GetMap().GetJunctions().size(), map.GetMap().GetJunctions().size());
+    ASSERT_EQ(streamed.GetSignals().size(), map.GetSignals().size());
+    ASSERT_EQ(streamed.GetControllers().size(), map.GetControllers().size());
+    ASSERT_EQ(streamed.GetGeoReference().latitude, map.GetGeoReference().latitude);
+    ASSERT_EQ(streamed.GetGeoReference().longitude, map.GetGeoReference().longitude);
+  }
+}
+
+TEST(road, stream_load_markup) {
+  // A single straight road with a driving lane on each side.
+  const std::string xodr =
+      "<?xml version=\"1.0\" standalone=\"yes\"?>\n"
+      "<OpenDRIVE>\n"
+      "  <header revMajor=\"1\" revMinor=\"4\" name=\"\" version=\"1\"/>\n"
+      "  <road name=\"Road 0\" length=\"100.0\" id=\"0\" junction=\"-1\">\n"
+      "    <link/>\n"
+      "    <planView>\n"
+      "      <geometry s=\"0.0\" x=\"0.0\" y=\"0.0\" hdg=\"0.0\" length=\"100.0\"><line/></geometry>\n"
+      "    </planView>\n"
+      "    <elevationProfile/>\n"
+      "    <lateralProfile/>\n"
+      "    <lanes>\n"
+      "      <laneSection s=\"0.0\">\n"
+      "        <left>\n"
+      "          <lane id=\"1\" type=\"driving\" level=\"false\">\n"
+      "            <link/>\n"
+      "            <width sOffset=\"0.0\" a=\"3.5\" b=\"0.0\" c=\"0.0\" d=\"0.0\"/>\n"
+      "          </lane>\n"
+      "        </left>\n"
+      "        <center>\n"
+      "          <lane id=\"0\" type=\"none\" level=\"false\"><link/></lane>\n"
+      "        </center>\n"
+      "        <right>\n"
+      "          <lane id=\"-1\" type=\"driving\" level=\"false\">\n"
+      "            <link/>\n"
+      "            <width sOffset=\"0.0\" a=\"3.5\" b=\"0.0\" c=\"0.0\" d=\"0.0\"/>\n"
+      "          </lane>\n"
+      "        </right>\n"
+      "      </laneSection>\n"
+      "    </lanes>\n"
+      "  </road>\n"
+      "</OpenDRIVE>\n";
+  auto m = OpenDriveParser::Load(xodr);
+  ASSERT_TRUE(m.has_value());
+
+  // Markup under <OpenDRIVE> that looks like elements but is not.
+  std::string with_markup = xodr;
+  with_markup.insert(
+      with_markup.find('>', with_markup.find("<OpenDRIVE")) + 1u,
+      "<!-- <road id=\"1000\"> -->"
+      "<?carla <road> ?>"
+      "<userData><![CDATA[</userData></OpenDRIVE>]]><info text='a > b'/></userData>");
+  std::istringstream stream(with_markup);
+  auto streamed = OpenDriveParser::Load(stream);
+  ASSERT_TRUE(streamed.has_value());
+  ASSERT_FALSE(m->GenerateWaypoints(2.0).empty());
+  ASSERT_EQ(streamed->GenerateWaypoints(2.0), m->GenerateWaypoints(2.0));
+
+  std::istringstream truncated(xodr.substr(0u, xodr.size() / 2u));
+  ASSERT_FALSE(OpenDriveParser::Load(truncated).has_value());
+  std::istringstream no_root("<?xml version=\"1.0\"?><road id=\"1\"/>");
+  ASSERT_FALSE(OpenDriveParser::Load(no_root).has_value());
+}
+
+/// Poly3 and ParamPoly3 positions as computed before the arc-length tables,
+/// sampling the curve the same way into a 1-D R-tree of segments and
+/// interpolating in the nearest one.
+class RtreeSpline {
+public:
+
+  explicit RtreeSpline(const GeometryPoly3 &geometry)
+    : _heading(geometry.GetHeading()),
+      _start_position(geometry.GetStartPosition()),
+      _is_param(false) {
+    CubicPolynomial poly(geometry.Geta(), geometry.Getb(), geometry.Getc(), geometry.Getd());
+    const double delta_u = 0.3;
+    double current_u = 0.0;
+    Sample last{0.0, poly.Evaluate(0.0), 0.0, poly.Tangent(0.0), 0.0};
+    while (last.s < geometry.GetLength() + delta_u) {
+      current_u += delta_u;
+      const double v = poly.Evaluate(current_u);
+      const double s = last.s + std::hypot(current_u - last.u, v - last.v);
+      Sample current{current_u, v, s, poly.Tangent(current_u), 0.0};
+      Insert(last, current);
+      last = current;
+    }
+  }
+
+  explicit RtreeSpline(const GeometryParamPoly3 &geometry)
+    : _heading(geometry.GetHeading()),
+      _start_position(geometry.GetStartPosition()),
+      _is_param(true) {
+    CubicPolynomial poly_u(geometry.GetaU(), geometry.GetbU(), geometry.GetcU(), geometry.GetdU());
+    CubicPolynomial poly_v(geometry.GetaV(), geometry.GetbV(), geometry.GetcV(), geometry.GetdV());
+    const double length = geometry.GetLength();
+    const auto number_intervals = std::max(static_cast<size_t>(length / 0.5), size_t(5));
+    double delta_p = 1.0 / static_cast<double>(number_intervals);
+    if (geometry.IsArcLength()) {
+      delta_p *= length;
+    }
+    double p = 0.0;
+    Sample last{poly_u.Evaluate(p), poly_v.Evaluate(p), 0.0, poly_u.Tangent(p), poly_v.Tangent(p)};
+    for (size_t i = 0u; i < number_intervals; ++i) {
+      p += delta_p;
+      const double u = poly_u.Evaluate(p);
+      const double v = poly_v.Evaluate(p);
+      const double s = last.s + std::hypot(u - last.u, v - last.v);
+      Sample current{u, v, s, poly_u.Tangent(p), poly_v.Tangent(p)};
+      Insert(last, current);
+      last = current;
+      if (s > length) {
+        break;
+      }
+    }
+  }
+
+  DirectedPoint PosFromDist(double dist) const {
+    auto result = _rtree.GetNearestNeighbours(Rtree::BPoint(static_cast<float>(dist))).front();
+    auto &val1 = result.second.first;
+    auto &val2 = result.second.second;
+    const double rate = (val2.s - dist) / (val2.s - val1.s);
+    const double u = rate * val1.u + (1.0 - rate) * val2.u;
+    const double v = rate * val1.v + (1.0 - rate) * val2.v;
+    const double t1 = rate * val1.t1 + (1.0 - rate) * val2.t1;
+    const double t2 = rate * val1.t2 + (1.0 - rate) * val2.t2;
+    const double tangent = _is_param ? std::atan2(t2, t1) : std::atan(t1);
+    const double cos_a = std::cos(_heading);
+    const double sin_a = std::sin(_heading);
+    DirectedPoint point(_start_position, _heading + tangent);
+    point.location.x += static_cast<float>(u * cos_a - v * sin_a);
+    point.location.y += static_cast<float>(v * cos_a + u * sin_a);
+    return point;
+  }
+
+private:
+
+  struct Sample {
+    double u;
+    double v;
+    double s;
+    double t1;
+    double t2;
+  };
+
+  using Rtree = SegmentCloudRtree<Sample, 1>;
+
+  void Insert(const Sample &first, const Sample &second) {
+    _rtree.InsertElement(
+        Rtree::BSegment(
+            Rtree::BPoint(static_cast<float>(first.s)),
+            Rtree::BPoint(static_cast<float>(second.s))),
+        first,
+        second);
+  }
+
+  double _heading;
+
+  Location _start_position;
+
+  bool _is_param;
+
+  Rtree _rtree;
+};
+
+template <typename GeometryT>
+static void CheckArcLengthTable(const GeometryT &geometry, double &rtree_time, double &table_time) {
+  const RtreeSpline reference(geometry);
+  std::vector<double> distances(2'000u);
+  for (auto &dist : distances) {
+    dist = Random::Uniform(-1.0, geometry.GetLength() + 1.0);
+  }
+  distances.front() = 0.0;
+  distances.back() = geometry.GetLength();
+
+  std::vector<DirectedPoint> expected;
+  carla::StopWatch stop_watch;
+  for (auto dist : distances) {
+    expected.emplace_back(reference.PosFromDist(dist));
+  }
+  stop_watch.Stop();
+  rtree_time += static_cast<double>(stop_watch.GetElapsedTime<std::chrono::microseconds>());
+
+  std::vector<DirectedPoint> points;
+  stop_watch.Restart();
+  for (auto dist : distances) {
+    points.emplace_back(geometry.PosFromDist(dist));
+  }
+  stop_watch.Stop();
+  table_time += static_cast<double>(stop_watch.GetElapsedTime<std::chrono::microseconds>());
+
+  for (auto i = 0u; i < distances.size(); ++i) {
+    ASSERT_NEAR(points[i].location.x, expected[i].location.x, 1e-3) << "s = " << distances[i];
+    ASSERT_NEAR(points[i].location.y, expected[i].location.y, 1e-3) << "s = " << distances[i];
+    ASSERT_NEAR(points[i].tangent, expected[i].tangent, 1e-6) << "s = " << distances[i];
+  }
+
+  // The batch gives the same points whether the distances are sorted or not.
+  ASSERT_EQ(geometry.PosFromDistances(distances), points);
+  std::sort(distances.begin(), distances.end());
+  const auto sorted_points = geometry.PosFromDistances(distances);
+  ASSERT_EQ(sorted_points.size(), distances.size());
+  for (auto i = 0u; i < distances.size(); ++i) {
+    ASSERT_EQ(sorted_points[i], geometry.PosFromDist(distances[i]));
+  }
+}
+
+TEST(road, geometry_arc_length_table) {
+  double rtree_time = 0.0;
+  double table_time = 0.0;
+  for (auto i = 0u; i < 50u; ++i) {
+    const Location start = Random::Location(-500.0f, 500.0f);
+    const double heading = Random::Uniform(-3.14, 3.14);
+    const double length = Random::Uniform(1.0, 300.0);
+    const GeometryPoly3 poly3(
+        0.0, length, heading, start,
+        Random::Uniform(-1.0, 1.0),
+        Random::Uniform(-0.5, 0.5),
+        Random::Uniform(-1e-2, 1e-2),
+        Random::Uniform(-1e-4, 1e-4));
+    CheckArcLengthTable(poly3, rtree_time, table_time);
+    const GeometryParamPoly3 param_poly3(
+        0.0, length, heading, start,
+        0.0,
+        Random::Uniform(0.5, 1.0) * ((i % 2u == 0u) ? 1.0 : length),
+        Random::Uniform(-1e-2, 1e-2),
+        Random::Uniform(-1e-4, 1e-4),
+        0.0,
+        Random::Uniform(-0.5, 0.5),
+        Random::Uniform(-1e-2, 1e-2),
+        Random::Uniform(-1e-4, 1e-4),
+        i % 2u == 0u);
+    CheckArcLengthTable(param_poly3, rtree_time, table_time);
+  }
+  carla::logging::log(
+      "Poly3 positions from distance: R-tree", rtree_time / 1000.0,
+      "ms, arc-length table", table_time / 1000.0, "ms.");
+}
@@ -0,0 +1,195 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/StopWatch.h>
+#include <carla/pointcloud/PointCloudIO.h>
+#include <carla/pointcloud/PointCloudWriter.h>
+#include <carla/sensor/SensorRegistry.h>
+#include <carla/sensor/data/LidarMeasurement.h>
+#include <carla/sensor/s11n/LidarSerializer.h>
+#include <carla/sensor/s11n/SensorHeaderSerializer.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+using namespace carla::sensor;
+using carla::pointcloud::PointCloudIO;
+using carla::pointcloud::PointCloudWriter;
+
+namespace {
+
+  struct FakeLidar {};
+
+} // namespace
+
+/// Make a lidar measurement of @a frame as the client receives it.
+static carla::SharedPtr<const data::LidarMeasurement> MakeLidarMeasurement(
+    uint64_t frame,
+    uint32_t channels,
+    uint32_t points_per_channel) {
+  data::LidarData lidar(channels);
+  lidar.AcquireBuffer(carla::Buffer());
+  std::vector<uint32_t> points_per_channel_list(channels, points_per_channel);
+  lidar.ResetMemory(points_per_channel_list);
+  for (auto channel = 0u; channel < channels; ++channel) {
+    for (auto i = 0u; i < points_per_channel; ++i) {
+      data::LidarDetection detection{
+          static_cast<float>(frame),
+          static_cast<float>(channel),
+          static_cast<float>(i),
+          0.25f * static_cast<float>(i % 4u)};
+      lidar.WritePointSync(detection);
+    }
+  }
+  lidar.WriteChannelCount(points_per_channel_list);
+  const auto payload = s11n::LidarSerializer::Serialize(FakeLidar{}, lidar);
+  const auto header = s11n::SensorHeaderSerializer::Serialize(
+      SensorRegistry::get<ARayCastLidar *>::index,
+      frame,
+      0.05 * static_cast<double>(frame),
+      carla::rpc::Transform{});
+  carla::Buffer message;
+  message.reset(header.size() + payload.size());
+  std::memcpy(message.data(), header.data(), header.size());
+  std::memcpy(message.data() + header.size(), payload.data(), payload.size());
+  return boost::static_pointer_cast<const data::LidarMeasurement>(
+      SensorRegistry::Deserialize(std::move(message)));
+}
+
+static std::string ReadFile(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  return std::string{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+/// Split a PLY file in its header, up to "end_header\n", and its body.
+static std::pair<std::string, std::string> SplitPly(const std::string &content) {
+  const std::string end_header = "end_header\n";
+  const auto pos = content.find(end_header);
+  EXPECT_NE(pos, std::string::npos);
+  return {content.substr(0u, pos + end_header.size()), content.substr(pos + end_header.size())};
+}
+
+TEST(pointcloud, binary_ply) {
+  const auto measurement = MakeLidarMeasurement(7u, 4u, 100u);
+  std::ostringstream out;
+  PointCloudIO::DumpBinary(out, measurement->begin(), measurement->end());
+  const auto ply = SplitPly(out.str());
+  ASSERT_EQ(ply.first,
+      "ply\n"
+      "format binary_little_endian 1.0\n"
+      "element vertex 400\n"
+      "property float32 x\n"
+      "property float32 y\n"
+      "property float32 z\n"
+      "property float32 I\n"
+      "end_header\n");
+  ASSERT_EQ(ply.second.size(), sizeof(data::LidarDetection) * measurement->size());
+  ASSERT_EQ(std::memcmp(ply.second.data(), measurement->data(), ply.second.size()), 0);
+}
+
+TEST(pointcloud, streaming_writer) {
+  const std::string path = "test_pointcloud_streaming_writer.ply";
+  std::vector<carla::SharedPtr<const data::LidarMeasurement>> measurements;
+  {
+    // Smaller than the number of frames, so Write waits for room.
+    PointCloudWriter<data::LidarDetection> writer(path, 2u);
+    for (auto frame = 1u; frame <= 5u; ++frame) {
+      // Frame numbers past 32 bits are kept.
+      measurements.emplace_back(MakeLidarMeasurement((uint64_t{1u} << 32u) + frame, 2u, 10u * frame));
+      writer.Write(measurements.back());
+    }
+    writer.Close();
+    ASSERT_THROW(writer.Write(measurements.back()), std::logic_error);
+  }
+  const auto ply = SplitPly(ReadFile(path));
+  std::remove(path.c_str());
+  ASSERT_EQ(ply.first,
+      "ply\n"
+      "format binary_little_endian 1.0\n"
+      "element vertex 000000000000300\n"
+      "property float32 x\n"
+      "property float32 y\n"
+      "property float32 z\n"
+      "property float32 I\n"
+      "element frame 000000000000005\n"
+      "property float64 frame\n"
+      "property uint32 point_count\n"
+      "property float64 timestamp\n"
+      "end_header\n");
+  constexpr size_t frame_size = sizeof(uint32_t) + 2u * sizeof(double);
+  ASSERT_EQ(ply.second.size(), 300u * sizeof(data::LidarDetection) + 5u * frame_size);
+  const char *body = ply.second.data();
+  for (auto &measurement : measurements) {
+    const size_t size = sizeof(data::LidarDetection) * measurement->size();
+    ASSERT_EQ(std::memcmp(body, measurement->data(), size), 0);
+    body += size;
+  }
+  for (auto &measurement : measurements) {
+    double frame;
+    uint32_t point_count;
+    double timestamp;
+    std::memcpy(&frame, body, sizeof(frame));
+    std::memcpy(&point_count, body + sizeof(frame), sizeof(point_count));
+    std::memcpy(&timestamp, body + sizeof(frame) + sizeof(point_count), sizeof(timestamp));
+    ASSERT_EQ(frame, static_cast<double>(measurement->GetFrame()));
+    ASSERT_EQ(point_count, measurement->size());
+    ASSERT_EQ(timestamp, measurement->GetTimestamp());
+    body += frame_size;
+  }
+}
+
+TEST(pointcloud, benchmark_save_to_disk) {
+  const std::string path = "benchmark_pointcloud.ply";
+  // A 128 channels lidar, about 1.3 million points.
+  const auto measurement = MakeLidarMeasurement(1u, 128u, 10000u);
+
+  carla::StopWatch stop_watch;
+  PointCloudIO::SaveToDisk(path, measurement->begin(), measurement->end());
+  stop_watch.Stop();
+  const auto ascii_time = stop_watch.GetElapsedTime();
+  const auto ascii_size = ReadFile(path).size();
+
+  stop_watch.Restart();
+  PointCloudIO::SaveToDisk(
+      path,
+      measurement->begin(),
+      measurement->end(),
+      PointCloudIO::Format::BinaryLittleEndian);
+  stop_watch.Stop();
+  const auto binary_time = stop_watch.GetElapsedTime();
+  const auto binary_size = ReadFile(path).size();
+
+  constexpr auto number_of_frames = 10u;
+  size_t write_time = 0u;
+  stop_watch.Restart();
+  {
+    PointCloudWriter<data::LidarDetection> writer(path);
+    for (auto frame = 0u; frame < number_of_frames; ++frame) {
+      carla::StopWatch write_stop_watch;
+      writer.Write(measurement);
+      write_stop_watch.Stop();
+      write_time += write_stop_watch.GetElapsedTime<std::chrono::microseconds>();
+    }
+    writer.Close();
+  }
+  stop_watch.Stop();
+  const auto streaming_time = stop_watch.GetElapsedTime();
+  std::remove(path.c_str());
+
+  carla::logging::log(
+      "Point cloud of", measurement->size(), "points: ascii",
+      ascii_time, "ms,", ascii_size / 1000000u, "MB; binary",
+      binary_time, "ms,", binary_size / 1000000u, "MB; streaming",
+      number_of_frames, "frames", streaming_time, "ms, blocking the caller",
+      write_time / number_of_frames, "us per frame");
+  ASSERT_LT(binary_size, ascii_size);
+}
@@ -0,0 +1,198 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/StopWatch.h>
+#include <carla/client/detail/SensorDispatchQueue.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using carla::client::SensorDispatchPolicy;
+using carla::client::detail::SensorDispatchQueue;
+
+static carla::Buffer MakeMessage(uint32_t value) {
+  carla::Buffer message;
+  message.copy_from(reinterpret_cast<const unsigned char *>(&value), sizeof(value));
+  return message;
+}
+
+/// Collects the messages dispatched, the callback waits until released so
+/// the queue fills up. The callback keeps this object alive as the dispatch
+/// thread may outlive the test.
+class FakeCallback : public std::enable_shared_from_this<FakeCallback> {
+public:
+
+  SensorDispatchQueue::CallbackType Get() {
+    return [self=shared_from_this()](carla::Buffer message) {
+      uint32_t value;
+      std::memcpy(&value, message.data(), sizeof(value));
+      std::unique_lock<std::mutex> lock(self->_mutex);
+      self->_values.push_back(value);
+      self->_changed.notify_all();
+      self->_changed.wait(lock, [&]() { return self->_released; });
+    };
+  }
+
+  void Release() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _released = true;
+    _changed.notify_all();
+  }
+
+  std::vector<uint32_t> WaitFor(size_t count) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _changed.wait(lock, [&]() { return _values.size() >= count; });
+    return _values;
+  }
+
+private:
+
+  std::mutex _mutex;
+
+  std::condition_variable _changed;
+
+  bool _released = false;
+
+  std::vector<uint32_t> _values;
+};
+
+static std::vector<uint32_t> Dispatch(SensorDispatchPolicy policy, size_t queue_size, size_t expected) {
+  auto callback = std::make_shared<FakeCallback>();
+  auto queue = std::make_shared<SensorDispatchQueue>(policy, queue_size);
+  queue->Start(callback->Get());
+  queue->Push(MakeMessage(0u));
+  // Wait until the callback is busy with the first message.
+  callback->WaitFor(1u);
+  for (auto i = 1u; i <= 10u; ++i) {
+    queue->Push(MakeMessage(i));
+  }
+  EXPECT_EQ(queue->GetDepth(), policy == SensorDispatchPolicy::LatestOnly ? 1u : queue_size);
+  EXPECT_EQ(queue->GetDroppedCount(), 10u - queue->GetDepth());
+  callback->Release();
+  const auto values = callback->WaitFor(expected);
+  queue->Close();
+  return values;
+}
+
+TEST(sensor_dispatch_queue, latest_only) {
+  const auto values = Dispatch(SensorDispatchPolicy::LatestOnly, 3u, 2u);
+  ASSERT_EQ(values, (std::vector<uint32_t>{0u, 10u}));
+}
+
+TEST(sensor_dispatch_queue, keep_n) {
+  const auto values = Dispatch(SensorDispatchPolicy::KeepN, 3u, 4u);
+  ASSERT_EQ(values, (std::vector<uint32_t>{0u, 8u, 9u, 10u}));
+}
+
+TEST(sensor_dispatch_queue, block) {
+  auto callback = std::make_shared<FakeCallback>();
+  auto queue = std::make_shared<SensorDispatchQueue>(SensorDispatchPolicy::Block, 2u);
+  queue->Start(callback->Get());
+  queue->Push(MakeMessage(0u));
+  callback->WaitFor(1u);
+  queue->Push(MakeMessage(1u));
+  queue->Push(MakeMessage(2u));
+  std::thread producer([&]() { queue->Push(MakeMessage(3u)); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  ASSERT_EQ(queue->GetDepth(), 2u);
+  callback->Release();
+  producer.join();
+  ASSERT_EQ(callback->WaitFor(4u), (std::vector<uint32_t>{0u, 1u, 2u, 3u}));
+  ASSERT_EQ(queue->GetDroppedCount(), 0u);
+  queue->Close();
+}
+
+TEST(sensor_dispatch_queue, close_releases_blocked_producer) {
+  auto callback = std::make_shared<FakeCallback>();
+  auto queue = std::make_shared<SensorDispatchQueue>(SensorDispatchPolicy::Block, 1u);
+  queue->Start(callback->Get());
+  queue->Push(MakeMessage(0u));
+  callback->WaitFor(1u);
+  queue->Push(MakeMessage(1u));
+  std::thread producer([&]() { queue->Push(MakeMessage(2u)); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  queue->Close();
+  producer.join();
+  ASSERT_EQ(queue->GetDepth(), 0u);
+  callback->Release();
+}
+
+TEST(sensor_dispatch_queue, close_from_callback) {
+  std::mutex mutex;
+  std::condition_variable closed;
+  size_t calls = 0u;
+  auto queue = std::make_shared<SensorDispatchQueue>(SensorDispatchPolicy::KeepN, 5u);
+  std::weak_ptr<SensorDispatchQueue> weak = queue;
+  queue->Start([&, weak](carla::Buffer) {
+    weak.lock()->Close();
+    std::lock_guard<std::mutex> lock(mutex);
+    ++calls;
+    closed.notify_all();
+  });
+  for (auto i = 0u; i < 5u; ++i) {
+    queue->Push(MakeMessage(i));
+  }
+  std::unique_lock<std::mutex> lock(mutex);
+  closed.wait(lock, [&]() { return calls > 0u; });
+  lock.unlock();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  ASSERT_EQ(calls, 1u);
+}
+
+TEST(sensor_dispatch_queue, callback_exceptions) {
+  // Exceptions thrown by the callback must not stop the dispatch thread.
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::vector<uint32_t> values;
+  auto queue = std::make_shared<SensorDispatchQueue>(SensorDispatchPolicy::KeepN, 5u);
+  queue->Start([&](carla::Buffer message) {
+    uint32_t value;
+    std::memcpy(&value, message.data(), sizeof(value));
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      values.push_back(value);
+      changed.notify_all();
+    }
+    if (value == 0u) {
+      throw std::runtime_error("callback error");
+    } else if (value == 1u) {
+      throw value;
+    }
+  });
+  for (auto i = 0u; i < 3u; ++i) {
+    queue->Push(MakeMessage(i));
+  }
+  std::unique_lock<std::mutex> lock(mutex);
+  changed.wait(lock, [&]() { return values.size() >= 3u; });
+  ASSERT_EQ(values, (std::vector<uint32_t>{0u, 1u, 2u}));
+  lock.unlock();
+  queue->Close();
+}
+
+TEST(sensor_dispatch_queue, slow_callback_does_not_stall_reads) {
+  // A 20 fps callback fed at a much higher rate, reads must never wait on it.
+  constexpr auto number_of_messages = 100u;
+  auto queue = std::make_shared<SensorDispatchQueue>(SensorDispatchPolicy::LatestOnly, 1u);
+  queue->Start([](carla::Buffer) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  });
+  carla::StopWatch stop_watch;
+  for (auto i = 0u; i < number_of_messages; ++i) {
+    queue->Push(MakeMessage(i));
+  }
+  stop_watch.Stop();
+  queue->Close();
+  ASSERT_LT(stop_watch.GetElapsedTime(), 50u);
+  ASSERT_GE(queue->GetDroppedCount(), number_of_messages - 2u);
+}
@@ -0,0 +1,254 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+#include "Random.h"
+
+#include <carla/Memory.h>
+#include <carla/StopWatch.h>
+#include <carla/client/Map.h>
+#include <carla/trafficmanager/CachedSimpleWaypoint.h>
+#include <carla/trafficmanager/CollisionGrid.h>
+#include <carla/trafficmanager/InMemoryMap.h>
+#include <carla/trafficmanager/SimulationState.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+using carla::traffic_manager::CollisionGrid;
+namespace cg = carla::geom;
+
+/// Place @a count actors in a square whose side grows with the square root of
+/// @a count, keeping a constant density similar to a crowded junction area.
+static std::vector<cg::Location> MakeActorLocations(size_t count) {
+  const float half_side = 5.0f * std::sqrt(static_cast<float>(count));
+  std::vector<cg::Location> locations;
+  locations.reserve(count);
+  for (auto i = 0u; i < count; ++i) {
+    locations.emplace_back(
+        static_cast<float>(util::Random::Uniform(-half_side, half_side)),
+        static_cast<float>(util::Random::Uniform(-half_side, half_side)),
+        0.0f);
+  }
+  return locations;
+}
+
+static size_t CountPairsInRange(const std::vector<cg::Location> &locations, float radius) {
+  size_t pairs = 0u;
+  for (auto i = 0u; i < locations.size(); ++i) {
+    for (auto j = 0u; j < locations.size(); ++j) {
+      if ((i != j) && (cg::Math::DistanceSquared(locations[i], locations[j]) < radius * radius)) {
+        ++pairs;
+      }
+    }
+  }
+  return pairs;
+}
+
+TEST(traffic_manager, collision_grid_query) {
+  constexpr float radius = 26.5f;
+  const auto locations = MakeActorLocations(500u);
+  CollisionGrid grid(20.0f);
+  for (auto i = 0u; i < locations.size(); ++i) {
+    grid.Insert(i, locations[i]);
+  }
+  ASSERT_EQ(grid.Size(), locations.size());
+
+  std::vector<carla::ActorId> result;
+  for (auto i = 0u; i < locations.size(); ++i) {
+    result.clear();
+    grid.Query(locations[i], radius, result);
+    std::sort(result.begin(), result.end());
+    for (auto j = 0u; j < locations.size(); ++j) {
+      const bool in_range = cg::Math::DistanceSquared(locations[i], locations[j]) < radius * radius;
+      if (in_range) {
+        ASSERT_TRUE(std::binary_search(result.begin(), result.end(), j));
+      }
+    }
+  }
+
+  grid.Clear();
+  ASSERT_EQ(grid.Size(), 0u);
+  result.clear();
+  grid.Query(locations[0u], radius, result);
+  ASSERT_TRUE(result.empty());
+}
+
+TEST(traffic_manager, collision_grid_erases_empty_cells) {
+  constexpr float cell_size = 20.0f;
+  CollisionGrid grid(cell_size);
+  // A single actor crossing the map, it enters a new cell every cycle.
+  for (auto cycle = 0u; cycle < 1000u; ++cycle) {
+    grid.Clear();
+    grid.Insert(1u, cg::Location(cell_size * static_cast<float>(cycle), 0.0f, 0.0f));
+    // The cell of this cycle and the one of the previous cycle.
+    ASSERT_LE(grid.NumberOfCells(), 2u);
+  }
+  grid.Clear();
+  grid.Clear();
+  ASSERT_EQ(grid.NumberOfCells(), 0u);
+}
+
+TEST(traffic_manager, benchmark_collision_grid) {
+  // Collision radius of a vehicle driving at 10 m/s.
+  constexpr float radius = 26.5f;
+  for (size_t count : {100u, 500u, 2000u}) {
+    const auto locations = MakeActorLocations(count);
+
+    auto begin = std::chrono::high_resolution_clock::now();
+    const size_t pairs_in_range = CountPairsInRange(locations, radius);
+    auto end = std::chrono::high_resolution_clock::now();
+    const auto brute_force_time = std::chrono::duration_cast<std::chrono::microseconds>(end - begin);
+
+    begin = std::chrono::high_resolution_clock::now();
+    CollisionGrid grid(20.0f);
+    for (auto i = 0u; i < locations.size(); ++i) {
+      grid.Insert(i, locations[i]);
+    }
+    size_t candidate_pairs = 0u;
+    std::vector<carla::ActorId> result;
+    for (auto i = 0u; i < locations.size(); ++i) {
+      result.clear();
+      grid.Query(locations[i], radius, result);
+      candidate_pairs += result.size() - 1u;
+    }
+    end = std::chrono::high_resolution_clock::now();
+    const auto grid_time = std::chrono::duration_cast<std::chrono::microseconds>(end - begin);
+
+    std::cout << count << " actors: "
+              << count * (count - 1u) << " pairs, "
+              << pairs_in_range << " in range, "
+              << candidate_pairs << " grid candidates; brute force "
+              << brute_force_time.count() << " us, grid "
+              << grid_time.count() << " us" << std::endl;
+    ASSERT_GE(candidate_pairs, pairs_in_range);
+  }
+}
+
+static carla::traffic_manager::KinematicState MakeKinematicState(const cg::Location &location) {
+  return {location, cg::Rotation(0.0f, 90.0f, 0.0f), cg::Vector3D(1.0f, 0.0f, 0.0f), 30.0f, true, false};
+}
+
+TEST(traffic_manager, simulation_state_slots) {
+  using namespace carla::traffic_manager;
+  SimulationState state;
+  const StaticAttributes attributes{ActorType::Vehicle, 2.0f, 1.0f, 0.75f};
+  const TrafficLightState tl_state{carla::rpc::TrafficLightState::Green, false};
+  for (carla::ActorId id = 1u; id <= 10u; ++id) {
+    state.AddActor(id, MakeKinematicState(cg::Location(static_cast<float>(id), 0.0f, 0.0f)), attributes, tl_state);
+  }
+  state.RemoveActor(3u);
+  state.RemoveActor(7u);
+  ASSERT_EQ(state.Size(), 8u);
+  ASSERT_FALSE(state.ContainsActor(3u));
+
+  const std::vector<carla::ActorId> vehicle_id_list = {2u, 5u, 8u, 42u, 9u};
+  state.ArrangeSlots(vehicle_id_list);
+  ASSERT_EQ(state.GetActorIdAt(0u), 2u);
+  ASSERT_EQ(state.GetActorIdAt(1u), 5u);
+  ASSERT_EQ(state.GetActorIdAt(2u), 8u);
+  ASSERT_EQ(state.GetActorIdAt(3u), 9u);
+  ASSERT_EQ(state.GetVehicleSlot(1u, 5u), 1u);
+  ASSERT_EQ(state.GetVehicleSlot(4u, 9u), 3u);
+
+  for (size_t slot = 0u; slot < state.Size(); ++slot) {
+    const carla::ActorId id = state.GetActorIdAt(slot);
+    ASSERT_EQ(state.GetSlot(id), slot);
+    ASSERT_EQ(state.GetLocationAt(slot).x, static_cast<float>(id));
+    ASSERT_EQ(state.GetLocation(id).x, static_cast<float>(id));
+    ASSERT_EQ(state.GetDimensions(id), cg::Vector3D(2.0f, 1.0f, 0.75f));
+  }
+  ASSERT_NEAR(state.GetHeading(5u).y, 1.0f, 1e-5f);
+
+  state.UpdateKinematicState(8u, MakeKinematicState(cg::Location(0.0f, 8.0f, 0.0f)));
+  ASSERT_EQ(state.GetLocationAt(2u).y, 8.0f);
+  state.Reset();
+  ASSERT_EQ(state.Size(), 0u);
+}
+
+static std::vector<uint8_t> ReadCacheFile(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  return std::vector<uint8_t>{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+/// Write @a local_map in the unversioned format cooked by previous versions.
+static void WriteUnversionedCache(
+    const carla::traffic_manager::InMemoryMap &local_map,
+    const std::string &path) {
+  using namespace carla::traffic_manager;
+  const NodeList dense_topology = local_map.GetDenseTopology();
+  std::ofstream out_file(path, std::ios::binary);
+  const uint32_t total = static_cast<uint32_t>(dense_topology.size());
+  out_file.write(reinterpret_cast<const char *>(&total), sizeof(uint32_t));
+  for (auto &swp : dense_topology) {
+    CachedSimpleWaypoint(swp).Write(out_file);
+  }
+}
+
+TEST(traffic_manager, benchmark_in_memory_map_cache) {
+  using namespace carla::traffic_manager;
+  const std::string cache_path = "benchmark_in_memory_map_cache.bin";
+  const std::string unversioned_cache_path = "benchmark_in_memory_map_cache_unversioned.bin";
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto world_map = carla::MakeShared<carla::client::Map>(file, util::OpenDrive::Load(file));
+
+    carla::StopWatch stop_watch;
+    InMemoryMap cooked_map(world_map);
+    cooked_map.SetUp();
+    stop_watch.Stop();
+    const auto set_up_time = stop_watch.GetElapsedTime();
+
+    InMemoryMap::Cook(world_map, cache_path);
+    WriteUnversionedCache(cooked_map, unversioned_cache_path);
+    const auto content = ReadCacheFile(cache_path);
+    const auto unversioned_content = ReadCacheFile(unversioned_cache_path);
+    std::remove(cache_path.c_str());
+    std::remove(unversioned_cache_path.c_str());
+
+    stop_watch.Restart();
+    InMemoryMap unversioned_map(world_map);
+    ASSERT_TRUE(unversioned_map.Load(unversioned_content));
+    stop_watch.Stop();
+    const auto unversioned_load_time = stop_watch.GetElapsedTime();
+
+    stop_watch.Restart();
+    InMemoryMap loaded_map(world_map);
+    ASSERT_TRUE(loaded_map.Load(content));
+    stop_watch.Stop();
+    const auto load_time = stop_watch.GetElapsedTime();
+
+    std::cout << file << ": " << cooked_map.GetDenseTopology().size()
+              << " waypoints; set up " << set_up_time
+              << " ms, unversioned cache " << unversioned_load_time
+              << " ms, cache " << load_time << " ms" << std::endl;
+
+    const NodeList expected = cooked_map.GetDenseTopology();
+    const NodeList loaded = loaded_map.GetDenseTopology();
+    ASSERT_EQ(loaded.size(), expected.size());
+    for (auto i = 0u; i < expected.size(); ++i) {
+      ASSERT_EQ(loaded[i]->GetId(), expected[i]->GetId());
+      ASSERT_EQ(loaded[i]->GetLocation(), expected[i]->GetLocation());
+      ASSERT_EQ(loaded[i]->GetGeodesicGridId(), expected[i]->GetGeodesicGridId());
+      ASSERT_EQ(loaded[i]->CheckJunction(), expected[i]->CheckJunction());
+      ASSERT_EQ(loaded[i]->GetNextWaypoint().size(), expected[i]->GetNextWaypoint().size());
+      ASSERT_EQ(loaded[i]->GetPreviousWaypoint().size(), expected[i]->GetPreviousWaypoint().size());
+      ASSERT_EQ(loaded[i]->GetLeftWaypoint() == nullptr, expected[i]->GetLeftWaypoint() == nullptr);
+      ASSERT_EQ(loaded[i]->GetWaypoint()->GetId(), expected[i]->GetId());
+    }
+    if (!expected.empty()) {
+      const cg::Location location = expected.front()->GetLocation();
+      ASSERT_EQ(loaded_map.GetWaypoint(location)->GetId(), cooked_map.GetWaypoint(location)->GetId());
+    }
+
+    InMemoryMap corrupted_map(world_map);
+    ASSERT_FALSE(corrupted_map.Load(std::vector<uint8_t>(content.begin(), content.end() - 1u)));
+  }
+}
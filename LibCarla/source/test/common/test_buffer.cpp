@@ -134,3 +134,69 @@ TEST(buffer, buffer_pool) {
   // Now delete the pool to test the weak reference inside the buffers.
   pool.reset();
 }
+
+TEST(buffer, buffer_pool_size_classes) {
+  auto pool = std::make_shared<carla::BufferPool>();
+  const unsigned char *big_data;
+  const unsigned char *small_data;
+  {
+    auto big = pool->Pop(1000000u);
+    auto small = pool->Pop(200u);
+    ASSERT_EQ(big.size(), 1000000u);
+    ASSERT_EQ(small.size(), 200u);
+    big_data = big.data();
+    small_data = small.data();
+  }
+  auto stats = pool->GetStatistics();
+  ASSERT_EQ(stats.misses, 2u);
+  ASSERT_EQ(stats.buffers_held, 2u);
+  ASSERT_EQ(stats.bytes_held, 1000200u);
+
+  // A small message does not take the big buffer, and the other way around.
+  auto small = pool->Pop(150u);
+  ASSERT_EQ(small.data(), small_data);
+  ASSERT_EQ(small.size(), 150u);
+  auto big = pool->Pop(900000u);
+  ASSERT_EQ(big.data(), big_data);
+  {
+    // Nothing left that fits.
+    auto other = pool->Pop(100u);
+    ASSERT_NE(other.data(), small_data);
+  }
+  // A buffer of the same class but too small is not used.
+  auto medium = pool->Pop(120u);
+  ASSERT_EQ(medium.size(), 120u);
+
+  stats = pool->GetStatistics();
+  ASSERT_EQ(stats.hits, 2u);
+  ASSERT_EQ(stats.misses, 4u);
+  ASSERT_EQ(stats.buffers_held, 1u);
+}
+
+TEST(buffer, buffer_pool_max_bytes) {
+  auto pool = std::make_shared<carla::BufferPool>();
+  pool->SetMaxBytes(1000u);
+  {
+    // A single buffer is kept even if bigger than the limit.
+    auto huge = pool->Pop(5000u);
+  }
+  ASSERT_EQ(pool->GetStatistics().bytes_held, 5000u);
+  {
+    auto b0 = pool->Pop(400u);
+    auto b1 = pool->Pop(400u);
+  }
+  auto stats = pool->GetStatistics();
+  ASSERT_EQ(stats.buffers_held, 1u);
+  ASSERT_EQ(stats.bytes_trimmed, 800u);
+
+  pool->Trim(0u);
+  stats = pool->GetStatistics();
+  ASSERT_EQ(stats.buffers_held, 0u);
+  ASSERT_EQ(stats.bytes_held, 0u);
+  ASSERT_EQ(stats.bytes_trimmed, 5800u);
+  {
+    auto b0 = pool->Pop(400u);
+    auto b1 = pool->Pop(500u);
+  }
+  ASSERT_EQ(pool->GetStatistics().bytes_held, 900u);
+}
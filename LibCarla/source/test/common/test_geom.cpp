@@ -5,10 +5,13 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 #include "test.h"
+#include "Random.h"
 
+#include <carla/StopWatch.h>
 #include <carla/geom/Vector3D.h>
 #include <carla/geom/Math.h>
 #include <carla/geom/BoundingBox.h>
+#include <carla/geom/Rtree.h>
 #include <carla/geom/Transform.h>
 #include <limits>
 
@@ -227,3 +230,69 @@ TEST(geom, nearest_point_arc) {
   ASSERT_NEAR(Math::DistanceArcToPoint(Vector3D(1,2,0),
       Vector3D(0,0,0), 1.57f, 0, 1).second, 1.0f, 0.01f);
 }
+
+TEST(geom, segment_rtree_build_tree) {
+  using Rtree = SegmentCloudRtree<size_t>;
+  constexpr size_t number_of_segments = 100'000u;
+  constexpr size_t number_of_queries = 10'000u;
+
+  std::vector<Rtree::TreeElement> elements;
+  elements.reserve(number_of_segments);
+  for (auto i = 0u; i < number_of_segments; ++i) {
+    const auto start = util::Random::Location(-2000.0f, 2000.0f);
+    const auto end = start + util::Random::Location(-5.0f, 5.0f);
+    elements.emplace_back(
+        Rtree::BSegment(Rtree::BPoint(start.x, start.y, start.z), Rtree::BPoint(end.x, end.y, end.z)),
+        std::make_pair(i, i));
+  }
+
+  carla::StopWatch stop_watch;
+  Rtree inserted_tree;
+  inserted_tree.InsertElements(elements);
+  stop_watch.Stop();
+  const auto insert_time = stop_watch.GetElapsedTime();
+
+  stop_watch.Restart();
+  Rtree packed_tree;
+  packed_tree.BuildTree(elements);
+  stop_watch.Stop();
+  const auto build_time = stop_watch.GetElapsedTime();
+  ASSERT_EQ(packed_tree.GetTreeSize(), inserted_tree.GetTreeSize());
+
+  std::vector<Rtree::BPoint> queries;
+  for (auto i = 0u; i < number_of_queries; ++i) {
+    const auto location = util::Random::Location(-2000.0f, 2000.0f);
+    queries.emplace_back(location.x, location.y, location.z);
+  }
+  auto accept_even = [](const Rtree::TreeElement &element) {
+    return element.second.first % 2u == 0u;
+  };
+
+  std::vector<Rtree::TreeElement> inserted_results;
+  stop_watch.Restart();
+  for (auto &query : queries) {
+    inserted_results.push_back(inserted_tree.GetNearestNeighboursWithFilter(query, accept_even).front());
+  }
+  stop_watch.Stop();
+  const auto inserted_query_time = stop_watch.GetElapsedTime();
+
+  std::vector<Rtree::TreeElement> packed_results;
+  stop_watch.Restart();
+  for (auto &query : queries) {
+    packed_results.push_back(packed_tree.GetNearestNeighboursWithFilter(query, accept_even).front());
+  }
+  stop_watch.Stop();
+  const auto packed_query_time = stop_watch.GetElapsedTime();
+
+  for (auto i = 0u; i < number_of_queries; ++i) {
+    ASSERT_EQ(packed_results[i].second.first % 2u, 0u);
+    ASSERT_FLOAT_EQ(
+        static_cast<float>(boost::geometry::distance(queries[i], packed_results[i].first)),
+        static_cast<float>(boost::geometry::distance(queries[i], inserted_results[i].first)));
+  }
+
+  std::cout << number_of_segments << " segments: insert " << insert_time
+            << " ms, bulk load " << build_time << " ms; "
+            << number_of_queries << " queries: inserted tree " << inserted_query_time
+            << " ms, packed tree " << packed_query_time << " ms" << std::endl;
+}
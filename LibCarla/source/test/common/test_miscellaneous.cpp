@@ -6,8 +6,33 @@
 
 #include "test.h"
 
+#include <carla/ThreadPool.h>
 #include <carla/Version.h>
 
+#include <atomic>
+#include <vector>
+
 TEST(miscellaneous, version) {
   std::cout << "LibCarla " << carla::version() << std::endl;
 }
+
+TEST(miscellaneous, thread_pool_parallel_for) {
+  constexpr size_t size = 1000u;
+  carla::ThreadPool pool;
+  pool.AsyncRun(4u);
+  std::vector<std::atomic_size_t> visits(size);
+  for (auto &count : visits) {
+    count = 0u;
+  }
+  pool.ParallelFor(size, 7u, [&](size_t index) { ++visits[index]; });
+  for (auto &count : visits) {
+    ASSERT_EQ(count, 1u);
+  }
+  // Nested calls from within a task of the same pool must not dead-lock.
+  std::atomic_size_t total{0u};
+  pool.ParallelFor(8u, 1u, [&](size_t) {
+    pool.ParallelFor(8u, 1u, [&](size_t) { ++total; });
+  });
+  ASSERT_EQ(total, 64u);
+  pool.Stop();
+}
@@ -9,13 +9,26 @@
 #include <carla/ThreadGroup.h>
 #include <carla/streaming/Client.h>
 #include <carla/streaming/Server.h>
+#include <carla/streaming/detail/Compressor.h>
 #include <carla/streaming/detail/Dispatcher.h>
+#include <carla/streaming/detail/Lz4.h>
+#include <carla/streaming/detail/SharedMemoryRing.h>
+#include <carla/streaming/detail/Token.h>
+#include <carla/streaming/detail/Types.h>
 #include <carla/streaming/detail/tcp/Client.h>
 #include <carla/streaming/detail/tcp/Server.h>
 #include <carla/streaming/low_level/Client.h>
 #include <carla/streaming/low_level/Server.h>
 
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+#include <array>
 #include <atomic>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
 
 using namespace std::chrono_literals;
 
@@ -259,3 +272,479 @@ TEST(streaming, multi_stream) {
     }
   }
 }
+
+TEST(streaming, send_queue_burst) {
+  using namespace carla::streaming;
+  using namespace util::buffer;
+  constexpr size_t number_of_messages = 50u;
+  const std::string message = "Burst!";
+
+  Server srv(TESTING_PORT);
+  srv.SetSendQueueCapacity(number_of_messages);
+  srv.SetSendQueuePolicy(Server::SendQueuePolicy::DropNewest);
+  srv.AsyncRun(2u);
+  auto stream = srv.MakeStream();
+
+  std::atomic_size_t messages_received{0u};
+  Client c;
+  c.AsyncRun(2u);
+  c.Subscribe(stream.token(), [&](auto buffer) {
+    const std::string result = as_string(buffer);
+    ASSERT_EQ(result, message);
+    ++messages_received;
+  });
+  std::this_thread::sleep_for(20ms);
+
+  // Write everything at once, the queue is big enough to hold all messages
+  // while the session is busy writing.
+  for (auto i = 0u; i < number_of_messages; ++i) {
+    stream << message;
+  }
+  for (auto i = 0u; (i < 100u) && (messages_received < number_of_messages); ++i) {
+    std::this_thread::sleep_for(10ms);
+  }
+
+  ASSERT_EQ(messages_received, number_of_messages);
+  const auto stats = srv.GetSendQueueStatistics();
+  ASSERT_EQ(stats.dropped_messages, 0u);
+  ASSERT_EQ(stats.queued_messages, 0u);
+  ASSERT_EQ(stats.sent_messages, number_of_messages);
+  ASSERT_LE(stats.number_of_writes, number_of_messages);
+}
+
+// A client that subscribes to a stream with a raw socket and only reads when
+// asked to, so the server's send queue fills up behind the message in flight.
+class stalled_client {
+public:
+
+  explicit stalled_client(const carla::streaming::Token &token)
+    : _socket(_io_context) {
+    using namespace boost::asio;
+    carla::streaming::detail::token_type token_data{token};
+    if (!token_data.has_address()) {
+      token_data.set_address(ip::address_v4::loopback());
+    }
+    // A small receive buffer keeps the first big message in flight.
+    _socket.open(ip::tcp::v4());
+    _socket.set_option(socket_base::receive_buffer_size(4096));
+    _socket.connect(token_data.to_tcp_endpoint());
+    carla::streaming::detail::SubscriptionRequest request;
+    request.stream_id = token_data.get_stream_id();
+    request.compression = carla::streaming::Compression::None;
+    request.transport = carla::streaming::Transport::Tcp;
+    boost::asio::write(_socket, buffer(&request, sizeof(request)));
+  }
+
+  std::string Read() {
+    using namespace boost::asio;
+    carla::streaming::detail::message_size_type size = 0u;
+    boost::asio::read(_socket, buffer(&size, sizeof(size)));
+    std::string payload(size, '\0');
+    boost::asio::read(_socket, buffer(&payload[0u], payload.size()));
+    return payload;
+  }
+
+private:
+
+  boost::asio::io_context _io_context;
+
+  boost::asio::ip::tcp::socket _socket;
+};
+
+// Big enough to never fit in the socket buffers of the stalled client.
+static const std::string BIG_MESSAGE(16u * 1024u * 1024u, 'x');
+
+// Writes a big message that stays in flight, then the given messages into a
+// send queue of capacity 2.
+static void FillSendQueue(
+    carla::streaming::Stream &stream,
+    const std::vector<std::string> &messages) {
+  stream << BIG_MESSAGE;
+  std::this_thread::sleep_for(50ms);
+  for (auto &&message : messages) {
+    stream << message;
+  }
+}
+
+TEST(streaming, send_queue_drop_oldest) {
+  using namespace carla::streaming;
+  Server srv(TESTING_PORT);
+  srv.SetSendQueueCapacity(2u);
+  srv.SetSendQueuePolicy(Server::SendQueuePolicy::DropOldest);
+  srv.AsyncRun(2u);
+  auto stream = srv.MakeStream();
+
+  stalled_client client{stream.token()};
+  std::this_thread::sleep_for(50ms);
+  FillSendQueue(stream, {"m1", "m2", "m3", "m4"});
+
+  auto stats = srv.GetSendQueueStatistics();
+  ASSERT_EQ(stats.dropped_messages, 2u);
+  ASSERT_EQ(stats.max_queue_depth, 2u);
+  ASSERT_EQ(stats.queued_messages, 2u);
+
+  ASSERT_EQ(client.Read(), BIG_MESSAGE);
+  ASSERT_EQ(client.Read(), "m3");
+  ASSERT_EQ(client.Read(), "m4");
+}
+
+TEST(streaming, send_queue_drop_newest) {
+  using namespace carla::streaming;
+  Server srv(TESTING_PORT);
+  srv.SetSendQueueCapacity(2u);
+  srv.SetSendQueuePolicy(Server::SendQueuePolicy::DropNewest);
+  srv.AsyncRun(2u);
+  auto stream = srv.MakeStream();
+
+  stalled_client client{stream.token()};
+  std::this_thread::sleep_for(50ms);
+  FillSendQueue(stream, {"m1", "m2", "m3", "m4"});
+
+  auto stats = srv.GetSendQueueStatistics();
+  ASSERT_EQ(stats.dropped_messages, 2u);
+  ASSERT_EQ(stats.max_queue_depth, 2u);
+  ASSERT_EQ(stats.queued_messages, 2u);
+
+  ASSERT_EQ(client.Read(), BIG_MESSAGE);
+  ASSERT_EQ(client.Read(), "m1");
+  ASSERT_EQ(client.Read(), "m2");
+}
+
+TEST(streaming, send_queue_block) {
+  using namespace carla::streaming;
+  Server srv(TESTING_PORT);
+  srv.SetSendQueueCapacity(2u);
+  srv.SetSendQueuePolicy(Server::SendQueuePolicy::Block);
+  srv.AsyncRun(2u);
+  auto stream = srv.MakeStream();
+
+  stalled_client client{stream.token()};
+  std::this_thread::sleep_for(50ms);
+  FillSendQueue(stream, {"m1", "m2"});
+
+  // The queue is full, the writer has to wait for the client.
+  std::atomic_bool is_written{false};
+  carla::ThreadGroup writer;
+  writer.CreateThread([&]() {
+    stream << std::string("m3");
+    is_written = true;
+  });
+  std::this_thread::sleep_for(100ms);
+  ASSERT_FALSE(is_written);
+
+  ASSERT_EQ(client.Read(), BIG_MESSAGE);
+  ASSERT_EQ(client.Read(), "m1");
+  ASSERT_EQ(client.Read(), "m2");
+  ASSERT_EQ(client.Read(), "m3");
+  writer.JoinAll();
+  ASSERT_TRUE(is_written);
+
+  auto stats = srv.GetSendQueueStatistics();
+  ASSERT_EQ(stats.dropped_messages, 0u);
+  ASSERT_EQ(stats.max_queue_depth, 2u);
+  ASSERT_EQ(stats.queued_messages, 0u);
+}
+
+TEST(streaming, send_queue_block_timeout) {
+  using namespace carla::streaming;
+  constexpr auto timeout = 200ms;
+  Server srv(TESTING_PORT);
+  srv.SetTimeout(timeout);
+  srv.SetSendQueueCapacity(2u);
+  srv.SetSendQueuePolicy(Server::SendQueuePolicy::Block);
+  srv.AsyncRun(2u);
+  auto stream = srv.MakeStream();
+
+  stalled_client client{stream.token()};
+  std::this_thread::sleep_for(50ms);
+  FillSendQueue(stream, {"m1", "m2"});
+
+  // The client never reads, the writer is released when either the wait or
+  // the session times out.
+  const auto begin = std::chrono::steady_clock::now();
+  stream << std::string("m3");
+  const auto elapsed = std::chrono::steady_clock::now() - begin;
+  ASSERT_GE(elapsed, timeout / 2);
+  ASSERT_LT(elapsed, 5 * timeout);
+
+  auto stats = srv.GetSendQueueStatistics();
+  ASSERT_LE(stats.dropped_messages, 1u);
+  ASSERT_EQ(stats.max_queue_depth, 2u);
+}
+
+static void CheckLz4RoundTrip(const std::vector<unsigned char> &data) {
+  using carla::streaming::detail::Lz4;
+  std::vector<unsigned char> compressed(Lz4::CompressBound(data.size()));
+  const auto size = Lz4::Compress(data.data(), data.size(), compressed.data());
+  ASSERT_LE(size, compressed.size());
+  std::vector<unsigned char> decompressed(data.size());
+  ASSERT_TRUE(Lz4::Decompress(compressed.data(), size, decompressed.data(), decompressed.size()));
+  ASSERT_EQ(decompressed, data);
+  // Truncated or oversized output must be detected.
+  if (size > 1u) {
+    ASSERT_FALSE(Lz4::Decompress(compressed.data(), size - 1u, decompressed.data(), decompressed.size()));
+  }
+  std::vector<unsigned char> too_big(data.size() + 1u);
+  ASSERT_FALSE(Lz4::Decompress(compressed.data(), size, too_big.data(), too_big.size()));
+}
+
+TEST(streaming, lz4_round_trip) {
+  std::mt19937 rng(42u);
+  for (size_t size : {0u, 1u, 12u, 13u, 100u, 4096u, 70000u, 1000000u}) {
+    std::vector<unsigned char> data(size);
+    // Incompressible.
+    for (auto &byte : data) {
+      byte = static_cast<unsigned char>(rng());
+    }
+    CheckLz4RoundTrip(data);
+    // Runs of a single byte, overlapping matches.
+    for (auto i = 0u; i < size; ++i) {
+      data[i] = static_cast<unsigned char>((i / 300u) % 3u);
+    }
+    CheckLz4RoundTrip(data);
+    // Repeated short patterns with some noise.
+    for (auto i = 0u; i < size; ++i) {
+      data[i] = static_cast<unsigned char>(i % 7u + ((rng() % 50u) == 0u ? 1u : 0u));
+    }
+    CheckLz4RoundTrip(data);
+  }
+}
+
+TEST(streaming, lz4_reference_block) {
+  using carla::streaming::detail::Lz4;
+  // A block assembled by hand following the format specification: 3
+  // literals, a match of 20 bytes at offset 3 (overlapping its own output)
+  // and a last sequence of 5 literals.
+  const unsigned char block[] = {0x3f, 'a', 'b', 'c', 0x03, 0x00, 0x01, 0x50, 'b', 'c', 'a', 'b', 'c'};
+  std::vector<unsigned char> output(3u + 20u + 5u);
+  ASSERT_TRUE(Lz4::Decompress(block, sizeof(block), output.data(), output.size()));
+  std::string expected;
+  while (expected.size() < 23u) {
+    expected += "abc";
+  }
+  expected = expected.substr(0u, 23u) + "bcabc";
+  ASSERT_EQ(std::string(output.begin(), output.end()), expected);
+  // Offset pointing before the start of the output.
+  const unsigned char bad_offset[] = {0x10, 'a', 0x05, 0x00, 0x00};
+  ASSERT_FALSE(Lz4::Decompress(bad_offset, sizeof(bad_offset), output.data(), 5u));
+}
+
+TEST(streaming, compressor_frames) {
+  using namespace carla::streaming;
+  using carla::streaming::detail::Compressor;
+  std::vector<uint32_t> image(640u * 480u);
+  for (auto i = 0u; i < image.size(); ++i) {
+    // A horizontal gradient, identical rows.
+    image[i] = 0xff000000u | ((i % 640u) * 0x010101u / 3u);
+  }
+  const carla::Buffer header(std::string("sensor header"));
+  const carla::Buffer body(image);
+  std::vector<boost::asio::const_buffer> payload{header.buffer(), body.buffer()};
+  for (auto compression : {Compression::LZ4, Compression::LZ4Bgra}) {
+    carla::Buffer frame;
+    Compressor::Compress(compression, payload, frame);
+    ASSERT_LT(frame.size(), body.size() / 10u);
+    carla::Buffer message;
+    ASSERT_TRUE(Compressor::Decompress(frame, message));
+    ASSERT_EQ(message.size(), header.size() + body.size());
+    ASSERT_EQ(std::memcmp(message.data(), header.data(), header.size()), 0);
+    ASSERT_EQ(std::memcmp(message.data() + header.size(), body.data(), body.size()), 0);
+  }
+  // Sizes that are not a whole number of pixels.
+  std::mt19937 rng(7u);
+  for (auto size = 1u; size < 40u; ++size) {
+    std::vector<unsigned char> data(size);
+    for (auto &byte : data) {
+      byte = static_cast<unsigned char>(rng());
+    }
+    const carla::Buffer buffer(data);
+    carla::Buffer frame;
+    Compressor::Compress(Compression::LZ4Bgra, std::vector<boost::asio::const_buffer>{buffer.buffer()}, frame);
+    carla::Buffer message;
+    ASSERT_TRUE(Compressor::Decompress(frame, message));
+    ASSERT_TRUE(message == buffer);
+  }
+  // Incompressible data is stored as is.
+  std::vector<uint32_t> noise(1000u);
+  for (auto &value : noise) {
+    value = static_cast<uint32_t>(rng());
+  }
+  const carla::Buffer noisy(noise);
+  carla::Buffer frame;
+  Compressor::Compress(Compression::LZ4, std::vector<boost::asio::const_buffer>{noisy.buffer()}, frame);
+  ASSERT_LE(frame.size(), noisy.size() + 8u);
+  carla::Buffer message;
+  ASSERT_TRUE(Compressor::Decompress(frame, message));
+  ASSERT_TRUE(message == noisy);
+  frame.resize(frame.size() - 1u);
+  ASSERT_FALSE(Compressor::Decompress(frame, message));
+}
+
+TEST(streaming, compressed_subscription) {
+  using namespace carla::streaming;
+  constexpr size_t number_of_messages = 20u;
+  std::vector<uint32_t> image(320u * 240u);
+  for (auto i = 0u; i < image.size(); ++i) {
+    image[i] = 0xff000000u | ((i % 320u) * 0x010203u);
+  }
+  const carla::Buffer message(image);
+
+  Server srv(TESTING_PORT);
+  srv.AsyncRun(2u);
+  auto stream = srv.MakeStream();
+
+  std::atomic_size_t plain{0u};
+  std::atomic_size_t compressed{0u};
+  Client c0;
+  Client c1;
+  c0.AsyncRun(1u);
+  c1.AsyncRun(1u);
+  // Two clients of the same stream, only one of them asks for compression.
+  c0.Subscribe(stream.token(), [&](carla::Buffer buffer) {
+    ASSERT_TRUE(buffer == message);
+    ++plain;
+  });
+  c1.Subscribe(stream.token(), Compression::LZ4Bgra, [&](carla::Buffer buffer) {
+    ASSERT_TRUE(buffer == message);
+    ++compressed;
+  });
+  std::this_thread::sleep_for(20ms);
+
+  for (auto i = 0u; i < number_of_messages; ++i) {
+    std::this_thread::sleep_for(2ms);
+    stream.Write(carla::Buffer(image));
+  }
+  for (auto i = 0u; (i < 100u) && ((plain < number_of_messages) || (compressed < number_of_messages)); ++i) {
+    std::this_thread::sleep_for(10ms);
+  }
+  ASSERT_EQ(plain, number_of_messages);
+  ASSERT_EQ(compressed, number_of_messages);
+}
+
+TEST(streaming, shared_memory_ring) {
+  using carla::streaming::detail::SharedMemoryRing;
+  constexpr size_t capacity = 1000u;
+  auto server_ring = SharedMemoryRing::Create(capacity);
+  ASSERT_NE(server_ring, nullptr);
+  ASSERT_EQ(SharedMemoryRing::Open(server_ring->GetNonce() + 1u, capacity), nullptr);
+  auto client_ring = SharedMemoryRing::Open(server_ring->GetNonce(), capacity);
+  ASSERT_NE(client_ring, nullptr);
+  // The client removed the name, nobody else can map it.
+  ASSERT_EQ(SharedMemoryRing::Open(server_ring->GetNonce(), capacity), nullptr);
+
+  auto make_message = [](size_t size, unsigned char value) {
+    return std::vector<unsigned char>(size, value);
+  };
+  auto write = [&](const std::vector<unsigned char> &message, uint64_t &position) {
+    const std::array<boost::asio::const_buffer, 1u> buffers{{boost::asio::buffer(message)}};
+    return server_ring->TryWrite(buffers, message.size(), position);
+  };
+
+  const auto m0 = make_message(400u, 1u);
+  const auto m1 = make_message(400u, 2u);
+  const auto m2 = make_message(300u, 3u);
+  uint64_t p0, p1, p2;
+  ASSERT_TRUE(write(m0, p0));
+  ASSERT_TRUE(write(m1, p1));
+  ASSERT_EQ(p1, 400u);
+  // Does not fit before the end, neither at the beginning of the next lap
+  // until the client reads the first message.
+  ASSERT_FALSE(write(m2, p2));
+  carla::Buffer buffer;
+  ASSERT_TRUE(client_ring->Read(p0, m0.size(), buffer));
+  ASSERT_TRUE(buffer == carla::Buffer(m0));
+  ASSERT_TRUE(write(m2, p2));
+  ASSERT_EQ(p2, capacity);
+  ASSERT_TRUE(client_ring->Read(p1, m1.size(), buffer));
+  ASSERT_TRUE(buffer == carla::Buffer(m1));
+  ASSERT_TRUE(client_ring->Read(p2, m2.size(), buffer));
+  ASSERT_TRUE(buffer == carla::Buffer(m2));
+  // Already read, or crossing the end of the ring.
+  ASSERT_FALSE(client_ring->Read(p0, m0.size(), buffer));
+  ASSERT_FALSE(client_ring->Read(p2 + 900u, 200u, buffer));
+  ASSERT_FALSE(write(make_message(capacity + 1u, 4u), p0));
+}
+
+TEST(streaming, shared_memory_subscription) {
+  using namespace carla::streaming;
+  constexpr size_t number_of_messages = 50u;
+  std::vector<uint32_t> image(320u * 240u);
+  for (auto i = 0u; i < image.size(); ++i) {
+    image[i] = 0xff000000u | ((i % 320u) * 0x010203u);
+  }
+  const carla::Buffer message(image);
+
+  Server srv(TESTING_PORT);
+  // Room for two messages only, the rest are sent inline while the client
+  // lags behind.
+  srv.SetSharedMemorySize(2u * message.size() + 100u);
+  srv.AsyncRun(2u);
+  auto stream = srv.MakeStream();
+
+  std::atomic_size_t tcp{0u};
+  std::atomic_size_t shared{0u};
+  std::atomic_size_t compressed{0u};
+  Client c0;
+  Client c1;
+  c0.AsyncRun(1u);
+  c1.AsyncRun(1u);
+  c0.Subscribe(stream.token(), [&](carla::Buffer buffer) {
+    ASSERT_TRUE(buffer == message);
+    ++tcp;
+  });
+  c1.SetTransport(Transport::SharedMemory);
+  c1.Subscribe(stream.token(), [&](carla::Buffer buffer) {
+    ASSERT_TRUE(buffer == message);
+    ++shared;
+  });
+  Client c2;
+  c2.AsyncRun(1u);
+  c2.SetTransport(Transport::SharedMemory);
+  c2.Subscribe(stream.token(), Compression::LZ4Bgra, [&](carla::Buffer buffer) {
+    ASSERT_TRUE(buffer == message);
+    ++compressed;
+  });
+  std::this_thread::sleep_for(20ms);
+
+  for (auto i = 0u; i < number_of_messages; ++i) {
+    std::this_thread::sleep_for(2ms);
+    stream.Write(carla::Buffer(image));
+  }
+  for (auto i = 0u; (i < 100u) && ((tcp < number_of_messages) || (shared < number_of_messages) || (compressed < number_of_messages)); ++i) {
+    std::this_thread::sleep_for(10ms);
+  }
+  ASSERT_EQ(tcp, number_of_messages);
+  ASSERT_EQ(shared, number_of_messages);
+  ASSERT_EQ(compressed, number_of_messages);
+}
+
+TEST(streaming, shared_memory_disabled) {
+  using namespace carla::streaming;
+  constexpr size_t number_of_messages = 10u;
+  const std::string message = "Hello shared memory!";
+
+  Server srv(TESTING_PORT);
+  srv.SetSharedMemorySize(0u);
+  srv.AsyncRun(1u);
+  auto stream = srv.MakeStream();
+
+  std::atomic_size_t received{0u};
+  Client c;
+  c.AsyncRun(1u);
+  c.SetTransport(Transport::SharedMemory);
+  c.Subscribe(stream.token(), [&](carla::Buffer buffer) {
+    ASSERT_EQ(buffer.size(), message.size());
+    ASSERT_EQ(std::memcmp(buffer.data(), message.data(), message.size()), 0);
+    ++received;
+  });
+  std::this_thread::sleep_for(20ms);
+
+  for (auto i = 0u; i < number_of_messages; ++i) {
+    std::this_thread::sleep_for(2ms);
+    stream << message;
+  }
+  for (auto i = 0u; (i < 100u) && (received < number_of_messages); ++i) {
+    std::this_thread::sleep_for(10ms);
+  }
+  ASSERT_EQ(received, number_of_messages);
+}
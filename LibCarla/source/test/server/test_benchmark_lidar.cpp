@@ -0,0 +1,115 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/BufferPool.h>
+#include <carla/StopWatch.h>
+#include <carla/sensor/s11n/LidarSerializer.h>
+#include <carla/sensor/s11n/RadarSerializer.h>
+
+#include <cstring>
+
+using namespace carla::sensor;
+
+namespace {
+
+  struct FakeSensor {};
+
+  // A 128 channels lidar with 1800 points per channel and revolution.
+  constexpr uint32_t CHANNELS = 128u;
+  constexpr uint32_t POINTS_PER_CHANNEL = 1800u;
+
+} // namespace
+
+static void SimulateLidar(data::LidarData &lidar, uint32_t frame) {
+  std::vector<uint32_t> points_per_channel(CHANNELS, POINTS_PER_CHANNEL);
+  lidar.SetHorizontalAngle(static_cast<float>(frame));
+  lidar.ResetMemory(points_per_channel);
+  for (auto channel = 0u; channel < CHANNELS; ++channel) {
+    for (auto i = 0u; i < POINTS_PER_CHANNEL; ++i) {
+      data::LidarDetection detection{
+          static_cast<float>(frame),
+          static_cast<float>(channel),
+          static_cast<float>(i),
+          0.5f};
+      lidar.WritePointSync(detection);
+    }
+  }
+  lidar.WriteChannelCount(points_per_channel);
+}
+
+static bool AreEqual(const carla::Buffer &lhs, const carla::Buffer &rhs) {
+  return (lhs.size() == rhs.size()) &&
+         (std::memcmp(lhs.data(), rhs.data(), lhs.size()) == 0);
+}
+
+TEST(lidar, serialize_in_place) {
+  auto pool = std::make_shared<carla::BufferPool>();
+  data::LidarData lidar(CHANNELS);
+  lidar.AcquireBuffer(pool->Pop());
+  SimulateLidar(lidar, 1u);
+  const auto copied = s11n::LidarSerializer::Serialize(
+      FakeSensor{},
+      static_cast<const data::LidarData &>(lidar),
+      pool->Pop());
+  const auto handed_over = s11n::LidarSerializer::Serialize(FakeSensor{}, lidar);
+  ASSERT_TRUE(AreEqual(copied, handed_over));
+  ASSERT_EQ(
+      handed_over.size(),
+      sizeof(uint32_t) * (2u + CHANNELS) + 4u * sizeof(float) * CHANNELS * POINTS_PER_CHANNEL);
+
+  data::RadarData radar;
+  radar.SetResolution(2u);
+  radar.AcquireBuffer(pool->Pop());
+  radar.Reset();
+  for (auto i = 0u; i < 5u; ++i) {
+    radar.WriteDetection({1.0f, 2.0f, 3.0f, static_cast<float>(i)});
+  }
+  ASSERT_EQ(radar.GetDetectionCount(), 5u);
+  const auto radar_copied = s11n::RadarSerializer::Serialize(
+      FakeSensor{},
+      static_cast<const data::RadarData &>(radar),
+      pool->Pop());
+  const auto radar_handed_over = s11n::RadarSerializer::Serialize(FakeSensor{}, radar);
+  ASSERT_TRUE(AreEqual(radar_copied, radar_handed_over));
+  ASSERT_EQ(radar_handed_over.size(), 5u * data::RadarData::detection_size);
+}
+
+TEST(lidar, benchmark_serialization) {
+  constexpr auto number_of_frames = 100u;
+  auto pool = std::make_shared<carla::BufferPool>();
+  data::LidarData lidar(CHANNELS);
+
+  size_t copy_time = 0u;
+  size_t bytes = 0u;
+  for (auto frame = 0u; frame < number_of_frames; ++frame) {
+    SimulateLidar(lidar, frame);
+    carla::StopWatch stop_watch;
+    auto buffer = s11n::LidarSerializer::Serialize(
+        FakeSensor{},
+        static_cast<const data::LidarData &>(lidar),
+        pool->Pop());
+    stop_watch.Stop();
+    copy_time += stop_watch.GetElapsedTime<std::chrono::microseconds>();
+    bytes += buffer.size();
+  }
+
+  size_t hand_over_time = 0u;
+  for (auto frame = 0u; frame < number_of_frames; ++frame) {
+    lidar.AcquireBuffer(pool->Pop());
+    SimulateLidar(lidar, frame);
+    carla::StopWatch stop_watch;
+    auto buffer = s11n::LidarSerializer::Serialize(FakeSensor{}, lidar);
+    stop_watch.Stop();
+    hand_over_time += stop_watch.GetElapsedTime<std::chrono::microseconds>();
+  }
+
+  const double mb = static_cast<double>(bytes) / 1e6;
+  carla::logging::log(
+      "Lidar serialization of", number_of_frames, "frames,", mb, "MB:",
+      "copy", copy_time / 1000u, "ms, in place", hand_over_time / 1000u, "ms");
+}
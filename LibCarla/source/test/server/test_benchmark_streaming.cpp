@@ -6,12 +6,15 @@
 
 #include "test.h"
 
+#include <carla/StopWatch.h>
 #include <carla/streaming/Client.h>
 #include <carla/streaming/Server.h>
+#include <carla/streaming/detail/Compressor.h>
 
 #include <boost/asio/post.hpp>
 
 #include <algorithm>
+#include <random>
 
 using namespace carla::streaming;
 using namespace std::chrono_literals;
@@ -27,17 +30,30 @@ class Benchmark {
 public:
 
   Benchmark(uint16_t port, size_t message_size, double success_ratio)
+    : Benchmark(port, make_special_message(message_size), success_ratio) {}
+
+  Benchmark(
+      uint16_t port,
+      carla::Buffer message,
+      double success_ratio,
+      Compression compression = Compression::None)
     : _server(port),
       _client(),
-      _message(make_special_message(message_size)),
+      _message(std::move(message)),
       _client_callback(),
       _work_to_do(_client_callback),
-      _success_ratio(success_ratio) {}
+      _success_ratio(success_ratio),
+      _compression(compression) {}
+
+  /// Applies to the streams added afterwards.
+  void SetTransport(Transport transport) {
+    _client.SetTransport(transport);
+  }
 
   void AddStream() {
     Stream stream = _server.MakeStream();
 
-    _client.Subscribe(stream.token(), [this](carla::Buffer DEBUG_ONLY(msg)) {
+    _client.Subscribe(stream.token(), _compression, [this](carla::Buffer DEBUG_ONLY(msg)) {
       DEBUG_ASSERT_EQ(msg.size(), _message.size());
       DEBUG_ASSERT(msg == _message);
       boost::asio::post(_client_callback, [this]() {
@@ -55,7 +71,7 @@ public:
     }
   }
 
-  void Run(size_t number_of_messages) {
+  void Run(size_t number_of_messages, std::chrono::milliseconds frame_time = 11ms) {
     _threads.CreateThread([this]() { _client_callback.run(); });
     _server.AsyncRun(_streams.size());
     _client.AsyncRun(_streams.size());
@@ -66,7 +82,7 @@ public:
     for (auto &&stream : _streams) {
       _threads.CreateThread([=]() mutable {
         for (auto i = 0u; i < number_of_messages; ++i) {
-          std::this_thread::sleep_for(11ms); // ~90FPS.
+          std::this_thread::sleep_for(frame_time); // ~90FPS by default.
           {
             CARLA_PROFILE_SCOPE(game, write_to_stream);
             stream << _message.buffer();
@@ -119,6 +135,8 @@ private:
 
   const double _success_ratio;
 
+  const Compression _compression;
+
   std::vector<Stream> _streams;
 
   std::atomic_size_t _number_of_messages_received{0u};
@@ -163,3 +181,109 @@ TEST(benchmark_streaming, image_800x600_mt) {
 TEST(benchmark_streaming, image_1920x1080_mt) {
   benchmark_image(1920u * 1080u, get_max_concurrency(), 0.9);
 }
+
+/// A synthetic BGRA camera frame, more representative of a render than a
+/// constant buffer when compressing: a smooth sky on the upper half and a
+/// noisy textured ground on the lower half.
+static carla::Buffer make_image_message(size_t width, size_t height) {
+  std::mt19937 rng(42u);
+  std::vector<uint32_t> pixels(width * height);
+  for (auto y = 0u; y < height; ++y) {
+    for (auto x = 0u; x < width; ++x) {
+      const uint32_t noise = (2u * y < height) ? 0u : rng() % 8u;
+      const uint32_t b = (200u + x * 55u / width + noise) & 0xffu;
+      const uint32_t g = (100u + y * 100u / height + noise) & 0xffu;
+      const uint32_t r = (50u + noise) & 0xffu;
+      pixels[y * width + x] = b | (g << 8u) | (r << 16u) | 0xff000000u;
+    }
+  }
+  return carla::Buffer(pixels);
+}
+
+static void benchmark_compression(Compression compression, const double success_ratio) {
+  using carla::streaming::detail::Compressor;
+  constexpr auto number_of_messages = 100u;
+  constexpr auto number_of_samples = 10u;
+  auto message = make_image_message(1920u, 1080u);
+
+  carla::Buffer frame;
+  carla::Buffer decompressed;
+  const std::vector<boost::asio::const_buffer> payload{message.buffer()};
+  size_t compress_time = 0u;
+  size_t decompress_time = 0u;
+  for (auto i = 0u; i < number_of_samples; ++i) {
+    carla::StopWatch stop_watch;
+    Compressor::Compress(compression, payload, frame);
+    stop_watch.Stop();
+    compress_time += stop_watch.GetElapsedTime<std::chrono::microseconds>();
+    stop_watch.Restart();
+    ASSERT_TRUE(Compressor::Decompress(frame, decompressed));
+    stop_watch.Stop();
+    decompress_time += stop_watch.GetElapsedTime<std::chrono::microseconds>();
+  }
+  ASSERT_TRUE(decompressed == message);
+  carla::logging::log(
+      "Compression of a 1920x1080 image:", message.size() / 1000u, "kB to",
+      frame.size() / 1000u, "kB, compress", compress_time / number_of_samples,
+      "us, decompress", decompress_time / number_of_samples, "us");
+
+  // Compressing a full HD frame takes longer than 11ms on a single core.
+  carla::logging::log("Benchmark: 1 compressed stream at 30FPS.");
+  Benchmark benchmark(TESTING_PORT, std::move(message), success_ratio, compression);
+  benchmark.AddStreams(1u);
+  benchmark.Run(number_of_messages, 33ms);
+}
+
+TEST(benchmark_streaming, image_1920x1080_lz4) {
+  benchmark_compression(Compression::LZ4, 0.9);
+}
+
+TEST(benchmark_streaming, image_1920x1080_lz4_bgra) {
+  benchmark_compression(Compression::LZ4Bgra, 0.9);
+}
+
+/// Milliseconds to deliver @a number_of_messages full HD frames written back
+/// to back. The server runs in synchronous mode so no frame is dropped.
+static size_t measure_transport(Transport transport, size_t number_of_messages) {
+  const auto message = make_image_message(1920u, 1080u);
+  Server server(TESTING_PORT);
+  server.SetSynchronousMode(true);
+  server.AsyncRun(1u);
+  auto stream = server.MakeStream();
+
+  std::atomic_size_t received{0u};
+  Client client;
+  client.SetTransport(transport);
+  client.AsyncRun(1u);
+  client.Subscribe(stream.token(), [&](carla::Buffer DEBUG_ONLY(msg)) {
+    DEBUG_ASSERT(msg == message);
+    ++received;
+  });
+  std::this_thread::sleep_for(1s);
+
+  carla::StopWatch stop_watch;
+  for (auto i = 0u; i < number_of_messages; ++i) {
+    stream << message.buffer();
+  }
+  while ((received < number_of_messages) && (stop_watch.GetElapsedTime() < 20000u)) {
+    std::this_thread::sleep_for(1ms);
+  }
+  stop_watch.Stop();
+  EXPECT_EQ(received, number_of_messages);
+  return stop_watch.GetElapsedTime();
+}
+
+TEST(benchmark_streaming, image_1920x1080_shared_memory) {
+  constexpr auto number_of_messages = 100u;
+  const auto tcp_time = measure_transport(Transport::Tcp, number_of_messages);
+  const auto shared_memory_time = measure_transport(Transport::SharedMemory, number_of_messages);
+  carla::logging::log(
+      "Delivering", number_of_messages, "1920x1080 images: TCP", tcp_time,
+      "ms, shared memory", shared_memory_time, "ms");
+
+  carla::logging::log("Benchmark: 1 stream through shared memory at 90FPS.");
+  Benchmark benchmark(TESTING_PORT, 4u * 1920u * 1080u, 0.9);
+  benchmark.SetTransport(Transport::SharedMemory);
+  benchmark.AddStreams(1u);
+  benchmark.Run(number_of_messages);
+}
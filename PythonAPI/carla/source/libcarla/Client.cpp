@@ -181,9 +181,16 @@ void export_client() {
     .def_readwrite("enable_pedestrian_navigation", &rpc::OpendriveGenerationParameters::enable_pedestrian_navigation)
   ;
 
+  enum_<carla::streaming::Transport>("StreamTransport")
+    .value("Tcp", carla::streaming::Transport::Tcp)
+    .value("SharedMemory", carla::streaming::Transport::SharedMemory)
+  ;
+
   class_<cc::Client>("Client",
       init<std::string, uint16_t, size_t>((arg("host"), arg("port"), arg("worker_threads")=0u)))
     .def("set_timeout", &::SetTimeout, (arg("seconds")))
+    .def("set_streaming_transport", &cc::Client::SetStreamingTransport, (arg("transport")))
+    .def("get_streaming_transport", &cc::Client::GetStreamingTransport)
     .def("get_client_version", &cc::Client::GetClientVersion)
     .def("get_server_version", CONST_CALL_WITHOUT_GIL(cc::Client, GetServerVersion))
     .def("get_world", &cc::Client::GetWorld)
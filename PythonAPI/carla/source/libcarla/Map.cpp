@@ -13,8 +13,13 @@
 #include <carla/client/Landmark.h>
 #include <carla/road/SignalType.h>
 
+#include <boost/python/stl_iterator.hpp>
+
+#include <cstdint>
 #include <ostream>
 #include <fstream>
+#include <stdexcept>
+#include <string>
 
 namespace carla {
 namespace client {
@@ -72,6 +77,90 @@ static auto GetLaneValidities(const carla::client::Landmark &self){
   return result;
 }
 
+/// Whether the struct module format @a format describes a single float or
+/// double in the byte order of this machine.
+static bool IsNativeFloatFormat(const std::string &format, const char type) {
+  if (format.size() == 1u) {
+    return format[0u] == type;
+  }
+  if ((format.size() != 2u) || (format[1u] != type)) {
+    return false;
+  }
+  const char byte_order = format[0u];
+  const uint16_t probe = 1u;
+  const bool is_little_endian = (*reinterpret_cast<const uint8_t *>(&probe) == 1u);
+  return
+      (byte_order == '@') ||
+      (byte_order == '=') ||
+      (byte_order == (is_little_endian ? '<' : '>')) ||
+      (!is_little_endian && (byte_order == '!'));
+}
+
+/// Reads the locations either from an object exposing a buffer of floats or
+/// doubles of shape (N, 3) (like a numpy array) or from an iterable of
+/// carla.Location.
+static std::vector<carla::geom::Location> ToLocationVector(const boost::python::object &locations) {
+  std::vector<carla::geom::Location> result;
+  Py_buffer view;
+  if (PyObject_CheckBuffer(locations.ptr()) &&
+      (PyObject_GetBuffer(locations.ptr(), &view, PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) == 0)) {
+    const std::string format = view.format != nullptr ? view.format : "B";
+    const bool is_float = IsNativeFloatFormat(format, 'f') && (view.itemsize == sizeof(float));
+    const bool is_double = IsNativeFloatFormat(format, 'd') && (view.itemsize == sizeof(double));
+    const bool has_valid_shape = (view.ndim == 2) && (view.shape != nullptr) && (view.shape[1] == 3);
+    if ((!is_float && !is_double) || !has_valid_shape) {
+      PyBuffer_Release(&view);
+      throw std::invalid_argument(
+          "locations buffer must contain float32 or float64 values in native "
+          "byte order with shape (N, 3)");
+    }
+    const size_t number_of_values = static_cast<size_t>(view.shape[0]) * 3u;
+    result.reserve(number_of_values / 3u);
+    for (size_t i = 0u; i < number_of_values; i += 3u) {
+      if (is_float) {
+        const float *values = static_cast<const float *>(view.buf) + i;
+        result.emplace_back(values[0u], values[1u], values[2u]);
+      } else {
+        const double *values = static_cast<const double *>(view.buf) + i;
+        result.emplace_back(
+            static_cast<float>(values[0u]),
+            static_cast<float>(values[1u]),
+            static_cast<float>(values[2u]));
+      }
+    }
+    PyBuffer_Release(&view);
+    return result;
+  }
+  PyErr_Clear();
+  result.assign(
+      boost::python::stl_input_iterator<carla::geom::Location>(locations),
+      boost::python::stl_input_iterator<carla::geom::Location>());
+  return result;
+}
+
+static auto GetWaypoints(
+    const carla::client::Map &self,
+    const boost::python::object &locations,
+    bool project_to_road,
+    int32_t lane_type) {
+  namespace py = boost::python;
+  const auto input = ToLocationVector(locations);
+  std::vector<carla::SharedPtr<carla::client::Waypoint>> waypoints;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    waypoints = self.GetWaypoints(input, project_to_road, lane_type);
+  }
+  py::list result;
+  for (auto &waypoint : waypoints) {
+    if (waypoint != nullptr) {
+      result.append(waypoint);
+    } else {
+      result.append(py::object());
+    }
+  }
+  return result;
+}
+
 static carla::geom::GeoLocation ToGeolocation(
     const carla::client::Map &self,
     const carla::geom::Location &location) {
@@ -160,6 +249,7 @@ void export_map() {
     .def("get_spawn_points", CALL_RETURNING_LIST(cc::Map, GetRecommendedSpawnPoints))
     .def("get_waypoint", &cc::Map::GetWaypoint, (arg("location"), arg("project_to_road")=true, arg("lane_type")=cr::Lane::LaneType::Driving))
     .def("get_waypoint_xodr", &cc::Map::GetWaypointXODR, (arg("road_id"), arg("lane_id"), arg("s")))
+    .def("get_waypoints", &GetWaypoints, (arg("locations"), arg("project_to_road")=true, arg("lane_type")=cr::Lane::LaneType::Driving))
     .def("get_topology", &GetTopology)
     .def("generate_waypoints", CALL_RETURNING_LIST_1(cc::Map, GenerateWaypoints, double), (args("distance")))
     .def("transform_to_geolocation", &ToGeolocation, (arg("location")))
@@ -25,8 +25,27 @@ void export_sensor() {
     .def(self_ns::str(self_ns::self))
   ;
 
+  enum_<cc::SensorDispatchPolicy>("SensorDispatchPolicy")
+    .value("LatestOnly", cc::SensorDispatchPolicy::LatestOnly)
+    .value("KeepN", cc::SensorDispatchPolicy::KeepN)
+    .value("Block", cc::SensorDispatchPolicy::Block)
+  ;
+
+  enum_<carla::streaming::Compression>("StreamCompression")
+    .value("NONE", carla::streaming::Compression::None) // None is reserved in Python3
+    .value("LZ4", carla::streaming::Compression::LZ4)
+    .value("LZ4Bgra", carla::streaming::Compression::LZ4Bgra)
+  ;
+
   class_<cc::ServerSideSensor, bases<cc::Sensor>, boost::noncopyable, boost::shared_ptr<cc::ServerSideSensor>>
       ("ServerSideSensor", no_init)
+    .add_property("dispatch_policy", &cc::ServerSideSensor::GetDispatchPolicy)
+    .add_property("dispatch_queue_size", &cc::ServerSideSensor::GetDispatchQueueSize)
+    .add_property("dispatch_queue_depth", &cc::ServerSideSensor::GetDispatchQueueDepth)
+    .add_property("dropped_measurement_count", &cc::ServerSideSensor::GetDroppedMeasurementCount)
+    .def("set_dispatch_policy", &cc::ServerSideSensor::SetDispatchPolicy, (arg("policy"), arg("queue_size")=3u))
+    .add_property("stream_compression", &cc::ServerSideSensor::GetStreamCompression)
+    .def("set_stream_compression", &cc::ServerSideSensor::SetStreamCompression, (arg("compression")))
     .def(self_ns::str(self_ns::self))
   ;
 
@@ -9,6 +9,7 @@
 #include <carla/image/ImageIO.h>
 #include <carla/image/ImageView.h>
 #include <carla/pointcloud/PointCloudIO.h>
+#include <carla/pointcloud/PointCloudWriter.h>
 #include <carla/sensor/SensorData.h>
 #include <carla/sensor/data/CollisionEvent.h>
 #include <carla/sensor/data/IMUMeasurement.h>
@@ -189,20 +190,141 @@ static auto GetRawDataAsBuffer(T &self) {
   return boost::python::object(boost::python::handle<>(ptr));
 }
 
+// image object resturned from optical flow to color conversion
+class FakeImage : public std::vector<uint8_t> {
+  public:
+  unsigned int Width = 0;
+  unsigned int Height = 0;
+  float FOV = 0;
+};
+
+#if PY_MAJOR_VERSION >= 3
+
+/// Shape and item type of the array exposed through the buffer protocol by a
+/// sensor measurement. Formats follow the struct module syntax, with named
+/// fields for the structured items that numpy turns into a structured dtype.
+struct SensorDataBufferLayout {
+  const char *format;
+  Py_ssize_t itemsize;
+  std::vector<Py_ssize_t> shape;
+};
+
+static SensorDataBufferLayout GetBufferLayout(const carla::sensor::data::Image &self) {
+  static_assert(sizeof(carla::sensor::data::Color) == 4u * sizeof(uint8_t), "Invalid pixel size");
+  return {"B", 1, {self.GetHeight(), self.GetWidth(), 4}};
+}
+
+static SensorDataBufferLayout GetBufferLayout(const carla::sensor::data::OpticalFlowImage &self) {
+  static_assert(sizeof(carla::sensor::data::OpticalFlowPixel) == 2u * sizeof(float), "Invalid pixel size");
+  return {"f", sizeof(float), {self.GetHeight(), self.GetWidth(), 2}};
+}
+
+static SensorDataBufferLayout GetBufferLayout(const FakeImage &self) {
+  return {"B", 1, {self.Height, self.Width, 4}};
+}
+
+static SensorDataBufferLayout GetBufferLayout(const carla::sensor::data::LidarMeasurement &self) {
+  return {"T{=f:x:f:y:f:z:f:intensity:}", sizeof(carla::sensor::data::LidarDetection), {static_cast<Py_ssize_t>(self.size())}};
+}
+
+static SensorDataBufferLayout GetBufferLayout(const carla::sensor::data::SemanticLidarMeasurement &self) {
+  return {
+      "T{=f:x:f:y:f:z:f:cos_inc_angle:I:object_idx:I:object_tag:}",
+      sizeof(carla::sensor::data::SemanticLidarDetection),
+      {static_cast<Py_ssize_t>(self.size())}};
+}
+
+static SensorDataBufferLayout GetBufferLayout(const carla::sensor::data::RadarMeasurement &self) {
+  static_assert(sizeof(carla::sensor::data::RadarDetection) == 4u * sizeof(float), "Invalid detection size");
+  return {
+      "T{=f:velocity:f:azimuth:f:altitude:f:depth:}",
+      sizeof(carla::sensor::data::RadarDetection),
+      {static_cast<Py_ssize_t>(self.size())}};
+}
+
+static SensorDataBufferLayout GetBufferLayout(const carla::sensor::data::DVSEventArray &self) {
+  static_assert(sizeof(carla::sensor::data::DVSEvent) == 13u, "DVSEvent is expected to be packed");
+  return {"T{=H:x:H:y:q:t:?:pol:}", sizeof(carla::sensor::data::DVSEvent), {static_cast<Py_ssize_t>(self.size())}};
+}
+
+/// bf_getbuffer of the measurements, the view points to the data of the
+/// measurement and keeps its Python object, hence the measurement, alive.
+template <typename T>
+static int GetSensorDataBuffer(PyObject *exporter, Py_buffer *view, int flags) {
+  boost::python::extract<T &> extract(exporter);
+  if (!extract.check()) {
+    PyErr_SetString(PyExc_BufferError, "object does not hold sensor data");
+    view->obj = nullptr;
+    return -1;
+  }
+  T &self = extract();
+  const auto layout = GetBufferLayout(self);
+  const auto ndim = static_cast<int>(layout.shape.size());
+  // Shape and strides live until the buffer is released.
+  auto *dimensions = new Py_ssize_t[2u * layout.shape.size()];
+  Py_ssize_t stride = layout.itemsize;
+  for (auto i = ndim - 1; i >= 0; --i) {
+    dimensions[i] = layout.shape[i];
+    dimensions[ndim + i] = stride;
+    stride *= layout.shape[i];
+  }
+  DEBUG_ASSERT(stride == static_cast<Py_ssize_t>(sizeof(typename T::value_type) * self.size()));
+  view->buf = self.data();
+  view->obj = exporter;
+  Py_INCREF(exporter);
+  view->len = stride;
+  view->readonly = 0;
+  view->itemsize = layout.itemsize;
+  view->format = (flags & PyBUF_FORMAT) ? const_cast<char *>(layout.format) : nullptr;
+  view->ndim = ndim;
+  view->shape = (flags & PyBUF_ND) ? dimensions : nullptr;
+  view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? dimensions + ndim : nullptr;
+  view->suboffsets = nullptr;
+  view->internal = dimensions;
+  return 0;
+}
+
+static void ReleaseSensorDataBuffer(PyObject *, Py_buffer *view) {
+  delete[] static_cast<Py_ssize_t *>(view->internal);
+}
+
+/// Make the instances of the class @a T, exported with boost::python,
+/// support the buffer protocol, so memoryview(data) or numpy.asarray(data)
+/// give a typed, shaped view of the measurement without copying it.
+template <typename T>
+static void ExportBufferProtocol(const boost::python::object &cls) {
+  auto *type = reinterpret_cast<PyTypeObject *>(cls.ptr());
+  if (!(type->tp_flags & Py_TPFLAGS_HEAPTYPE)) {
+    throw std::runtime_error("buffer protocol can only be added to heap types");
+  }
+  auto *heap_type = reinterpret_cast<PyHeapTypeObject *>(type);
+  heap_type->as_buffer.bf_getbuffer = &GetSensorDataBuffer<T>;
+  heap_type->as_buffer.bf_releasebuffer = &ReleaseSensorDataBuffer;
+  type->tp_as_buffer = &heap_type->as_buffer;
+}
+
+#else
+
+template <typename T>
+static void ExportBufferProtocol(const boost::python::object &) {}
+
+#endif // PY_MAJOR_VERSION >= 3
+
 template <typename T>
 static void ConvertImage(T &self, EColorConverter cc) {
   carla::PythonUtil::ReleaseGIL unlock;
   using namespace carla::image;
-  auto view = ImageView::MakeView(self);
+  // Use a thread per core, the GIL is released.
+  constexpr size_t number_of_threads = 0u;
   switch (cc) {
     case EColorConverter::Depth:
-      ImageConverter::ConvertInPlace(view, ColorConverter::Depth());
+      ImageConverter::ConvertInPlace(self, ColorConverter::Depth(), number_of_threads);
       break;
     case EColorConverter::LogarithmicDepth:
-      ImageConverter::ConvertInPlace(view, ColorConverter::LogarithmicDepth());
+      ImageConverter::ConvertInPlace(self, ColorConverter::LogarithmicDepth(), number_of_threads);
       break;
     case EColorConverter::CityScapesPalette:
-      ImageConverter::ConvertInPlace(view, ColorConverter::CityScapesPalette());
+      ImageConverter::ConvertInPlace(self, ColorConverter::CityScapesPalette(), number_of_threads);
       break;
     case EColorConverter::Raw:
       break; // ignore.
@@ -211,116 +333,44 @@ static void ConvertImage(T &self, EColorConverter cc) {
   }
 }
 
-// image object resturned from optical flow to color conversion
-class FakeImage : public std::vector<uint8_t> {
-  public:
-  unsigned int Width = 0;
-  unsigned int Height = 0;
-  float FOV = 0;
-};
-// method to convert optical flow images to rgb
-static FakeImage ColorCodedFlow (
-    carla::sensor::data::OpticalFlowImage& image) {
+/// Color code the optical flow of @a image. The result is written into
+/// @a output if given, any object exposing a writable, contiguous buffer of
+/// 4 bytes per pixel (e.g. a numpy array of shape (height, width, 4) and
+/// dtype uint8) that can be reused every frame; otherwise a new FakeImage is
+/// returned.
+static boost::python::object ColorCodedFlow(
+    const carla::sensor::data::OpticalFlowImage &image,
+    boost::python::object output) {
   namespace bp = boost::python;
-  namespace csd = carla::sensor::data;
-  constexpr float pi = 3.1415f;
-  constexpr float rad2ang = 360.f/(2.f*pi);
-  FakeImage result;
-  result.Width = image.GetWidth();
-  result.Height = image.GetHeight();
-  result.FOV = image.GetFOVAngle();
-  result.resize(image.GetHeight()*image.GetWidth()* 4);
-
-  // lambda for computing batches of pixels
-  auto command = [&] (size_t min_index, size_t max_index) {
-    for (size_t index = min_index; index < max_index; index++) {
-      const csd::OpticalFlowPixel& pixel = image[index];
-      float vx = pixel.x;
-      float vy = pixel.y;
-
-      float angle = 180.f + std::atan2(vy, vx)*rad2ang;
-      if (angle < 0) angle = 360.f + angle;
-      angle = std::fmod(angle, 360.f);
-
-      float norm = std::sqrt(vx*vx + vy*vy);
-      const float shift = 0.999f;
-      const float a = 1.f/std::log(0.1f + shift);
-      float intensity = carla::geom::Math::Clamp(a*std::log(norm + shift), 0.f, 1.f);
-
-      float& H = angle;
-      float  S = 1.f;
-      float V = intensity;
-      float H_60 = H*(1.f/60.f);
-
-      float C = V * S;
-      float X = C*(1.f - std::abs(std::fmod(H_60, 2.f) - 1.f));
-      float m = V - C;
-
-      float r = 0,g = 0,b = 0;
-      unsigned int angle_case = static_cast<unsigned int>(H_60);
-      switch (angle_case) {
-      case 0:
-        r = C;
-        g = X;
-        b = 0;
-        break;
-      case 1:
-        r = X;
-        g = C;
-        b = 0;
-        break;
-      case 2:
-        r = 0;
-        g = C;
-        b = X;
-        break;
-      case 3:
-        r = 0;
-        g = X;
-        b = C;
-        break;
-      case 4:
-        r = X;
-        g = 0;
-        b = C;
-        break;
-      case 5:
-        r = C;
-        g = 0;
-        b = X;
-        break;
-      default:
-        r = 1;
-        g = 1;
-        b = 1;
-        break;
-      }
-
-      uint8_t R = static_cast<uint8_t>((r+m)*255.f);
-      uint8_t G = static_cast<uint8_t>((g+m)*255.f);
-      uint8_t B = static_cast<uint8_t>((b+m)*255.f);
-      result[4*index] = B;
-      result[4*index + 1] = G;
-      result[4*index + 2] = R;
-      result[4*index + 3] = 0;
+  using carla::image::ImageConverter;
+  // Use a thread per core, the GIL is released.
+  constexpr size_t number_of_threads = 0u;
+  if (output.is_none()) {
+    auto result = boost::make_shared<FakeImage>();
+    result->Width = image.GetWidth();
+    result->Height = image.GetHeight();
+    result->FOV = image.GetFOVAngle();
+    result->resize(4u * image.size());
+    {
+      carla::PythonUtil::ReleaseGIL unlock;
+      ImageConverter::ColorCodedFlow(image, result->data(), number_of_threads);
     }
-  };
-  size_t num_threads = std::max(8u, std::thread::hardware_concurrency());
-  size_t batch_size = image.size() / num_threads;
-  std::vector<std::thread*> t(num_threads+1);
-
-  for(size_t n = 0; n < num_threads; n++) {
-    t[n] = new std::thread(command, n * batch_size, (n+1) * batch_size);
+    return bp::object(result);
   }
-  t[num_threads] = new std::thread(command, num_threads * batch_size, image.size());
-
-  for(size_t n = 0; n <= num_threads; n++) {
-    if(t[n]->joinable()){
-      t[n]->join();
-    }
-    delete t[n];
+  Py_buffer view;
+  if (PyObject_GetBuffer(output.ptr(), &view, PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS) != 0) {
+    bp::throw_error_already_set();
+  }
+  if (static_cast<size_t>(view.len) != 4u * image.size()) {
+    PyBuffer_Release(&view);
+    throw std::invalid_argument("output buffer must have 4 bytes per pixel of the optical flow image");
+  }
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    ImageConverter::ColorCodedFlow(image, static_cast<uint8_t *>(view.buf), number_of_threads);
   }
-  return result;
+  PyBuffer_Release(&view);
+  return output;
 }
 
 template <typename T>
@@ -351,9 +401,42 @@ static std::string SaveImageToDisk(T &self, std::string path, EColorConverter cc
 }
 
 template <typename T>
-static std::string SavePointCloudToDisk(T &self, std::string path) {
+static std::string SavePointCloudToDisk(T &self, std::string path, bool binary) {
   carla::PythonUtil::ReleaseGIL unlock;
-  return carla::pointcloud::PointCloudIO::SaveToDisk(std::move(path), self.begin(), self.end());
+  using carla::pointcloud::PointCloudIO;
+  return PointCloudIO::SaveToDisk(
+      std::move(path),
+      self.begin(),
+      self.end(),
+      binary ? PointCloudIO::Format::BinaryLittleEndian : PointCloudIO::Format::Ascii);
+}
+
+template <typename T>
+static void ExportPointCloudWriter(const char *name) {
+  using namespace boost::python;
+  using Writer = carla::pointcloud::PointCloudWriter<typename T::value_type>;
+  class_<Writer, boost::noncopyable, boost::shared_ptr<Writer>>(
+      name,
+      init<std::string, size_t>((arg("path"), arg("queue_size")=16u)))
+    .add_property("path", CALL_RETURNING_COPY(Writer, GetPath))
+    .def("write", +[](Writer &self, const boost::shared_ptr<T> &measurement) {
+      // This pointer drops a reference to the Python object when deleted, the
+      // writer's thread may be the one deleting it, so it must take the GIL.
+      using Deleter = carla::PythonUtil::AcquireGILDeleter;
+      const carla::SharedPtr<boost::shared_ptr<T>> holder{
+          new boost::shared_ptr<T>(measurement),
+          Deleter()};
+      carla::SharedPtr<const T> ptr{holder, holder->get()};
+      // Write waits for room in the queue, while the writer's thread may
+      // need the GIL to release the measurements already written.
+      carla::PythonUtil::ReleaseGIL unlock;
+      self.Write(std::move(ptr));
+    }, (arg("measurement")))
+    .def("close", +[](Writer &self) {
+      carla::PythonUtil::ReleaseGIL unlock;
+      self.Close();
+    })
+  ;
 }
 
 void export_sensor_data() {
@@ -366,7 +449,7 @@ void export_sensor_data() {
 
   // Fake image returned from optical flow to color conversion
   // fakes the regular image object
-  class_<FakeImage>("FakeImage", no_init)
+  class_<FakeImage, boost::shared_ptr<FakeImage>>("FakeImage", no_init)
       .def(vector_indexing_suite<std::vector<uint8_t>>())
       .add_property("width", &FakeImage::Width)
       .add_property("height", &FakeImage::Height)
@@ -410,7 +493,7 @@ void export_sensor_data() {
     .add_property("height", &csd::OpticalFlowImage::GetHeight)
     .add_property("fov", &csd::OpticalFlowImage::GetFOVAngle)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::OpticalFlowImage>)
-    .def("get_color_coded_flow", &ColorCodedFlow)
+    .def("get_color_coded_flow", &ColorCodedFlow, (arg("output")=object()))
     .def("__len__", &csd::OpticalFlowImage::size)
     .def("__iter__", iterator<csd::OpticalFlowImage>())
     .def("__getitem__", +[](const csd::OpticalFlowImage &self, size_t pos) -> csd::OpticalFlowPixel {
@@ -427,7 +510,7 @@ void export_sensor_data() {
     .add_property("channels", &csd::LidarMeasurement::GetChannelCount)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::LidarMeasurement>)
     .def("get_point_count", &csd::LidarMeasurement::GetPointCount, (arg("channel")))
-    .def("save_to_disk", &SavePointCloudToDisk<csd::LidarMeasurement>, (arg("path")))
+    .def("save_to_disk", &SavePointCloudToDisk<csd::LidarMeasurement>, (arg("path"), arg("binary")=false))
     .def("__len__", &csd::LidarMeasurement::size)
     .def("__iter__", iterator<csd::LidarMeasurement>())
     .def("__getitem__", +[](const csd::LidarMeasurement &self, size_t pos) -> csd::LidarDetection {
@@ -444,7 +527,7 @@ void export_sensor_data() {
     .add_property("channels", &csd::SemanticLidarMeasurement::GetChannelCount)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::SemanticLidarMeasurement>)
     .def("get_point_count", &csd::SemanticLidarMeasurement::GetPointCount, (arg("channel")))
-    .def("save_to_disk", &SavePointCloudToDisk<csd::SemanticLidarMeasurement>, (arg("path")))
+    .def("save_to_disk", &SavePointCloudToDisk<csd::SemanticLidarMeasurement>, (arg("path"), arg("binary")=false))
     .def("__len__", &csd::SemanticLidarMeasurement::size)
     .def("__iter__", iterator<csd::SemanticLidarMeasurement>())
     .def("__getitem__", +[](const csd::SemanticLidarMeasurement &self, size_t pos) -> csd::SemanticLidarDetection {
@@ -456,6 +539,9 @@ void export_sensor_data() {
     .def(self_ns::str(self_ns::self))
   ;
 
+  ExportPointCloudWriter<csd::LidarMeasurement>("LidarPointCloudWriter");
+  ExportPointCloudWriter<csd::SemanticLidarMeasurement>("SemanticLidarPointCloudWriter");
+
   class_<csd::CollisionEvent, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::CollisionEvent>>("CollisionEvent", no_init)
     .add_property("actor", &csd::CollisionEvent::GetActor)
     .add_property("other_actor", &csd::CollisionEvent::GetOtherActor)
@@ -555,4 +641,12 @@ void export_sensor_data() {
     .def("to_array_pol", CALL_RETURNING_LIST(csd::DVSEventArray, ToArrayPol))
     .def(self_ns::str(self_ns::self))
   ;
+
+  ExportBufferProtocol<FakeImage>(scope().attr("FakeImage"));
+  ExportBufferProtocol<csd::Image>(scope().attr("Image"));
+  ExportBufferProtocol<csd::OpticalFlowImage>(scope().attr("OpticalFlowImage"));
+  ExportBufferProtocol<csd::LidarMeasurement>(scope().attr("LidarMeasurement"));
+  ExportBufferProtocol<csd::SemanticLidarMeasurement>(scope().attr("SemanticLidarMeasurement"));
+  ExportBufferProtocol<csd::RadarMeasurement>(scope().attr("RadarMeasurement"));
+  ExportBufferProtocol<csd::DVSEventArray>(scope().attr("DVSEventArray"));
 }
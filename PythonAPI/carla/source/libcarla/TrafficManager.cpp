@@ -38,5 +38,6 @@ void export_trafficmanager() {
     .def("set_osm_mode", &carla::traffic_manager::TrafficManager::SetOSMMode)
     .def("set_respawn_dormant_vehicles", &carla::traffic_manager::TrafficManager::SetRespawnDormantVehicles)
     .def("set_boundaries_respawn_dormant_vehicles", &carla::traffic_manager::TrafficManager::SetBoundariesRespawnDormantVehicles)
+    .def("set_worker_threads", &carla::traffic_manager::TrafficManager::SetWorkerThreads)
     .def("shut_down", &ctm::TrafficManager::ShutDown);
 }
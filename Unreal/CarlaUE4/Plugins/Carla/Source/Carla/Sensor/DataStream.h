@@ -50,6 +50,13 @@ public:
     return (*Stream).token();
   }
 
+  /// Return the number of clients that subscribed to this stream so far.
+  size_t GetConnectionCount() const
+  {
+    check(Stream.has_value());
+    return (*Stream).GetConnectionCount();
+  }
+
 private:
 
   boost::optional<StreamType> Stream;
@@ -69,6 +69,9 @@ void ARadar::BeginPlay()
 void ARadar::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTime)
 {
   TRACE_CPUPROFILER_EVENT_SCOPE(ARadar::PostPhysTick);
+  // Detections go straight into a pooled buffer that is later handed over.
+  auto DataStream = GetDataStream(*this);
+  RadarData.AcquireBuffer(DataStream.PopBufferFromPool());
   CalculateCurrentVelocity(DeltaTime);
 
   RadarData.Reset();
@@ -76,8 +79,7 @@ void ARadar::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTime)
 
   {
     TRACE_CPUPROFILER_EVENT_SCOPE_STR("Send Stream");
-    auto DataStream = GetDataStream(*this);
-    DataStream.Send(*this, RadarData, DataStream.PopBufferFromPool());
+    DataStream.Send(*this, RadarData);
   }
 }
 
@@ -57,12 +57,13 @@ void ARayCastLidar::Set(const FLidarDescription &LidarDescription)
 void ARayCastLidar::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTime)
 {
   TRACE_CPUPROFILER_EVENT_SCOPE(ARayCastLidar::PostPhysTick);
+  auto DataStream = GetDataStream(*this);
+  LidarData.AcquireBuffer(DataStream.PopBufferFromPool());
   SimulateLidar(DeltaTime);
 
   {
     TRACE_CPUPROFILER_EVENT_SCOPE_STR("Send Stream");
-    auto DataStream = GetDataStream(*this);
-    DataStream.Send(*this, LidarData, DataStream.PopBufferFromPool());
+    DataStream.Send(*this, LidarData);
   }
 }
 
@@ -67,12 +67,15 @@ void ARayCastSemanticLidar::CreateLasers()
 void ARayCastSemanticLidar::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTime)
 {
   TRACE_CPUPROFILER_EVENT_SCOPE(ARayCastSemanticLidar::PostPhysTick);
+  // The measurement is written straight into a buffer of the stream's pool,
+  // sending it does not copy the points again.
+  auto DataStream = GetDataStream(*this);
+  SemanticLidarData.AcquireBuffer(DataStream.PopBufferFromPool());
   SimulateLidar(DeltaTime);
 
   {
     TRACE_CPUPROFILER_EVENT_SCOPE_STR("Send Stream");
-    auto DataStream = GetDataStream(*this);
-    DataStream.Send(*this, SemanticLidarData, DataStream.PopBufferFromPool());
+    DataStream.Send(*this, SemanticLidarData);
   }
 }
 
@@ -7,6 +7,7 @@
 #include "Carla.h"
 #include "Carla/Sensor/WorldObserver.h"
 #include "Carla/Actor/ActorData.h"
+#include "Carla/Game/CarlaEngine.h"
 
 #include "Carla/Traffic/TrafficLightBase.h"
 #include "Carla/Traffic/TrafficLightComponent.h"
@@ -261,6 +262,7 @@ static carla::geom::Vector3D FWorldObserver_GetAcceleration(
 
 static carla::Buffer FWorldObserver_Serialize(
     carla::Buffer &&buffer,
+    carla::sensor::s11n::EpisodeStateEncoder &Encoder,
     const UCarlaEpisode &Episode,
     float DeltaSeconds,
     bool MapChange,
@@ -274,17 +276,6 @@ static carla::Buffer FWorldObserver_Serialize(
 
   const FActorRegistry &Registry = Episode.GetActorRegistry();
 
-  auto total_size = sizeof(Serializer::Header) + sizeof(ActorDynamicState) * Registry.Num();
-  auto current_size = 0;
-  // Set up buffer for writing.
-  buffer.reset(total_size);
-  auto write_data = [&current_size, &buffer](const auto &data)
-  {
-    auto begin = buffer.begin() + current_size;
-    std::memcpy(begin, &data, sizeof(data));
-    current_size += sizeof(data);
-  };
-
   constexpr float TO_METERS = 1e-2;
 
   // Write header.
@@ -301,7 +292,12 @@ static carla::Buffer FWorldObserver_Serialize(
 
   header.simulation_state = static_cast<SimulationState>(simulation_state);
 
-  write_data(header);
+  Encoder.Begin(
+      std::move(buffer),
+      FCarlaEngine::GetFrameCounter(),
+      header,
+      Registry.Num(),
+      Episode.GetSettings().bDeltaEpisodeState);
 
   // Write every actor.
   for (auto& It : Registry)
@@ -347,15 +343,10 @@ static carla::Buffer FWorldObserver_Serialize(
       Acceleration,
       State,
     };
-    write_data(info);
+    Encoder.Add(info);
   }
 
-  // Shrink buffer
-  buffer.resize(current_size);
-
-  check(buffer.size() == current_size);
-
-  return std::move(buffer);
+  return Encoder.End();
 }
 
 void FWorldObserver::BroadcastTick(
@@ -367,8 +358,17 @@ void FWorldObserver::BroadcastTick(
   TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
   auto AsyncStream = Stream.MakeAsyncDataStream(*this, Episode.GetElapsedGameTime());
 
+  // A client that just subscribed has no state to apply deltas to.
+  const size_t ConnectionCount = Stream.GetConnectionCount();
+  if (ConnectionCount != LastConnectionCount)
+  {
+    LastConnectionCount = ConnectionCount;
+    Encoder.ForceKeyframe();
+  }
+
   carla::Buffer buffer = FWorldObserver_Serialize(
       AsyncStream.PopBufferFromPool(),
+      Encoder,
       Episode,
       DeltaSecond,
       MapChange,
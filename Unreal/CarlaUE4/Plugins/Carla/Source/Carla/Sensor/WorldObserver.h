@@ -8,6 +8,10 @@
 
 #include "Carla/Sensor/DataStream.h"
 
+#include <compiler/disable-ue4-macros.h>
+#include <carla/sensor/s11n/EpisodeStateEncoder.h>
+#include <compiler/enable-ue4-macros.h>
+
 class UCarlaEpisode;
 
 /// Serializes and sends all the actors in the current UCarlaEpisode.
@@ -47,4 +51,11 @@ public:
 private:
 
   FDataMultiStream Stream;
+
+  /// Remembers the actor states sent for the delta mode of the stream.
+  carla::sensor::s11n::EpisodeStateEncoder Encoder;
+
+  /// Clients subscribed to the stream as of the last tick, a new one gets a
+  /// keyframe.
+  size_t LastConnectionCount = 0u;
 };
@@ -37,4 +37,9 @@ struct CARLA_API FEpisodeSettings
 
   float ActorActiveDistance = 200000.f; // 3km
 
+  /// Send only the actors that changed in the episode state stream, with
+  /// periodic keyframes.
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  bool bDeltaEpisodeState = false;
+
 };